@@ -96,9 +96,11 @@ G::DirectoryTree::DirectoryTree( const Path & path , bool reverse , DirectoryTre
 G::DirectoryTree::FileList G::DirectoryTree::readFileList() const
 {
 	FileList file_list ;
+	const G::Path & path = (*m_stack.back().m_p).m_path ;
+	if( m_callback == nullptr || !m_callback->directoryTreeList( path , file_list ) )
 	{
 		G::Root claim_root ;
-		G::DirectoryList::readAll( (*m_stack.back().m_p).m_path , file_list , true ) ;
+		G::DirectoryList::readAll( path , file_list , true ) ;
 	}
 	G_ASSERT( is__sorted(file_list.begin(),file_list.end(),compare_names) ) ;
 	filter( file_list , m_stack.size() ) ;
@@ -276,12 +278,16 @@ void G::DirectoryTree::filter( FileList & list , size_t depth ) const
 	}
 }
 
-bool G::DirectoryTree::ignore( const FileItem & item , size_t depth ) const
+bool G::DirectoryTree::ignore( FileItem & item , size_t depth ) const
 {
-	if( m_callback )
-		return m_callback->directoryTreeIgnore( item , depth ) ;
-	else
+	if( m_callback == nullptr )
 		return false ;
+
+	// container files are traversed as if they were directories
+	if( !item.m_is_dir && m_callback->directoryTreeContainer( item , depth ) )
+		item.m_is_dir = true ;
+
+	return m_callback->directoryTreeIgnore( item , depth ) ;
 }
 
 bool G::DirectoryTree::reversed() const
@@ -295,4 +301,14 @@ G::DirectoryTreeCallback::~DirectoryTreeCallback()
 {
 }
 
+bool G::DirectoryTreeCallback::directoryTreeContainer( const G::DirectoryList::Item & , size_t )
+{
+	return false ;
+}
+
+bool G::DirectoryTreeCallback::directoryTreeList( const G::Path & , std::vector<G::DirectoryList::Item> & )
+{
+	return false ;
+}
+
 /// \file gdirectorytree.cpp
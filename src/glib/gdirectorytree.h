@@ -56,7 +56,9 @@ public:
 			///< An optional callback function, taking a path and a depth,
 			///< can be used to filter out files and directories that
 			///< should be ignored. Directories that are ignored are not
-			///< traversed at all.
+			///< traversed at all. The callback can also nominate files
+			///< that should be traversed as if they were directories, 
+			///< such as archive files.
 
 	DirectoryTree & operator++() ;
 		///< Pre-increment operator. Moves to the next file or directory.
@@ -126,7 +128,7 @@ private:
 	static bool isDir( const Path & ) ;
 	FileList readFileList() const ;
 	void filter( FileList & , size_t ) const ;
-	bool ignore( const FileItem & , size_t ) const ;
+	bool ignore( FileItem & , size_t ) const ;
 
 private:
 	Stack m_stack ;
@@ -135,7 +137,8 @@ private:
 } ;
 
 /// \class G::DirectoryTreeCallback
-/// A callback interface to allow G::DirectoryTree to ignore paths.
+/// A callback interface to allow G::DirectoryTree to ignore paths, and to 
+/// look inside container files.
 /// 
 class G::DirectoryTreeCallback
 {
@@ -143,6 +146,20 @@ public:
 	virtual bool directoryTreeIgnore( const G::DirectoryList::Item & , size_t depth ) = 0 ;
 		///< Returns true if the file should be ignored.
 
+	virtual bool directoryTreeContainer( const G::DirectoryList::Item & , size_t depth ) ;
+		///< Returns true if the given non-directory item is a container
+		///< file that should be traversed as if it were a directory, with
+		///< its contents obtained from directoryTreeList(). This should
+		///< normally be a cheap test, eg. on the file name. This default
+		///< implementation returns false.
+
+	virtual bool directoryTreeList( const G::Path & , std::vector<G::DirectoryList::Item> & ) ;
+		///< Returns by reference the sorted contents of a container file
+		///< or of a directory within a container, returning false if 
+		///< the path is not a container path. Entries that are 
+		///< directories within the container should have m_is_dir 
+		///< set. This default implementation returns false.
+
 protected:
 	virtual ~DirectoryTreeCallback() ;
 } ;
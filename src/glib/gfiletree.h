@@ -38,6 +38,11 @@ namespace G
 /// implementation uses G::DirectoryTree, transparently stepping over 
 /// directories. 
 /// 
+/// If the callback object nominates container files (see 
+/// G::DirectoryTreeCallback::directoryTreeContainer()) then their contents 
+/// are visited as files with paths that look like they are underneath
+/// the container, and these paths can also be used for repositioning.
+/// 
 /// The iteration model is:
 /// \code
 /// while( tree.next() != G::Path() )
@@ -146,6 +146,9 @@ void G::LogOutput::doOutput( Log::Severity severity , const char * /*file*/ , in
 	bool do_output = at( severity ) ;
 	if( do_output )
 	{
+		// some programs log from worker threads, and the timestamp cache is shared
+		G::threading::lock_type lock( m_mutex ) ;
+
 		// allocate a buffer
 		const size_type limit = static_cast<size_type>(limits::log) ;
 		std::string buffer ;
@@ -134,6 +134,7 @@ private:
 	time_t m_time ;
 	std::vector<char> m_time_buffer ;
 	bool m_timestamp ;
+	G::threading::mutex_type m_mutex ; // serialises doOutput() across threads
 	HANDLE m_handle ; // windows
 	bool m_handle_set ;
 } ;
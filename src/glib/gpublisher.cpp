@@ -37,6 +37,7 @@
 #include <cstring>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sched.h>
 #include <string.h>
 
 namespace G
@@ -47,6 +48,7 @@ namespace G
 	namespace PublisherImp
 	{
 		struct DataMemory ;
+		struct DataBuffer ;
 		struct ControlMemory ;
 		struct Slot ;
 		struct InfoSlot ;
@@ -54,7 +56,8 @@ namespace G
 		struct SocketHolder ;
 		struct Snapshot ;
 		enum { ERRORS = 5 } ;
-		enum { SLOTS = 10 } ;
+		enum { SLOTS = 128 } ; // default number of subscriber slots
+		enum { BUFFERS = 3 } ; // minimum number of data buffers in the ring
 		enum { MAGIC = 0xa5a5 } ;
 		enum { e_connect , e_unlink , e_send } ; // error[] index
 		enum { socket_path_size = 200 } ;
@@ -73,8 +76,8 @@ namespace G
 		static void closeAllSlots( SignalSafe , ControlMemory * mem ) ;
 		static void closeSlot( SignalSafe , Slot & ) ;
 		static void clearSlot( SignalSafe , Slot & ) ;
-		static void notifyAll( SignalSafe , ControlMemory * , PublisherInfo & ) ;
-		static void notifyOne( SignalSafe , Slot & , InfoSlot & ) ;
+		static void notifyAll( SignalSafe , ControlMemory * , PublisherInfo * ) ;
+		static void notifyOne( SignalSafe , Slot & , InfoSlot * ) ;
 		static void cleanupControlMemory( SignalSafe , const char * ) ;
 		static void cleanupDataMemory( SignalSafe , const char * ) ;
 		static void cleanupProcess( SignalSafe signal_safe , const char * ) ;
@@ -83,15 +86,21 @@ namespace G
 		static size_t findFreeSlot( ControlMemory & ) ;
 		static void claimSlot( Slot & , const std::string & , pid_t ) ;
 		static void publish( SharedMemory & , unique_ptr<SharedMemory> & , PublisherInfo & , const std::string & ,
-			size_t data_total , size_t data_count , const char ** data_p_p , size_t * data_n_p , const char * type ) ;
+			size_t buffers , size_t data_total , size_t data_count , const char ** data_p_p , size_t * data_n_p , 
+			const char * type , const PublisherHeader * ) ;
 		static size_t subscribe( SharedMemory & shmem_control , SocketHolder & , const std::string & ) ;
 		static void releaseSlot( SharedMemory & shmem_control , size_t slot_id ) ;
 		static void releaseSlot( SignalSafe , Lock & , Slot & ) ;
 		static size_t flush( int socket_fd ) ;
 		static bool getch( int socket_fd ) ;
 		static bool receive( SharedMemory & shmem_control , unique_ptr<SharedMemory> & shmem_data ,
-			const std::string & , size_t slot_id , int socket_fd , std::vector<char> & buffer , 
-			std::string * type_p , G::EpochTime * time_p ) ;
+			const std::string & , size_t slot_id , int socket_fd , std::vector<char> * buffer_p , 
+			PublisherView * view_p , std::string * type_p , G::EpochTime * time_p ,
+			PublisherHeader * header_p ) ;
+		static void clear( std::vector<char> * , PublisherView * , std::string * , PublisherHeader * ) ;
+		static bool attach( SharedMemory & shmem_control , unique_ptr<SharedMemory> & shmem_data , const std::string & ) ;
+		static bool history( SharedMemory & shmem_control , unique_ptr<SharedMemory> & shmem_data , 
+			const std::string & , G::EpochTime since , std::vector<PublisherView> & ) ;
 		static std::vector<std::string> list( std::vector<std::string> * ) ;
 		static G::Item info( const std::string & channel_name , bool detail , bool all_slots ) ;
 		static void purge( const std::string & channel_name ) ;
@@ -101,6 +110,11 @@ namespace G
 		static void strget( const char * p_in , size_t n_in , std::string & s_out ) ;
 		static std::string strget( const char * p_in , size_t n_in ) ;
 		static size_t morethan( size_t ) ;
+		static size_t controlSize( size_t slots ) ;
+		static size_t dataOffset( size_t buffers ) ;
+		static size_t segmentSize( size_t buffers , size_t size_limit ) ;
+		static char * bufferData( DataMemory * , size_t index , size_t size_limit ) ;
+		static void barrier() ;
 	}
 } ;
 
@@ -111,6 +125,7 @@ struct G::PublisherImp::Slot
 {
 	bool in_use ; // subscriber lock
 	bool failed ; // publisher failure
+	bool pending ; // notification sent but not yet consumed
 	pid_t pid ; // subscriber's pid
 	unsigned long seq ;
 	int socket_fd ; // publisher's fd
@@ -119,7 +134,8 @@ struct G::PublisherImp::Slot
 } ;
 
 /// \class G::PublisherImp::ControlMemory
-/// A shared-memory structure used by G::Publisher.
+/// A shared-memory structure used by G::Publisher. The slot array is 
+/// sized when the segment is created.
 ///
 struct G::PublisherImp::ControlMemory
 {
@@ -128,20 +144,39 @@ struct G::PublisherImp::ControlMemory
 	pid_t publisher_pid ;
 	char publisher_info[2048] ; // eg. json
 	unsigned long seq ;
-	Slot slot[SLOTS] ;
+	size_t slots ;
+	Slot slot[1] ; // [slots]
 } ;
 
-/// \class G::PublisherImp::DataMemory
-/// A shared-memory structure used by G::Publisher.
+/// \class G::PublisherImp::DataBuffer
+/// A shared-memory structure used by G::Publisher to describe one of the 
+/// data buffers in the ring. The generation number is odd while the 
+/// publisher is writing into the buffer, and it also changes when the
+/// data segment is resized.
 ///
-struct G::PublisherImp::DataMemory
+struct G::PublisherImp::DataBuffer
 {
-	size_t size_limit ;
+	unsigned long gen ;
+	unsigned long seq ;
 	char type[60] ;
 	time_t time_s ;
 	g_uint32_t time_us ;
 	size_t data_size ;
-	char data[1] ;
+	PublisherHeader header ;
+} ;
+
+/// \class G::PublisherImp::DataMemory
+/// A shared-memory structure used by G::Publisher. The payload data 
+/// follows the array of buffer descriptors as a ring of equal-sized 
+/// buffers, each 'size_limit' bytes long. The number of buffers
+/// is fixed when the segment is created.
+///
+struct G::PublisherImp::DataMemory
+{
+	size_t size_limit ; // per buffer
+	size_t latest ; // buffer index
+	size_t buffers ;
+	DataBuffer buffer[1] ; // [buffers]
 } ;
 
 /// \class G::PublisherImp::Lock
@@ -173,9 +208,11 @@ struct G::PublisherImp::SocketHolder
 ///
 struct G::PublisherImp::Snapshot
 {
-	ControlMemory control ;
+	ControlMemory control ; // excluding slots
+	std::vector<Slot> slots ;
 	bool has_data ;
-	DataMemory data ;
+	DataMemory data ; // excluding buffers
+	DataBuffer latest ;
 } ;
 
 /// \class G::PublisherImp::InfoSlot
@@ -201,17 +238,19 @@ struct G::PublisherImp::InfoSlot
 ///
 struct G::PublisherInfo
 {
+	explicit PublisherInfo( size_t slots ) ;
 	void clear( SignalSafe ) ;
 	//
-	PublisherImp::InfoSlot slot[PublisherImp::SLOTS] ;
+	std::vector<PublisherImp::InfoSlot> slot ;
 } ;
 
 // ==
 
 G::Publisher::Publisher( const std::string & name , bool auto_cleanup ) :
 	m_name(PublisherImp::checkName(name)) ,
-	m_shmem_control(name,sizeof(PublisherImp::ControlMemory),SharedMemory::Control()) ,
-	m_info(new PublisherInfo)
+	m_buffers(PublisherImp::BUFFERS) ,
+	m_shmem_control(name,PublisherImp::controlSize(PublisherImp::SLOTS),SharedMemory::Control()) ,
+	m_info(new PublisherInfo(PublisherImp::SLOTS))
 {
 	G::Item info = G::Item::map() ;
 	info.add( "type" , G::Path(G::Arg::v0()).basename() ) ;
@@ -220,8 +259,20 @@ G::Publisher::Publisher( const std::string & name , bool auto_cleanup ) :
 
 G::Publisher::Publisher( const std::string & name , G::Item info , bool auto_cleanup ) :
 	m_name(PublisherImp::checkName(name)) ,
-	m_shmem_control(name,sizeof(PublisherImp::ControlMemory),SharedMemory::Control()) ,
-	m_info(new PublisherInfo)
+	m_buffers(PublisherImp::BUFFERS) ,
+	m_shmem_control(name,PublisherImp::controlSize(PublisherImp::SLOTS),SharedMemory::Control()) ,
+	m_info(new PublisherInfo(PublisherImp::SLOTS))
+{
+	if( info.type() == G::Item::t_map && !info.has("type") )
+		info.add( "type" , G::Path(G::Arg::v0()).basename() ) ;
+	PublisherImp::initialise( m_shmem_control , name , info , auto_cleanup ) ;
+}
+
+G::Publisher::Publisher( const std::string & name , G::Item info , const PublisherConfig & config , bool auto_cleanup ) :
+	m_name(PublisherImp::checkName(name)) ,
+	m_buffers(std::max(size_t(PublisherImp::BUFFERS),config.m_history+2U)) ,
+	m_shmem_control(name,PublisherImp::controlSize(config.m_slots),SharedMemory::Control()) ,
+	m_info(new PublisherInfo(std::max(config.m_slots,size_t(1U))))
 {
 	if( info.type() == G::Item::t_map && !info.has("type") )
 		info.add( "type" , G::Path(G::Arg::v0()).basename() ) ;
@@ -233,27 +284,28 @@ G::Publisher::~Publisher()
 	PublisherImp::deactivate( SignalSafe() , m_shmem_control.ptr() ) ;
 }
 
-void G::Publisher::publish( const char * data_p , size_t data_n , const char * type )
+void G::Publisher::publish( const char * data_p , size_t data_n , const char * type , const PublisherHeader * header_p )
 {
 	if( data_p == nullptr || data_n == 0U ) return ;
 	m_data_p.resize( 1U ) ;
 	m_data_n.resize( 1U ) ;
 	m_data_p[0] = data_p ;
 	m_data_n[0] = data_n ;
-	PublisherImp::publish( m_shmem_control , m_shmem_data , *m_info.get() , m_name , data_n , 1U , &m_data_p[0] , &m_data_n[0] , type ) ;
+	PublisherImp::publish( m_shmem_control , m_shmem_data , *m_info.get() , m_name , m_buffers , data_n , 1U , &m_data_p[0] , &m_data_n[0] , type , header_p ) ;
 }
 
-void G::Publisher::publish( const std::vector<char> & data , const char * type )
+void G::Publisher::publish( const std::vector<char> & data , const char * type , const PublisherHeader * header_p )
 {
 	if( data.empty() ) return ;
 	m_data_p.resize( 1U ) ;
 	m_data_n.resize( 1U ) ;
 	m_data_p[0] = &data[0] ;
 	m_data_n[0] = data.size() ;
-	PublisherImp::publish( m_shmem_control , m_shmem_data , *m_info.get() , m_name , data.size() , 1U , &m_data_p[0] , &m_data_n[0] , type ) ;
+	PublisherImp::publish( m_shmem_control , m_shmem_data , *m_info.get() , m_name , m_buffers , data.size() , 1U , &m_data_p[0] , &m_data_n[0] , type , header_p ) ;
 }
 
-void G::Publisher::publish( const std::vector<std::pair<const char *,size_t> > & data , const char * type )
+void G::Publisher::publish( const std::vector<std::pair<const char *,size_t> > & data , const char * type , 
+	const PublisherHeader * header_p )
 {
 	m_data_p.resize( data.size() ) ;
 	m_data_n.resize( data.size() ) ;
@@ -265,10 +317,11 @@ void G::Publisher::publish( const std::vector<std::pair<const char *,size_t> > &
 		data_total += data[i].second ;
 	}
 	if( data_total != 0U )
-		PublisherImp::publish( m_shmem_control , m_shmem_data , *m_info.get() , m_name , data_total , data.size() , &m_data_p[0] , &m_data_n[0] , type ) ;
+		PublisherImp::publish( m_shmem_control , m_shmem_data , *m_info.get() , m_name , m_buffers , data_total , data.size() , &m_data_p[0] , &m_data_n[0] , type , header_p ) ;
 }
 
-void G::Publisher::publish( const std::vector<std::vector<char> > & data , const char * type )
+void G::Publisher::publish( const std::vector<std::vector<char> > & data , const char * type , 
+	const PublisherHeader * header_p )
 {
 	m_data_p.resize( data.size() ) ;
 	m_data_n.resize( data.size() ) ;
@@ -282,7 +335,7 @@ void G::Publisher::publish( const std::vector<std::vector<char> > & data , const
 		data_total += data[i_in].size() ;
 	}
 	if( data_total != 0U )
-		PublisherImp::publish( m_shmem_control , m_shmem_data , *m_info.get() , m_name , data_total , i_out , &m_data_p[0] , &m_data_n[0] , type ) ;
+		PublisherImp::publish( m_shmem_control , m_shmem_data , *m_info.get() , m_name , m_buffers , data_total , i_out , &m_data_p[0] , &m_data_n[0] , type , header_p ) ;
 }
 
 std::vector<std::string> G::Publisher::list( std::vector<std::string> * others )
@@ -338,9 +391,19 @@ void G::PublisherChannel::releaseSlot( size_t slot_id )
 }
 
 bool G::PublisherChannel::receive( size_t slot_id , int socket_fd , std::vector<char> & buffer , 
-	std::string * type_p , G::EpochTime * time_p )
+	std::string * type_p , G::EpochTime * time_p , PublisherHeader * header_p )
 {
-	return PublisherImp::receive( m_shmem_control , m_shmem_data , m_name , slot_id , socket_fd , buffer , type_p , time_p ) ;
+	return PublisherImp::receive( m_shmem_control , m_shmem_data , m_name , slot_id , socket_fd , &buffer , nullptr , type_p , time_p , header_p ) ;
+}
+
+bool G::PublisherChannel::borrow( size_t slot_id , int socket_fd , PublisherView & view )
+{
+	return PublisherImp::receive( m_shmem_control , m_shmem_data , m_name , slot_id , socket_fd , nullptr , &view , nullptr , nullptr , nullptr ) ;
+}
+
+bool G::PublisherChannel::history( G::EpochTime since , std::vector<PublisherView> & views )
+{
+	return PublisherImp::history( m_shmem_control , m_shmem_data , m_name , since , views ) ;
 }
 
 std::string G::PublisherChannel::name() const
@@ -355,7 +418,6 @@ G::PublisherSubscriber::PublisherSubscriber( PublisherChannel & channel , size_t
 	m_slot_id(slot_id) ,
 	m_socket_fd(socket_fd)
 {
-	G_ASSERT( slot_id < PublisherImp::SLOTS ) ;
 	G_ASSERT( socket_fd >= 0 ) ;
 }
 
@@ -375,16 +437,18 @@ int G::PublisherSubscriber::fd() const
 	return m_socket_fd ;
 }
 
-bool G::PublisherSubscriber::receive( std::vector<char> & buffer , std::string * type_p , G::EpochTime * time_p )
+bool G::PublisherSubscriber::receive( std::vector<char> & buffer , std::string * type_p , G::EpochTime * time_p , 
+	PublisherHeader * header_p )
 {
-	return m_channel.receive( m_slot_id , m_socket_fd , buffer , type_p , time_p ) ;
+	return m_channel.receive( m_slot_id , m_socket_fd , buffer , type_p , time_p , header_p ) ;
 }
 
-bool G::PublisherSubscriber::peek( std::vector<char> & buffer , std::string * type_p , G::EpochTime * time_p )
+bool G::PublisherSubscriber::peek( std::vector<char> & buffer , std::string * type_p , G::EpochTime * time_p , 
+	PublisherHeader * header_p )
 {
 	try
 	{
-		bool ok = m_channel.receive( m_slot_id , -1 , buffer , type_p , time_p ) ;
+		bool ok = m_channel.receive( m_slot_id , -1 , buffer , type_p , time_p , header_p ) ;
 		return ok && !buffer.empty() ;
 	}
 	catch( SharedMemory::Error & )
@@ -394,6 +458,38 @@ bool G::PublisherSubscriber::peek( std::vector<char> & buffer , std::string * ty
 	}
 }
 
+bool G::PublisherSubscriber::borrow( PublisherView & view )
+{
+	return m_channel.borrow( m_slot_id , m_socket_fd , view ) ;
+}
+
+bool G::PublisherSubscriber::peek( PublisherView & view )
+{
+	try
+	{
+		bool ok = m_channel.borrow( m_slot_id , -1 , view ) ;
+		return ok && !view.empty() ;
+	}
+	catch( SharedMemory::Error & )
+	{
+		return false ;
+	}
+}
+
+bool G::PublisherSubscriber::history( G::EpochTime since , std::vector<PublisherView> & views )
+{
+	try
+	{
+		return m_channel.history( since , views ) ;
+	}
+	catch( SharedMemory::Error & )
+	{
+		// eg. nothing ever published, so no data segment
+		views.clear() ;
+		return false ;
+	}
+}
+
 // ==
 
 G::PublisherSubscription::PublisherSubscription( const std::string & channel_name , bool lazy ) :
@@ -456,14 +552,34 @@ int G::PublisherSubscription::fd() const
 	return m_subscriber ? m_subscriber->fd() : -1 ;
 }
 
-bool G::PublisherSubscription::receive( std::vector<char> & buffer , std::string * type_p , G::EpochTime * time_p )
+bool G::PublisherSubscription::receive( std::vector<char> & buffer , std::string * type_p , G::EpochTime * time_p , 
+	PublisherHeader * header_p )
+{
+	return m_subscriber ? m_subscriber->receive(buffer,type_p,time_p,header_p) : false ;
+}
+
+bool G::PublisherSubscription::peek( std::vector<char> & buffer , std::string * type_p , G::EpochTime * time_p , 
+	PublisherHeader * header_p )
 {
-	return m_subscriber ? m_subscriber->receive(buffer,type_p,time_p) : false ;
+	return m_subscriber ? m_subscriber->peek(buffer,type_p,time_p,header_p) : false ;
 }
 
-bool G::PublisherSubscription::peek( std::vector<char> & buffer , std::string * type_p , G::EpochTime * time_p )
+bool G::PublisherSubscription::borrow( PublisherView & view )
 {
-	return m_subscriber ? m_subscriber->peek(buffer,type_p,time_p) : false ;
+	view.clear() ;
+	return m_subscriber ? m_subscriber->borrow(view) : false ;
+}
+
+bool G::PublisherSubscription::peek( PublisherView & view )
+{
+	view.clear() ;
+	return m_subscriber ? m_subscriber->peek(view) : false ;
+}
+
+bool G::PublisherSubscription::history( G::EpochTime since , std::vector<PublisherView> & views )
+{
+	views.clear() ;
+	return m_subscriber ? m_subscriber->history(since,views) : false ;
 }
 
 std::string G::PublisherSubscription::name() const
@@ -496,14 +612,124 @@ void G::PublisherSubscription::close()
 
 // ==
 
+G::PublisherInfo::PublisherInfo( size_t slots ) :
+	slot(slots)
+{
+}
+
 void G::PublisherInfo::clear( SignalSafe )
 {
-	for( size_t i = 0U ; i < PublisherImp::SLOTS ; i++ )
+	for( size_t i = 0U ; i < slot.size() ; i++ )
 		slot[i] = PublisherImp::InfoSlot() ;
 }
 
 // ==
 
+G::PublisherConfig::PublisherConfig( size_t history ) :
+	m_history(history) ,
+	m_slots(PublisherImp::SLOTS)
+{
+}
+
+// ==
+
+G::PublisherHeader::PublisherHeader() :
+	m_format(0U) ,
+	m_dx(0) ,
+	m_dy(0) ,
+	m_channels(0) ,
+	m_flags(0U) ,
+	m_seq(0UL) ,
+	m_time_s(0) ,
+	m_time_us(0UL) ,
+	m_parts(0U) ,
+	m_size(0U) ,
+	m_representations(0U)
+{
+	for( size_t i = 0U ; i < PARTS ; i++ )
+		m_offset[i] = 0U ;
+	for( size_t i = 0U ; i < REPRESENTATIONS ; i++ )
+	{
+		Representation & r = m_representation[i] ;
+		r.m_format = 0U ;
+		r.m_dx = r.m_dy = r.m_channels = 0 ;
+		r.m_offset = r.m_size = 0U ;
+	}
+}
+
+// ==
+
+G::PublisherView::PublisherView() :
+	m_gen_p(nullptr) ,
+	m_gen(0UL) ,
+	m_p(nullptr) ,
+	m_n(0U) ,
+	m_time(0)
+{
+}
+
+void G::PublisherView::set( const volatile unsigned long * gen_p , unsigned long gen , 
+	const char * p , size_t n , const std::string & type , G::EpochTime time , 
+	const PublisherHeader & header )
+{
+	m_gen_p = gen_p ;
+	m_gen = gen ;
+	m_p = p ;
+	m_n = n ;
+	m_type = type ;
+	m_time = time ;
+	m_header = header ;
+}
+
+void G::PublisherView::clear()
+{
+	m_gen_p = nullptr ;
+	m_gen = 0UL ;
+	m_p = nullptr ;
+	m_n = 0U ;
+	m_type.clear() ;
+	m_time = G::EpochTime(0) ;
+	m_header = PublisherHeader() ;
+}
+
+bool G::PublisherView::empty() const
+{
+	return m_n == 0U ;
+}
+
+const char * G::PublisherView::data() const
+{
+	return m_p ;
+}
+
+size_t G::PublisherView::size() const
+{
+	return m_n ;
+}
+
+std::string G::PublisherView::type() const
+{
+	return m_type ;
+}
+
+G::EpochTime G::PublisherView::time() const
+{
+	return m_time ;
+}
+
+const G::PublisherHeader & G::PublisherView::header() const
+{
+	return m_header ;
+}
+
+bool G::PublisherView::valid() const
+{
+	PublisherImp::barrier() ; // see the data reads before the generation read
+	return m_gen_p != nullptr && m_n != 0U && *m_gen_p == m_gen ;
+}
+
+// ==
+
 void G::PublisherImp::initialise( SharedMemory & shmem_control , const std::string & channel_name , 
 	const G::Item & info , bool auto_cleanup )
 {
@@ -513,7 +739,8 @@ void G::PublisherImp::initialise( SharedMemory & shmem_control , const std::stri
 		mem->publisher_pid = ::getpid() ;
 		strset( mem->publisher_info , sizeof(mem->publisher_info) , info.str() ) ;
 		mem->seq = 1 ;
-		for( size_t i = 0U ; i < SLOTS ; i++ )
+		mem->slots = ( shmem_control.size() - sizeof(ControlMemory) ) / sizeof(Slot) + 1U ;
+		for( size_t i = 0U ; i < mem->slots ; i++ )
 			clearSlot( SignalSafe() , mem->slot[i] ) ;
 		{
 			Root claim_root ;
@@ -540,7 +767,8 @@ std::string G::PublisherImp::checkName( const std::string & name )
 void G::PublisherImp::check( SharedMemory & shmem_control , const std::string & name )
 {
 	ControlMemory * mem = static_cast<ControlMemory*>(shmem_control.ptr()) ;
-	if( shmem_control.size() != sizeof(ControlMemory) || mem->magic != MAGIC )
+	if( shmem_control.size() < sizeof(ControlMemory) || mem->magic != MAGIC || 
+		shmem_control.size() != controlSize(mem->slots) )
 	{
 		G_DEBUG( "G::PublisherImp::check: not valid as a publisher control segment: [" << name << "] (" << shmem_control.size() << ")" ) ;
 		throw PublisherError( "invalid shared memory segment: [" + SharedMemory::osName(name) + "]" ) ;
@@ -572,7 +800,7 @@ void G::PublisherImp::releaseSlots( SignalSafe signal_safe , void * p )
 	ControlMemory * mem = static_cast<ControlMemory*>(p) ;
 	{
 		Lock lock( Semaphore::at(&mem->mutex) ) ;
-		for( size_t i = 0U ; i < SLOTS ; i++ )
+		for( size_t i = 0U ; i < mem->slots ; i++ )
 		{
 			if( mem->slot[i].in_use && mem->slot[i].pid == pid )
 			{
@@ -586,12 +814,13 @@ void G::PublisherImp::releaseSlots( SignalSafe signal_safe , void * p )
 
 void G::PublisherImp::deactivate( SignalSafe signal_safe , void * p )
 {
-	static PublisherInfo info ;
 	ControlMemory * mem = static_cast<ControlMemory*>(p) ;
 	{
 		Lock lock( Semaphore::at(&mem->mutex) ) ;
 		mem->magic = 0 ; // mark as defunct
-		notifyAll( signal_safe , mem , info ) ;
+		for( size_t i = 0U ; i < mem->slots ; i++ )
+			mem->slot[i].pending = false ; // make sure everyone hears
+		notifyAll( signal_safe , mem , nullptr ) ;
 		closeAllSlots( signal_safe , mem ) ;
 	}
 }
@@ -600,7 +829,7 @@ void G::PublisherImp::closeAllSlots( SignalSafe signal_safe , ControlMemory * me
 {
 	if( mem->publisher_pid == ::getpid() )
 	{
-		for( size_t i = 0U ; i < SLOTS ; i++ )
+		for( size_t i = 0U ; i < mem->slots ; i++ )
 			closeSlot( signal_safe , mem->slot[i] ) ;
 	}
 }
@@ -615,9 +844,9 @@ void G::PublisherImp::closeSlot( SignalSafe , Slot & slot )
 }
 
 void G::PublisherImp::publish( SharedMemory & shmem_control , unique_ptr<SharedMemory> & shmem_data ,
-	PublisherInfo & info , const std::string & channel_name ,
+	PublisherInfo & info , const std::string & channel_name , size_t buffers ,
 	size_t data_total , size_t data_count , const char ** data_p_p , size_t * data_n_p , 
-	const char * type )
+	const char * type , const PublisherHeader * header_p )
 {
 	// lazy construction of the data segment once we know an appropriate size --
 	// subscribers will not try to access the data segment until we have sent
@@ -626,57 +855,114 @@ void G::PublisherImp::publish( SharedMemory & shmem_control , unique_ptr<SharedM
 	if( shmem_data.get() == nullptr )
 	{
 		const size_t size_limit = morethan( data_total ) ;
-		shmem_data.reset( new SharedMemory(channel_name+".d",size_limit+sizeof(DataMemory)) ) ;
+		shmem_data.reset( new SharedMemory(channel_name+".d",segmentSize(buffers,size_limit)) ) ;
 		DataMemory * dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
 		dmem->size_limit = size_limit ;
-		dmem->type[0] = '\0' ;
-		dmem->data_size = 0U ;
-		dmem->time_s = 0 ;
-		dmem->time_us = 0U ;
+		dmem->latest = 0U ;
+		dmem->buffers = buffers ;
+		for( size_t i = 0U ; i < buffers ; i++ )
+		{
+			DataBuffer & buffer = dmem->buffer[i] ;
+			buffer.gen = 0UL ;
+			buffer.seq = 0UL ;
+			buffer.type[0] = '\0' ;
+			buffer.data_size = 0U ;
+			buffer.time_s = 0 ;
+			buffer.time_us = 0U ;
+			buffer.header = PublisherHeader() ;
+		}
 	}
 
-	// publish to all subscribers -- copy the payload into the data segment and notify-all
+	// grow the data segment if necessary -- this is done with the mutex locked
+	// so that subscribers can follow suit safely -- the resize moves the
+	// buffers around so they are all invalidated with an odd generation 
+	// number while the size is changing
 	//
 	ControlMemory * mem = static_cast<ControlMemory*>(shmem_control.ptr()) ;
+	DataMemory * dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
+	if( data_total > dmem->size_limit )
 	{
-		G::EpochTime time = G::DateTime::now() ;
 		Lock lock( Semaphore::at(&mem->mutex) ) ;
-		DataMemory * dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
-		if( data_total > dmem->size_limit )
-		{
-			const size_t new_size_limit = morethan( data_total ) ;
-			shmem_data->remap( new_size_limit + sizeof(DataMemory) , true ) ;
-			dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
-			dmem->size_limit = new_size_limit ;
-		}
+		for( size_t i = 0U ; i < dmem->buffers ; i++ )
+			dmem->buffer[i].gen++ ;
+		barrier() ;
+
+		const size_t new_size_limit = morethan( data_total ) ;
+		shmem_data->remap( segmentSize(dmem->buffers,new_size_limit) , true ) ;
+		dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
+		dmem->size_limit = new_size_limit ;
+		for( size_t i = 0U ; i < dmem->buffers ; i++ )
+			dmem->buffer[i].data_size = 0U ;
+
+		barrier() ;
+		for( size_t i = 0U ; i < dmem->buffers ; i++ )
+			dmem->buffer[i].gen++ ;
+	}
+
+	// copy the payload into the next buffer in the ring without locking -- 
+	// the generation number of the buffer is odd while we are writing so 
+	// that subscribers can tell if they need to retry (ie. a 'seqlock') --
+	// subscribers normally read the latest buffer so there is no contention
+	// unless they are more than a whole ring behind
+	//
+	{
+		const size_t index = ( dmem->latest + 1U ) % dmem->buffers ;
+		DataBuffer & buffer = dmem->buffer[index] ;
+		buffer.gen++ ;
+		barrier() ;
+
+		G::EpochTime time = G::DateTime::now() ;
 		mem->seq++ ; if( mem->seq == 0U ) mem->seq = 1UL ;
-		dmem->data_size = data_total ;
-		dmem->time_s = time.s ;
-		dmem->time_us = time.us ;
-		::memset( dmem->type , 0 , sizeof(dmem->type) ) ;
-		if( type != nullptr ) ::strncpy( dmem->type , type , sizeof(dmem->type)-1U ) ;
-		for( char * out = dmem->data ; data_count ; out += *data_n_p , data_count-- , data_p_p++ , data_n_p++ )
+		buffer.seq = mem->seq ;
+		buffer.data_size = data_total ;
+		buffer.time_s = time.s ;
+		buffer.time_us = time.us ;
+		::memset( buffer.type , 0 , sizeof(buffer.type) ) ;
+		if( type != nullptr ) ::strncpy( buffer.type , type , sizeof(buffer.type)-1U ) ;
+		buffer.header = header_p ? *header_p : PublisherHeader() ;
+		buffer.header.m_seq = buffer.seq ;
+		if( buffer.header.m_time_s == 0 )
+			buffer.header.m_time_s = time.s , buffer.header.m_time_us = time.us ;
+		buffer.header.m_parts = data_count ;
+		for( size_t i = 0U , offset = 0U ; i < PublisherHeader::PARTS ; offset += (i<data_count?data_n_p[i]:0U) , i++ )
+			buffer.header.m_offset[i] = i < data_count ? offset : 0U ;
+		for( char * out = bufferData(dmem,index,dmem->size_limit) ; data_count ; out += *data_n_p , data_count-- , data_p_p++ , data_n_p++ )
 			::memcpy( out , *data_p_p , *data_n_p ) ;
-		notifyAll( SignalSafe() , mem , info ) ;
+
+		barrier() ;
+		buffer.gen++ ;
+		barrier() ;
+		dmem->latest = index ;
+	}
+
+	// notify-all -- the mutex only excludes subscribers that are coming
+	// and going, not subscribers that are reading
+	//
+	barrier() ;
+	{
+		Lock lock( Semaphore::at(&mem->mutex) ) ;
+		notifyAll( SignalSafe() , mem , &info ) ;
 	}
 
 	// report errors
 	//
-	for( size_t i = 0U ; i < SLOTS ; i++ )
+	for( size_t i = 0U ; i < info.slot.size() ; i++ )
 	{
 		if( info.slot[i].failed )
 			info.slot[i].report() ;
 	}
 }
 
-void G::PublisherImp::notifyAll( SignalSafe signal_safe , ControlMemory * mem , PublisherInfo & info )
+void G::PublisherImp::notifyAll( SignalSafe signal_safe , ControlMemory * mem , PublisherInfo * info )
 {
-	info.clear( signal_safe ) ;
-	for( size_t i = 0U ; i < SLOTS ; i++ )
+	if( info != nullptr )
+		info->clear( signal_safe ) ;
+
+	for( size_t i = 0U ; i < mem->slots ; i++ )
 	{
 		if( mem->slot[i].in_use && !mem->slot[i].failed )
 		{
-			notifyOne( signal_safe , mem->slot[i] , info.slot[i] ) ;
+			notifyOne( signal_safe , mem->slot[i] , info && i < info->slot.size() ? &info->slot[i] : nullptr ) ;
 		}
 		else if( mem->slot[i].socket_fd != -1 )
 		{
@@ -688,8 +974,11 @@ void G::PublisherImp::notifyAll( SignalSafe signal_safe , ControlMemory * mem ,
 	}
 }
 
-void G::PublisherImp::notifyOne( SignalSafe signal_safe , Slot & slot , InfoSlot & info_slot )
+void G::PublisherImp::notifyOne( SignalSafe signal_safe , Slot & slot , InfoSlot * info_slot_p )
 {
+	InfoSlot dummy_info_slot ;
+	InfoSlot & info_slot = info_slot_p ? *info_slot_p : dummy_info_slot ;
+
 	// connect to the subscriber if necessary
 	if( slot.socket_fd == -1 && !slot.failed ) // ie. newly in_use
 	{
@@ -716,13 +1005,21 @@ void G::PublisherImp::notifyOne( SignalSafe signal_safe , Slot & slot , InfoSlot
 		Root::stop( signal_safe , identity ) ;
 	}
 
-	// poke the subscriber - dont use G::Msg::send() in case it is not signal-handler-safe
-	char msg = '.' ;
-	int rc = ::send( slot.socket_fd , &msg , 1 , MSG_NOSIGNAL | MSG_DONTWAIT ) ; 
-	if( rc < 0 ) 
+	// poke the subscriber, but only if it has consumed the previous poke -- 
+	// the subscriber clears the pending flag before it reads the data, so
+	// if it is still set then the subscriber will see the new data anyway --
+	// dont use G::Msg::send() in case it is not signal-handler-safe
+	if( !slot.pending )
 	{
-		int e = errno ;
-		slot.error[e_send] = info_slot.error[e_send] = e ;
+		slot.pending = true ;
+		char msg = '.' ;
+		int rc = ::send( slot.socket_fd , &msg , 1 , MSG_NOSIGNAL | MSG_DONTWAIT ) ; 
+		if( rc < 0 ) 
+		{
+			int e = errno ;
+			slot.error[e_send] = info_slot.error[e_send] = e ;
+			slot.pending = false ;
+		}
 	}
 
 	// record fatal errors -- keep the slot in_use because it is the subscriber's 
@@ -767,15 +1064,17 @@ size_t G::PublisherImp::subscribe( SharedMemory & shmem_control , SocketHolder &
 {
 	// find a free slot and grab it
 	//
-	size_t slot_id = SLOTS ;
+	bool claimed = false ;
+	size_t slot_id = 0U ;
 	ControlMemory * mem = static_cast<ControlMemory*>(shmem_control.ptr()) ;
 	{
 		Lock lock( Semaphore::at(&mem->mutex) ) ;
 		slot_id = findFreeSlot( *mem ) ;
-		if( slot_id < SLOTS )
+		claimed = slot_id < mem->slots ;
+		if( claimed )
 			claimSlot( mem->slot[slot_id] , socket_holder.path , ::getpid() ) ;
 	}
-	if( slot_id == SLOTS )
+	if( !claimed )
 		throw PublisherError( "no free slots in channel [" + name + "]" ) ; // probably need to kill failed subscribers
 
 	return slot_id ;
@@ -783,8 +1082,8 @@ size_t G::PublisherImp::subscribe( SharedMemory & shmem_control , SocketHolder &
 
 void G::PublisherImp::releaseSlot( SharedMemory & shmem_control , size_t slot_id )
 {
-	G_ASSERT( slot_id < SLOTS ) ;
 	ControlMemory * mem = static_cast<ControlMemory*>(shmem_control.ptr()) ;
+	G_ASSERT( slot_id < mem->slots ) ;
 	{
 		Lock lock( Semaphore::at(&mem->mutex) ) ;
 		releaseSlot( SignalSafe() , lock , mem->slot[slot_id] ) ;
@@ -814,9 +1113,18 @@ bool G::PublisherImp::getch( int socket_fd )
 	return 1 == ::recv( socket_fd , &c , 1 , 0 ) ;
 }
 
+void G::PublisherImp::clear( std::vector<char> * buffer_p , PublisherView * view_p , std::string * type_p , 
+	PublisherHeader * header_p )
+{
+	if( buffer_p != nullptr ) buffer_p->clear() ;
+	if( view_p != nullptr ) view_p->clear() ;
+	if( type_p != nullptr ) type_p->clear() ;
+	if( header_p != nullptr ) *header_p = PublisherHeader() ;
+}
+
 bool G::PublisherImp::receive( SharedMemory & shmem_control , unique_ptr<SharedMemory> & shmem_data ,
-	const std::string & channel_name , size_t slot_id , int socket_fd , std::vector<char> & buffer , 
-	std::string * type_p , G::EpochTime * time_p )
+	const std::string & channel_name , size_t slot_id , int socket_fd , std::vector<char> * buffer_p , 
+	PublisherView * view_p , std::string * type_p , G::EpochTime * time_p , PublisherHeader * header_p )
 {
 	bool peek = socket_fd == -1 ;
 	if( time_p != nullptr )
@@ -833,84 +1141,205 @@ bool G::PublisherImp::receive( SharedMemory & shmem_control , unique_ptr<SharedM
 		size_t flushed = flush( socket_fd ) ;
 		if( flushed == 0U && !getch(socket_fd) )
 		{
-			buffer.clear() ;
-			if( type_p != nullptr ) type_p->clear() ;
+			clear( buffer_p , view_p , type_p , header_p ) ;
 			throw PublisherError( "socket receive error" ) ;
 		}
 		G_DEBUG( "G::PublisherImp::receive: got publication event" ) ;
+
+		// allow the next poke -- this must be done before reading the data 
+		// so that we cannot miss a publication
+		mem->slot[slot_id].pending = false ;
+		barrier() ;
 	}
 
-	// lazy attach to the data segment -- this can fail if peeking because
+	// attach to the data segment -- this can fail if peeking because
 	// the data segment will not exist if nothing has been published
-	if( shmem_data.get() == nullptr )
+	if( !attach( shmem_control , shmem_data , channel_name ) )
 	{
-		shmem_data.reset( new SharedMemory(channel_name+".d") ) ;
-		G_DEBUG( "G::PublisherImp::receive: data segment size: " << shmem_data->size() ) ;
+		clear( buffer_p , view_p , type_p , header_p ) ;
+		return false ;
 	}
 
 	// check the publisher again
 	if( mem->magic != MAGIC )
 		return false ;
 
-	// copy the data payload into the caller's buffer
+	// copy the data payload into the caller's buffer, or just point to it, 
+	// without locking -- the copy is retried if the buffer's generation 
+	// number shows that the publisher has started to overwrite it 
+	// (ie. a 'seqlock')
 	unsigned long seq = 0UL ;
 	{
 		if( type_p != nullptr )
-			type_p->resize( sizeof(((DataMemory*)(nullptr))->type)+1U ) ;
+			type_p->resize( sizeof(((DataBuffer*)(nullptr))->type)+1U ) ;
 
-		// lock the shared memory -- could do better wrt. serialising readers -- use two 
-		// mutexes and a reader-count for a 'readers-writer' lock
-		Lock lock( Semaphore::at(&mem->mutex) ) ;
-		G_ASSERT( shmem_data.get() != nullptr ) ;
-
-		// if the publisher has grown the data segment then we follow suit
-		DataMemory * dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
-		G_ASSERT( dmem != nullptr ) ;
-		if( (dmem->size_limit+sizeof(DataMemory)) > shmem_data->size() )
-			shmem_data->remap( dmem->size_limit+sizeof(DataMemory) , true ) ;
-		dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
-
-		// check that we have not seen the current data already
 		Slot & slot = mem->slot[slot_id] ;
-		seq = slot.seq ;
-		bool ok = slot.in_use && ( peek || slot.seq == 0UL || slot.seq != mem->seq ) ;
-		if( ok )
+		bool ok = false ;
+		for( int retry = 0 ; !ok && retry < 100 ; retry++ )
 		{
+			if( retry && ( retry % 10 ) == 0 )
+				::sched_yield() ;
+
+			DataMemory * dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
+			const size_t index = dmem->latest % dmem->buffers ;
+			const DataBuffer & buffer = dmem->buffer[index] ;
+			const unsigned long gen = buffer.gen ;
+			if( gen & 1UL )
+				continue ; // publisher is writing
+			barrier() ;
+
+			// read the metadata, checking that it is consistent with our mapping
+			const size_t size_limit = dmem->size_limit ;
+			const size_t data_size = buffer.data_size ;
+			const unsigned long buffer_seq = buffer.seq ;
+			if( segmentSize(dmem->buffers,size_limit) > shmem_data->size() || data_size > size_limit )
+				continue ; // publisher is resizing
+
+			// check that we have not seen the current data already
+			seq = slot.seq ;
+			if( !slot.in_use || data_size == 0U || ( !peek && slot.seq != 0UL && slot.seq == buffer_seq ) )
+				break ;
+
+			const char * data = bufferData( dmem , index , size_limit ) ;
+			const std::string type = ( view_p != nullptr || type_p != nullptr ) ? strget(buffer.type,sizeof(buffer.type)) : std::string() ;
+			const G::EpochTime time( buffer.time_s , buffer.time_us ) ;
+			const PublisherHeader header = buffer.header ;
+
+			// copy out the payload
+			if( buffer_p != nullptr )
+			{
+				buffer_p->resize( data_size ) ;
+				::memcpy( &(*buffer_p)[0] , data , data_size ) ;
+			}
+
+			// check for overwrites
+			barrier() ;
+			if( buffer.gen != gen )
+			{
+				G_DEBUG( "G::PublisherImp::receive: buffer overwritten: retrying" ) ;
+				continue ;
+			}
+			ok = true ;
+
 			// update the sequence number
 			if( !peek )
-				slot.seq = mem->seq ;
+				slot.seq = buffer_seq ;
 
-			// copy out the payload
-			buffer.resize( dmem->data_size ) ;
-			::memcpy( &buffer[0] , dmem->data , buffer.size() ) ;
+			// or point to the payload
+			if( view_p != nullptr )
+				view_p->set( &buffer.gen , gen , data , data_size , type , time , header ) ;
 
 			// copy out the type
 			if( type_p != nullptr )
-				strget( dmem->type , sizeof(dmem->type) , *type_p ) ;
+				*type_p = type ;
 
 			// copy out the publication time
 			if( time_p != nullptr )
-				time_p->s = dmem->time_s , time_p->us = dmem->time_us ;
+				*time_p = time ;
+
+			// copy out the binary header
+			if( header_p != nullptr )
+				*header_p = header ;
 		}
-		else
+		if( !ok )
+			clear( buffer_p , view_p , type_p , header_p ) ;
+	}
+	G_DEBUG( "G::PublisherImp::receive: got message [" << seq << "]" ) ;
+
+	return true ;
+}
+
+bool G::PublisherImp::attach( SharedMemory & shmem_control , unique_ptr<SharedMemory> & shmem_data , 
+	const std::string & channel_name )
+{
+	// lazy attach
+	if( shmem_data.get() == nullptr )
+	{
+		shmem_data.reset( new SharedMemory(channel_name+".d") ) ;
+		G_DEBUG( "G::PublisherImp::attach: data segment size: " << shmem_data->size() ) ;
+		if( shmem_data->size() < sizeof(DataMemory) )
 		{
-			buffer.clear() ;
-			if( type_p != nullptr ) type_p->clear() ;
+			shmem_data.reset() ;
+			throw PublisherError( "invalid data segment" ) ;
 		}
 	}
-	G_DEBUG( "G::PublisherImp::receive: got message [" << seq << "]" ) ;
 
+	// the number of buffers is fixed once the publisher has initialised the segment
+	const size_t buffers = static_cast<DataMemory*>(shmem_data->ptr())->buffers ;
+	if( buffers == 0U || dataOffset(buffers) > shmem_data->size() )
+		return false ;
+
+	// if the publisher has grown the data segment then we follow suit -- this
+	// is done with the mutex locked because the remap() does an ftruncate()
+	// that must not be allowed to shrink the segment
+	DataMemory * dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
+	if( segmentSize(dmem->buffers,dmem->size_limit) > shmem_data->size() )
+	{
+		ControlMemory * mem = static_cast<ControlMemory*>(shmem_control.ptr()) ;
+		Lock lock( Semaphore::at(&mem->mutex) ) ;
+		dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
+		if( segmentSize(dmem->buffers,dmem->size_limit) > shmem_data->size() )
+			shmem_data->remap( segmentSize(dmem->buffers,dmem->size_limit) , true ) ;
+	}
 	return true ;
 }
 
+bool G::PublisherImp::history( SharedMemory & shmem_control , unique_ptr<SharedMemory> & shmem_data ,
+	const std::string & channel_name , G::EpochTime since , std::vector<PublisherView> & views )
+{
+	views.clear() ;
+	ControlMemory * mem = static_cast<ControlMemory*>(shmem_control.ptr()) ;
+	if( mem->magic != MAGIC )
+		return false ;
+
+	if( !attach( shmem_control , shmem_data , channel_name ) )
+		return false ;
+
+	// work backwards from the latest buffer, skipping the one after it since
+	// that is the next one to be written -- each buffer is checked for 
+	// consistency using its generation number, as in receive()
+	DataMemory * dmem = static_cast<DataMemory*>(shmem_data->ptr()) ;
+	const size_t buffers = dmem->buffers ;
+	const size_t latest = dmem->latest % buffers ;
+	unsigned long seq = 0UL ;
+	for( size_t i = 0U ; (i+1U) < buffers ; i++ )
+	{
+		const size_t index = ( latest + buffers - i ) % buffers ;
+		const DataBuffer & buffer = dmem->buffer[index] ;
+		const unsigned long gen = buffer.gen ;
+		if( gen & 1UL )
+			break ;
+		barrier() ;
+
+		const size_t size_limit = dmem->size_limit ;
+		const size_t data_size = buffer.data_size ;
+		const unsigned long buffer_seq = buffer.seq ;
+		const G::EpochTime time( buffer.time_s , buffer.time_us ) ;
+		const std::string type = strget( buffer.type , sizeof(buffer.type) ) ;
+		const PublisherHeader header = buffer.header ;
+		barrier() ;
+		if( buffer.gen != gen || data_size == 0U || data_size > size_limit || 
+			segmentSize(buffers,size_limit) > shmem_data->size() ||
+			( i && buffer_seq >= seq ) || time < since )
+				break ;
+
+		seq = buffer_seq ;
+		views.push_back( PublisherView() ) ;
+		views.back().set( &buffer.gen , gen , bufferData(dmem,index,size_limit) , data_size , type , time , header ) ;
+	}
+	std::reverse( views.begin() , views.end() ) ;
+	G_DEBUG( "G::PublisherImp::history: " << views.size() << " buffer(s)" ) ;
+	return !views.empty() ;
+}
+
 size_t G::PublisherImp::findFreeSlot( ControlMemory & mem )
 {
-	for( size_t i = 0U ; i < SLOTS ; i++ )
+	for( size_t i = 0U ; i < mem.slots ; i++ )
 	{
 		if( !mem.slot[i].in_use && mem.slot[i].socket_fd == -1 )
 			return i ;
 	}
-	return SLOTS ;
+	return mem.slots ;
 }
 
 void G::PublisherImp::claimSlot( Slot & slot , const std::string & socket_path , pid_t pid )
@@ -925,6 +1354,7 @@ void G::PublisherImp::clearSlot( SignalSafe , Slot & slot )
 {
 	slot.in_use = false ;
 	slot.failed = false ;
+	slot.pending = false ;
 	slot.pid = 0 ;
 	slot.seq = 0UL ;
 	slot.socket_fd = -1 ;
@@ -948,8 +1378,13 @@ G::PublisherImp::Snapshot G::PublisherImp::snapshot( const std::string & channel
 			Lock lock( Semaphore::at(&mem->mutex) ) ;
 			DataMemory * dmem = static_cast<DataMemory*>(shmem_data.ptr()) ;
 			snapshot.control = *mem ;
-			snapshot.has_data = true ;
-			snapshot.data = *dmem ;
+			snapshot.slots.assign( mem->slot , mem->slot+mem->slots ) ;
+			snapshot.has_data = dmem->buffers != 0U && shmem_data.size() >= segmentSize(dmem->buffers,0U) ;
+			if( snapshot.has_data )
+			{
+				snapshot.data = *dmem ;
+				snapshot.latest = dmem->buffer[dmem->latest%dmem->buffers] ;
+			}
 		}
 	}
 	catch( G::SharedMemory::Error & )
@@ -958,6 +1393,7 @@ G::PublisherImp::Snapshot G::PublisherImp::snapshot( const std::string & channel
 		{
 			Lock lock( Semaphore::at(&mem->mutex) ) ;
 			snapshot.control = *mem ;
+			snapshot.slots.assign( mem->slot , mem->slot+mem->slots ) ;
 			snapshot.has_data = false ;
 		}
 	}
@@ -1032,15 +1468,40 @@ G::Item G::PublisherImp::info( const std::string & channel_name , bool detail ,
 		item.add( "data" , Item::map() ) ;
 		if( s.has_data )
 		{
-			item["data"].add( "type" , Str::printable(strget(s.data.type,sizeof(s.data.type))) ) ;
-			item["data"].add( "size" , Str::fromULong(s.data.data_size) ) ;
+			const DataBuffer & buffer = s.latest ;
+			item["data"].add( "type" , Str::printable(strget(buffer.type,sizeof(buffer.type))) ) ;
+			item["data"].add( "size" , Str::fromULong(buffer.data_size) ) ;
 			item["data"].add( "limit" , Str::fromULong(s.data.size_limit) ) ;
-			item["data"].add( "time" , Str::fromULong(s.data.time_s) ) ; // long vs. time_t
+			item["data"].add( "time" , Str::fromULong(buffer.time_s) ) ; // long vs. time_t
+			item["data"].add( "buffers" , Str::fromULong(s.data.buffers) ) ;
+			item["data"].add( "header" , Item::map() ) ;
+			Item & header = item["data"]["header"] ;
+			header.add( "format" , Str::fromUInt(buffer.header.m_format) ) ;
+			header.add( "dx" , Str::fromInt(buffer.header.m_dx) ) ;
+			header.add( "dy" , Str::fromInt(buffer.header.m_dy) ) ;
+			header.add( "channels" , Str::fromInt(buffer.header.m_channels) ) ;
+			header.add( "flags" , Str::fromUInt(buffer.header.m_flags) ) ;
+			header.add( "seq" , Str::fromULong(buffer.header.m_seq) ) ;
+			header.add( "time" , Str::fromULong(buffer.header.m_time_s) ) ; // long vs. time_t
+			header.add( "parts" , Str::fromULong(buffer.header.m_parts) ) ;
+			header.add( "representations" , Item::list() ) ;
+			for( size_t i = 0U ; i < buffer.header.m_representations && i < PublisherHeader::REPRESENTATIONS ; i++ )
+			{
+				const PublisherHeader::Representation & r = buffer.header.m_representation[i] ;
+				Item r_info = Item::map() ;
+				r_info.add( "format" , Str::fromUInt(r.m_format) ) ;
+				r_info.add( "dx" , Str::fromInt(r.m_dx) ) ;
+				r_info.add( "dy" , Str::fromInt(r.m_dy) ) ;
+				r_info.add( "channels" , Str::fromInt(r.m_channels) ) ;
+				r_info.add( "offset" , Str::fromULong(r.m_offset) ) ;
+				r_info.add( "size" , Str::fromULong(r.m_size) ) ;
+				header["representations"].add( r_info ) ;
+			}
 		}
 		item.add( "slots" , Item::list() ) ;
-		for( size_t i = 0U ; i < SLOTS ; i++ )
+		for( size_t i = 0U ; i < s.slots.size() ; i++ )
 		{
-			const Slot & slot = s.control.slot[i] ;
+			const Slot & slot = s.slots[i] ;
 			if( all_slots || ( slot.in_use && !slot.failed ) )
 			{
 				int error = slot.error[0] ? slot.error[0] : ( slot.error[1] ? slot.error[1] : slot.error[2] ) ;
@@ -1049,6 +1510,7 @@ G::Item G::PublisherImp::info( const std::string & channel_name , bool detail ,
 				slot_info.add( "index" , Str::fromUInt(i) ) ;
 				slot_info.add( "in_use" , slot.in_use ? "1" : "0" ) ;
 				slot_info.add( "failed" , slot.failed ? "1" : "0" ) ;
+				slot_info.add( "pending" , slot.pending ? "1" : "0" ) ;
 				slot_info.add( "pid" , Str::fromUInt(slot.pid) ) ;
 				slot_info.add( "seq" , Str::fromUInt(slot.seq) ) ;
 				slot_info.add( "socket_fd" , Str::fromInt(slot.socket_fd) ) ;
@@ -1071,7 +1533,7 @@ void G::PublisherImp::purge( const std::string & channel_name )
 	ControlMemory * mem = static_cast<ControlMemory*>(shmem_control.ptr()) ;
 	{
 		Lock lock( Semaphore::at(&mem->mutex) ) ;
-		for( size_t i = 0U ; i < SLOTS ; i++ )
+		for( size_t i = 0U ; i < mem->slots ; i++ )
 		{
 			Slot & slot = mem->slot[i] ;
 			if( slot.in_use && slot.failed && slot.seq < mem->seq && (mem->seq-slot.seq) > 10 )
@@ -1119,7 +1581,34 @@ std::string G::PublisherImp::strget( const char * p , size_t n )
 
 size_t G::PublisherImp::morethan( size_t n )
 {
-	return n + n/2U + 10U ;
+	n = n + n/2U + 10U ;
+	return ( n + 15U ) & ~size_t(15U) ; // keep the buffers aligned
+}
+
+size_t G::PublisherImp::controlSize( size_t slots )
+{
+	return sizeof(ControlMemory) + ( std::max(slots,size_t(1U)) - 1U ) * sizeof(Slot) ;
+}
+
+size_t G::PublisherImp::dataOffset( size_t buffers )
+{
+	size_t n = sizeof(DataMemory) + ( std::max(buffers,size_t(1U)) - 1U ) * sizeof(DataBuffer) ;
+	return ( n + 15U ) & ~size_t(15U) ;
+}
+
+size_t G::PublisherImp::segmentSize( size_t buffers , size_t size_limit )
+{
+	return dataOffset(buffers) + buffers * size_limit ;
+}
+
+char * G::PublisherImp::bufferData( DataMemory * dmem , size_t index , size_t size_limit )
+{
+	return reinterpret_cast<char*>(dmem) + dataOffset(dmem->buffers) + index * size_limit ;
+}
+
+void G::PublisherImp::barrier()
+{
+	__sync_synchronize() ;
 }
 
 // ==
@@ -35,9 +35,12 @@
 namespace G
 {
 	class Publisher ;
+	struct PublisherConfig ;
+	struct PublisherHeader ;
 	class PublisherChannel ;
 	class PublisherSubscription ;
 	class PublisherSubscriber ;
+	class PublisherView ;
 	class PublisherInfo ;
 	G_EXCEPTION( PublisherError , "publish/subscribe error" ) ;
 }
@@ -46,13 +49,26 @@ namespace G
 /// A broadcast communication channel between unrelated processes using shared 
 /// memory. The shared memory name is public so that subscribers can find it 
 /// (see shm_open()). Subscribers are then notified via individual unix-domain 
-/// sockets.
+/// sockets, so that they can use select(). Notifications are coalesced so 
+/// that a subscriber that has not yet consumed its last notification is not
+/// notified again. The number of subscriber slots is fixed when the channel
+/// is created.
 /// 
 /// Communication is message-based and unreliable; newer messages will overwrite 
-/// older ones if not consumed. Messages have an associated type name.
+/// older ones if not consumed. Messages have an associated type name and
+/// an optional fixed-size binary header (G::PublisherHeader) so that 
+/// subscribers can learn the shape of the data without parsing it.
+/// Optionally the publisher keeps a history of recent messages that 
+/// subscribers can read back (see G::PublisherSubscription::history()).
 /// 
 /// There are two shared memory segments per channel; one control and one data.
 /// This allows the data segment to be discarded and replaced if it is too small.
+/// The data segment holds a small ring of buffers so that subscribers can
+/// borrow() the latest publication in-place while the publisher writes the 
+/// next one into a different buffer. Each buffer has a generation number
+/// that acts as a sequence lock, so neither the publisher nor the 
+/// subscribers need to hold the channel mutex while copying data. The
+/// mutex is only used for slot management and for resizing.
 /// 
 /// The named sockets are created by the subscribers, their name is put into the
 /// shared memory segment, and they are unlinked by the publisher on first use. 
@@ -76,6 +92,10 @@ public:
 		///< The metadata is enriched with a "type" field that is
 		///< initialised with the basename of argv0.
 
+	Publisher( const std::string & channel_name , Item publisher_info , const PublisherConfig & , 
+		bool auto_cleanup = true ) ;
+			///< A constructor overload with additional configuration.
+
 	~Publisher() ;
 		///< Destructor. Marks the shared memory as defunct and sends out 
 		///< notification to subscribers causing their receive()s to return 
@@ -86,17 +106,21 @@ public:
 		///< be unlink()d. This means that the subscribers do not have to do 
 		///< any special filesystem cleanup themselves.
 
-	void publish( const char * p , size_t n , const char * type = nullptr ) ;
-		///< Publishes a chunk of data to subscribers.
+	void publish( const char * p , size_t n , const char * type = nullptr , const PublisherHeader * = nullptr ) ;
+		///< Publishes a chunk of data to subscribers, with an optional
+		///< binary header.
 
-	void publish( const std::vector<char> & , const char * type = nullptr ) ;
+	void publish( const std::vector<char> & , const char * type = nullptr , const PublisherHeader * = nullptr ) ;
 		///< Publishes a chunk of data to subscribers.
 
-	void publish( const std::vector<std::pair<const char*,size_t> > & , const char * type ) ;
-		///< Publishes segmented data to subscribers.
+	void publish( const std::vector<std::pair<const char*,size_t> > & , const char * type , 
+		const PublisherHeader * = nullptr ) ;
+			///< Publishes segmented data to subscribers. The header's
+			///< part offsets are filled in from the segment sizes.
 
-	void publish( const std::vector<std::vector<char> > & , const char * type ) ;
-		///< Publishes chunked data to subscribers.
+	void publish( const std::vector<std::vector<char> > & , const char * type , 
+		const PublisherHeader * = nullptr ) ;
+			///< Publishes chunked data to subscribers.
 
 	static std::vector<std::string> list( std::vector<std::string> * others = nullptr ) ;
 		///< Returns a list of channel names. Optionally returns by reference
@@ -126,6 +150,7 @@ private:
 
 private:
 	std::string m_name ;
+	size_t m_buffers ;
 	SharedMemory m_shmem_control ;
 	unique_ptr<SharedMemory> m_shmem_data ;
 	unique_ptr<PublisherInfo> m_info ;
@@ -165,7 +190,14 @@ public:
 		///< file descriptor in the slot. The slot and the socket
 		///< are freed in the PublisherSubscriber's destructor.
 
-	bool receive( size_t , int , std::vector<char> & , std::string * = nullptr , G::EpochTime * = nullptr ) ; 
+	bool receive( size_t , int , std::vector<char> & , std::string * = nullptr , G::EpochTime * = nullptr ,
+		PublisherHeader * = nullptr ) ; 
+			///< Used by PublisherSubscriber.
+
+	bool borrow( size_t , int , PublisherView & ) ;
+		///< Used by PublisherSubscriber.
+
+	bool history( G::EpochTime , std::vector<PublisherView> & ) ;
 		///< Used by PublisherSubscriber.
 
 	void releaseSlot( size_t slot_id ) ;
@@ -203,15 +235,30 @@ public:
 	int fd() const ;
 		///< Returns the named socket file descriptor.
 
-	bool receive( std::vector<char> & buffer , std::string * type_p = nullptr , G::EpochTime * time_p = nullptr ) ; 
-		///< Does a read for new publish()ed data. Blocks if there is nothing 
-		///< to read. Returns false if the publisher has gone away. Returns 
-		///< an empty buffer in the case of an ignorable event.
+	bool receive( std::vector<char> & buffer , std::string * type_p = nullptr , G::EpochTime * time_p = nullptr , 
+		PublisherHeader * header_p = nullptr ) ; 
+			///< Does a read for new publish()ed data. Blocks if there is nothing 
+			///< to read. Returns false if the publisher has gone away. Returns 
+			///< an empty buffer in the case of an ignorable event.
 
-	bool peek( std::vector<char> & buffer , std::string * type_p = nullptr , G::EpochTime * time_p = nullptr ) ; 
-		///< Does a receive() but without requiring a publication event.
+	bool peek( std::vector<char> & buffer , std::string * type_p = nullptr , G::EpochTime * time_p = nullptr , 
+		PublisherHeader * header_p = nullptr ) ; 
+			///< Does a receive() but without requiring a publication event.
+			///< Returns false if no data is available.
+
+	bool borrow( PublisherView & view ) ;
+		///< A zero-copy variant of receive() that returns a view directly into
+		///< the shared memory rather than copying into a buffer. See 
+		///< G::PublisherView.
+
+	bool peek( PublisherView & view ) ;
+		///< Does a borrow() but without requiring a publication event.
 		///< Returns false if no data is available.
 
+	bool history( G::EpochTime since , std::vector<PublisherView> & views ) ;
+		///< Returns views of the publisher's history. See
+		///< G::PublisherSubscription::history().
+
 private:
 	PublisherSubscriber( const PublisherSubscriber & ) ;
 	void operator=( const PublisherSubscriber & ) ;
@@ -246,14 +293,39 @@ public:
 	int fd() const ;
 		///< Returns the subscriber's file descriptor or minus one.
 
-	bool receive( std::vector<char> & buffer , std::string * type_p = nullptr , G::EpochTime * time_p = nullptr ) ; 
-		///< Does a read for new publish()ed data. Blocks if there is 
-		///< nothing to read. Returns false if the publisher has gone 
-		///< away. Returns an empty buffer in the case of an ignorable 
-		///< event.
+	bool receive( std::vector<char> & buffer , std::string * type_p = nullptr , G::EpochTime * time_p = nullptr , 
+		PublisherHeader * header_p = nullptr ) ; 
+			///< Does a read for new publish()ed data. Blocks if there is 
+			///< nothing to read. Returns false if the publisher has gone 
+			///< away. Returns an empty buffer in the case of an ignorable 
+			///< event. Optionally returns the publication's binary header.
+
+	bool peek( std::vector<char> & buffer , std::string * type_p = nullptr , G::EpochTime * time_p = nullptr , 
+		PublisherHeader * header_p = nullptr ) ; 
+			///< Does a receive() but without requiring a publication event.
+
+	bool borrow( PublisherView & view ) ; 
+		///< A zero-copy alternative to receive(). The returned view points
+		///< directly into the channel's shared memory and it stays usable 
+		///< until the next receive(), peek(), borrow() or close(), but only 
+		///< for as long as the view is valid(). Returns false if the 
+		///< publisher has gone away. Returns an empty view in the case of 
+		///< an ignorable event.
+
+	bool peek( PublisherView & view ) ; 
+		///< Does a borrow() but without requiring a publication event.
+		///< Returns false if no data is available.
 
-	bool peek( std::vector<char> & buffer , std::string * type_p = nullptr , G::EpochTime * time_p = nullptr ) ; 
-		///< Does a receive() but without requiring a publication event.
+	bool history( G::EpochTime since , std::vector<PublisherView> & views ) ; 
+		///< Returns views of the most recent publications, oldest first, 
+		///< having a publication time no earlier than the given time. Only 
+		///< the latest publication is available unless the publisher was 
+		///< configured with a history (see G::PublisherConfig). This does 
+		///< not need a publication event and it does not affect receive(). 
+		///< Each view must be checked with valid() after use, as with borrow(), 
+		///< and they are only usable until the next receive(), peek(), 
+		///< borrow(), history() or close(). Returns false if no views are 
+		///< available.
 
 	std::string name() const ;
 		///< Returns the channel name, as passed in to the constructor.
@@ -287,4 +359,119 @@ private:
 	unique_ptr<PublisherSubscriber> m_subscriber ; // second
 } ;
 
+/// \class G::PublisherConfig
+/// A structure to hold configuration for a G::Publisher object.
+/// 
+struct G::PublisherConfig
+{
+	size_t m_history ; // publications kept in addition to the latest
+	size_t m_slots ; // maximum number of subscribers
+	explicit PublisherConfig( size_t history = 0U ) ;
+} ;
+
+/// \class G::PublisherHeader
+/// A fixed-size binary header that is published alongside the payload.
+/// The format and flag values are defined by the application, with zero 
+/// meaning unknown. The sequence number and part offsets are always filled 
+/// in by the publisher, and the time defaults to the publication time.
+/// 
+/// The payload can optionally carry alternative representations of the
+/// same data (eg. a thumbnail) after the primary representation, in which 
+/// case 'm_size' is the size of the primary representation and the 
+/// alternatives are described by 'm_representation'.
+/// 
+struct G::PublisherHeader
+{
+	enum { PARTS = 4 } ;
+	enum { REPRESENTATIONS = 3 } ;
+	enum { f_keyframe = 1 } ;
+	struct Representation /// An alternative representation within a G::PublisherHeader payload.
+	{
+		unsigned int m_format ;
+		int m_dx ;
+		int m_dy ;
+		int m_channels ;
+		size_t m_offset ; // within the payload
+		size_t m_size ;
+	} ;
+	unsigned int m_format ; // application-defined, zero if unknown
+	int m_dx ;
+	int m_dy ;
+	int m_channels ;
+	unsigned int m_flags ; // eg. f_keyframe
+	unsigned long m_seq ; // publication sequence number
+	time_t m_time_s ; // capture time
+	unsigned long m_time_us ;
+	size_t m_parts ; // number of payload parts
+	size_t m_offset[PARTS] ; // offsets of the first few payload parts
+	size_t m_size ; // size of the primary representation, or zero for all of the payload
+	size_t m_representations ; // number of alternative representations
+	Representation m_representation[REPRESENTATIONS] ;
+	PublisherHeader() ;
+} ;
+
+/// \class G::PublisherView
+/// A read-only view of a publication that is held in a channel's shared memory,
+/// as returned by G::PublisherSubscription::borrow(). 
+/// 
+/// The publisher uses a ring of buffers so a borrowed buffer is not normally 
+/// overwritten until two more publications have been made, but slow readers 
+/// must check valid() after using the data, and discard their results if the 
+/// view has become invalid.
+/// 
+/// \code
+/// G::PublisherView view ;
+/// if( subscription.borrow(view) && !view.empty() ) {
+///   process( view.data() , view.size() ) ;
+///   if( !view.valid() ) discard() ;
+/// }
+/// \endcode
+/// 
+class G::PublisherView
+{
+public:
+	PublisherView() ;
+		///< Default constructor for an empty view.
+
+	bool empty() const ;
+		///< Returns true if the view is empty.
+
+	const char * data() const ;
+		///< Returns a pointer to the borrowed data.
+
+	size_t size() const ;
+		///< Returns the size of the borrowed data.
+
+	std::string type() const ;
+		///< Returns the publication type.
+
+	G::EpochTime time() const ;
+		///< Returns the publication time.
+
+	const PublisherHeader & header() const ;
+		///< Returns the publication's binary header.
+
+	bool valid() const ;
+		///< Returns true if the publisher has not started to overwrite 
+		///< the borrowed buffer. Returns false if empty().
+
+	void clear() ;
+		///< Resets the view to empty.
+		///< Postcondition: empty()
+
+	void set( const volatile unsigned long * gen_p , unsigned long gen ,
+		const char * p , size_t n , const std::string & type , G::EpochTime time ,
+		const PublisherHeader & header ) ;
+			///< Used by G::PublisherChannel.
+
+private:
+	const volatile unsigned long * m_gen_p ;
+	unsigned long m_gen ;
+	const char * m_p ;
+	size_t m_n ;
+	std::string m_type ;
+	G::EpochTime m_time ;
+	PublisherHeader m_header ;
+} ;
+
 #endif
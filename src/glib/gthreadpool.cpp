@@ -0,0 +1,261 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// gthreadpool.cpp
+//
+
+#include "gdef.h"
+#include "gthreadpool.h"
+#include "glog.h"
+#include "gassert.h"
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#if GCONFIG_ENABLE_STD_THREAD
+#include <condition_variable>
+#endif
+
+/// \class G::ThreadPoolImp
+/// A pimple-pattern implementation class for G::ThreadPool.
+///
+class G::ThreadPoolImp
+{
+public:
+	explicit ThreadPoolImp( unsigned int threads ) ;
+	~ThreadPoolImp() ;
+	unsigned int threads() const ;
+	void run( ThreadPool::Job & , unsigned int count ) ;
+
+private:
+	ThreadPoolImp( const ThreadPoolImp & ) ;
+	void operator=( const ThreadPoolImp & ) ;
+
+#if GCONFIG_ENABLE_STD_THREAD
+	static void workerThread( ThreadPoolImp * ) ;
+	void start() ;
+	void worker() ;
+	void runItems( ThreadPool::Job & , unsigned long ) ;
+	void runItem( ThreadPool::Job & , unsigned int ) ;
+	bool take( unsigned long , unsigned int & ) ;
+	std::mutex m_mutex ;
+	std::condition_variable m_work_cond ;
+	std::condition_variable m_done_cond ;
+	std::vector<std::thread> m_threads ;
+	unsigned int m_size ;
+	unsigned long m_generation ;
+	bool m_stop ;
+	unsigned int m_next ;
+	unsigned int m_pending ;
+	std::exception_ptr m_exception ;
+	ThreadPool::Job * m_job ;
+	unsigned int m_count ;
+#endif
+} ;
+
+// ==
+
+G::ThreadPool::ThreadPool( unsigned int threads ) :
+	m_imp(new ThreadPoolImp(threads))
+{
+}
+
+G::ThreadPool::~ThreadPool()
+{
+}
+
+unsigned int G::ThreadPool::threads() const
+{
+	return m_imp->threads() ;
+}
+
+void G::ThreadPool::run( Job & job , unsigned int count )
+{
+	m_imp->run( job , count ) ;
+}
+
+// ==
+
+#if GCONFIG_ENABLE_STD_THREAD
+
+G::ThreadPoolImp::ThreadPoolImp( unsigned int threads ) :
+	m_size(std::max(1U,threads)) ,
+	m_generation(0UL) ,
+	m_stop(false) ,
+	m_next(0U) ,
+	m_pending(0U) ,
+	m_job(nullptr) ,
+	m_count(0U)
+{
+	if( threads > 1U && !threading::works() )
+	{
+		G_WARNING( "G::ThreadPool::ctor: threading not available: using one thread" ) ;
+		m_size = 1U ;
+	}
+}
+
+G::ThreadPoolImp::~ThreadPoolImp()
+{
+	{
+		threading::lock_type lock( m_mutex ) ;
+		m_stop = true ;
+	}
+	m_work_cond.notify_all() ;
+	for( std::vector<std::thread>::iterator p = m_threads.begin() ; p != m_threads.end() ; ++p )
+		p->join() ;
+}
+
+unsigned int G::ThreadPoolImp::threads() const
+{
+	return m_size ;
+}
+
+void G::ThreadPoolImp::start()
+{
+	// the workers are started by the first run() rather than by the 
+	// constructor so that the pool can be constructed before the
+	// process forks, eg. in G::Daemon::detach()
+	G_ASSERT( m_threads.empty() ) ;
+	for( unsigned int i = 1U ; i < m_size ; i++ )
+		m_threads.push_back( std::thread(&ThreadPoolImp::workerThread,this) ) ;
+}
+
+void G::ThreadPoolImp::run( ThreadPool::Job & job , unsigned int count )
+{
+	if( m_size > 1U && count > 1U && m_threads.empty() )
+		start() ;
+
+	if( m_threads.empty() || count <= 1U )
+	{
+		for( unsigned int i = 0U ; i < count ; i++ )
+			job.run( i ) ;
+		return ;
+	}
+
+	unsigned long generation = 0UL ;
+	{
+		threading::lock_type lock( m_mutex ) ;
+		G_ASSERT( m_pending == 0U ) ;
+		m_job = &job ;
+		m_count = count ;
+		m_next = 0U ;
+		m_pending = count ;
+		m_exception = std::exception_ptr() ;
+		generation = ++m_generation ;
+	}
+	m_work_cond.notify_all() ;
+
+	// help out, then wait for the stragglers
+	runItems( job , generation ) ;
+	std::exception_ptr e ;
+	{
+		std::unique_lock<std::mutex> lock( m_mutex ) ;
+		while( m_pending != 0U )
+			m_done_cond.wait( lock ) ;
+		m_job = nullptr ;
+		e = m_exception ;
+	}
+	if( e )
+		std::rethrow_exception( e ) ;
+}
+
+void G::ThreadPoolImp::workerThread( ThreadPoolImp * This )
+{
+	This->worker() ;
+}
+
+void G::ThreadPoolImp::worker()
+{
+	unsigned long generation = 0UL ;
+	for(;;)
+	{
+		ThreadPool::Job * job = nullptr ;
+		{
+			std::unique_lock<std::mutex> lock( m_mutex ) ;
+			while( !m_stop && ( m_generation == generation || m_job == nullptr ) )
+				m_work_cond.wait( lock ) ;
+			if( m_stop )
+				break ;
+			generation = m_generation ;
+			job = m_job ;
+		}
+		runItems( *job , generation ) ;
+	}
+}
+
+bool G::ThreadPoolImp::take( unsigned long generation , unsigned int & index )
+{
+	// (a late-waking worker must not take items from the next run)
+	threading::lock_type lock( m_mutex ) ;
+	if( generation != m_generation || m_next >= m_count )
+		return false ;
+	index = m_next++ ;
+	return true ;
+}
+
+void G::ThreadPoolImp::runItems( ThreadPool::Job & job , unsigned long generation )
+{
+	unsigned int index = 0U ;
+	while( take(generation,index) )
+		runItem( job , index ) ;
+}
+
+void G::ThreadPoolImp::runItem( ThreadPool::Job & job , unsigned int index )
+{
+	try
+	{
+		job.run( index ) ;
+	}
+	catch(...)
+	{
+		threading::lock_type lock( m_mutex ) ;
+		if( !m_exception )
+			m_exception = std::current_exception() ;
+	}
+	bool done = false ;
+	{
+		threading::lock_type lock( m_mutex ) ;
+		done = --m_pending == 0U ;
+	}
+	if( done )
+		m_done_cond.notify_all() ;
+}
+
+#else
+
+G::ThreadPoolImp::ThreadPoolImp( unsigned int )
+{
+}
+
+G::ThreadPoolImp::~ThreadPoolImp()
+{
+}
+
+unsigned int G::ThreadPoolImp::threads() const
+{
+	return 1U ;
+}
+
+void G::ThreadPoolImp::run( ThreadPool::Job & job , unsigned int count )
+{
+	for( unsigned int i = 0U ; i < count ; i++ )
+		job.run( i ) ;
+}
+
+#endif
+
+/// \file gthreadpool.cpp
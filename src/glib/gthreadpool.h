@@ -0,0 +1,92 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gthreadpool.h
+///
+
+#ifndef G_THREAD_POOL__H
+#define G_THREAD_POOL__H
+
+#include "gdef.h"
+#include "gexception.h"
+
+namespace G
+{
+	class ThreadPool ;
+	class ThreadPoolImp ;
+}
+
+/// \class G::ThreadPool
+/// A fixed-size pool of worker threads for fork-join parallelism, where
+/// the calling thread hands out a number of independent work items and
+/// then helps to run them until they are all done.
+///
+/// \code
+/// struct Bands : G::ThreadPool::Job { void run( unsigned int band ) override { ... } } ;
+/// G::ThreadPool pool( 4U ) ;
+/// Bands bands ;
+/// pool.run( bands , 4U ) ;
+/// \endcode
+///
+/// If threading is not available (see G::threading) then the work items
+/// are all run on the calling thread.
+///
+/// The worker threads are started by the first run() rather than by the
+/// constructor, so a pool can be constructed before the process forks
+/// (eg. G::Daemon::detach()) as long as it is not used until afterwards.
+///
+class G::ThreadPool
+{
+public:
+	G_EXCEPTION( Error , "thread pool error" ) ;
+
+	struct Job /// A callback interface for G::ThreadPool.
+	{
+		virtual void run( unsigned int index ) = 0 ;
+			///< Runs the index-th work item. Called from the worker
+			///< threads and from the thread calling ThreadPool::run().
+
+		virtual ~Job() {}
+			///< Destructor.
+	} ;
+
+	explicit ThreadPool( unsigned int threads ) ;
+		///< Constructor for a pool with the given number of threads
+		///< in total, including the calling thread, so one or zero
+		///< gives no worker threads.
+
+	~ThreadPool() ;
+		///< Destructor. Stops and joins any worker threads.
+
+	unsigned int threads() const ;
+		///< Returns the total number of threads, including the
+		///< calling thread.
+
+	void run( Job & , unsigned int count ) ;
+		///< Runs count work items, returning when they are all complete.
+		///< Throws if a work item threw an exception. Must not be called
+		///< from a work item.
+
+private:
+	ThreadPool( const ThreadPool & ) ;
+	void operator=( const ThreadPool & ) ;
+
+private:
+	unique_ptr<ThreadPoolImp> m_imp ;
+} ;
+
+#endif
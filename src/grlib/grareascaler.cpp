@@ -0,0 +1,395 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// grareascaler.cpp
+//
+
+#include "gdef.h"
+#include "grdef.h"
+#include "grareascaler.h"
+#include "grcolourspace.h"
+#include "gassert.h"
+#include <algorithm>
+
+#if defined(__SSE2__)
+#define GR_AREA_SCALER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// the 16-bit column sums are good for up to 257 rows of 255
+	g__constexpr int max_scale_16 = 256 ;
+
+	// divides with rounding, using a multiply and shift when the divisor is
+	// small enough for the result to be exact, ie. when the dividend is
+	// less than 2^32/n -- the dividend here is a sum of n bytes so it is
+	// always less than 256n, giving a limit of 4096 on n
+	//
+	struct Divisor
+	{
+		explicit Divisor( unsigned int n ) :
+			m_n(std::max(1U,n)) ,
+			m_half(m_n/2U) ,
+			m_recip(m_n<4096U?(0xFFFFFFFFULL/m_n+1ULL):0ULL)
+		{
+		}
+		unsigned int operator()( unsigned int a ) const
+		{
+			a += m_half ;
+			return m_recip ? static_cast<unsigned int>((a*m_recip)>>32) : (a/m_n) ;
+		}
+		bool pow2() const
+		{
+			return (m_n & (m_n-1U)) == 0U ;
+		}
+		unsigned int m_n ;
+		unsigned int m_half ;
+		unsigned long long m_recip ;
+	} ;
+
+	// a divisor for powers of two, eg. for the full 2x2 and 4x4 blocks
+	//
+	struct ShiftDivisor
+	{
+		explicit ShiftDivisor( const Divisor & d ) :
+			m_half(d.m_half) ,
+			m_shift(0U)
+		{
+			while( (1U<<m_shift) < d.m_n )
+				m_shift++ ;
+		}
+		unsigned int operator()( unsigned int a ) const
+		{
+			return (a+m_half) >> m_shift ;
+		}
+		unsigned int m_half ;
+		unsigned int m_shift ;
+	} ;
+
+	// adds a row of bytes into a row of 16-bit column sums, or just widens
+	// it if the first row of the block
+	//
+	void accumulate( unsigned short * sum , const unsigned char * p , size_t n , bool first )
+	{
+		size_t i = 0U ;
+		#ifdef GR_AREA_SCALER_SSE2
+		{
+			const __m128i zero = _mm_setzero_si128() ;
+			for( ; (i+16U) <= n ; i += 16U )
+			{
+				__m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>(p+i) ) ;
+				__m128i lo = _mm_unpacklo_epi8( v , zero ) ;
+				__m128i hi = _mm_unpackhi_epi8( v , zero ) ;
+				__m128i * s = reinterpret_cast<__m128i*>(sum+i) ;
+				if( !first )
+				{
+					lo = _mm_add_epi16( lo , _mm_loadu_si128(s) ) ;
+					hi = _mm_add_epi16( hi , _mm_loadu_si128(s+1) ) ;
+				}
+				_mm_storeu_si128( s , lo ) ;
+				_mm_storeu_si128( s+1 , hi ) ;
+			}
+		}
+		#endif
+		if( first )
+		{
+			for( ; i < n ; i++ )
+				sum[i] = p[i] ;
+		}
+		else
+		{
+			for( ; i < n ; i++ )
+				sum[i] += p[i] ;
+		}
+	}
+
+	void accumulate( unsigned int * sum , const unsigned char * p , size_t n , bool first )
+	{
+		if( first )
+			std::copy( p , p+n , sum ) ;
+		else
+			for( size_t i = 0U ; i < n ; i++ )
+				sum[i] += p[i] ;
+	}
+
+	// averages each block of k adjacent pixels from the column sums, using
+	// the given divisor, for n output pixels
+	//
+	template <typename T, typename D>
+	void reduce( const T * p , int n , int k , int channels , const D & d , unsigned char * out )
+	{
+		if( channels == 1 )
+		{
+			for( int x = 0 ; x < n ; x++ , p += k )
+			{
+				unsigned int s0 = 0U ;
+				for( int i = 0 ; i < k ; i++ )
+					s0 += p[i] ;
+				*out++ = static_cast<unsigned char>( d(s0) ) ;
+			}
+		}
+		else if( k == 2 )
+		{
+			for( int x = 0 ; x < n ; x++ , p += 6 )
+			{
+				*out++ = static_cast<unsigned char>( d(p[0]+p[3]) ) ;
+				*out++ = static_cast<unsigned char>( d(p[1]+p[4]) ) ;
+				*out++ = static_cast<unsigned char>( d(p[2]+p[5]) ) ;
+			}
+		}
+		else
+		{
+			for( int x = 0 ; x < n ; x++ )
+			{
+				unsigned int s0 = 0U ;
+				unsigned int s1 = 0U ;
+				unsigned int s2 = 0U ;
+				for( int i = 0 ; i < k ; i++ , p += 3 )
+				{
+					s0 += p[0] ;
+					s1 += p[1] ;
+					s2 += p[2] ;
+				}
+				*out++ = static_cast<unsigned char>( d(s0) ) ;
+				*out++ = static_cast<unsigned char>( d(s1) ) ;
+				*out++ = static_cast<unsigned char>( d(s2) ) ;
+			}
+		}
+	}
+}
+
+Gr::AreaScaler::AreaScaler( int dx_in , int dy_in , int channels_in , int scale , bool monochrome_out , bool use_colourspace )
+{
+	if( scale < 1 )
+		throw Error( "invalid scale factor" ) ;
+	init( dx_in , dy_in , channels_in , scaled(dx_in,scale) , scaled(dy_in,scale) , monochrome_out , use_colourspace ) ;
+	m_scale = scale ;
+	if( m_scale <= max_scale_16 )
+		m_sum16.resize( sizet(m_dx_in,m_channels_in) ) ;
+	else
+		m_sum32.resize( sizet(m_dx_in,m_channels_in) ) ;
+}
+
+Gr::AreaScaler::AreaScaler( int dx_in , int dy_in , int channels_in , int dx_out , int dy_out , bool monochrome_out , bool use_colourspace )
+{
+	init( dx_in , dy_in , channels_in , dx_out , dy_out , monochrome_out , use_colourspace ) ;
+
+	// use the block code if the scale factor is integral
+	if( (dx_in%dx_out) == 0 && (dy_in%dy_out) == 0 && (dx_in/dx_out) == (dy_in/dy_out) )
+	{
+		m_scale = dx_in / dx_out ;
+		if( m_scale <= max_scale_16 )
+			m_sum16.resize( sizet(m_dx_in,m_channels_in) ) ;
+		else
+			m_sum32.resize( sizet(m_dx_in,m_channels_in) ) ;
+		return ;
+	}
+
+	// work out the horizontal weights, normalised to sum to 256 -- input
+	// pixel i spans [i*dx_out,(i+1)*dx_out) and output pixel x spans
+	// [x*dx_in,(x+1)*dx_in)
+	//
+	m_x_first.resize( sizet(dx_out) ) ;
+	m_x_count.resize( sizet(dx_out) ) ;
+	for( int x = 0 ; x < dx_out ; x++ )
+	{
+		const unsigned long long begin = static_cast<unsigned long long>(x) * dx_in ;
+		const unsigned long long end = begin + dx_in ;
+		const int first = static_cast<int>( begin / dx_out ) ;
+		const int last = static_cast<int>( (end-1U) / dx_out ) ;
+		const size_t base = m_x_weight.size() ;
+		unsigned int total = 0U ;
+		size_t biggest = base ;
+		for( int i = first ; i <= last ; i++ )
+		{
+			const unsigned long long i_begin = static_cast<unsigned long long>(i) * dx_out ;
+			const unsigned long long overlap = std::min(end,i_begin+dx_out) - std::max(begin,i_begin) ;
+			const unsigned int w = static_cast<unsigned int>( (overlap*256U+dx_in/2) / dx_in ) ;
+			m_x_weight.push_back( w ) ;
+			total += w ;
+			if( w > m_x_weight[biggest] ) biggest = m_x_weight.size() - 1U ;
+		}
+		m_x_weight[biggest] += 256U ;
+		m_x_weight[biggest] -= total ;
+		m_x_first[x] = first ;
+		m_x_count[x] = last - first + 1 ;
+	}
+	m_hrow.resize( sizet(dx_out,m_channels_in) ) ;
+	m_sum32.resize( m_hrow.size() ) ;
+	m_sum_next.resize( m_hrow.size() ) ;
+}
+
+void Gr::AreaScaler::init( int dx_in , int dy_in , int channels_in , int dx_out , int dy_out , bool monochrome_out , bool use_colourspace )
+{
+	if( dx_in <= 0 || dy_in <= 0 || !( channels_in == 1 || channels_in == 3 ) )
+		throw Error( "invalid input image size" ) ;
+	if( dx_out <= 0 || dy_out <= 0 || dx_out > dx_in || dy_out > dy_in )
+		throw Error( "invalid output image size" ) ;
+
+	m_dx_in = dx_in ;
+	m_dy_in = dy_in ;
+	m_channels_in = channels_in ;
+	m_dx_out = dx_out ;
+	m_dy_out = dy_out ;
+	m_channels_out = monochrome_out ? 1 : channels_in ;
+	m_use_colourspace = use_colourspace ;
+	m_scale = 0 ;
+	m_y_in = 0 ;
+	m_y_out = 0 ;
+	m_rows = 0 ;
+	m_ready = false ;
+	if( m_channels_out != m_channels_in )
+		m_line.resize( sizet(dx_out,m_channels_in) ) ;
+}
+
+void Gr::AreaScaler::add( const unsigned char * row_in )
+{
+	G_ASSERT( !m_ready && m_y_in < m_dy_in ) ;
+	if( m_ready || m_y_in >= m_dy_in || row_in == nullptr )
+		throw Error( "unexpected input row" ) ;
+
+	m_y_in++ ;
+	if( m_scale )
+		addBlock( row_in ) ;
+	else
+		addWeighted( row_in ) ;
+}
+
+void Gr::AreaScaler::emit( unsigned char * row_out )
+{
+	G_ASSERT( m_ready ) ;
+	if( !m_ready || row_out == nullptr )
+		throw Error( "unexpected output row" ) ;
+
+	if( m_scale )
+		emitBlock( row_out ) ;
+	else
+		emitWeighted( row_out ) ;
+	m_ready = false ;
+	m_y_out++ ;
+	G_ASSERT( m_y_out <= m_dy_out ) ;
+}
+
+void Gr::AreaScaler::addBlock( const unsigned char * row_in )
+{
+	const size_t n = sizet( m_dx_in , m_channels_in ) ;
+	if( m_sum16.empty() )
+		accumulate( &m_sum32[0] , row_in , n , m_rows == 0 ) ;
+	else
+		accumulate( &m_sum16[0] , row_in , n , m_rows == 0 ) ;
+	m_rows++ ;
+	m_ready = m_rows == m_scale || m_y_in == m_dy_in ;
+}
+
+void Gr::AreaScaler::emitBlock( unsigned char * out )
+{
+	const int k = m_scale ;
+	const int c = m_channels_in ;
+	const int n = m_dx_out - 1 ;
+	const int k_tail = m_dx_in - n * k ; // right-hand edge block
+	const Divisor divisor( static_cast<unsigned int>(m_rows*k) ) ;
+	const Divisor divisor_tail( static_cast<unsigned int>(m_rows*k_tail) ) ;
+	const size_t offset_tail = sizet( n , k , c ) ;
+	unsigned char * p = m_channels_out == c ? out : &m_line[0] ;
+	if( m_sum16.empty() )
+	{
+		reduce( &m_sum32[0] , n , k , c , divisor , p ) ;
+		reduce( &m_sum32[offset_tail] , 1 , k_tail , c , divisor_tail , p + sizet(n,c) ) ;
+	}
+	else
+	{
+		if( divisor.pow2() )
+			reduce( &m_sum16[0] , n , k , c , ShiftDivisor(divisor) , p ) ;
+		else
+			reduce( &m_sum16[0] , n , k , c , divisor , p ) ;
+		reduce( &m_sum16[offset_tail] , 1 , k_tail , c , divisor_tail , p + sizet(n,c) ) ;
+	}
+	if( p != out )
+		toMonochrome( p , out ) ;
+	m_rows = 0 ;
+}
+
+void Gr::AreaScaler::addWeighted( const unsigned char * row_in )
+{
+	// horizontal pass into the scaled-up row buffer
+	const int c = m_channels_in ;
+	const unsigned int * w = &m_x_weight[0] ;
+	unsigned int * h = &m_hrow[0] ;
+	for( int x = 0 ; x < m_dx_out ; x++ )
+	{
+		const int count = m_x_count[x] ;
+		const unsigned char * p = row_in + sizet(m_x_first[x],c) ;
+		for( int ch = 0 ; ch < c ; ch++ , h++ )
+		{
+			unsigned int sum = 0U ;
+			for( int i = 0 ; i < count ; i++ )
+				sum += w[i] * p[i*c+ch] ;
+			*h = sum ;
+		}
+		w += count ;
+	}
+
+	// vertical pass -- the input row spans [y_in*dy_out,(y_in+1)*dy_out) and
+	// the output row [y_out*dy_in,(y_out+1)*dy_in) so the input row can straddle
+	// two output rows
+	const unsigned long long end_in = static_cast<unsigned long long>(m_y_in) * m_dy_out ;
+	const unsigned long long end_out = static_cast<unsigned long long>(m_y_out+1) * m_dy_in ;
+	const unsigned int b = end_in > end_out ? static_cast<unsigned int>(end_in-end_out) : 0U ;
+	const unsigned int a = static_cast<unsigned int>(m_dy_out) - b ;
+	const size_t n = m_hrow.size() ;
+	for( size_t i = 0U ; i < n ; i++ )
+		m_sum32[i] += m_hrow[i] * a ;
+	if( b )
+	{
+		for( size_t i = 0U ; i < n ; i++ )
+			m_sum_next[i] += m_hrow[i] * b ;
+	}
+	m_ready = end_in >= end_out ;
+}
+
+void Gr::AreaScaler::emitWeighted( unsigned char * out )
+{
+	const unsigned int d = static_cast<unsigned int>(m_dy_in) * 256U ;
+	const unsigned int half = d / 2U ;
+	const size_t n = m_sum32.size() ;
+	unsigned char * p = m_channels_out == m_channels_in ? out : &m_line[0] ;
+	for( size_t i = 0U ; i < n ; i++ )
+		p[i] = static_cast<unsigned char>( (m_sum32[i]+half) / d ) ;
+	if( p != out )
+		toMonochrome( p , out ) ;
+	m_sum32.swap( m_sum_next ) ;
+	std::fill( m_sum_next.begin() , m_sum_next.end() , 0U ) ;
+}
+
+void Gr::AreaScaler::toMonochrome( const unsigned char * p , unsigned char * out ) const
+{
+	G_ASSERT( m_channels_in == 3 && m_channels_out == 1 ) ;
+	unsigned char * const end = out + m_dx_out ;
+	if( m_use_colourspace )
+	{
+		for( ; out != end ; p += 3 )
+			*out++ = Gr::ColourSpace::y_int( p[0] , p[1] , p[2] ) ;
+	}
+	else
+	{
+		for( ; out != end ; p += 3 )
+			*out++ = p[0] ;
+	}
+}
+
+/// \file grareascaler.cpp
@@ -0,0 +1,151 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file grareascaler.h
+///
+
+#ifndef GR_AREA_SCALER__H
+#define GR_AREA_SCALER__H
+
+#include "gdef.h"
+#include "gexception.h"
+#include <vector>
+
+namespace Gr
+{
+	class AreaScaler ;
+}
+
+/// \class Gr::AreaScaler
+/// An image down-scaler that does area averaging, so that each output pixel
+/// is the mean of the input pixels that it covers. This is less prone to
+/// aliasing than the point sampling done by Gr::Scaler, and it works on
+/// whole rows rather than on individual pixels.
+///
+/// Input rows are added one at a time and each output row is emitted as
+/// soon as it is complete:
+/// \code
+/// AreaScaler scaler( dx , dy , 3 , scale , monochrome ) ;
+/// for( int y_in = 0 , y_out = 0 ; y_in < dy ; y_in++ )
+/// {
+///   scaler.add( row_in(y_in) ) ;
+///   if( scaler.ready() )
+///     scaler.emit( row_out(y_out++) ) ;
+/// }
+/// \endcode
+///
+/// An output row is not emitted until all the input rows that contribute
+/// to it have been added, so scaling can be done in place within a
+/// contiguous buffer.
+///
+/// Integral scale factors sum the input rows with SSE2, where available,
+/// and the right-hand and bottom edge blocks are averaged over just the
+/// pixels that they contain, consistent with Gr::scaled(). Non-integral
+/// factors use pixel-overlap weights.
+///
+class Gr::AreaScaler
+{
+public:
+	G_EXCEPTION( Error , "area scaler error" ) ;
+
+	AreaScaler( int dx_in , int dy_in , int channels_in , int scale , bool monochrome_out , bool use_colourspace = true ) ;
+		///< Constructor for an integral scale factor. The output image
+		///< size is Gr::scaled(dx_in,scale) by Gr::scaled(dy_in,scale).
+		///< Monochrome output uses a colourspace transform of the
+		///< averaged pixel or just its first channel.
+
+	AreaScaler( int dx_in , int dy_in , int channels_in , int dx_out , int dy_out , bool monochrome_out , bool use_colourspace = true ) ;
+		///< Constructor for an arbitrary reduction in size. Throws if the
+		///< output is larger than the input in either dimension.
+
+	int dx() const ;
+		///< Returns the output width.
+
+	int dy() const ;
+		///< Returns the output height.
+
+	int channels() const ;
+		///< Returns the number of output channels, one or three.
+
+	void add( const unsigned char * row_in ) ;
+		///< Adds the next input row. Precondition: !ready()
+
+	bool ready() const ;
+		///< Returns true if an output row is complete and should be
+		///< emitted before the next input row is added.
+
+	void emit( unsigned char * row_out ) ;
+		///< Writes out the completed output row. Precondition: ready()
+
+private:
+	AreaScaler( const AreaScaler & ) ;
+	void operator=( const AreaScaler & ) ;
+	void init( int , int , int , int , int , bool , bool ) ;
+	void addBlock( const unsigned char * ) ;
+	void addWeighted( const unsigned char * ) ;
+	void emitBlock( unsigned char * ) ;
+	void emitWeighted( unsigned char * ) ;
+	void toMonochrome( const unsigned char * , unsigned char * ) const ;
+
+private:
+	int m_dx_in ;
+	int m_dy_in ;
+	int m_channels_in ;
+	int m_dx_out ;
+	int m_dy_out ;
+	int m_channels_out ;
+	bool m_use_colourspace ;
+	int m_scale ; // zero if non-integral
+	int m_y_in ;
+	int m_y_out ;
+	int m_rows ;
+	bool m_ready ;
+	std::vector<unsigned short> m_sum16 ;
+	std::vector<unsigned int> m_sum32 ;
+	std::vector<unsigned int> m_sum_next ;
+	std::vector<unsigned int> m_hrow ;
+	std::vector<int> m_x_first ;
+	std::vector<int> m_x_count ;
+	std::vector<unsigned int> m_x_weight ;
+	std::vector<unsigned char> m_line ;
+} ;
+
+inline
+int Gr::AreaScaler::dx() const
+{
+	return m_dx_out ;
+}
+
+inline
+int Gr::AreaScaler::dy() const
+{
+	return m_dy_out ;
+}
+
+inline
+int Gr::AreaScaler::channels() const
+{
+	return m_channels_out ;
+}
+
+inline
+bool Gr::AreaScaler::ready() const
+{
+	return m_ready ;
+}
+
+#endif
@@ -740,4 +740,52 @@ bool Gr::Avc::Rbsp::hasMarkers( const std::string & s )
 		s.find(_002()) != std::string::npos ;
 }
 
+// ==
+
+bool Gr::Avc::ByteStream::signature( const unsigned char * p , size_t n )
+{
+	return
+		( n > 4U && p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 1 ) ||
+		( n > 3U && p[0] == 0 && p[1] == 0 && p[2] == 1 ) ;
+}
+
+bool Gr::Avc::ByteStream::next( const char * p , size_t n , size_t & pos , size_t & size )
+{
+	// skip to the start of the next NALU
+	bool found = false ;
+	for( ; !found && (pos+3U) <= n ; pos++ )
+		found = p[pos] == 0 && p[pos+1U] == 0 && p[pos+2U] == 1 ;
+	if( !found || (pos+2U) >= n )
+		return false ;
+	pos += 2U ;
+
+	// find the end -- the next marker or the end of the buffer, with 
+	// any trailing zero belonging to a start-code
+	size_t end = pos ;
+	for( ; (end+3U) <= n ; end++ )
+	{
+		if( p[end] == 0 && p[end+1U] == 0 && p[end+2U] == 1 )
+			break ;
+	}
+	if( (end+3U) > n ) 
+		end = n ;
+	else if( end > pos && p[end-1U] == 0 ) 
+		end-- ;
+	size = end - pos ;
+	return size != 0U ;
+}
+
+bool Gr::Avc::ByteStream::keyframe( const char * p , size_t n )
+{
+	size_t pos = 0U ;
+	size_t size = 0U ;
+	for( ; next( p , n , pos , size ) ; pos += size )
+	{
+		unsigned int type = static_cast<unsigned char>(p[pos]) & 0x1fU ;
+		if( type >= 1U && type <= 5U ) // coded slice
+			return type == 5U ;
+	}
+	return false ;
+}
+
 /// \file gravc.cpp
@@ -77,6 +77,7 @@ namespace Gr
 		class Sps ;
 		class Pps ;
 		class Rbsp ;
+		class ByteStream ;
 		std::ostream & operator<<( std::ostream & , const Avc::Sps & ) ;
 		std::ostream & operator<<( std::ostream & , const Avc::Pps & ) ;
 		typedef G::bit_iterator<const char*> bit_iterator_t ;
@@ -341,4 +342,29 @@ private:
 	Rbsp() ;
 } ;
 
+/// \class Gr::Avc::ByteStream
+/// Provides static helper functions for NALU byte-streams, where each
+/// NALU is preceded by a 00-00-01 marker or 00-00-00-01 start-code.
+/// 
+class Gr::Avc::ByteStream
+{
+public:
+	static bool signature( const unsigned char * p , size_t n ) ;
+		///< Returns true if the buffer starts with a start-code.
+
+	static bool next( const char * p , size_t n , size_t & pos , size_t & size ) ;
+		///< Finds the next NALU at or after the given position, returning
+		///< its offset and size, not including any marker. The NALU type
+		///< is in the low five bits of the first byte. Returns false
+		///< if there are no more NALUs.
+
+	static bool keyframe( const char * p , size_t n ) ;
+		///< Returns true if the first picture NALU in the byte-stream is an
+		///< IDR picture, ie. a key frame that does not depend on the 
+		///< previous pictures.
+
+private:
+	ByteStream() ;
+} ;
+
 #endif
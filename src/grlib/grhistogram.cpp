@@ -0,0 +1,158 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// grhistogram.cpp
+//
+
+#include "gdef.h"
+#include "grhistogram.h"
+#include "gassert.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#define GR_HISTOGRAM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+void Gr::Histogram::add( const value_type * p , size_t n , const unsigned char * mask )
+{
+	G_ASSERT( active() ) ;
+	sum_type * data = &m_data[0] ;
+	size_t i = 0U ;
+	if( mask == nullptr )
+	{
+		for( ; (i+4U) <= n ; i += 4U )
+		{
+			data[p[i]*L]++ ;
+			data[p[i+1U]*L+1U]++ ;
+			data[p[i+2U]*L+2U]++ ;
+			data[p[i+3U]*L+3U]++ ;
+		}
+	}
+	#ifdef GR_HISTOGRAM_SSE2
+	else
+	{
+		// test the mask sixteen pixels at a time so that the common cases of
+		// fully-masked and fully-unmasked runs need no per-pixel tests
+		const __m128i zero = _mm_setzero_si128() ;
+		for( ; (i+16U) <= n ; i += 16U )
+		{
+			const __m128i m = _mm_loadu_si128( reinterpret_cast<const __m128i*>(mask+i) ) ;
+			const unsigned int bits = static_cast<unsigned int>( _mm_movemask_epi8( _mm_cmpeq_epi8(m,zero) ) ) ;
+			if( bits == 0xffffU )
+			{
+				for( size_t j = i ; j < (i+16U) ; j += 4U )
+				{
+					data[p[j]*L]++ ;
+					data[p[j+1U]*L+1U]++ ;
+					data[p[j+2U]*L+2U]++ ;
+					data[p[j+3U]*L+3U]++ ;
+				}
+			}
+			else if( bits != 0U )
+			{
+				for( unsigned int j = 0U ; j < 16U ; j++ )
+				{
+					if( bits & (1U<<j) )
+						data[p[i+j]*L+(j%L)]++ ;
+				}
+			}
+		}
+	}
+	#endif
+	for( ; i < n ; i++ )
+	{
+		if( mask == nullptr || mask[i] == 0 )
+			data[p[i]*L]++ ;
+	}
+}
+
+void Gr::Histogram::totals( sum_type * out ) const
+{
+	for( unsigned int i = 0U ; i < N ; i++ )
+	{
+		out[i] = 0 ;
+		for( unsigned int lane = 0U ; lane < L ; lane++ )
+			out[i] += m_data[i*L+lane] ;
+	}
+}
+
+void Gr::Histogram::compute()
+{
+	G_ASSERT( active() ) ;
+	sum_type data[N] ;
+	totals( data ) ;
+
+	// find the cumulative count of the darkest pixel value and the total
+	sum_type min = 0 ;
+	sum_type total = 0 ;
+	for( unsigned int i = 0U ; i < N ; i++ )
+	{
+		total += data[i] ;
+		if( min == 0 )
+			min = total ;
+	}
+
+	// map the cumulative distribution onto the full range
+	if( total == min )
+	{
+		for( unsigned int i = 0U ; i < N ; i++ )
+			m_map[i] = static_cast<value_type>(i) ;
+		return ;
+	}
+	const sum_type divisor = total - min ;
+	sum_type n = 0 ;
+	for( unsigned int i = 0U ; i < N ; i++ )
+	{
+		n += data[i] ;
+		m_map[i] = n < min ? 0 : static_cast<value_type>( ( ( n - min ) * ( N - 1 ) ) / divisor ) ;
+	}
+}
+
+unsigned int Gr::Histogram::distance( const Histogram & other ) const
+{
+	G_ASSERT( active() && other.active() ) ;
+	sum_type data[N] ;
+	sum_type other_data[N] ;
+	totals( data ) ;
+	other.totals( other_data ) ;
+
+	sum_type total = 0 ;
+	sum_type other_total = 0 ;
+	for( unsigned int i = 0U ; i < N ; i++ )
+	{
+		total += data[i] ;
+		other_total += other_data[i] ;
+	}
+	if( total == 0 || other_total == 0 )
+		return total == other_total ? 0U : (N-1U) ;
+
+	double d_max = 0.0 ;
+	sum_type n = 0 ;
+	sum_type other_n = 0 ;
+	for( unsigned int i = 0U ; i < N ; i++ )
+	{
+		n += data[i] ;
+		other_n += other_data[i] ;
+		const double d = std::fabs( double(n)/double(total) - double(other_n)/double(other_total) ) ;
+		d_max = std::max( d_max , d ) ;
+	}
+	return static_cast<unsigned int>( d_max * (N-1U) + 0.5 ) ;
+}
+
+/// \file grhistogram.cpp
@@ -24,7 +24,6 @@
 #include "gdef.h"
 #include "gstaticassert.h"
 #include <vector>
-#include <algorithm>
 
 namespace Gr
 {
@@ -38,6 +37,13 @@ namespace Gr
 /// map of pixel values rather than just the pixel values that appear 
 /// in the image.
 /// 
+/// The pixel counts are retained after the map is compute()d so that
+/// the distance() between two histograms can be used to decide whether
+/// a previously-computed map is still good enough.
+/// 
+/// The counts are held in several interleaved sub-histograms so that
+/// runs of identical pixel values do not serialise on one counter.
+/// 
 class Gr::Histogram
 {
 public:
@@ -54,12 +60,22 @@ public:
 		///< Constructor, optionally for an unusable, zero-cost object.
 
 	void clear() ;
-		///< Clears the map.
+		///< Clears the pixel counts.
 
 	void add( value_type ) ;
 		///< Adds a pixel to the histogram.
 		///< Precondition: active()
 
+	void add( const value_type * p , size_t n , const unsigned char * mask ) ;
+		///< Adds a row of pixels to the histogram, ignoring those with
+		///< a non-zero mask value. The mask pointer can be null. 
+		///< Precondition: active()
+
+	void add( const Histogram & ) ;
+		///< Adds in the pixel counts from another histogram, so
+		///< that partial histograms can be merged.
+		///< Precondition: active()
+
 	void compute() ;
 		///< Computes the equalisation map once all the pixels
 		///< have been add()ed.
@@ -67,42 +83,34 @@ public:
 	value_type map( value_type ) const ;
 		///< Does the equalisation mapping.
 
+	const value_type * lut() const ;
+		///< Returns the equalisation map as an N-entry lookup table.
+		///< Precondition: active()
+
+	unsigned int distance( const Histogram & other ) const ;
+		///< Returns the largest difference between the two cumulative
+		///< distributions, scaled to the range 0..255. This is roughly 
+		///< the largest change in map() that would result from using
+		///< the other histogram instead.
+
 	bool active() const ;
 		///< Returns true if constructed as active.
 
 private:
+	enum { L = 4 } ; // number of sub-histograms
+	G_STATIC_ASSERT( L == 4 ) ; // add() is unrolled to match
 	typedef std::vector<sum_type> Vector ;
-	Vector m_data ;
+	void totals( sum_type * ) const ;
 
 private:
-	template <typename TValue,typename TSum>
-	struct Accumulator
-	{
-		typedef TValue value_type ;
-		typedef TSum sum_type ;
-		sum_type & n ;
-		Accumulator( sum_type & n_ ) : n(n_) {}
-		void operator()( sum_type & v ) { n += v ; v = n ; }
-	} ;
-	template <typename TValue,typename TSum>
-	struct Scaler
-	{
-		typedef TValue value_type ;
-		typedef TSum sum_type ;
-		sum_type min ;
-		sum_type divisor ;
-		Scaler( value_type min_ , sum_type total_ ) : min(min_) , divisor(total_-min_) {}
-		void operator()( sum_type & v ) 
-		{ 
-			const sum_type n = ( v - min ) * ( N - 1 ) ;
-			v = (value_type)( n / divisor ) ;
-		}
-	} ;
+	Vector m_data ; // L interleaved sub-histograms
+	std::vector<value_type> m_map ;
 } ;
 
 inline
 Gr::Histogram::Histogram() :
-	m_data(N)
+	m_data(N*L) ,
+	m_map(N)
 {
 }
 
@@ -110,36 +118,44 @@ inline
 Gr::Histogram::Histogram( bool active )
 {
 	if( active )
-		m_data.resize( N ) ;
+	{
+		m_data.resize( N*L ) ;
+		m_map.resize( N ) ;
+	}
 }
 
 inline
 void Gr::Histogram::add( value_type n )
 {
-	m_data[n]++ ;
+	m_data[n*L]++ ;
 }
 
 inline
-void Gr::Histogram::clear()
+void Gr::Histogram::add( const Histogram & other )
 {
-	m_data.assign( N , 0 ) ;
+	if( other.active() )
+	{
+		for( Vector::size_type i = 0U ; i < m_data.size() ; i++ )
+			m_data[i] += other.m_data[i] ;
+	}
 }
 
 inline
-void Gr::Histogram::compute()
+void Gr::Histogram::clear()
 {
-	const Vector::iterator end = m_data.end() ;
-	Vector::iterator min_p = std::find_if( m_data.begin() , end , std::bind2nd(std::not_equal_to<value_type>(),0) ) ;
-	if( min_p == end ) return ;
-	sum_type n = 0 ;
-	std::for_each( m_data.begin() , end , Accumulator<value_type,sum_type>(n) ) ;
-	std::for_each( m_data.begin() , end , Scaler<value_type,sum_type>(*min_p,m_data.back()) ) ;
+	m_data.assign( N*L , 0 ) ;
 }
 
 inline
 Gr::Histogram::value_type Gr::Histogram::map( value_type n ) const
 {
-	return m_data[n] ;
+	return m_map[n] ;
+}
+
+inline
+const Gr::Histogram::value_type * Gr::Histogram::lut() const
+{
+	return &m_map[0] ;
 }
 
 inline
@@ -21,7 +21,9 @@
 #include "gdef.h"
 #include "grdef.h"
 #include "grimage.h"
+#include "grimagepool.h"
 #include "grpnm.h"
+#include "gravc.h"
 #include "glimits.h"
 #include "ghexdump.h"
 #include "gdebug.h"
@@ -57,7 +59,7 @@ Gr::ImageBuffer * Gr::Image::blank( Image & image , ImageType type , bool contig
 	if( !type.isRaw() )
 		throw std::runtime_error( "invalid type for blank image" ) ;
 
-	shared_ptr<ImageBuffer> ptr = image.recycle() ;
+	shared_ptr<ImageBuffer> ptr = image.recycle( type.size() ) ;
 
 	if( contiguous )
 	{
@@ -66,11 +68,7 @@ Gr::ImageBuffer * Gr::Image::blank( Image & image , ImageType type , bool contig
 	}
 	else
 	{
-		size_t rowsize = type.rowsize() ;
-		const int dy = type.dy() ;
-		ptr->resize( dy ) ;
-		for( int y = 0 ; y < dy ; y++ )
-			ptr->at(y).resize( rowsize ) ;
+		imagebuffer::resize( *ptr , type.dx() , type.dy() , type.channels() ) ;
 	}
 
 	image = Image( ptr , type ) ;
@@ -114,12 +112,12 @@ const Gr::ImageBuffer & Gr::Image::data() const
 	return *m_ptr ;
 }
 
-shared_ptr<Gr::ImageBuffer> Gr::Image::recycle()
+shared_ptr<Gr::ImageBuffer> Gr::Image::recycle( size_t size_hint )
 {
 	if( m_ptr.get() != nullptr && m_ptr.unique() )
 		return const_pointer_cast<ImageBuffer>(m_ptr) ;
 	else
-		return shared_ptr<ImageBuffer>( new ImageBuffer ) ;
+		return ImagePool::get( size_hint , m_ptr.get() ) ;
 }
 
 void Gr::Image::read( std::istream & in , Image & image , const std::string & help_text )
@@ -164,18 +162,152 @@ bool Gr::Image::peek( G::PublisherSubscription & channel , Image & image , std::
 
 bool Gr::Image::receiveImp( bool peek , G::PublisherSubscription & channel , Image & image , std::string & type_str )
 {
+	// copy straight out of the channel's shared memory into the image 
+	// buffer, peeking again if the publisher overwrites the data while 
+	// it is being copied
+	G::PublisherView view ;
+	bool ok = peek ? channel.peek(view) : channel.borrow(view) ;
+	for( int retry = 0 ; ok && !view.empty() && retry < 10 ; retry++ )
+	{
+		type_str = view.type() ;
+		if( copy( view , image , type(view.header(),type_str) ) )
+			return true ;
+		ok = channel.peek( view ) ;
+	}
+	if( !ok )
+		return false ;
+
+	// ignorable event or repeated overwrites
 	shared_ptr<ImageBuffer> ptr = image.recycle() ;
-	ptr->resize( 1U ) ;
-	std::vector<char> & buffer = ptr->at(0) ;
+	ptr->clear() ;
+	type_str.clear() ;
+	image = Image( ptr , ImageType() ) ;
+	return true ;
+}
 
-	bool ok = peek ? channel.peek(buffer,&type_str) : channel.receive(buffer,&type_str) ;
-	if( !ok )
+bool Gr::Image::borrow( G::PublisherSubscription & channel , G::PublisherView & view , ImageType & type )
+{
+	if( !channel.borrow(view) )
 		return false ;
 
-	ImageType image_type( type_str ) ;
-	image = Image( ptr , image_type ) ; // even if !image_type.valid()
+	type = view.empty() ? ImageType() : Image::type( view.header() , view.type() ) ;
+	return true ;
+}
+
+Gr::ImageType Gr::Image::type( const G::PublisherHeader & header , const std::string & type_str )
+{
+	if( header.m_format != 0U )
+		return ImageType::fromId( header.m_format , header.m_dx , header.m_dy , header.m_channels ) ;
+	else
+		return ImageType( type_str ) ;
+}
+
+G::PublisherHeader Gr::Image::header( ImageType type , G::EpochTime capture_time , const char * p , size_t n )
+{
+	G::PublisherHeader header ;
+	if( type.valid() )
+	{
+		header.m_format = type.id() ;
+		header.m_dx = type.dx() ;
+		header.m_dy = type.dy() ;
+		header.m_channels = type.channels() ;
+		if( !type.isAvc() || ( p != nullptr && Avc::ByteStream::keyframe( p , n ) ) )
+			header.m_flags |= G::PublisherHeader::f_keyframe ;
+	}
+	header.m_time_s = capture_time.s ;
+	header.m_time_us = capture_time.us ;
+	return header ;
+}
+
+void Gr::Image::add( G::PublisherHeader & header , size_t offset , Image image )
+{
+	if( header.m_representations < G::PublisherHeader::REPRESENTATIONS && image.valid() )
+	{
+		if( header.m_size == 0U || offset < header.m_size )
+			header.m_size = offset ;
+
+		G::PublisherHeader::Representation & r = header.m_representation[header.m_representations++] ;
+		r.m_format = image.type().id() ;
+		r.m_dx = image.type().dx() ;
+		r.m_dy = image.type().dy() ;
+		r.m_channels = image.type().channels() ;
+		r.m_offset = offset ;
+		r.m_size = image.size() ;
+	}
+}
+
+bool Gr::Image::copy( const G::PublisherView & view , Image & image , ImageType type )
+{
+	Part part = { type , view.data() , primarySize(view.header(),view.size()) , 1 } ;
+	return copy( view , part , image ) ;
+}
 
+bool Gr::Image::copy( const G::PublisherView & view , const Part & part , Image & image )
+{
+	shared_ptr<ImageBuffer> ptr = image.recycle( part.n ) ;
+	ptr->resize( 1U ) ;
+	ptr->at(0).assign( part.p , part.p + part.n ) ;
+	if( !view.valid() )
+	{
+		image.clear() ;
+		return false ;
+	}
+	image = Image( ptr , part.type ) ;
 	return true ;
 }
 
+Gr::Image::Part Gr::Image::select( const G::PublisherView & view , ImageType type , bool jpeg_out , int scale , bool monochrome )
+{
+	scale = std::max( 1 , scale ) ;
+	Part result = { type , view.data() , primarySize(view.header(),view.size()) , scale } ;
+	const G::PublisherHeader & header = view.header() ;
+	size_t best = 0U ;
+	for( size_t i = 0U ; type.valid() && i < header.m_representations && i < G::PublisherHeader::REPRESENTATIONS ; i++ )
+	{
+		const G::PublisherHeader::Representation & r = header.m_representation[i] ;
+		ImageType r_type = ImageType::fromId( r.m_format , r.m_dx , r.m_dy , r.m_channels ) ;
+		if( !r_type.valid() || r.m_size == 0U || r.m_offset > view.size() || r.m_size > (view.size()-r.m_offset) )
+			continue ;
+
+		// must be a reduction of the primary by a factor of the required reduction
+		const int factor = type.dx() / r_type.dx() ;
+		if( factor < 1 || (scale % factor) != 0 || 
+			scaled(type.dx(),factor) != r_type.dx() || scaled(type.dy(),factor) != r_type.dy() )
+				continue ;
+
+		// must have enough colour
+		if( !monochrome && r_type.channels() != type.channels() )
+			continue ;
+
+		if( jpeg_out )
+		{
+			// jpeg encoding is expensive so only take an exact match
+			if( !r_type.isJpeg() || factor != scale || r_type.channels() != (monochrome?1:type.channels()) )
+				continue ;
+		}
+		else
+		{
+			// prefer the smallest raw representation, or a smaller jpeg than the primary
+			if( !r_type.isRaw() && !( r_type.isJpeg() && type.isJpeg() ) )
+				continue ;
+			if( result.p != view.data() && result.type.isRaw() && !r_type.isRaw() )
+				continue ;
+			if( result.p != view.data() && result.type.isRaw() == r_type.isRaw() && r.m_size >= best )
+				continue ;
+		}
+
+		result.type = r_type ;
+		result.p = view.data() + r.m_offset ;
+		result.n = r.m_size ;
+		result.scale = scale / factor ;
+		best = r.m_size ;
+	}
+	return result ;
+}
+
+size_t Gr::Image::primarySize( const G::PublisherHeader & header , size_t n )
+{
+	return ( header.m_size != 0U && header.m_size < n ) ? header.m_size : n ;
+}
+
 /// \file grimage.cpp
@@ -42,6 +42,13 @@ class Gr::Image
 {
 public:
 	G_EXCEPTION( ReadError , "cannot read image" ) ;
+	struct Part /// One representation of an image within a borrowed publication. See Gr::Image::select().
+	{
+		ImageType type ;
+		const char * p ;
+		size_t n ;
+		int scale ; // remaining reduction factor
+	} ;
 
 	Image() ;
 		///< Default constructor for an empty() image with an in-valid() 
@@ -72,12 +79,14 @@ public:
 	size_t size() const ; 
 		///< Returns the image data total size.
 
-	shared_ptr<ImageBuffer> recycle() ;
-		///< Creates a new shared pointer that can be deposited into a new Image,
-		///< but if the current Image is not empty() and not shared (unique()) then 
-		///< its buffer is returned instead. This can avoid memory allocation when 
-		///< processing a sequence of images all of the same size, while still 
-		///< allowing slow code to take copies.
+	shared_ptr<ImageBuffer> recycle( size_t size_hint = 0U ) ;
+		///< Returns a shared pointer that can be deposited into a new Image.
+		///< If the current Image is not empty() and its buffer is not shared
+		///< then that buffer is returned, otherwise a free buffer is taken
+		///< from the Gr::ImagePool, preferably one that suits the size hint.
+		///< This avoids memory allocation when processing a sequence of 
+		///< images all of the same size, while still allowing slow code 
+		///< to take copies.
 		///< \code
 		///<
 		///< Image ImageFactory::newImage( Image & old_image ) {
@@ -101,11 +110,50 @@ public:
 		///< Reads a publication channel into an image. If a non-image is received 
 		///< then the non-image type will be deposited in the supplied string
 		///< and the Image type() will be invalid(). Returns false iff the channel
-		///< receive fails.
+		///< receive fails. The image type is taken from the publication's binary 
+		///< header if the publisher supplied one, so the type string is only
+		///< parsed as a fallback.
 
 	static bool peek( G::PublisherSubscription & channel , Image & , std::string & type_str ) ;
 		///< A variant on receive() that does a channel peek().
 
+	static bool borrow( G::PublisherSubscription & channel , G::PublisherView & , ImageType & ) ;
+		///< A zero-copy variant on receive() that leaves the image data in the 
+		///< channel's shared memory. The image type comes from the view's
+		///< header or type string, and will be invalid() for non-images. 
+		///< Returns false iff the channel receive fails. See G::PublisherView.
+
+	static bool copy( const G::PublisherView & , Image & , ImageType ) ;
+		///< Copies borrowed data into an image, recycle()ing the image buffer.
+		///< Only the primary representation is copied. Returns false, with 
+		///< an empty() image, if the view has become invalid during the copy.
+
+	static bool copy( const G::PublisherView & , const Part & , Image & ) ;
+		///< Copies one representation of borrowed data into an image.
+
+	static Part select( const G::PublisherView & , ImageType , bool jpeg_out , int scale , bool monochrome_out ) ;
+		///< Selects the cheapest representation within a borrowed publication 
+		///< from which to make a raw or jpeg image with the given reduction 
+		///< factor and monochrome-ness. The primary representation, with the
+		///< given image type, is returned if there is nothing better. 
+		///< Alternative raw representations are preferred for raw output, and
+		///< only exact matches are used for jpeg output.
+
+	static ImageType type( const G::PublisherHeader & , const std::string & type_str ) ;
+		///< Returns the image type described by a publication header, or by 
+		///< the type string if the header has no format.
+
+	static G::PublisherHeader header( ImageType , G::EpochTime capture_time = G::EpochTime(0) ,
+		const char * p = nullptr , size_t n = 0U ) ;
+			///< Returns a publication header describing the given image type.
+			///< Still images are flagged as key frames, but H.264 pictures
+			///< only if the given image data starts with an IDR picture.
+
+	static void add( G::PublisherHeader & , size_t offset , Image ) ;
+		///< Adds an alternative representation to a publication header. The
+		///< image data should be published at the given offset, after the 
+		///< primary representation.
+
 	static ImageBuffer * blank( Image & , ImageType raw_type , bool contiguous = false ) ;
 		///< Factory function for a not-really-blank raw image that is temporarily writable 
 		///< via the returned image buffer pointer. The implementation recycle()s the 
@@ -115,6 +163,7 @@ public:
 
 private:
 	static bool receiveImp( bool , G::PublisherSubscription & , Image & , std::string & ) ;
+	static size_t primarySize( const G::PublisherHeader & , size_t ) ;
 
 private:
 	shared_ptr<const ImageBuffer> m_ptr ;
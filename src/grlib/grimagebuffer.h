@@ -23,6 +23,9 @@
 
 #include "gdef.h"
 #include "grvectors.h"
+#include "grslab.h"
+#include <utility>
+#include <vector>
 
 namespace Gr
 {
@@ -39,12 +42,41 @@ namespace Gr
 	/// namespace is used to define associated streambuf and iterator types.
 	/// Standard streaming operators are also defined.
 	/// 
-	/// The current definition is a vector-of-vectors, but a vector of malloced
-	/// buffers might be a good alternative. Classes affected by the choice of
-	/// image buffer type include Gr::ImageData, GNet::SocketProtocol,
-	/// G::Publisher and G::FatPipe.
+	/// The current definition is Gr::Slab, which keeps all the rows in one
+	/// aligned and pooled block of memory. The original vector-of-vectors 
+	/// (Gr::Vectors) is still available as an alternative. Classes affected 
+	/// by the choice of image buffer type include Gr::ImageData, and the 
+	/// users of imagebuffer::segments() that pass image data on to 
+	/// GNet::SocketProtocol, G::Publisher and G::FatPipe.
 	/// 
-	typedef Vectors ImageBuffer ;
+	typedef Slab ImageBuffer ;
+
+	namespace imagebuffer
+	{
+		template <typename T>
+		void segments( const T & image_buffer , std::vector<std::pair<const char*,size_t> > & out ) ;
+			///< Appends to the given scatter-gather list so that it refers to the 
+			///< data in the image buffer, with adjacent rows coalesced so that a 
+			///< contiguous image buffer yields a single segment.
+	}
+}
+
+template <typename T>
+void Gr::imagebuffer::segments( const T & image_buffer , std::vector<std::pair<const char*,size_t> > & out )
+{
+	typedef typename traits::imagebuffer<T>::const_row_iterator row_iterator ;
+	row_iterator const end = row_end( image_buffer ) ;
+	for( row_iterator row_p = row_begin(image_buffer) ; row_p != end ; ++row_p )
+	{
+		const size_t n = row_size( row_p ) ;
+		if( n == 0U )
+			continue ;
+		const char * p = row_ptr( row_p ) ;
+		if( !out.empty() && (out.back().first+out.back().second) == p )
+			out.back().second += n ;
+		else
+			out.push_back( std::make_pair(p,n) ) ;
+	}
 }
 
 #endif
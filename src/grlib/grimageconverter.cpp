@@ -68,6 +68,44 @@ bool Gr::ImageConverter::toRawImp( Image image_in , Image & image_out , int scal
 	}
 }
 
+bool Gr::ImageConverter::toRaw( const char * p , size_t n , ImageType type_in , Image & image_out , int scale , bool monochrome_out )
+{
+	scale = std::max( 1 , scale ) ;
+	if( p != nullptr && n != 0U && convertible(type_in) )
+	{
+		ImageType type_out = ImageType::raw( type_in , scale , monochrome_out ) ;
+		ImageBuffer * image_out_p = Gr::Image::blank( image_out , type_out , false ) ;
+		ImageData image_data_out( *image_out_p , type_out.dx() , type_out.dy() , type_out.channels() ) ;
+		m_decoder.setup( scale , monochrome_out ) ;
+		m_decoder.decode( type_in , p , n , image_data_out ) ;
+		return image_out.valid() ;
+	}
+	else
+	{
+		G_DEBUG( "Gr::ImageConverter::toRaw: invalid input image type: " << type_in ) ;
+		return false ;
+	}
+}
+
+bool Gr::ImageConverter::toRaw( const ImageBuffer & buffer , ImageType type_in , Image & image_out , int scale , bool monochrome_out )
+{
+	scale = std::max( 1 , scale ) ;
+	if( imagebuffer::size_of(buffer) != 0U && convertible(type_in) )
+	{
+		ImageType type_out = ImageType::raw( type_in , scale , monochrome_out ) ;
+		ImageBuffer * image_out_p = Gr::Image::blank( image_out , type_out , false ) ;
+		ImageData image_data_out( *image_out_p , type_out.dx() , type_out.dy() , type_out.channels() ) ;
+		m_decoder.setup( scale , monochrome_out ) ;
+		m_decoder.decode( type_in , buffer , image_data_out ) ;
+		return image_out.valid() ;
+	}
+	else
+	{
+		G_DEBUG( "Gr::ImageConverter::toRaw: invalid input image type: " << type_in ) ;
+		return false ;
+	}
+}
+
 bool Gr::ImageConverter::toJpeg( Image image_in , Image & image_out , int scale , bool monochrome_out )
 {
 	return toJpegImp( image_in , image_out , std::max(1,scale) , monochrome_out ) ;
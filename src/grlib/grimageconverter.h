@@ -49,6 +49,14 @@ public:
 	bool toRaw( Image image_in , Image & image_out , int scale = 1 , bool monochrome_out = false ) ;
 		///< Converts the image to raw format. Returns a false on error.
 
+	bool toRaw( const char * p , size_t n , ImageType type_in , Image & image_out , int scale = 1 , bool monochrome_out = false ) ;
+		///< An overload that decodes directly from a memory buffer, such 
+		///< as a borrowed G::PublisherView, without an intermediate copy.
+
+	bool toRaw( const ImageBuffer & , ImageType type_in , Image & image_out , int scale = 1 , bool monochrome_out = false ) ;
+		///< An overload that decodes directly from an image buffer that
+		///< is not held by a Gr::Image.
+
 	bool toJpeg( Image image_in , Image & image_out , int scale = 1 , bool monochrome_out = false ) ;
 		///< Converts the image to jpeg format. Returns false on error.
 
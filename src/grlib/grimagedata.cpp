@@ -21,6 +21,7 @@
 #include "gdef.h"
 #include "grdef.h"
 #include "grimagedata.h"
+#include "grareascaler.h"
 #include "grcolourspace.h"
 #include "grglyph.h"
 #include "gtest.h"
@@ -106,13 +107,7 @@ void Gr::ImageData::resize( int dx , int dy , int channels )
 	else
 	{
 		m_data.clear() ;
-		m_data.reserve( m_dy ) ;
-		const size_t rowsize = sizet(m_dx,m_channels) ;
-		for( int y = 0 ; y < m_dy ; y++ )
-		{
-			m_data.push_back( std::vector<char>() ) ; // ie. emplace_back(rowsize)
-			m_data.back().resize( rowsize ) ;
-		}
+		imagebuffer::resize( m_data , m_dx , m_dy , m_channels ) ; // aligned rows in one block
 	}
 	m_rows_set = false ;
 	G_ASSERT( valid() ) ;
@@ -169,32 +164,21 @@ void Gr::ImageData::scale( int scale_in , bool monochrome_out , bool use_colours
 	if( scale_in == 1 && (monochrome_out?1:m_channels) == m_channels ) return ;
 	if( m_data.empty() ) throw Error( "empty" ) ;
 
-	int x_new = 0 ;
+	// area-average each block of input rows as it completes, writing the 
+	// output rows over the input rows that have already been consumed
+	AreaScaler scaler( m_dx , m_dy , m_channels , scale_in , monochrome_out , use_colourspace ) ;
+	const size_t drow_out = sizet( scaler.dx() , scaler.channels() ) ;
 	int y_new = 0 ;
-	unsigned char * p_out = storerow( 0 ) ;
-	const size_t dp = sizet( m_channels , scale_in ) ;
-	for( int y = 0 ; y < m_dy ; y += scale_in , y_new++ )
+	for( int y = 0 ; y < m_dy ; y++ )
 	{
-		const unsigned char * p_in = row( y ) ;
-		if( m_data.size() > 1U ) p_out = row( y_new ) ;
-		for( int x = x_new = 0 ; x < m_dx ; x += scale_in , p_in += dp , x_new++ )
+		scaler.add( row(y) ) ;
+		if( scaler.ready() )
 		{
-			if( monochrome_out && m_channels == 3 && use_colourspace )
-			{
-				*p_out++ = Gr::ColourSpace::y_int( p_in[0] , p_in[1] , p_in[2] ) ;
-			}
-			else if( monochrome_out || m_channels == 1 )
-			{
-				*p_out++ = p_in[0] ;
-			}
-			else
-			{
-				*p_out++ = p_in[0] ;
-				*p_out++ = p_in[1] ;
-				*p_out++ = p_in[2] ;
-			}
+			scaler.emit( contiguous() ? (storerow(0)+sizet(y_new)*drow_out) : storerow(y_new) ) ;
+			y_new++ ;
 		}
 	}
+	const int x_new = scaler.dx() ;
 	G_ASSERT( x_new == scaled(m_dx,scale_in) ) ;
 	G_ASSERT( y_new == scaled(m_dy,scale_in) ) ;
 	m_dx = x_new ;
@@ -333,11 +317,25 @@ void Gr::ImageData::copyIn( const char * data_in , size_t size_in , int dx_in ,
 	if( size_in != sizet(dx_in,dy_in,channels_in) || scaled(dx_in,scale) != m_dx || scaled(dy_in,scale) != m_dy )
 		throw Error( "copy-in size mismatch" ) ;
 
-	const size_t drow_in = sizet( dx_in , channels_in , scale ) ;
 	const unsigned char * p_in = reinterpret_cast<const unsigned char*>(data_in) ;
-	for( int y = 0 ; y < m_dy ; y++ , p_in += drow_in )
+	if( scale > 1 && m_channels <= channels_in )
+	{
+		const size_t drow_in = sizet( dx_in , channels_in ) ;
+		AreaScaler scaler( dx_in , dy_in , channels_in , scale , m_channels == 1 , use_colourspace ) ;
+		for( int y_in = 0 , y_out = 0 ; y_in < dy_in ; y_in++ , p_in += drow_in )
+		{
+			scaler.add( p_in ) ;
+			if( scaler.ready() )
+				scaler.emit( row(y_out++) ) ;
+		}
+	}
+	else
 	{
-		copyRowInImp( row(y) , p_in , channels_in , use_colourspace , scale ) ;
+		const size_t drow_in = sizet( dx_in , channels_in , scale ) ;
+		for( int y = 0 ; y < m_dy ; y++ , p_in += drow_in )
+		{
+			copyRowInImp( row(y) , p_in , channels_in , use_colourspace , scale ) ;
+		}
 	}
 }
 
@@ -357,7 +355,21 @@ void Gr::ImageData::copyIn( const ImageBuffer & data_in , int dx_in , int dy_in
 	if( scaled(dx_in,scale) != m_dx || scaled(dy_in,scale) != m_dy )
 		throw Error( "copy-in size mismatch" ) ;
 
-	if( data_in.size() == 1U ) // contiguous
+	if( scale > 1 && m_channels <= channels_in )
+	{
+		const size_t drow_in = sizet( dx_in , channels_in ) ;
+		AreaScaler scaler( dx_in , dy_in , channels_in , scale , m_channels == 1 , use_colourspace ) ;
+		for( int y_in = 0 , y_out = 0 ; y_in < dy_in ; y_in++ )
+		{
+			const unsigned char * row_in = data_in.size() == 1U ?
+				( reinterpret_cast<const unsigned char*>(&(data_in.at(0))[0]) + sizet(y_in) * drow_in ) :
+				reinterpret_cast<const unsigned char*>(&(data_in.at(y_in))[0]) ;
+			scaler.add( row_in ) ;
+			if( scaler.ready() )
+				scaler.emit( row(y_out++) ) ;
+		}
+	}
+	else if( data_in.size() == 1U ) // contiguous
 	{
 		const size_t drow_in = sizet(scale,dx_in,channels_in) ;
 		const unsigned char * row_in = reinterpret_cast<const unsigned char*>(&(data_in.at(0))[0]) ;
@@ -26,6 +26,7 @@
 #include "grjpeg.h"
 #include "grpng.h"
 #include "grpnm.h"
+#include "grareascaler.h"
 #include "grcolourspace.h"
 #include "glog.h"
 #include "gassert.h"
@@ -37,6 +38,24 @@ namespace
 	{
 		return Gr::ImageType::raw( image_data.dx() , image_data.dy() , image_data.channels() ) ;
 	}
+
+	void scaleInPlace( char * p , const Gr::ImageType & type_in , int scale , bool monochrome_out )
+	{
+		Gr::AreaScaler scaler( type_in.dx() , type_in.dy() , type_in.channels() , scale , monochrome_out ) ;
+		const size_t drow_in = Gr::sizet( type_in.dx() , type_in.channels() ) ;
+		const size_t drow_out = Gr::sizet( scaler.dx() , scaler.channels() ) ;
+		const unsigned char * p_in = reinterpret_cast<unsigned char*>(p) ;
+		unsigned char * p_out = reinterpret_cast<unsigned char*>(p) ;
+		for( int y = 0 ; y < type_in.dy() ; y++ , p_in += drow_in )
+		{
+			scaler.add( p_in ) ;
+			if( scaler.ready() )
+			{
+				scaler.emit( p_out ) ;
+				p_out += drow_out ;
+			}
+		}
+	}
 }
 
 // ==
@@ -220,26 +239,12 @@ Gr::ImageType Gr::ImageDecoder::decodeInPlace( ImageType type_in , char * & p ,
 	{
 		// strip the header
 		type_out = ImageType::raw( type_in , m_scale , m_monochrome_out ) ;
-		if( size_in <= pnm_info.offset() || (size_in-pnm_info.offset()) != type_out.size() ) 
+		if( size_in <= pnm_info.offset() || (size_in-pnm_info.offset()) != type_in.size() ) 
 			throw Error( "invalid pnm size" ) ;
 		std::memmove( p , p+pnm_info.offset() , size_in-pnm_info.offset() ) ;
 
 		// treat as raw
-		unsigned char * p_out = reinterpret_cast<unsigned char*>(p) ;
-		const unsigned char * p_in = p_out ;
-		size_t dp_in = sizet( m_scale , type_in.channels() ) ;
-		for( int y = 0 ; y < type_in.dy() ; y += m_scale )
-		{
-			for( int x = 0 ; x < type_in.dx() ; x += m_scale , p += dp_in )
-			{
-				if( m_monochrome_out && type_in.channels() == 3 )
-					*p_out++ = Gr::ColourSpace::y_int( p_in[0] , p_in[1] , p_in[2] ) ;
-				else if( m_monochrome_out )
-					*p_out++ = *p_in ;
-				else
-					{ *p_out++ = p_in[0] ; *p_out++ = p_in[1] ; *p_out++ = p_in[2] ; }
-			}
-		}
+		scaleInPlace( p , type_in , m_scale , m_monochrome_out ) ;
 	}
 	else if( type_in.isPnm() && pnm_info.binary8() )
 	{
@@ -259,21 +264,7 @@ Gr::ImageType Gr::ImageDecoder::decodeInPlace( ImageType type_in , char * & p ,
 	else if( type_in.isRaw() && (m_scale > 1 || type_in.channels() != (m_monochrome_out?1:type_in.channels()) ) )
 	{
 		type_out = ImageType::raw( type_in , m_scale , m_monochrome_out ) ;
-		unsigned char * p_out = reinterpret_cast<unsigned char*>(p) ;
-		const unsigned char * p_in = p_out ;
-		size_t dp_in = sizet( m_scale , type_in.channels() ) ;
-		for( int y = 0 ; y < type_in.dy() ; y += m_scale )
-		{
-			for( int x = 0 ; x < type_in.dx() ; x += m_scale , p += dp_in )
-			{
-				if( m_monochrome_out && type_in.channels() == 3 )
-					*p_out++ = Gr::ColourSpace::y_int( p_in[0] , p_in[1] , p_in[2] ) ;
-				else if( m_monochrome_out )
-					*p_out++ = *p_in ;
-				else
-					{ *p_out++ = p_in[0] ; *p_out++ = p_in[1] ; *p_out++ = p_in[2] ; }
-			}
-		}
+		scaleInPlace( p , type_in , m_scale , m_monochrome_out ) ;
 	}
 	else if( type_in.isRaw() )
 	{
@@ -0,0 +1,111 @@
+//
+// Copyright (C) 2017 Graeme Walker
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// grimagepool.cpp
+//
+
+#include "gdef.h"
+#include "grimagepool.h"
+#include "glog.h"
+#include "gdebug.h"
+#include <vector>
+
+namespace
+{
+	struct PoolState
+	{
+		enum { max_buffers = 32 } ;
+		enum { log_interval = 1000 } ;
+		PoolState() : hits(0U) , misses(0U) {}
+		G::threading::mutex_type mutex ;
+		std::vector<shared_ptr<Gr::ImageBuffer> > buffers ;
+		size_t hits ;
+		size_t misses ;
+	} ;
+
+	PoolState & state()
+	{
+		static PoolState s ;
+		return s ;
+	}
+
+	bool same_class( size_t capacity , size_t size_hint )
+	{
+		return capacity >= size_hint && capacity <= (size_hint*2U) ;
+	}
+}
+
+shared_ptr<Gr::ImageBuffer> Gr::ImagePool::get( size_t size_hint , const ImageBuffer * current )
+{
+	PoolState & s = state() ;
+	G::threading::lock_type lock( s.mutex ) ;
+
+	// a buffer is free if the pool holds the only reference, or if it 
+	// is the caller's current buffer and only the caller and the pool 
+	// hold references -- no-one else can take a new reference without 
+	// going through the pool, so these counts are stable
+	typedef std::vector<shared_ptr<ImageBuffer> >::iterator iterator ;
+	iterator best = s.buffers.end() ;
+	for( iterator p = s.buffers.begin() ; p != s.buffers.end() ; ++p )
+	{
+		if( current != nullptr && (*p).get() == current && (*p).use_count() == 2 )
+		{
+			best = p ;
+			break ;
+		}
+		if( (*p).use_count() != 1 )
+			continue ;
+
+		if( best == s.buffers.end() )
+			best = p ;
+		else if( size_hint != 0U && same_class((*p)->capacity(),size_hint) && !same_class((*best)->capacity(),size_hint) )
+			best = p ;
+		else if( size_hint != 0U && !same_class((*best)->capacity(),size_hint) && (*p)->capacity() > (*best)->capacity() )
+			best = p ;
+	}
+
+	shared_ptr<ImageBuffer> result ;
+	if( best != s.buffers.end() )
+	{
+		s.hits++ ;
+		result = *best ;
+	}
+	else
+	{
+		s.misses++ ;
+		result.reset( new ImageBuffer ) ;
+		if( s.buffers.size() < PoolState::max_buffers )
+			s.buffers.push_back( result ) ;
+		G_DEBUG( "Gr::ImagePool::get: new image buffer: pool size " << s.buffers.size() ) ;
+	}
+
+	if( ( (s.hits+s.misses) % PoolState::log_interval ) == 0U )
+		G_LOG( "Gr::ImagePool::get: image buffer pool: hits=" << s.hits << " misses=" << s.misses << " buffers=" << s.buffers.size() ) ;
+
+	return result ;
+}
+
+void Gr::ImagePool::counters( size_t & hits , size_t & misses , size_t & buffers )
+{
+	PoolState & s = state() ;
+	G::threading::lock_type lock( s.mutex ) ;
+	hits = s.hits ;
+	misses = s.misses ;
+	buffers = s.buffers.size() ;
+}
+
+/// \file grimagepool.cpp
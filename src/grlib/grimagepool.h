@@ -0,0 +1,65 @@
+//
+// Copyright (C) 2017 Graeme Walker
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file grimagepool.h
+///
+
+#ifndef GR_IMAGE_POOL__H
+#define GR_IMAGE_POOL__H
+
+#include "gdef.h"
+#include "grdef.h"
+#include "grimagebuffer.h"
+
+namespace Gr
+{
+	class ImagePool ;
+}
+
+/// \class Gr::ImagePool
+/// A process-wide, thread-safe pool of shared image buffers, used by
+/// Gr::Image::recycle() when the current image buffer cannot be reused
+/// in place.
+/// 
+/// The pool holds a shared pointer to each of its buffers, so a buffer 
+/// is free once every Gr::Image using it has gone away, and it can then 
+/// be handed out again without any heap allocation. Free buffers are 
+/// chosen by size class so that a steady stream of same-sized images
+/// keeps hitting buffers that are already big enough.
+/// 
+/// Hit and miss counts are logged periodically at the verbose level.
+/// 
+class Gr::ImagePool
+{
+public:
+	static shared_ptr<ImageBuffer> get( size_t size_hint = 0U , const ImageBuffer * current = nullptr ) ;
+		///< Returns an image buffer that is not in use by anyone else. 
+		///< The optional 'current' buffer is returned if it is a pool 
+		///< buffer that is held only by the pool and the caller.
+		///< Otherwise a free pool buffer is returned, preferably one 
+		///< whose capacity is in the size class of the hint, or a new 
+		///< buffer if there are none free.
+
+	static void counters( size_t & hits , size_t & misses , size_t & buffers ) ;
+		///< Returns the pool's hit and miss counters and the number of 
+		///< buffers in the pool.
+
+private:
+	ImagePool() ;
+} ;
+
+#endif
@@ -24,6 +24,7 @@
 #include "grpng.h"
 #include "grjpeg.h"
 #include "grpnm.h"
+#include "gravc.h"
 #include "ghexdump.h"
 #include "gassert.h"
 #include <algorithm> // std::reverse
@@ -178,6 +179,10 @@ Gr::ImageType::ImageType( const std::string & type_str ) :
 	{
 		m_type = t_pnm ;
 	}
+	else if( type_str.find("video/h264") == 0U )
+	{
+		m_type = t_avc ;
+	}
 
 	if( m_type != t_invalid )
 	{
@@ -246,6 +251,7 @@ void Gr::ImageType::setsimple( String & out ) const
 	else if( m_type == t_png ) std::strcpy( out.s , "image/png" ) ; // ignore warnings
 	else if( m_type == t_raw ) std::strcpy( out.s , "image/x.raw" ) ; // ignore warnings
 	else if( m_type == t_pnm ) std::strcpy( out.s , "image/x-portable-anymap" ) ; // ignore warnings
+	else if( m_type == t_avc ) std::strcpy( out.s , "video/h264" ) ; // ignore warnings
 }
 
 std::string Gr::ImageType::simple() const
@@ -281,6 +287,11 @@ bool Gr::ImageType::isPnm() const
 	return m_type == t_pnm ;
 }
 
+bool Gr::ImageType::isAvc() const
+{
+	return m_type == t_avc ;
+}
+
 size_t Gr::ImageType::size() const 
 { 
 	return sizet( m_dx , m_dy , m_channels ) ;
@@ -340,6 +351,23 @@ Gr::ImageType Gr::ImageType::png( ImageType type_in , int scale , bool monochrom
 	return png( scaled(type_in.dx(),scale) , scaled(type_in.dy(),scale) , monochrome?1:type_in.channels() ) ;
 }
 
+Gr::ImageType Gr::ImageType::avc( int dx , int dy )
+{
+	return ImageType( t_avc , dx , dy , 3 ) ;
+}
+
+Gr::ImageType Gr::ImageType::fromId( unsigned int id , int dx , int dy , int channels )
+{
+	if( id != t_jpeg && id != t_png && id != t_raw && id != t_pnm && id != t_avc )
+		return ImageType() ;
+	return ImageType( static_cast<Type>(id) , dx , dy , channels ) ;
+}
+
+unsigned int Gr::ImageType::id() const
+{
+	return static_cast<unsigned int>( m_type ) ;
+}
+
 void Gr::ImageType::init( ImageType::Type t , int dx , int dy , int channels )
 {
 	m_type = t ;
@@ -379,6 +407,16 @@ void Gr::ImageType::init( std::istream & stream )
 		if( info.valid() )
 			init( t_pnm , info.dx() , info.dy() , info.channels() ) ;
 	}
+	else if( t == t_avc )
+	{
+		// the sps is near the start, if there is one
+		std::vector<char> head( 256U ) ;
+		stream.read( &head[0] , head.size() ) ;
+		head.resize( static_cast<size_t>(stream.gcount()) ) ;
+		stream.clear() ;
+		if( !head.empty() )
+			init( reinterpret_cast<const unsigned char*>(&head[0]) , head.size() ) ;
+	}
 
 	stream.seekg( pos , std::ios_base::beg ) ;
 	if( pos == -1 || stream.tellg() != pos )
@@ -406,6 +444,19 @@ void Gr::ImageType::init( const unsigned char * p , size_t n )
 		if( info.valid() )
 			init( t_pnm , info.dx() , info.dy() , info.channels() ) ;
 	}
+	else if( t == t_avc )
+	{
+		// take the size from a leading sps
+		const char * cp = reinterpret_cast<const char*>(p) ;
+		size_t pos = 0U ;
+		size_t size = 0U ;
+		if( Avc::ByteStream::next( cp , n , pos , size ) && (static_cast<unsigned char>(cp[pos]) & 0x1fU) == 7U )
+		{
+			Avc::Sps sps( std::string(cp+pos,size) ) ;
+			if( sps.valid() )
+				init( t_avc , static_cast<int>(sps.dx()) , static_cast<int>(sps.dy()) , 3 ) ;
+		}
+	}
 }
 
 Gr::ImageType::Type Gr::ImageType::typeFromSignature( const unsigned char * p , size_t n )
@@ -428,6 +479,10 @@ Gr::ImageType::Type Gr::ImageType::typeFromSignature( const unsigned char * p ,
 	{
 		return t_pnm ;
 	}
+	else if( Avc::ByteStream::signature( p , n ) )
+	{
+		return t_avc ;
+	}
 	else
 	{
 		return t_invalid ;
@@ -40,6 +40,11 @@ namespace Gr
 /// three numbers is the number of channels (1 or 3), and the image type is 
 /// "x.raw", "jpeg", "png" or "x-portable-anymap".
 /// 
+/// There is also a "video/h264" type for H.264 pictures that are passed 
+/// through without decoding. The data is a NALU byte-stream, and only key 
+/// frames that start with an SPS have a size that can be determined from 
+/// the data.
+/// 
 class Gr::ImageType
 {
 public:
@@ -99,6 +104,13 @@ public:
 		///< Factory function for a raw image type with the same dimensions
 		///< as the given image type, optionally scaled.
 
+	static ImageType avc( int dx , int dy ) ;
+		///< Factory function for an H.264 picture type.
+
+	static ImageType fromId( unsigned int id , int dx , int dy , int channels ) ;
+		///< Factory function taking a numeric image format as returned by id().
+		///< Returns an in-valid() type if the id is not recognised.
+
 	bool valid() const ;
 		///< Returns true if valid.
 
@@ -126,6 +138,14 @@ public:
 	bool isPnm() const ;
 		///< Returns true if a pnm image type.
 
+	bool isAvc() const ;
+		///< Returns true if an H.264 picture type.
+
+	unsigned int id() const ;
+		///< Returns a small non-zero number identifying the image format, 
+		///< or zero if in-valid(). This is used in binary publication 
+		///< headers (see G::PublisherHeader).
+
 	int dx() const ;
 		///< Returns the image width.
 
@@ -156,7 +176,7 @@ public:
 		///< Used by op<<().
 
 private:
-	enum Type { t_invalid , t_jpeg , t_png , t_raw , t_pnm } ;
+	enum Type { t_invalid , t_jpeg , t_png , t_raw , t_pnm , t_avc } ; // see id()
 	ImageType( Type type_ , int dx_ , int dy_ , int channels_ ) ;
 	static Type typeFromSignature( const unsigned char * , size_t ) ;
 	void init( std::istream & ) ;
@@ -128,6 +128,14 @@ public:
 	void decode( ImageData & out , const ImageBuffer & ) ;
 		///< Decodes a jpeg buffer into an image. Throws on error.
 
+	void decodeDc( ImageData & out , const char * p_in , size_t n ) ;
+		///< Decodes just the DC coefficients of the luma channel, giving
+		///< a monochrome image at one-eighth scale where each pixel is
+		///< the average of an eight-by-eight block. This is several times
+		///< faster than a full decode since there are no inverse DCTs and 
+		///< no colour-space conversion. Ignores the setup() parameters.
+		///< Throws on error.
+
 private:
 	JpegReader( const JpegReader & ) ;
 	void operator=( const JpegReader & ) ;
@@ -21,6 +21,7 @@
 #include "gdef.h"
 #include "grdef.h"
 #include "grjpeg.h"
+#include "grareascaler.h"
 #include "gstr.h"
 #include "groot.h"
 #include "gtest.h"
@@ -281,7 +282,7 @@ public:
 private:
 	JpegReaderImp( const JpegReaderImp & ) ;
 	void operator=( const JpegReaderImp & ) ;
-	void createBuffers( ImageData & ) ;
+	void createBuffers( ImageData & , int channels ) ;
 	jpeg_decompress_struct * p() ;
 	const jpeg_decompress_struct * p() const ;
 	j_common_ptr base() ;
@@ -297,6 +298,7 @@ private:
 	void reduce( ImageData & , int , bool ) ;
 	static int pre( int ) ;
 	static int post( int ) ;
+	static int channels( int , bool ) ;
 
 private:
 	int m_dx ;
@@ -361,7 +363,7 @@ void Gr::JpegReaderImp::decode( ImageData & out , FILE * fp , int scale , bool m
 {
 	start( fp , pre(scale) , monochrome_out ) ;
 	readGeometry() ;
-	createBuffers( out ) ;
+	createBuffers( out , channels(scale,monochrome_out) ) ;
 	readPixels( out ) ;
 	reduce( out , post(scale) , monochrome_out ) ;
 	finish() ;
@@ -371,7 +373,7 @@ void Gr::JpegReaderImp::decode( ImageData & out , const unsigned char * p , size
 {
 	start( p , n , pre(scale) , monochrome_out ) ;
 	readGeometry() ;
-	createBuffers( out ) ;
+	createBuffers( out , channels(scale,monochrome_out) ) ;
 	readPixels( out ) ;
 	reduce( out , post(scale) , monochrome_out ) ;
 	finish() ;
@@ -381,7 +383,7 @@ void Gr::JpegReaderImp::decode( ImageData & out , const ImageBuffer & b , int sc
 {
 	start( b , pre(scale) , monochrome_out ) ;
 	readGeometry() ;
-	createBuffers( out ) ;
+	createBuffers( out , channels(scale,monochrome_out) ) ;
 	readPixels( out ) ;
 	reduce( out , post(scale) , monochrome_out ) ;
 	finish() ;
@@ -411,9 +413,15 @@ int Gr::JpegReaderImp::post( int scale )
 		return scale ;
 }
 
-void Gr::JpegReaderImp::createBuffers( ImageData & data )
+int Gr::JpegReaderImp::channels( int scale , bool monochrome_out )
 {
-	data.resize( m_dx , m_dy , 3 ) ;
+	// decode straight into a monochrome image if there is no post-scaling
+	return monochrome_out && post(scale) == 1 ? 1 : 3 ;
+}
+
+void Gr::JpegReaderImp::createBuffers( ImageData & data , int channels )
+{
+	data.resize( m_dx , m_dy , channels ) ;
 }
 
 void Gr::JpegReaderImp::readGeometry()
@@ -507,8 +515,11 @@ void Gr::JpegReaderImp::readPixels( ImageData & data_out )
 
 void Gr::JpegReaderImp::reduce( ImageData & data_out , int post_scale , bool monochrome_out )
 {
-	G_ASSERT( data_out.channels() == 3 ) ;
-	if( post_scale > 1 || monochrome_out )
+	if( data_out.channels() == 1 )
+	{
+		G_ASSERT( post_scale == 1 && monochrome_out ) ;
+	}
+	else if( post_scale > 1 || monochrome_out )
 	{
 		data_out.scale( post_scale , monochrome_out , false/*since decoded to greyscale*/ ) ;
 	}
@@ -562,6 +573,14 @@ void Gr::JpegReader::decode( ImageData & out , const ImageBuffer & b )
 	m_imp->decode( out , b , m_scale , m_monochrome_out ) ;
 }
 
+void Gr::JpegReader::decodeDc( ImageData & out , const char * p , size_t n )
+{
+	// libjpeg's one-eighth scaling uses just the dc coefficients, and the
+	// chroma components are not transformed when decoding to greyscale
+	if( m_imp.get() == nullptr ) m_imp.reset( new JpegReaderImp ) ;
+	m_imp->decode( out , reinterpret_cast<const unsigned char*>(p) , n , 8 , true ) ;
+}
+
 Gr::JpegReader::~JpegReader()
 {
 }
@@ -679,6 +698,22 @@ void Gr::JpegWriterImp::compress( const ImageData & in )
 			jpeg_write_scanlines( &m , &row_pointer , 1 ) ;
 		}
 	}
+	else if( m_scale > 1 )
+	{
+		AreaScaler scaler( in.dx() , in.dy() , in.channels() , m_scale , m_monochrome_out ) ;
+		G_ASSERT( m.image_height == static_cast<JDIMENSION>(scaler.dy()) ) ;
+		m_line_buffer.resize( sizet(scaler.dx(),scaler.channels()) ) ;
+		jpeg_byte * row_pointer = reinterpret_cast<unsigned char *>(&m_line_buffer[0]) ;
+		for( int y_in = 0 ; y_in < in.dy() ; y_in++ )
+		{
+			scaler.add( in.row(y_in) ) ;
+			if( scaler.ready() )
+			{
+				scaler.emit( row_pointer ) ;
+				jpeg_write_scanlines( &m , &row_pointer , 1 ) ;
+			}
+		}
+	}
 	else
 	{
 		m_line_buffer.resize( sizet(in.dx(),m_monochrome_out?1:in.channels()) ) ;
@@ -32,6 +32,7 @@ void Gr::JpegReader::decode( ImageData & , const G::Path & ) { throw Jpeg::Error
 void Gr::JpegReader::decode( ImageData & , const unsigned char * , size_t ) { throw Jpeg::Error( "jpegreader not implemented" + std::string(help) ) ; }
 void Gr::JpegReader::decode( ImageData & , const char * , size_t ) { throw Jpeg::Error( "jpegreader not implemented" + std::string(help) ) ; }
 void Gr::JpegReader::decode( ImageData & out , const ImageBuffer & ) { throw Jpeg::Error( "jpegreader not implemented" + std::string(help) ) ; }
+void Gr::JpegReader::decodeDc( ImageData & , const char * , size_t ) { throw Jpeg::Error( "jpegreader not implemented" + std::string(help) ) ; }
 ;
 //
 class Gr::JpegWriterImp {} ;
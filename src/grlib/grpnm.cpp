@@ -21,6 +21,7 @@
 #include "gdef.h"
 #include "grdef.h"
 #include "grpnm.h"
+#include "grareascaler.h"
 #include "groot.h"
 #include "gassert.h"
 #include "gstr.h"
@@ -434,7 +435,20 @@ bool Gr::PnmReader::readBody( std::istream & in , const PnmInfo & info , ImageDa
 
 	data.resize( scaled(info.dx(),scale) , scaled(info.dy(),scale) , monochrome_out ? 1 : info.channels() ) ;
 
-	if( info.binary() && info.maxval() == 255 ) // optimisation
+	if( info.binary() && info.maxval() == 255 && scale > 1 ) // optimisation
+	{
+		std::vector<char> buffer( info.rowsize() ) ;
+		unsigned char * buffer_p = reinterpret_cast<unsigned char*>(&buffer[0]) ;
+		AreaScaler scaler( info.dx() , info.dy() , info.channels() , scale , monochrome_out ) ;
+		for( int y_in = 0 , y_out = 0 ; y_in < info.dy() ; y_in++ )
+		{
+			in.read( &buffer[0] , buffer.size() ) ;
+			scaler.add( buffer_p ) ;
+			if( scaler.ready() )
+				scaler.emit( data.row(y_out++) ) ;
+		}
+	}
+	else if( info.binary() && info.maxval() == 255 ) // optimisation
 	{
 		std::vector<char> buffer( info.rowsize() ) ;
 		unsigned char * buffer_p = reinterpret_cast<unsigned char*>(&buffer[0]) ;
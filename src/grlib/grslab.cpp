@@ -0,0 +1,470 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// grslab.cpp
+//
+
+#include "gdef.h"
+#include "grslab.h"
+#include "glimits.h"
+#include "gtest.h"
+#include "gassert.h"
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	// A small process-wide pool of aligned memory blocks. Blocks are
+	// sized in whole pages so that images of the same shape hit the
+	// same block size. A block is only reused for a request that is
+	// at least half its size so that big blocks are not wasted on
+	// small images.
+	//
+	class SlabPool
+	{
+	public:
+		enum { page = 4096 } ;
+		enum { max_blocks = 16 } ;
+		static char * acquire( size_t & size ) ;
+		static void release( char * p , size_t size ) ;
+
+	private:
+		struct Block { char * p ; size_t size ; } ;
+		static SlabPool & instance() ;
+		static char * allocate( size_t size ) ;
+
+	private:
+		G::threading::mutex_type m_mutex ;
+		std::vector<Block> m_blocks ;
+	} ;
+
+	SlabPool & SlabPool::instance()
+	{
+		// never deleted, so that slabs with static storage duration
+		// can still release their blocks at exit
+		static SlabPool * pool = new SlabPool ;
+		return *pool ;
+	}
+
+	char * SlabPool::allocate( size_t size )
+	{
+		void * p = nullptr ;
+		if( posix_memalign( &p , Gr::Slab::alignment , size ) != 0 || p == nullptr )
+			throw std::bad_alloc() ;
+		return static_cast<char*>(p) ;
+	}
+
+	char * SlabPool::acquire( size_t & size )
+	{
+		size = ( ( size + page - 1U ) / page ) * page ;
+		{
+			SlabPool & pool = instance() ;
+			G::threading::lock_type lock( pool.m_mutex ) ;
+			std::vector<Block>::iterator best = pool.m_blocks.end() ;
+			for( std::vector<Block>::iterator p = pool.m_blocks.begin() ; p != pool.m_blocks.end() ; ++p )
+			{
+				if( (*p).size >= size && (*p).size <= (size*2U) && ( best == pool.m_blocks.end() || (*p).size < (*best).size ) )
+					best = p ;
+			}
+			if( best != pool.m_blocks.end() )
+			{
+				char * result = (*best).p ;
+				size = (*best).size ;
+				pool.m_blocks.erase( best ) ;
+				return result ;
+			}
+		}
+		return allocate( size ) ;
+	}
+
+	void SlabPool::release( char * p , size_t size )
+	{
+		if( p == nullptr )
+			return ;
+
+		{
+			SlabPool & pool = instance() ;
+			G::threading::lock_type lock( pool.m_mutex ) ;
+			if( pool.m_blocks.size() < max_blocks )
+			{
+				Block block = { p , size } ;
+				pool.m_blocks.push_back( block ) ;
+				return ;
+			}
+		}
+		std::free( p ) ;
+	}
+}
+
+Gr::Slab::Slab() :
+	m_p(nullptr) ,
+	m_capacity(0U) ,
+	m_used(0U) ,
+	m_stride(0U)
+{
+}
+
+Gr::Slab::~Slab()
+{
+	SlabPool::release( m_p , m_capacity ) ;
+}
+
+Gr::Slab::Slab( const Slab & other ) :
+	m_p(nullptr) ,
+	m_capacity(0U) ,
+	m_used(0U) ,
+	m_stride(other.m_stride) ,
+	m_rows(other.m_rows)
+{
+	if( other.m_used )
+	{
+		reserveBytes( other.m_used ) ;
+		std::memcpy( m_p , other.m_p , other.m_used ) ;
+		m_used = other.m_used ;
+	}
+}
+
+Gr::Slab & Gr::Slab::operator=( const Slab & other )
+{
+	Slab tmp( other ) ;
+	swap( tmp ) ;
+	return *this ;
+}
+
+void Gr::Slab::swap( Slab & other )
+{
+	std::swap( m_p , other.m_p ) ;
+	std::swap( m_capacity , other.m_capacity ) ;
+	std::swap( m_used , other.m_used ) ;
+	std::swap( m_stride , other.m_stride ) ;
+	m_rows.swap( other.m_rows ) ;
+}
+
+size_t Gr::Slab::aligned( size_t n )
+{
+	return ( n + alignment - 1U ) & ~static_cast<size_t>(alignment-1U) ;
+}
+
+void Gr::Slab::reserveBytes( size_t n )
+{
+	if( n <= m_capacity )
+		return ;
+
+	size_t size = std::max( n , m_capacity*2U ) ;
+	char * p = SlabPool::acquire( size ) ;
+	if( m_used )
+		std::memcpy( p , m_p , m_used ) ;
+	SlabPool::release( m_p , m_capacity ) ;
+	m_p = p ;
+	m_capacity = size ;
+}
+
+void Gr::Slab::setUsed()
+{
+	m_used = 0U ;
+	for( std::vector<Row>::const_iterator p = m_rows.begin() ; p != m_rows.end() ; ++p )
+		m_used = std::max( m_used , (*p).offset + (*p).capacity ) ;
+}
+
+void Gr::Slab::clear()
+{
+	m_rows.clear() ;
+	m_used = 0U ;
+	m_stride = 0U ;
+}
+
+void Gr::Slab::reserve( size_t rows )
+{
+	m_rows.reserve( rows ) ;
+}
+
+void Gr::Slab::addRow()
+{
+	m_used = aligned( m_used ) ;
+	Row row = { m_used , 0U , 0U } ;
+	m_rows.push_back( row ) ;
+	m_stride = 0U ;
+}
+
+void Gr::Slab::push_back()
+{
+	addRow() ;
+}
+
+void Gr::Slab::resize( size_t rows )
+{
+	if( rows < m_rows.size() )
+	{
+		m_rows.resize( rows ) ;
+		setUsed() ;
+	}
+	else
+	{
+		m_rows.reserve( rows ) ;
+		while( m_rows.size() < rows )
+			addRow() ;
+	}
+}
+
+void Gr::Slab::layout( size_t rows , size_t rowsize )
+{
+	if( rows == 0U )
+	{
+		clear() ;
+		return ;
+	}
+
+	const size_t stride = aligned( std::max(rowsize,size_t(1U)) ) ;
+	if( m_stride == stride && m_rows.size() == rows )
+	{
+		for( size_t i = 0U ; i < rows ; i++ )
+			rowResize( i , rowsize ) ;
+	}
+	else
+	{
+		m_rows.clear() ;
+		m_used = 0U ;
+		reserveBytes( rows * stride ) ;
+		m_rows.resize( rows ) ;
+		for( size_t i = 0U ; i < rows ; i++ )
+		{
+			m_rows[i].offset = i * stride ;
+			m_rows[i].size = rowsize ;
+			m_rows[i].capacity = stride ;
+		}
+		m_used = rows * stride ;
+		m_stride = stride ;
+		std::memset( m_p , 0 , m_used ) ;
+	}
+}
+
+void Gr::Slab::rowResize( size_t i , size_t n )
+{
+	Row & row = m_rows.at( i ) ;
+	if( n <= row.capacity )
+	{
+		if( n > row.size )
+			std::memset( m_p + row.offset + row.size , 0 , n - row.size ) ;
+		row.size = n ;
+	}
+	else if( ( row.offset + row.capacity ) == m_used )
+	{
+		// last in the block -- grow in place
+		reserveBytes( row.offset + n ) ;
+		std::memset( m_p + row.offset + row.size , 0 , n - row.size ) ;
+		row.size = row.capacity = n ;
+		m_used = row.offset + n ;
+		m_stride = 0U ;
+	}
+	else
+	{
+		// move to the end of the block
+		const size_t offset = aligned( m_used ) ;
+		reserveBytes( offset + n ) ;
+		std::memcpy( m_p + offset , m_p + row.offset , row.size ) ;
+		std::memset( m_p + offset + row.size , 0 , n - row.size ) ;
+		row.offset = offset ;
+		row.size = row.capacity = n ;
+		m_used = offset + n ;
+		m_stride = 0U ;
+	}
+}
+
+void Gr::Slab::rowSwap( size_t i , size_t j )
+{
+	std::swap( m_rows.at(i) , m_rows.at(j) ) ;
+	m_stride = 0U ;
+}
+
+Gr::Slab::reference Gr::Slab::at( size_t i )
+{
+	if( i >= m_rows.size() ) throw std::out_of_range( "slab row" ) ;
+	return reference( this , i ) ;
+}
+
+Gr::Slab::const_reference Gr::Slab::at( size_t i ) const
+{
+	if( i >= m_rows.size() ) throw std::out_of_range( "slab row" ) ;
+	return const_reference( this , i ) ;
+}
+
+Gr::Slab::iterator Gr::Slab::erase( iterator begin , iterator end )
+{
+	G_ASSERT( end == this->end() ) ;
+	if( end != this->end() )
+		throw std::runtime_error( "Gr::Slab::erase: can only erase trailing rows" ) ;
+	m_rows.erase( m_rows.begin() + begin.index() , m_rows.end() ) ;
+	setUsed() ;
+	return this->end() ;
+}
+
+// ==
+
+size_t Gr::imagebuffer::size_of( const Slab & slab )
+{
+	size_t n = 0U ;
+	for( size_t i = 0U ; i < slab.size() ; i++ )
+		n += slab.rowSize( i ) ;
+	return n ;
+}
+
+void Gr::imagebuffer::resize( Slab & slab , int dx , int dy , int channels )
+{
+	if( dx > 0 && dy > 0 && channels > 0 )
+		slab.layout( sizet(dy) , sizet(dx,channels) ) ;
+}
+
+// ==
+
+Gr::imp::slab_streambuf::slab_streambuf( const Slab & slab ) :
+	m_slab(slab) ,
+	m_row(0U) ,
+	m_row_pos(0) ,
+	m_size(static_cast<std::streamoff>(imagebuffer::size_of(slab)))
+{
+	setRow( 0U , 0U ) ;
+}
+
+Gr::imp::slab_streambuf::~slab_streambuf()
+{
+}
+
+void Gr::imp::slab_streambuf::setRow( size_t row , size_t offset )
+{
+	m_row = row ;
+	if( m_row < m_slab.size() )
+	{
+		char * p = const_cast<char*>( m_slab.rowData(m_row) ) ;
+		setg( p , p + offset , p + m_slab.rowSize(m_row) ) ;
+	}
+	else
+	{
+		setg( nullptr , nullptr , nullptr ) ;
+	}
+}
+
+int Gr::imp::slab_streambuf::underflow()
+{
+	if( gptr() != nullptr && gptr() < egptr() )
+		return static_cast<int>(static_cast<unsigned char>(*gptr())) ;
+
+	while( m_row < m_slab.size() )
+	{
+		m_row_pos += m_slab.rowSize( m_row ) ;
+		setRow( m_row + 1U , 0U ) ;
+		if( gptr() != nullptr && gptr() < egptr() )
+			return static_cast<int>(static_cast<unsigned char>(*gptr())) ;
+	}
+	return EOF ;
+}
+
+std::streampos Gr::imp::slab_streambuf::seekpos( std::streampos pos , std::ios_base::openmode which )
+{
+	return seekoff( pos , std::ios_base::beg , which ) ;
+}
+
+std::streampos Gr::imp::slab_streambuf::seekoff( std::streamoff off , std::ios_base::seekdir way , std::ios_base::openmode which )
+{
+	if( which & std::ios_base::in )
+	{
+		if( way == std::ios_base::beg )
+			return seek( off ) ;
+		else if( way == std::ios_base::end )
+			return seek( m_size + off ) ;
+		else if( way == std::ios_base::cur )
+			return seek( m_row_pos + ( gptr() == nullptr ? 0 : (gptr()-eback()) ) + off ) ;
+	}
+	return -1 ;
+}
+
+std::streampos Gr::imp::slab_streambuf::seek( std::streamoff pos )
+{
+	if( pos < 0 || pos > m_size )
+		return -1 ;
+
+	size_t row = 0U ;
+	std::streamoff row_pos = 0 ;
+	for( ; row < m_slab.size() && (row_pos+static_cast<std::streamoff>(m_slab.rowSize(row))) <= pos ; row++ )
+		row_pos += m_slab.rowSize( row ) ;
+
+	m_row_pos = row_pos ;
+	setRow( row , static_cast<size_t>(pos-row_pos) ) ;
+	return pos ;
+}
+
+// ==
+
+std::istream & operator>>( std::istream & stream , Gr::Slab & slab )
+{
+	size_t buffer_size = static_cast<size_t>( G::limits::file_buffer ) ;
+	if( G::Test::enabled("tiny-image-buffers") )
+		buffer_size = size_t(10U) ;
+
+	// get the stream size
+	size_t stream_size = 0U ;
+	std::streampos pos = stream.tellg() ;
+	if( pos >= 0 )
+	{
+		stream.seekg( 0 , std::ios_base::end ) ;
+		std::streampos endpos = stream.tellg() ;
+		if( endpos >= 0 && endpos > pos )
+			stream_size = static_cast<size_t>( std::streamoff(endpos-pos) ) ;
+		stream.seekg( pos ) ;
+		if( stream.tellg() != pos )
+			throw std::runtime_error( "Gr::Slab::operator>>: stream repositioning error" ) ;
+	}
+
+	// read everything into one row, growing it as necessary -- add one
+	// to the expected size to avoid an extra go round at eof
+	slab.clear() ;
+	slab.push_back() ;
+	Gr::Slab::reference row = slab.back() ;
+	size_t n = 0U ;
+	row.resize( stream_size ? (stream_size+1U) : buffer_size ) ;
+	while( stream.good() )
+	{
+		if( n == row.size() )
+			row.resize( n + buffer_size ) ;
+
+		stream.read( row.data() + n , row.size() - n ) ;
+		std::streamsize gcount = stream.gcount() ;
+		if( gcount <= 0 )
+			break ;
+		n += static_cast<size_t>(gcount) ;
+	}
+	row.resize( n ) ;
+	if( n == 0U )
+		slab.clear() ;
+
+	// read() sets the failbit if asked to read more than what's
+	// available, but we only want eof in that case
+	if( stream.eof() && stream.fail() && !stream.bad() )
+		stream.clear( std::ios_base::eofbit ) ;
+
+	return stream ;
+}
+
+std::ostream & operator<<( std::ostream & stream , const Gr::Slab & slab )
+{
+	for( size_t i = 0U ; i < slab.size() ; i++ )
+		stream.write( slab.rowData(i) , slab.rowSize(i) ) ;
+	return stream ;
+}
+
+/// \file grslab.cpp
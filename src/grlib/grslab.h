@@ -0,0 +1,896 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file grslab.h
+///
+
+#ifndef GR_SLAB__H
+#define GR_SLAB__H
+
+#include "gdef.h"
+#include "grdef.h"
+#include "grtraits.h"
+#include <iostream>
+#include <streambuf>
+#include <iterator>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+
+namespace Gr
+{
+	class Slab ;
+
+	namespace imp
+	{
+		template <typename TSlab, typename TChar> class slab_row ;
+		template <typename TSlab, typename TRow> class slab_row_iterator ;
+		class slab_streambuf ;
+		class slab_const_byte_iterator ;
+		template <typename TSlab, typename TChar> void swap( slab_row<TSlab,TChar> , slab_row<TSlab,TChar> ) ;
+	}
+}
+
+/// \class Gr::imp::slab_row
+/// A lightweight handle for one row of a Gr::Slab, with a subset of the
+/// std::vector<char> interface. Handles are invalidated by any change to
+/// the owning slab's row count, and row pointers are invalidated by any
+/// row growth.
+///
+template <typename TSlab, typename TChar>
+class Gr::imp::slab_row
+{
+public:
+	slab_row( TSlab * slab , size_t index ) ;
+		///< Constructor.
+
+	template <typename TOtherSlab, typename TOtherChar>
+	slab_row( const slab_row<TOtherSlab,TOtherChar> & ) ;
+		///< Converting constructor, non-const to const.
+
+	size_t size() const ;
+		///< Returns the row size.
+
+	bool empty() const ;
+		///< Returns true if the row is empty.
+
+	TChar * data() const ;
+		///< Returns a pointer to the row data.
+
+	TChar * begin() const ;
+		///< Returns data().
+
+	TChar * end() const ;
+		///< Returns data()+size().
+
+	TChar & operator[]( size_t ) const ;
+		///< Indexing operator.
+
+	TChar & at( size_t ) const ;
+		///< Checked indexing operator.
+
+	void resize( size_t n ) ;
+		///< Resizes the row, zero-filling any new bytes.
+
+	template <typename T> void assign( T begin , T end ) ;
+		///< Assigns the row from the given forward-iterator range.
+
+	void swap( slab_row other ) ;
+		///< Swaps the rows' positions in the slab, without copying
+		///< any row data.
+
+private:
+	template <typename S, typename C> friend class slab_row ;
+	TSlab * m_slab ;
+	size_t m_index ;
+} ;
+
+/// \class Gr::imp::slab_row_iterator
+/// A random-access iterator over the rows of a Gr::Slab that
+/// dereferences to a Gr::imp::slab_row handle.
+///
+template <typename TSlab, typename TRow>
+class Gr::imp::slab_row_iterator
+{
+public:
+	typedef std::random_access_iterator_tag iterator_category ;
+	typedef TRow value_type ;
+	typedef std::ptrdiff_t difference_type ;
+	typedef TRow reference ;
+	struct pointer /// An operator->() helper.
+	{
+		TRow m_row ;
+		const TRow * operator->() const { return &m_row ; }
+	} ;
+
+	slab_row_iterator() ;
+		///< Default constructor.
+
+	slab_row_iterator( TSlab * , size_t index ) ;
+		///< Constructor.
+
+	template <typename TOtherSlab, typename TOtherRow>
+	slab_row_iterator( const slab_row_iterator<TOtherSlab,TOtherRow> & ) ;
+		///< Converting constructor, non-const to const.
+
+	TRow operator*() const ;
+		///< Dereference operator returning a row handle.
+
+	pointer operator->() const ;
+		///< Dereference operator.
+
+	slab_row_iterator & operator++() ;
+		///< Preincrement operator.
+
+	slab_row_iterator operator++( int ) ;
+		///< Postincrement operator.
+
+	slab_row_iterator & operator--() ;
+		///< Predecrement operator.
+
+	slab_row_iterator & operator+=( difference_type ) ;
+		///< Advance operator.
+
+	slab_row_iterator operator+( difference_type ) const ;
+		///< Addition operator.
+
+	slab_row_iterator operator-( difference_type ) const ;
+		///< Subtraction operator.
+
+	difference_type operator-( const slab_row_iterator & ) const ;
+		///< Difference operator.
+
+	bool operator==( const slab_row_iterator & ) const ;
+		///< Comparison operator.
+
+	bool operator!=( const slab_row_iterator & ) const ;
+		///< Comparison operator.
+
+	bool operator<( const slab_row_iterator & ) const ;
+		///< Comparison operator.
+
+	size_t index() const ;
+		///< Returns the row index.
+
+private:
+	template <typename S, typename R> friend class slab_row_iterator ;
+	TSlab * m_slab ;
+	size_t m_index ;
+} ;
+
+/// \class Gr::Slab
+/// A candidate for Gr::ImageBuffer that keeps all of its rows in one
+/// contiguous, cache-aligned block of memory, with row offsets, sizes
+/// and capacities held in a separate small index.
+///
+/// The layout() method (and imagebuffer::resize()) places image rows
+/// at a regular stride that is a multiple of the alignment so that
+/// every row starts on an aligned boundary, and when the row size is
+/// itself a multiple of the alignment the whole image is one contiguous
+/// span of memory. Rows that grow beyond their capacity are grown in
+/// place if they are at the end of the block, or otherwise moved to
+/// the end.
+///
+/// Memory blocks are recycled through a small process-wide pool so that
+/// a steady stream of same-sized images does not hit the heap.
+///
+/// The interface is a vector-of-vectors look-alike, with row handles
+/// (imp::slab_row) standing in for the inner vectors.
+///
+class Gr::Slab
+{
+public:
+	enum { alignment = 64 } ;
+	typedef imp::slab_row<Slab,char> value_type ;
+	typedef imp::slab_row<Slab,char> reference ;
+	typedef imp::slab_row<const Slab,const char> const_reference ;
+	typedef imp::slab_row_iterator<Slab,reference> iterator ;
+	typedef imp::slab_row_iterator<const Slab,const_reference> const_iterator ;
+
+	Slab() ;
+		///< Default constructor for an empty slab.
+
+	~Slab() ;
+		///< Destructor. The memory block is returned to the pool.
+
+	Slab( const Slab & ) ;
+		///< Copy constructor.
+
+	Slab & operator=( const Slab & ) ;
+		///< Assignment operator.
+
+	void swap( Slab & ) ;
+		///< Swaps contents with another slab.
+
+	size_t size() const ;
+		///< Returns the number of rows.
+
+	bool empty() const ;
+		///< Returns true if there are no rows.
+
+	void clear() ;
+		///< Removes all the rows, but keeps the memory block.
+
+	void reserve( size_t rows ) ;
+		///< Reserves space in the row index.
+
+	void resize( size_t rows ) ;
+		///< Changes the number of rows. New rows are empty.
+
+	void layout( size_t rows , size_t rowsize ) ;
+		///< Sets the number of rows and sets each row to the given size,
+		///< placing the rows at an aligned stride(). Row contents are
+		///< preserved if the existing layout already has that shape,
+		///< otherwise they are undefined.
+
+	size_t stride() const ;
+		///< Returns the row stride of the last layout(), or zero if the
+		///< rows have since been individually reorganised.
+
+	void push_back() ;
+		///< Adds an empty row.
+
+	template <typename T> void push_back( const T & row ) ;
+		///< Adds a row copied from a vector-like container.
+
+	reference operator[]( size_t ) ;
+		///< Returns a handle for the given row.
+
+	const_reference operator[]( size_t ) const ;
+		///< Returns a handle for the given row.
+
+	reference at( size_t ) ;
+		///< Returns a handle for the given row, with bounds checking.
+
+	const_reference at( size_t ) const ;
+		///< Returns a handle for the given row, with bounds checking.
+
+	reference front() ;
+		///< Returns a handle for the first row.
+
+	const_reference front() const ;
+		///< Returns a handle for the first row.
+
+	reference back() ;
+		///< Returns a handle for the last row.
+
+	const_reference back() const ;
+		///< Returns a handle for the last row.
+
+	iterator begin() ;
+		///< Returns a begin row iterator.
+
+	iterator end() ;
+		///< Returns an end row iterator.
+
+	const_iterator begin() const ;
+		///< Returns a begin row iterator.
+
+	const_iterator end() const ;
+		///< Returns an end row iterator.
+
+	iterator erase( iterator begin , iterator end ) ;
+		///< Removes a trailing range of rows.
+
+	char * rowData( size_t ) ;
+		///< Returns a pointer to the given row. Used by imp::slab_row.
+
+	const char * rowData( size_t ) const ;
+		///< Returns a pointer to the given row. Used by imp::slab_row.
+
+	size_t rowSize( size_t ) const ;
+		///< Returns the size of the given row. Used by imp::slab_row.
+
+	void rowResize( size_t , size_t ) ;
+		///< Resizes the given row. Used by imp::slab_row.
+
+	void rowSwap( size_t , size_t ) ;
+		///< Swaps two rows. Used by imp::slab_row.
+
+	size_t capacity() const ;
+		///< Returns the size of the memory block.
+
+private:
+	struct Row /// A row index entry for Gr::Slab.
+	{
+		size_t offset ;
+		size_t size ;
+		size_t capacity ;
+	} ;
+	static size_t aligned( size_t ) ;
+	void reserveBytes( size_t ) ;
+	void addRow() ;
+	void setUsed() ;
+
+private:
+	char * m_p ;
+	size_t m_capacity ;
+	size_t m_used ;
+	size_t m_stride ;
+	std::vector<Row> m_rows ;
+} ;
+
+namespace Gr
+{
+	namespace traits
+	{
+		template <>
+		struct imagebuffer<Slab> /// Specialisation for Gr::Slab.
+		{
+			typedef imp::slab_streambuf streambuf_type ;
+			typedef imp::slab_const_byte_iterator const_byte_iterator ;
+			typedef Slab::iterator row_iterator ;
+			typedef Slab::const_iterator const_row_iterator ;
+		} ;
+	}
+
+	namespace imagebuffer
+	{
+		size_t size_of( const Slab & ) ;
+		void resize( Slab & , int dx , int dy , int channels ) ;
+		imp::slab_const_byte_iterator bytes_begin( const Slab & ) ;
+		imp::slab_const_byte_iterator bytes_end( const Slab & ) ;
+		bool row_empty( Slab::iterator row_p ) ;
+		void row_resize( Slab::iterator row_p , size_t n ) ;
+		Slab::iterator row_erase( Slab & , Slab::iterator row_p ) ;
+		Slab::const_iterator row_begin( const Slab & ) ;
+		Slab::iterator row_begin( Slab & ) ;
+		Slab::const_iterator row_end( const Slab & ) ;
+		Slab::iterator row_end( Slab & ) ;
+		Slab::iterator row_add( Slab & ) ;
+		char * row_ptr( Slab::iterator row_p ) ;
+		const char * row_ptr( Slab::const_iterator row_p ) ;
+		size_t row_size( Slab::const_iterator row_p ) ;
+	}
+}
+std::istream & operator>>( std::istream & stream , Gr::Slab & ) ;
+std::ostream & operator<<( std::ostream & stream , const Gr::Slab & ) ;
+
+/// \class Gr::imp::slab_streambuf
+/// A simple, read-only streambuf for Gr::Slab.
+///
+class Gr::imp::slab_streambuf : public std::streambuf
+{
+public:
+	explicit slab_streambuf( const Slab & ) ;
+		///< Constructor.
+
+	virtual ~slab_streambuf() ;
+		///< Destructor.
+
+	virtual std::streampos seekpos( std::streampos pos , std::ios_base::openmode which ) override ;
+		///< Override from std::streambuf.
+
+	virtual std::streampos seekoff( std::streamoff off , std::ios_base::seekdir way , std::ios_base::openmode which ) override ;
+		///< Override from std::streambuf.
+
+	virtual int underflow() override ;
+		///< Override from std::streambuf.
+
+private:
+	slab_streambuf( const slab_streambuf & ) ;
+	void operator=( const slab_streambuf & ) ;
+	void setRow( size_t row , size_t offset ) ;
+	std::streampos seek( std::streamoff ) ;
+
+private:
+	const Slab & m_slab ;
+	size_t m_row ;
+	std::streamoff m_row_pos ;
+	std::streamoff m_size ;
+} ;
+
+/// \class Gr::imp::slab_const_byte_iterator
+/// A forward byte-by-byte input iterator for Gr::Slab.
+///
+class Gr::imp::slab_const_byte_iterator
+{
+public:
+	slab_const_byte_iterator() ;
+		///< Default constructor for an end iterator.
+
+	explicit slab_const_byte_iterator( const Slab & ) ;
+		///< Constructor.
+
+	char operator*() const ;
+		///< Dereference operator.
+
+	slab_const_byte_iterator & operator++() ;
+		///< Preincrement operator.
+
+	slab_const_byte_iterator operator++( int ) ;
+		///< Postfix increment operator.
+
+	bool operator==( const slab_const_byte_iterator & ) const ;
+		///< Equality operator.
+
+	bool operator!=( const slab_const_byte_iterator & ) const ;
+		///< Inequality operator.
+
+private:
+	bool atEnd() const ;
+	void skipEmpty() ;
+
+private:
+	const Slab * m_slab ;
+	size_t m_row ;
+	size_t m_row_offset ;
+	size_t m_offset ;
+} ;
+
+
+template <typename TSlab, typename TChar>
+Gr::imp::slab_row<TSlab,TChar>::slab_row( TSlab * slab , size_t index ) :
+	m_slab(slab) ,
+	m_index(index)
+{
+}
+
+template <typename TSlab, typename TChar>
+template <typename TOtherSlab, typename TOtherChar>
+Gr::imp::slab_row<TSlab,TChar>::slab_row( const slab_row<TOtherSlab,TOtherChar> & other ) :
+	m_slab(other.m_slab) ,
+	m_index(other.m_index)
+{
+}
+
+template <typename TSlab, typename TChar>
+size_t Gr::imp::slab_row<TSlab,TChar>::size() const
+{
+	return m_slab->rowSize( m_index ) ;
+}
+
+template <typename TSlab, typename TChar>
+bool Gr::imp::slab_row<TSlab,TChar>::empty() const
+{
+	return size() == 0U ;
+}
+
+template <typename TSlab, typename TChar>
+TChar * Gr::imp::slab_row<TSlab,TChar>::data() const
+{
+	return m_slab->rowData( m_index ) ;
+}
+
+template <typename TSlab, typename TChar>
+TChar * Gr::imp::slab_row<TSlab,TChar>::begin() const
+{
+	return data() ;
+}
+
+template <typename TSlab, typename TChar>
+TChar * Gr::imp::slab_row<TSlab,TChar>::end() const
+{
+	return data() + size() ;
+}
+
+template <typename TSlab, typename TChar>
+TChar & Gr::imp::slab_row<TSlab,TChar>::operator[]( size_t i ) const
+{
+	return data()[i] ;
+}
+
+template <typename TSlab, typename TChar>
+TChar & Gr::imp::slab_row<TSlab,TChar>::at( size_t i ) const
+{
+	if( i >= size() ) throw std::out_of_range( "slab row index" ) ;
+	return data()[i] ;
+}
+
+template <typename TSlab, typename TChar>
+void Gr::imp::slab_row<TSlab,TChar>::resize( size_t n )
+{
+	m_slab->rowResize( m_index , n ) ;
+}
+
+template <typename TSlab, typename TChar>
+template <typename T>
+void Gr::imp::slab_row<TSlab,TChar>::assign( T begin , T end )
+{
+	resize( static_cast<size_t>(std::distance(begin,end)) ) ;
+	std::copy( begin , end , data() ) ;
+}
+
+template <typename TSlab, typename TChar>
+void Gr::imp::slab_row<TSlab,TChar>::swap( slab_row other )
+{
+	m_slab->rowSwap( m_index , other.m_index ) ;
+}
+
+template <typename TSlab, typename TChar>
+void Gr::imp::swap( slab_row<TSlab,TChar> a , slab_row<TSlab,TChar> b )
+{
+	a.swap( b ) ;
+}
+
+
+template <typename TSlab, typename TRow>
+Gr::imp::slab_row_iterator<TSlab,TRow>::slab_row_iterator() :
+	m_slab(nullptr) ,
+	m_index(0U)
+{
+}
+
+template <typename TSlab, typename TRow>
+Gr::imp::slab_row_iterator<TSlab,TRow>::slab_row_iterator( TSlab * slab , size_t index ) :
+	m_slab(slab) ,
+	m_index(index)
+{
+}
+
+template <typename TSlab, typename TRow>
+template <typename TOtherSlab, typename TOtherRow>
+Gr::imp::slab_row_iterator<TSlab,TRow>::slab_row_iterator( const slab_row_iterator<TOtherSlab,TOtherRow> & other ) :
+	m_slab(other.m_slab) ,
+	m_index(other.m_index)
+{
+}
+
+template <typename TSlab, typename TRow>
+TRow Gr::imp::slab_row_iterator<TSlab,TRow>::operator*() const
+{
+	return TRow( m_slab , m_index ) ;
+}
+
+template <typename TSlab, typename TRow>
+typename Gr::imp::slab_row_iterator<TSlab,TRow>::pointer Gr::imp::slab_row_iterator<TSlab,TRow>::operator->() const
+{
+	pointer p = { TRow(m_slab,m_index) } ;
+	return p ;
+}
+
+template <typename TSlab, typename TRow>
+Gr::imp::slab_row_iterator<TSlab,TRow> & Gr::imp::slab_row_iterator<TSlab,TRow>::operator++()
+{
+	m_index++ ;
+	return *this ;
+}
+
+template <typename TSlab, typename TRow>
+Gr::imp::slab_row_iterator<TSlab,TRow> Gr::imp::slab_row_iterator<TSlab,TRow>::operator++( int )
+{
+	slab_row_iterator orig( *this ) ;
+	m_index++ ;
+	return orig ;
+}
+
+template <typename TSlab, typename TRow>
+Gr::imp::slab_row_iterator<TSlab,TRow> & Gr::imp::slab_row_iterator<TSlab,TRow>::operator--()
+{
+	m_index-- ;
+	return *this ;
+}
+
+template <typename TSlab, typename TRow>
+Gr::imp::slab_row_iterator<TSlab,TRow> & Gr::imp::slab_row_iterator<TSlab,TRow>::operator+=( difference_type n )
+{
+	m_index += n ;
+	return *this ;
+}
+
+template <typename TSlab, typename TRow>
+Gr::imp::slab_row_iterator<TSlab,TRow> Gr::imp::slab_row_iterator<TSlab,TRow>::operator+( difference_type n ) const
+{
+	return slab_row_iterator( m_slab , m_index + n ) ;
+}
+
+template <typename TSlab, typename TRow>
+Gr::imp::slab_row_iterator<TSlab,TRow> Gr::imp::slab_row_iterator<TSlab,TRow>::operator-( difference_type n ) const
+{
+	return slab_row_iterator( m_slab , m_index - n ) ;
+}
+
+template <typename TSlab, typename TRow>
+typename Gr::imp::slab_row_iterator<TSlab,TRow>::difference_type Gr::imp::slab_row_iterator<TSlab,TRow>::operator-( const slab_row_iterator & other ) const
+{
+	return static_cast<difference_type>(m_index) - static_cast<difference_type>(other.m_index) ;
+}
+
+template <typename TSlab, typename TRow>
+bool Gr::imp::slab_row_iterator<TSlab,TRow>::operator==( const slab_row_iterator & other ) const
+{
+	return m_index == other.m_index ;
+}
+
+template <typename TSlab, typename TRow>
+bool Gr::imp::slab_row_iterator<TSlab,TRow>::operator!=( const slab_row_iterator & other ) const
+{
+	return m_index != other.m_index ;
+}
+
+template <typename TSlab, typename TRow>
+bool Gr::imp::slab_row_iterator<TSlab,TRow>::operator<( const slab_row_iterator & other ) const
+{
+	return m_index < other.m_index ;
+}
+
+template <typename TSlab, typename TRow>
+size_t Gr::imp::slab_row_iterator<TSlab,TRow>::index() const
+{
+	return m_index ;
+}
+
+
+inline
+size_t Gr::Slab::size() const
+{
+	return m_rows.size() ;
+}
+
+inline
+bool Gr::Slab::empty() const
+{
+	return m_rows.empty() ;
+}
+
+inline
+size_t Gr::Slab::stride() const
+{
+	return m_stride ;
+}
+
+inline
+size_t Gr::Slab::capacity() const
+{
+	return m_capacity ;
+}
+
+template <typename T>
+void Gr::Slab::push_back( const T & row )
+{
+	addRow() ;
+	back().assign( row.begin() , row.end() ) ;
+}
+
+inline
+Gr::Slab::reference Gr::Slab::operator[]( size_t i )
+{
+	return reference( this , i ) ;
+}
+
+inline
+Gr::Slab::const_reference Gr::Slab::operator[]( size_t i ) const
+{
+	return const_reference( this , i ) ;
+}
+
+inline
+Gr::Slab::reference Gr::Slab::front()
+{
+	return reference( this , 0U ) ;
+}
+
+inline
+Gr::Slab::const_reference Gr::Slab::front() const
+{
+	return const_reference( this , 0U ) ;
+}
+
+inline
+Gr::Slab::reference Gr::Slab::back()
+{
+	return reference( this , m_rows.size()-1U ) ;
+}
+
+inline
+Gr::Slab::const_reference Gr::Slab::back() const
+{
+	return const_reference( this , m_rows.size()-1U ) ;
+}
+
+inline
+Gr::Slab::iterator Gr::Slab::begin()
+{
+	return iterator( this , 0U ) ;
+}
+
+inline
+Gr::Slab::iterator Gr::Slab::end()
+{
+	return iterator( this , m_rows.size() ) ;
+}
+
+inline
+Gr::Slab::const_iterator Gr::Slab::begin() const
+{
+	return const_iterator( this , 0U ) ;
+}
+
+inline
+Gr::Slab::const_iterator Gr::Slab::end() const
+{
+	return const_iterator( this , m_rows.size() ) ;
+}
+
+inline
+char * Gr::Slab::rowData( size_t i )
+{
+	return m_p + m_rows[i].offset ;
+}
+
+inline
+const char * Gr::Slab::rowData( size_t i ) const
+{
+	return m_p + m_rows[i].offset ;
+}
+
+inline
+size_t Gr::Slab::rowSize( size_t i ) const
+{
+	return m_rows[i].size ;
+}
+
+
+inline
+bool Gr::imagebuffer::row_empty( Slab::iterator row_p )
+{
+	return (*row_p).empty() ;
+}
+
+inline
+void Gr::imagebuffer::row_resize( Slab::iterator row_p , size_t n )
+{
+	(*row_p).resize( n ) ;
+}
+
+inline
+Gr::Slab::iterator Gr::imagebuffer::row_erase( Slab & slab , Slab::iterator row_p )
+{
+	return slab.erase( row_p , slab.end() ) ;
+}
+
+inline
+Gr::Slab::const_iterator Gr::imagebuffer::row_begin( const Slab & slab )
+{
+	return slab.begin() ;
+}
+
+inline
+Gr::Slab::iterator Gr::imagebuffer::row_begin( Slab & slab )
+{
+	return slab.begin() ;
+}
+
+inline
+Gr::Slab::const_iterator Gr::imagebuffer::row_end( const Slab & slab )
+{
+	return slab.end() ;
+}
+
+inline
+Gr::Slab::iterator Gr::imagebuffer::row_end( Slab & slab )
+{
+	return slab.end() ;
+}
+
+inline
+Gr::Slab::iterator Gr::imagebuffer::row_add( Slab & slab )
+{
+	slab.push_back() ;
+	return slab.begin() + (slab.size()-1U) ;
+}
+
+inline
+char * Gr::imagebuffer::row_ptr( Slab::iterator row_p )
+{
+	return (*row_p).data() ;
+}
+
+inline
+const char * Gr::imagebuffer::row_ptr( Slab::const_iterator row_p )
+{
+	return (*row_p).data() ;
+}
+
+inline
+size_t Gr::imagebuffer::row_size( Slab::const_iterator row_p )
+{
+	return (*row_p).size() ;
+}
+
+inline
+Gr::imp::slab_const_byte_iterator Gr::imagebuffer::bytes_begin( const Slab & slab )
+{
+	return imp::slab_const_byte_iterator( slab ) ;
+}
+
+inline
+Gr::imp::slab_const_byte_iterator Gr::imagebuffer::bytes_end( const Slab & )
+{
+	return imp::slab_const_byte_iterator() ;
+}
+
+
+inline
+Gr::imp::slab_const_byte_iterator::slab_const_byte_iterator() :
+	m_slab(nullptr) ,
+	m_row(0U) ,
+	m_row_offset(0U) ,
+	m_offset(0U)
+{
+}
+
+inline
+Gr::imp::slab_const_byte_iterator::slab_const_byte_iterator( const Slab & slab ) :
+	m_slab(&slab) ,
+	m_row(0U) ,
+	m_row_offset(0U) ,
+	m_offset(0U)
+{
+	skipEmpty() ;
+}
+
+inline
+bool Gr::imp::slab_const_byte_iterator::atEnd() const
+{
+	return m_slab == nullptr || m_row >= m_slab->size() ;
+}
+
+inline
+void Gr::imp::slab_const_byte_iterator::skipEmpty()
+{
+	while( m_row < m_slab->size() && m_slab->rowSize(m_row) == 0U )
+		m_row++ ;
+}
+
+inline
+char Gr::imp::slab_const_byte_iterator::operator*() const
+{
+	return atEnd() ? '\0' : m_slab->rowData(m_row)[m_row_offset] ;
+}
+
+inline
+Gr::imp::slab_const_byte_iterator & Gr::imp::slab_const_byte_iterator::operator++()
+{
+	if( !atEnd() )
+	{
+		m_offset++ ;
+		m_row_offset++ ;
+		if( m_row_offset == m_slab->rowSize(m_row) )
+		{
+			m_row++ ;
+			m_row_offset = 0U ;
+			skipEmpty() ;
+		}
+	}
+	return *this ;
+}
+
+inline
+Gr::imp::slab_const_byte_iterator Gr::imp::slab_const_byte_iterator::operator++( int )
+{
+	slab_const_byte_iterator orig( *this ) ;
+	++(*this) ;
+	return orig ;
+}
+
+inline
+bool Gr::imp::slab_const_byte_iterator::operator==( const slab_const_byte_iterator & other ) const
+{
+	return
+		( atEnd() && other.atEnd() ) ||
+		( m_slab == other.m_slab && m_offset == other.m_offset ) ;
+}
+
+inline
+bool Gr::imp::slab_const_byte_iterator::operator!=( const slab_const_byte_iterator & other ) const
+{
+	return !( *this == other ) ;
+}
+
+#endif
@@ -645,6 +645,14 @@ it does not scale well and it can lead to crazy-slow startup while looking
 for a matching file. The match name can be changed at run-time by using the
 `--match-name` option on a `move` command sent to the command socket.
 
+Segment files written by `vt-recorder --segments` are played back in the 
+same way as separate image files, and the images within a segment file can 
+be specified on the command-line or in `move` commands using the paths that
+they would have had as separate files. H.264 pictures recorded from 
+`vt-rtpserver --passthrough` are decoded starting from the preceding key 
+frame in the segment, which needs an H.264 decoder such as FFmpeg's 
+libavcodec.
+
 <h3>Usage</h3>
 <p><pre class="fragment">vt-fileplayer [&lt;options&gt;] &lt;directory&gt;</pre></p>
 
@@ -710,6 +718,8 @@ and this is equivalent to `http://<address>/_?streaming=1&type=any`.
     <tr><td>&ndash;&ndash;watchdog-timeout=&lt;seconds&gt;</td><td>watchdog timeout (default 20s)</td></tr>
     <tr><td>&ndash;&ndash;request-timeout=&lt;ms&gt;</td><td>time between http get requests (default 1ms)</td></tr>
     <tr><td>&ndash;&ndash;channel=&lt;channel&gt;</td><td>publish to the named channel</td></tr>
+    <tr><td>&ndash;&ndash;channel-history=&lt;count&gt;</td><td>number of recent images kept in the channel for lead-in</td></tr>
+    <tr><td>&ndash;&ndash;channel-luma=&lt;divisor&gt;</td><td>add a reduced monochrome image to each publication</td></tr>
     <tr><td>&ndash;&ndash;connection-timeout=&lt;seconds&gt;</td><td>connection timeout</td></tr>
     <tr><td>&ndash;&ndash;retry=&lt;seconds&gt;</td><td>retry failed connections or zero to exit (default 1s)</td></tr>
     <tr><td>&ndash;&ndash;once</td><td>exit when the first connection closes</td></tr>
@@ -834,21 +844,28 @@ The recorder enters the fast state on startup (`--fast`) or when it gets a
 program. On entering the fast state any in-memory images from the last few
 seconds are also committed to disk.
 
-A sub-directory called `.cache` is used to hold the recent images that have 
-not been commited to the main image store. These files are held open, and 
-they should not be accessed externally. When the recorder is triggered
-by a `fast` command on the command socket the cached files are moved
-into the main image store so that they provide a lead-in to the event
+The recent images that have not been commited to the main image store are 
+held in memory, up to a limit on the number of images (`--cache-size`) and 
+a limit on their total size in megabytes (`--cache-memory`), so there is no 
+disk activity when the recorder is in the "stopped" state. When the recorder 
+is triggered by a `fast` command on the command socket the cached images are 
+written into the main image store so that they provide a lead-in to the event
 that triggered the recording.
 
-On machines with limited memory the cache size should be tuned so that
-there is no disk activity when the recorder is in the "stopped" state.
-The cache can be completely disabled by setting the cache size to zero, 
-but then there will be no lead-in to recordings triggered by an event.
+On machines with limited memory the `--cache-memory` limit should be tuned to
+suit the image size and the length of lead-in required. The cache can be 
+completely disabled by setting the cache size to zero, but then there will be 
+no lead-in to recordings triggered by an event.
 
 Use `--fast --timeout=0 --cache-size=0` for continuous recording of a 
 channel.
 
+Alternatively, if the publisher keeps a history of recent images in its
+channel (eg. `vt-webcamplayer --channel-history`) then the `--lead-in` 
+option can be used to take the lead-in images directly from the channel's 
+shared memory, with no disk activity at all until the fast state is entered. 
+The in-memory cache is disabled by default in this case.
+
 The `--tz` option is the number of hours added to UTC when constructing
 file system paths under the base directory, so to get local times at western
 longitudes the value should be negative (eg. `--tz=-5`). However, if this 
@@ -870,6 +887,35 @@ root directory by adding a fixed prefix to every image filename. However,
 this approach does not scale well on playback, so only use it for a very
 small number of video streams.
 
+The `--segments` option reduces the number of files by appending the images 
+for each minute into a single segment file that takes the place of the 
+minute's directory. The segment file has an index of the image offsets 
+and timestamps so that `vt-fileplayer` can step through the images as if 
+they were separate files. Each recorder using segment files must have its 
+own base directory. H.264 video published by `vt-rtpserver --passthrough` 
+must be recorded into segment files, in which case the index also marks 
+the pictures that depend on earlier pictures, and the "slow" state only 
+records key frames.
+
+The `--dedupe` option avoids storing repeated copies of a static scene. 
+Each image that is about to be saved is reduced to the average brightness
+of each eight-by-eight block, using only the DC coefficients for JPEG 
+images, and if no block differs from the last image saved in full by more 
+than the given amount then the image is saved as a reference to that 
+image. With separate files the reference is a hard link, and with segment 
+files it is a small record that points back to the earlier image within 
+the same segment. Either way `vt-fileplayer` plays back the timeline as 
+normal.
+
+The `--write-behind` option moves the disk writes onto a background thread
+so that a slow disk does not hold up the reading of the input channel. The 
+option value is the number of images that can be queued, and the 
+`--write-behind-policy` option determines what happens when the queue is 
+full: `drop-new` discards the incoming image, `drop-old` discards the 
+oldest queued image, and `block` waits for space. The queue statistics 
+are logged once a minute, with a warning if any images have been dropped.
+The `--write-behind` option cannot be used with `--user`.
+
 <h3>Usage</h3>
 <p><pre class="fragment">vt-recorder [&lt;options&gt;] &lt;input-channel&gt; &lt;base-dir&gt;</pre></p>
 
@@ -883,10 +929,16 @@ small number of video streams.
     <tr><td>&ndash;&ndash;fast</td><td>start in fast state</td></tr>
     <tr><td>&ndash;&ndash;state=&lt;state&gt;</td><td>state when not fast (slow or stopped, slow by default)</td></tr>
     <tr><td>&ndash;&ndash;tz=&lt;hours&gt;</td><td>timezone offset</td></tr>
-    <tr><td>&ndash;&ndash;cache-size=&lt;files&gt;</td><td>cache size</td></tr>
+    <tr><td>&ndash;&ndash;cache-size=&lt;images&gt;</td><td>cache size</td></tr>
+    <tr><td>&ndash;&ndash;cache-memory=&lt;megabytes&gt;</td><td>cache memory limit</td></tr>
+    <tr><td>&ndash;&ndash;lead-in=&lt;seconds&gt;</td><td>take the lead-in from the channel history rather than the memory cache</td></tr>
     <tr><td>&ndash;&ndash;name=&lt;prefix&gt;</td><td>prefix for all image files (defaults to the channel name)</td></tr>
     <tr><td>&ndash;&ndash;retry=&lt;timeout&gt;</td><td>poll for the input channel to appear</td></tr>
     <tr><td>&ndash;&ndash;once</td><td>exit if the input channel disappears</td></tr>
+    <tr><td>&ndash;&ndash;segments</td><td>record into one file per minute rather than one file per image</td></tr>
+    <tr><td>&ndash;&ndash;dedupe=&lt;luma&gt;</td><td>record unchanged images as references to the last image saved allowing the given change in block brightness</td></tr>
+    <tr><td>&ndash;&ndash;write-behind=&lt;images&gt;</td><td>write to disk from a background thread with a queue of the given size</td></tr>
+    <tr><td>&ndash;&ndash;write-behind-policy=&lt;policy&gt;</td><td>action when the write-behind queue is full (drop-new, drop-old or block)</td></tr>
 </table>
 
 \section rtpserver rtpserver
@@ -908,6 +960,26 @@ be reduced by handling only RTP packets that match certain criteria by
 using the `--filter` option, or by using `--scale` and `--monochrome`
 to reduce the image resolution after decoding.
 
+The `--event-channel` option can be used to publish motion-detection 
+events based on the H.264 encoder's motion vectors, which is much 
+cheaper than decoding images and comparing them with `vt-watcher`. The 
+events have the same format as `vt-watcher` "changes" events, where the 
+"count" is the total area in pixels of the blocks that have moved, so 
+they can be used by `vt-alarm`. Events are only published when the 
+count reaches the `--threshold` value. If the `--viewer` and `--channel`
+options are not used then the images are not converted to RGB at all. 
+This feature needs an H.264 decoder that can export motion vectors, ie.
+a recent version of FFmpeg's libavcodec.
+
+The `--passthrough` option publishes the H.264 video to the channel without
+decoding it, so the published images are H.264 pictures rather than RGB
+images, and `--scale` and `--monochrome` have no effect. This avoids the 
+cost of decoding when the video is only being recorded, and the recording 
+is typically five to ten times smaller than the equivalent JPEG files. The
+pictures must be recorded with `vt-recorder --segments` so that key frames
+can be found again on playback, and they can only be played back by a 
+`vt-fileplayer` that has an H.264 decoder.
+
 Cameras that use RTP will normally be controlled by an RTSP client (such as
 `vt-rtspclient`); the RTSP client asks the camera to start sending
 its video stream to the address that the RTP server is listening on.
@@ -933,11 +1005,16 @@ one another and it is likely that both will stop working.
     <tr><td>&ndash;&ndash;monochrome</td><td>convert to monochrome</td></tr>
     <tr><td>&ndash;&ndash;port=&lt;port&gt;</td><td>listening port</td></tr>
     <tr><td>&ndash;&ndash;channel=&lt;channel&gt;</td><td>publish to the named channel</td></tr>
+    <tr><td>&ndash;&ndash;event-channel=&lt;channel&gt;</td><td>publish motion events derived from h264 motion vectors</td></tr>
+    <tr><td>&ndash;&ndash;threshold=&lt;pixels&gt;</td><td>motion event threshold in pixels (default 256)</td></tr>
+    <tr><td>&ndash;&ndash;channel-history=&lt;count&gt;</td><td>number of recent images kept in the channel for lead-in</td></tr>
+    <tr><td>&ndash;&ndash;channel-luma=&lt;divisor&gt;</td><td>add a reduced monochrome image to each publication</td></tr>
     <tr><td>&ndash;&ndash;address=&lt;ip&gt;</td><td>listening address</td></tr>
     <tr><td>&ndash;&ndash;multicast=&lt;address&gt;</td><td>multicast group address</td></tr>
     <tr><td>&ndash;&ndash;format-file=&lt;path&gt;</td><td>file to read for the H264 format parameters</td></tr>
     <tr><td>&ndash;&ndash;type=&lt;type&gt;</td><td>process packets of one rtp payload type (eg. 26 or 96)</td></tr>
     <tr><td>&ndash;&ndash;jpeg-table=&lt;ff&gt;</td><td>tweak for jpeg quantisation tables (0,1 or 2)</td></tr>
+    <tr><td>&ndash;&ndash;passthrough</td><td>publish h264 video to the channel without decoding</td></tr>
 </table>
 
 \section rtspclient rtspclient
@@ -1054,14 +1131,71 @@ the given threshold value then a motion detection event is emitted.
 
 The `--scale` option also has an important effect because it increases the
 size of the motion detection pixels (by decreasing the resolution of the 
-image), and it affects the interpretation of the threshold value.
+image), and it affects the interpretation of the threshold value. If the
+publisher adds a reduced monochrome image to its channel (eg. 
+`vt-webcamplayer --channel-luma`) with a compatible reduction factor then 
+that is used in preference to decoding the full-size image.
+
+JPEG images are relatively expensive to decode, but a `--scale` value of 8
+allows them to be decoded using only their DC coefficients, giving the 
+average brightness of each eight-by-eight block. Alternatively, the 
+`--dc-gate` option can be used to keep the full resolution while avoiding
+most of the decoding effort when nothing is happening. Each JPEG image is 
+first decoded at one-eighth scale and compared with the image from the 
+last full comparison, and the full decode and comparison are skipped 
+unless at least the given number of the one-eighth scale pixels have 
+changed by more than the squelch value. No events or analysis images are 
+published for the skipped images.
 
 Histogram equalisation is enabled with the `--equalise` option and this can
 be particularly useful for cameras that loose contrast in infra-red mode.
+The equalisation mapping is only recalculated when the image histogram 
+changes significantly, so that small fluctuations in overall brightness 
+do not show up as changed pixels.
+
+The `--background` option selects a different algorithm where each image is
+compared against a background model rather than against the previous image.
+The model holds a running average and variance for every pixel, and a pixel
+is counted as changed if it differs from its average by more than the squelch
+value and by more than three standard deviations. This suppresses false
+alarms from slow lighting changes and from noisy or flickering areas of the 
+image. The option value is the time constant of the model, measured in
+images, with larger values making the background adapt more slowly.
+
+More than one input channel can be given on the command-line, in which case
+the channels are all watched by the one process, sharing the image decoder 
+and the `--threads` thread pool. In this case the `--event-channel`, 
+`--image-channel` and `--command-socket` values must contain `%c`, which 
+is replaced by the input channel name, and the `--recorder`, `--mask` and 
+`--viewer-title` values can also use it. The other options apply to all 
+the channels.
+
+The `--threads` option can be used to spread the image analysis across more 
+than one processor core, with each thread working on a horizontal band of
+the image. Per-stage timings are logged periodically when using `--verbose`.
+
+The `--zones` option divides the image into a grid of zones, such as `4x3`,
+and the changed pixels are then also counted separately for each zone. The
+zone counts are added to the motion detection events, together with a 
+bounding box of the zones that have changes. Each zone can have its own
+threshold by using the `--zone-thresholds` option with a comma-separated 
+list, in row order, where zero means no threshold. A motion detection event 
+is emitted if the overall count reaches the `--threshold` value or if any 
+zone count reaches its own threshold, so one watcher process can do the
+work of several watchers using different masks.
+
+The `--idle-interval` option can be used to save processing power when 
+nothing is happening. If there have been no motion detection events for 
+the `--idle-timeout` period then the comparisons are done at the slower 
+idle interval, and as soon as there is a detection the normal `--interval` 
+is used again. Changes of rate are logged when using `--verbose`. Note that
+a `--background` time constant counts compared images, so the background
+adapts more quickly, in real time, while idle.
 
 The command socket, enabled with the `--command-socket` option, accepts
-`squelch`, `threshold` and `equalise` commands. Multiple commands can
-be sent in one datagram by using semi-colon separators.
+`squelch`, `threshold`, `zone-thresholds`, `equalise` and `idle-interval` 
+commands, and a `status` command that logs the current analysis rate. Multiple 
+commands can be sent in one datagram by using semi-colon separators.
 
 The squelch and threshold values have default values that will need
 fine-tuning for your camera. This can be done interactively by temporarily
@@ -1073,7 +1207,7 @@ Adjust the squelch value to eliminate the green highlights when there is
 no motion. Repeat in different lighting conditions.
 
 <h3>Usage</h3>
-<p><pre class="fragment">vt-watcher [&lt;options&gt;] &lt;input-channel&gt;</pre></p>
+<p><pre class="fragment">vt-watcher [&lt;options&gt;] &lt;input-channel&gt; [&lt;input-channel&gt; ...]</pre></p>
 
 <h3>Options</h3>
 <table class="options_">
@@ -1094,6 +1228,13 @@ no motion. Repeat in different lighting conditions.
     <tr><td>&ndash;&ndash;command-socket=&lt;path&gt;</td><td>socket for update commands</td></tr>
     <tr><td>&ndash;&ndash;plain</td><td>do not show changed-pixel highlights in output images</td></tr>
     <tr><td>&ndash;&ndash;repeat-timeout=&lt;seconds&gt;</td><td>send events repeatedly with the given period</td></tr>
+    <tr><td>&ndash;&ndash;threads=&lt;count&gt;</td><td>number of image analysis threads (default 1)</td></tr>
+    <tr><td>&ndash;&ndash;background=&lt;images&gt;</td><td>use a background model with the given time constant in images</td></tr>
+    <tr><td>&ndash;&ndash;zones=&lt;grid&gt;</td><td>count changes in a grid of zones (eg. 4x3)</td></tr>
+    <tr><td>&ndash;&ndash;zone-thresholds=&lt;list&gt;</td><td>per-zone pixel count thresholds as a comma-separated list</td></tr>
+    <tr><td>&ndash;&ndash;idle-interval=&lt;ms&gt;</td><td>time interval between comparisons when idle (default 0 for no idling)</td></tr>
+    <tr><td>&ndash;&ndash;idle-timeout=&lt;seconds&gt;</td><td>time without detections before idling (default 10)</td></tr>
+    <tr><td>&ndash;&ndash;dc-gate=&lt;pixels&gt;</td><td>skip full comparisons of jpeg images unless enough eighth-scale pixels have changed</td></tr>
 </table>
 
 \section webcamserver webcamserver
@@ -1178,6 +1319,8 @@ longitudes in order to show local time.
     <tr><td>&ndash;&ndash;caption-text=&lt;text&gt;</td><td>defines the caption text in ascii, with %t for a timestamp</td></tr>
     <tr><td>&ndash;&ndash;viewer</td><td>run a viewer</td></tr>
     <tr><td>&ndash;&ndash;channel=&lt;channel&gt;</td><td>publish to the named channel</td></tr>
+    <tr><td>&ndash;&ndash;channel-history=&lt;count&gt;</td><td>number of recent images kept in the channel for lead-in</td></tr>
+    <tr><td>&ndash;&ndash;channel-luma=&lt;divisor&gt;</td><td>add a reduced monochrome image to each publication</td></tr>
     <tr><td>&ndash;&ndash;scale=&lt;divisor&gt;</td><td>reduce the image size</td></tr>
     <tr><td>&ndash;&ndash;tz=&lt;hours&gt;</td><td>timezone offset for the caption</td></tr>
     <tr><td>&ndash;&ndash;monochrome</td><td>convert to monochrome</td></tr>
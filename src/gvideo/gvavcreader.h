@@ -42,12 +42,16 @@ namespace Gv
 class Gv::AvcReaderStream
 {
 public:
-	AvcReaderStream() ;
+	explicit AvcReaderStream( bool motion_vectors = false ) ;
 		///< Default constructor. Since no configuration is supplied
 		///< the decoding will only work once the the required SPS 
 		///< and PPS NALUs have been supplied.
+		///< 
+		///< If the motion-vectors flag is set then the decoder is 
+		///< asked to export its motion vectors so that they can be 
+		///< summarised by Gv::AvcReader::motion().
 
-	explicit AvcReaderStream( const Gr::Avc::Configuration & avcc ) ;
+	explicit AvcReaderStream( const Gr::Avc::Configuration & avcc , bool motion_vectors = false ) ;
 		///< Constructor taking a configuration object.
 
 	~AvcReaderStream() ;
@@ -79,6 +83,20 @@ private:
 class Gv::AvcReader
 {
 public:
+	struct Motion /// Motion statistics for a Gv::AvcReader image, summarising the decoder's motion vectors.
+	{
+		Motion() ;
+		bool valid ; // motion vectors were available
+		unsigned int vectors ; // number of motion vectors, ie. predicted blocks
+		unsigned int moving ; // number of blocks moving by at least the minimum displacement
+		unsigned long area ; // total area of the moving blocks, in pixels
+		unsigned long displacement ; // total displacement of the moving blocks, in pixels
+		int x0 ; // bounding box of the moving blocks
+		int y0 ;
+		int x1 ; // (one-past)
+		int y1 ;
+	} ;
+
 	AvcReader( AvcReaderStream & stream , const char * p , size_t n ) ;
 		///< Constructor taking a complete NALU data buffer, including
 		///< a leading four-byte 00-00-00-01 start code.
@@ -101,6 +119,14 @@ public:
 	bool keyframe() const ;
 		///< Returns true if a key frame.
 
+	Motion motion( unsigned int min_displacement = 1U ) const ;
+		///< Returns a summary of the motion vectors for the decoded picture,
+		///< counting blocks that move by at least the given number of pixels.
+		///< This is much cheaper than comparing decoded images, but it
+		///< needs the stream to be constructed with the motion-vectors flag.
+		///< The result is not valid() if the decoder does not support
+		///< exporting of motion vectors. Key frames have no motion vectors.
+
 	unsigned char r( int x , int y ) const ;
 		///< Returns a pixel red value.
 
@@ -221,6 +247,20 @@ private:
 	Data m_data ;
 } ;
 
+inline
+Gv::AvcReader::Motion::Motion() :
+	valid(false) ,
+	vectors(0U) ,
+	moving(0U) ,
+	area(0UL) ,
+	displacement(0UL) ,
+	x0(0) ,
+	y0(0) ,
+	x1(0) ,
+	y1(0)
+{
+}
+
 inline
 Gv::AvcReader::AvcReader( AvcReaderStream & stream , const char * p , size_t n ) :
 	m_stream(stream)
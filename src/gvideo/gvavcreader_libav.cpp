@@ -27,6 +27,7 @@
 #include "ghexdump.h"
 #include "gassert.h"
 #include <cstring>
+#include <cstdlib> // std::abs
 #include <vector>
 #include <algorithm> // std::max
 #include <iostream>
@@ -66,6 +67,21 @@ extern "C" {
 #endif
 #endif
 //
+//
+#ifndef GCONFIG_LIBAV_MOTION_VECTORS
+#if LIBAVCODEC_VERSION_MAJOR >= 57 && LIBAVCODEC_VERSION_MICRO >= 100 // ffmpeg rather than libav
+#define GCONFIG_LIBAV_MOTION_VECTORS 1
+#else
+#define GCONFIG_LIBAV_MOTION_VECTORS 0
+#endif
+#endif
+//
+#if GCONFIG_LIBAV_MOTION_VECTORS
+extern "C" {
+#include "libavutil/motion_vector.h"
+}
+#endif
+//
 #ifndef AV_PIX_FMT_FLAG_BE
 #define AV_PIX_FMT_FLAG_BE PIX_FMT_BE
 #define AV_PIX_FMT_FLAG_PAL PIX_FMT_PAL
@@ -108,23 +124,25 @@ static void logger( void * p , int level , const char * s , va_list args )
 class Gv::AvcReaderStreamImp
 {
 public:
-	AvcReaderStreamImp() ;
-	explicit AvcReaderStreamImp( const Gr::Avc::Configuration & avcc ) ;
+	explicit AvcReaderStreamImp( bool motion_vectors ) ;
+	AvcReaderStreamImp( const Gr::Avc::Configuration & avcc , bool motion_vectors ) ;
 	~AvcReaderStreamImp() ;
 	void init( const Gr::Avc::Configuration * avcc_p ) ;
 
 public:
 	int m_dx ;
 	int m_dy ;
+	bool m_motion_vectors ;
 	AVCodec * m_codec ;
 	AVCodecContext * m_cc ;
 	std::string m_sps_pps ;
 	AVFrame * m_frame ;
 } ;
 
-Gv::AvcReaderStreamImp::AvcReaderStreamImp() :
+Gv::AvcReaderStreamImp::AvcReaderStreamImp( bool motion_vectors ) :
 	m_dx(0) ,
 	m_dy(0) ,
+	m_motion_vectors(motion_vectors) ,
 	m_codec(nullptr) ,
 	m_cc(nullptr) ,
 	m_frame(nullptr)
@@ -132,9 +150,10 @@ Gv::AvcReaderStreamImp::AvcReaderStreamImp() :
 	init( nullptr ) ;
 }
 
-Gv::AvcReaderStreamImp::AvcReaderStreamImp( const Gr::Avc::Configuration & avcc ) :
+Gv::AvcReaderStreamImp::AvcReaderStreamImp( const Gr::Avc::Configuration & avcc , bool motion_vectors ) :
 	m_dx(0) ,
 	m_dy(0) ,
+	m_motion_vectors(motion_vectors) ,
 	m_codec(nullptr) ,
 	m_cc(nullptr) ,
 	m_frame(nullptr)
@@ -174,6 +193,14 @@ void Gv::AvcReaderStreamImp::init( const Gr::Avc::Configuration * avcc_p )
 		G_ASSERT( m_cc != nullptr ) ;
 		m_cc->debug |= FF_DEBUG_STARTCODE ;
 		m_cc->debug |= FF_DEBUG_PICT_INFO ;
+		if( m_motion_vectors )
+		{
+#if GCONFIG_LIBAV_MOTION_VECTORS
+			m_cc->flags2 |= AV_CODEC_FLAG2_EXPORT_MVS ;
+#else
+			G_WARNING( "Gv::AvcReaderStreamImp::init: motion vectors are not available from this decoder library" ) ;
+#endif
+		}
 	}
 
 	// pass any avcc from a fmtp into to the context
@@ -222,13 +249,13 @@ Gv::AvcReaderStreamImp::~AvcReaderStreamImp()
 
 // ==
 
-Gv::AvcReaderStream::AvcReaderStream() :
-	m_imp(new AvcReaderStreamImp)
+Gv::AvcReaderStream::AvcReaderStream( bool motion_vectors ) :
+	m_imp(new AvcReaderStreamImp(motion_vectors))
 {
 }
 
-Gv::AvcReaderStream::AvcReaderStream( const Gr::Avc::Configuration & avcc ) :
-	m_imp(new AvcReaderStreamImp(avcc))
+Gv::AvcReaderStream::AvcReaderStream( const Gr::Avc::Configuration & avcc , bool motion_vectors ) :
+	m_imp(new AvcReaderStreamImp(avcc,motion_vectors))
 {
 }
 
@@ -446,6 +473,47 @@ bool Gv::AvcReader::keyframe() const
 	return !!m_stream.m_imp->m_frame->key_frame ;
 }
 
+Gv::AvcReader::Motion Gv::AvcReader::motion( unsigned int min_displacement ) const
+{
+	Motion motion ;
+#if GCONFIG_LIBAV_MOTION_VECTORS
+	if( valid() && m_stream.m_imp->m_motion_vectors )
+	{
+		// the side data is an array of AVMotionVector structures with 
+		// block sizes and source and destination block centres -- absent 
+		// for intra-coded pictures
+		motion.valid = true ;
+		motion.x0 = m_data.m_dx ;
+		motion.y0 = m_data.m_dy ;
+		const AVFrameSideData * side_data = av_frame_get_side_data( m_stream.m_imp->m_frame , AV_FRAME_DATA_MOTION_VECTORS ) ;
+		const size_t n = side_data ? ( side_data->size / sizeof(AVMotionVector) ) : 0U ;
+		const AVMotionVector * mv = side_data ? reinterpret_cast<const AVMotionVector*>(side_data->data) : nullptr ;
+		for( size_t i = 0U ; i < n ; i++ , mv++ )
+		{
+			motion.vectors++ ;
+			const unsigned int ddx = static_cast<unsigned int>( std::abs( mv->dst_x - mv->src_x ) ) ;
+			const unsigned int ddy = static_cast<unsigned int>( std::abs( mv->dst_y - mv->src_y ) ) ;
+			const unsigned int d = std::max( ddx , ddy ) ;
+			if( d == 0U || d < min_displacement )
+				continue ;
+
+			motion.moving++ ;
+			motion.area += static_cast<unsigned long>(mv->w) * static_cast<unsigned long>(mv->h) ;
+			motion.displacement += d ;
+			motion.x0 = std::min( motion.x0 , std::max(0,mv->dst_x-mv->w/2) ) ;
+			motion.y0 = std::min( motion.y0 , std::max(0,mv->dst_y-mv->h/2) ) ;
+			motion.x1 = std::max( motion.x1 , std::min(m_data.m_dx,mv->dst_x+(mv->w+1)/2) ) ;
+			motion.y1 = std::max( motion.y1 , std::min(m_data.m_dy,mv->dst_y+(mv->h+1)/2) ) ;
+		}
+		if( motion.moving == 0U )
+			motion.x0 = motion.y0 = 0 ;
+	}
+#else
+	G_IGNORE_PARAMETER( unsigned int , min_displacement ) ;
+#endif
+	return motion ;
+}
+
 template <typename Tout>
 void fill_imp( Tout out_p , const Gv::AvcReader & reader , int scale , bool monochrome_out )
 {
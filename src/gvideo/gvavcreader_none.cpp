@@ -23,11 +23,11 @@
 #include "gvavcreader.h"
 #include <stdexcept>
 
-Gv::AvcReaderStream::AvcReaderStream()
+Gv::AvcReaderStream::AvcReaderStream( bool )
 {
 }
 
-Gv::AvcReaderStream::AvcReaderStream( const Gr::Avc::Configuration & )
+Gv::AvcReaderStream::AvcReaderStream( const Gr::Avc::Configuration & , bool )
 {
 	throw std::runtime_error( "AvcReaderStream not implemented" ) ;
 }
@@ -62,6 +62,11 @@ bool Gv::AvcReader::keyframe() const
 	return false ;
 }
 
+Gv::AvcReader::Motion Gv::AvcReader::motion( unsigned int ) const
+{
+	return Motion() ;
+}
+
 bool Gv::AvcReader::available()
 {
 	return false ;
@@ -0,0 +1,103 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// gvbackgroundmodel.cpp
+//
+
+#include "gdef.h"
+#include "gvbackgroundmodel.h"
+#include "gassert.h"
+#include <algorithm>
+
+namespace
+{
+	const int var_max = 4095 ; // luma-squared, before the 12.4 fixed-point shift
+	const int var_min = 4 ; // ditto
+	const int var_init = 16 ; // ditto
+	const int sigma_squared = 9 ; // three standard deviations
+	const unsigned int slow = 2U ; // extra shift for changed pixels
+
+	inline int step( int delta , unsigned int shift )
+	{
+		// rounds towards zero so that the average does not creep
+		return delta < 0 ? -((-delta) >> shift) : ( delta >> shift ) ;
+	}
+}
+
+Gv::BackgroundModel::BackgroundModel( int dx , int dy , unsigned int time_constant ) :
+	m_dx(std::max(0,dx)) ,
+	m_dy(std::max(0,dy)) ,
+	m_shift(1U) ,
+	m_mean(static_cast<size_t>(m_dx)*static_cast<size_t>(m_dy)) ,
+	m_var(m_mean.size(),static_cast<unsigned short>(var_init<<4))
+{
+	while( m_shift < 12U && (2U<<m_shift) <= time_constant )
+		m_shift++ ;
+}
+
+void Gv::BackgroundModel::init( int y , const unsigned char * row )
+{
+	G_ASSERT( y >= 0 && y < m_dy ) ;
+	const size_t n = static_cast<size_t>(m_dx) ;
+	unsigned short * mean = &m_mean[0] + static_cast<size_t>(y) * n ;
+	unsigned short * var = &m_var[0] + static_cast<size_t>(y) * n ;
+	for( size_t i = 0U ; i < n ; i++ )
+	{
+		mean[i] = static_cast<unsigned short>( row[i] << 8 ) ;
+		var[i] = static_cast<unsigned short>( var_init << 4 ) ;
+	}
+}
+
+void Gv::BackgroundModel::update( int x , int y , size_t n , const unsigned char * row , const unsigned char * mask , 
+	unsigned int squelch , unsigned int & changed_out , unsigned int & unmasked_out , unsigned char * changes_out )
+{
+	G_ASSERT( y >= 0 && y < m_dy && x >= 0 && (x+n) <= static_cast<size_t>(m_dx) ) ;
+	const size_t offset = static_cast<size_t>(y) * static_cast<size_t>(m_dx) + static_cast<size_t>(x) ;
+	unsigned short * mean = &m_mean[0] + offset ;
+	unsigned short * var = &m_var[0] + offset ;
+	const int threshold = static_cast<int>( std::min(squelch,255U) ) ;
+	const unsigned int shift_slow = m_shift + slow ;
+	unsigned int changed = 0U ;
+	unsigned int unmasked = 0U ;
+	for( size_t i = 0U ; i < n ; i++ )
+	{
+		const int d = ( static_cast<int>(row[i]) << 8 ) - static_cast<int>(mean[i]) ;
+		const int ad = ( ( d < 0 ? -d : d ) + 128 ) >> 8 ;
+		const int d2 = std::min( ad * ad , var_max ) << 4 ;
+		const int v = static_cast<int>(var[i]) ;
+
+		// compare
+		const bool masked = mask != nullptr && mask[i] != 0 ;
+		const bool fg = ad > threshold && ( ad * ad * 16 ) > ( sigma_squared * v ) ;
+		if( !masked )
+		{
+			unmasked++ ;
+			if( fg ) changed++ ;
+		}
+		if( changes_out != nullptr )
+			changes_out[i] = ( fg && !masked ) ? 0xff : 0 ;
+
+		// update
+		const unsigned int shift = fg ? shift_slow : m_shift ;
+		mean[i] = static_cast<unsigned short>( static_cast<int>(mean[i]) + step(d,shift) ) ;
+		var[i] = static_cast<unsigned short>( std::max( v + step(d2-v,shift) , var_min << 4 ) ) ;
+	}
+	changed_out += changed ;
+	unmasked_out += unmasked ;
+}
+
+/// \file gvbackgroundmodel.cpp
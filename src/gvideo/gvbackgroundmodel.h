@@ -0,0 +1,101 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gvbackgroundmodel.h
+///
+
+#ifndef GV_BACKGROUND_MODEL__H
+#define GV_BACKGROUND_MODEL__H
+
+#include "gdef.h"
+#include <vector>
+
+namespace Gv
+{
+	class BackgroundModel ;
+}
+
+/// \class Gv::BackgroundModel
+/// A per-pixel background model for motion detection, holding a running 
+/// average and a running variance of each pixel's luma value.
+///
+/// A pixel is counted as changed if it differs from its running average
+/// by more than the squelch value and also by more than three standard
+/// deviations, so pixels that are normally noisy, or that flicker under
+/// infra-red lighting, need a bigger change than pixels that are stable.
+///
+/// The model is updated incrementally by each new image in the same pass 
+/// that does the comparison, using fixed-point exponential averaging with 
+/// a time constant that is a power of two. Changed pixels are absorbed
+/// into the background more slowly than the others.
+///
+/// Rows are independent so different rows can be updated by different 
+/// threads.
+///
+class Gv::BackgroundModel
+{
+public:
+	BackgroundModel( int dx , int dy , unsigned int time_constant ) ;
+		///< Constructor. The time constant is given as a number of images
+		///< and it is rounded down to a power of two. Initialise the
+		///< model with init() before using update().
+
+	int dx() const ;
+		///< Returns the width.
+
+	int dy() const ;
+		///< Returns the height.
+
+	void init( int y , const unsigned char * row ) ;
+		///< Initialises one row of the model from a row of luma values,
+		///< with a small variance.
+
+	void update( int x , int y , size_t n , const unsigned char * p_new , const unsigned char * mask , 
+		unsigned int squelch , unsigned int & changed , unsigned int & unmasked , unsigned char * changes_out ) ;
+			///< Compares a run of n new luma values, starting at pixel (x,y), 
+			///< against the model and then updates the model. Adds to 'changed' 
+			///< the number of unmasked pixels that are not background and adds 
+			///< to 'unmasked' the number that are not masked. The mask run is 
+			///< as per Gv::FrameDiff and it can be null. Optionally writes out 
+			///< a run of flags with 0xff for the changed pixels and zero 
+			///< otherwise.
+
+private:
+	BackgroundModel( const BackgroundModel & ) ;
+	void operator=( const BackgroundModel & ) ;
+
+private:
+	int m_dx ;
+	int m_dy ;
+	unsigned int m_shift ;
+	std::vector<unsigned short> m_mean ; // 8.8 fixed point
+	std::vector<unsigned short> m_var ; // 12.4 fixed point
+} ;
+
+inline
+int Gv::BackgroundModel::dx() const
+{
+	return m_dx ;
+}
+
+inline
+int Gv::BackgroundModel::dy() const
+{
+	return m_dy ;
+}
+
+#endif
@@ -22,50 +22,36 @@
 #include "gstr.h"
 #include "gfile.h"
 #include "groot.h"
-#include "gprocess.h"
 #include "gdatetime.h"
 #include "gvcache.h"
+#include "gvsegment.h"
+#include "gravc.h"
 #include "gassert.h"
 #include "glog.h"
+#include <algorithm>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h> // ::open()
 #include <stdio.h> // ::rename()
+#include <limits.h> // IOV_MAX
 #include <errno.h>
 #include <unistd.h>
 
-Gv::Cache::Cache( const G::Path & base_dir , const std::string & name , size_t size ) :
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+
+Gv::Cache::Cache( const G::Path & base_dir , const std::string & name , size_t size , size_t max_bytes ) :
 	m_base_dir(base_dir) ,
-	m_prefix(name.empty()?std::string():(name+".")) ,
-	m_cache_dir(base_dir+".cache") ,
-	m_list(size) ,
-	m_p(m_list.begin()) ,
-	m_ok(true)
+	m_size(size) ,
+	m_max_bytes(max_bytes) ,
+	m_bytes(0U)
 {
-	G_ASSERT( name.find('/') == std::string::npos ) ;
-	G::Str::replaceAll( m_prefix , "/" , "" ) ;
-
-	G_LOG( "Gv::Cache::ctor: cache dir=[" << m_cache_dir << "] size=" << m_list.size() ) ;
-	if( m_list.size() )
-	{
-		G::Root claim_root ;
-		G::File::mkdirs( m_cache_dir ) ;
-	}
-
-	unsigned int i = 0U ;
-	for( List::iterator p = m_list.begin() ; p != m_list.end() ; ++p , i++ )
-		(*p).cache_path = G::Path(m_cache_dir+(m_prefix+G::Str::fromUInt(i))).str() ;
+	G_LOG( "Gv::Cache::ctor: cache for [" << name << "]: size=" << m_size << " max-bytes=" << m_max_bytes ) ;
 }
 
 Gv::Cache::~Cache()
 {
-	G::Root claim_root ;
-	for( List::iterator p = m_list.begin() ; p != m_list.end() ; ++p )
-	{
-		if( (*p).fd != -1 )
-			::close( (*p).fd ) ;
-		::unlink( (*p).cache_path.c_str() ) ;
-	}
 }
 
 std::string Gv::Cache::base() const
@@ -73,107 +59,185 @@ std::string Gv::Cache::base() const
 	return m_base_dir.str() ;
 }
 
+size_t Gv::Cache::bytes() const
+{
+	return m_bytes ;
+}
+
 void Gv::Cache::fail( const char * where )
 {
 	G_DEBUG( "Gv::Cache::fail: failed: " << where ) ;
 	G_WARNING_ONCE( "Gv::Cache::fail: one or more cache failures" ) ;
-	m_ok = false ;
 }
 
-void Gv::Cache::store( const Gr::ImageBuffer & image_buffer , const std::string & commit_path , 
-	const std::string & commit_path_other , const std::string & same_as_path )
+void Gv::Cache::store( const Gr::Image & image , const std::string & commit_path , 
+	const std::string & commit_path_other , const std::string & same_as_path , G::EpochTime time )
 {
-	if( m_list.empty() ) return ;
-	if( ++m_p == m_list.end() )
-		m_p = m_list.begin() ;
+	const size_t n = image.size() ;
+	if( m_size == 0U || n > m_max_bytes || image.empty() ) 
+		return ;
 
-	Entry & e = *m_p ;
+	m_list.push_back( Entry() ) ;
+	Entry & e = m_list.back() ;
+	e.image = image ;
 	e.commit_path = commit_path ;
 	e.commit_path_other = commit_path_other ;
 	e.same_as_path = same_as_path ;
-	open( e ) ;
-	write( e , image_buffer ) ;
-}
+	e.time = time ;
+	m_bytes += n ;
 
-void Gv::Cache::open( Entry & e )
-{
-	if( e.fd == -1 ) 
+	// discard the oldest
+	while( m_list.size() > m_size || m_bytes > m_max_bytes )
 	{
-		{
-			G::Root claim_root ;
-			e.fd = ::open( e.cache_path.c_str() , O_CREAT | O_TRUNC | O_WRONLY , 
-				S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH ) ;
-		}
-		if( e.fd == -1 ) 
-			fail( "open" ) ;
+		m_bytes -= m_list.front().image.size() ;
+		m_list.pop_front() ;
 	}
 }
 
-void Gv::Cache::write( Entry & e , const Gr::ImageBuffer & image_buffer )
+void Gv::Cache::commit( bool other )
 {
-	if( ::lseek( e.fd , 0L , SEEK_SET ) < 0 ) 
-		fail( "lseek" ) ;
+	G_DEBUG( "Gv::Cache::commit: commiting " << m_list.size() ) ;
+	for( List::iterator p = m_list.begin() ; p != m_list.end() ; ++p )
+		commit( *p , other ) ;
+	m_list.clear() ;
+	m_bytes = 0U ;
+}
 
-	typedef Gr::traits::imagebuffer<Gr::ImageBuffer>::const_row_iterator row_iterator ;
-	for( row_iterator part_p = Gr::imagebuffer::row_begin(image_buffer) ; part_p != Gr::imagebuffer::row_end(image_buffer) ; ++part_p )
-	{
-		const char * p = Gr::imagebuffer::row_ptr( part_p ) ;
-		size_t n = Gr::imagebuffer::row_size( part_p ) ;
-		if( n != 0U && ::write( e.fd , p , n ) != static_cast<ssize_t>(n) ) 
-		{
-			fail( "write" ) ;
-			break ;
-		}
-	}
+void Gv::Cache::commit( Entry & e , bool other )
+{
+	const std::string & commit_path = other && !e.commit_path_other.empty() ? e.commit_path_other : e.commit_path ;
+	if( !e.same_as_path.empty() && move(e.same_as_path,commit_path) ) // avoid duplication
+		return ;
+
+	if( !write(e,commit_path) )
+		fail( "write" ) ;
 }
 
-void Gv::Cache::commit( bool other )
+void Gv::Cache::commit( Gv::SegmentWriter & segments , bool other )
 {
-	size_t n = 0U ;
+	G_DEBUG( "Gv::Cache::commit: commiting " << m_list.size() << " into segments" ) ;
 	for( List::iterator p = m_list.begin() ; p != m_list.end() ; ++p )
+		commit( *p , other , segments ) ;
+	m_list.clear() ;
+	m_bytes = 0U ;
+}
+
+void Gv::Cache::commit( Entry & e , bool other , Gv::SegmentWriter & segments )
+{
+	if( !e.same_as_path.empty() ) // already saved
+		return ;
+
+	const std::string & commit_path = other && !e.commit_path_other.empty() ? e.commit_path_other : e.commit_path ;
+	const std::string head = header( e.image.type() ) ;
+	Gv::SegmentWriter::Parts parts ;
+	if( !head.empty() )
+		parts.push_back( std::make_pair(head.data(),head.size()) ) ;
+	typedef Gr::traits::imagebuffer<Gr::ImageBuffer>::const_row_iterator row_iterator ;
+	const Gr::ImageBuffer & buffer = e.image.data() ;
+	for( row_iterator part_p = Gr::imagebuffer::row_begin(buffer) ; part_p != Gr::imagebuffer::row_end(buffer) ; ++part_p )
+		parts.push_back( std::make_pair(Gr::imagebuffer::row_ptr(part_p),Gr::imagebuffer::row_size(part_p)) ) ;
+
+	const bool dependent = e.image.type().isAvc() && 
+		( parts.empty() || !Gr::Avc::ByteStream::keyframe( parts[0].first , parts[0].second ) ) ;
+
+	if( !segments.write( commit_path , e.time.s ? e.time : G::DateTime::now() , parts , dependent ) && !write(e,commit_path) )
+		fail( "write" ) ;
+}
+
+std::string Gv::Cache::header( const Gr::ImageType & type )
+{
+	// raw images are committed as 'portable-anymap' files, as per ImageOutput
+	std::string s ;
+	if( type.isRaw() )
 	{
-		if( (*p).fd >= 0 )
-		{
-			commit( *p , other ) ;
-			n++ ;
-		}
+		s.append( type.channels()==1 ? "P5\n" : "P6\n" ) ;
+		s.append( G::Str::fromInt(type.dx()) ).append( 1U , ' ' ).append( G::Str::fromInt(type.dy()) ) ;
+		s.append( "\n255\n" ) ;
 	}
-	G_DEBUG( "Gv::Cache::commit: commited " << n << "/" << m_list.size() ) ;
+	return s ;
 }
 
-void Gv::Cache::commit( Entry & e , bool other )
+bool Gv::Cache::write( const Entry & e , const std::string & path )
 {
-	close( e ) ;
-	const std::string & commit_path = other && !e.commit_path_other.empty() ? e.commit_path_other : e.commit_path ;
-	if( !e.same_as_path.empty() && move(e.same_as_path,commit_path) ) // avoid duplication
+	// gather the image rows into one iovec list
+	const std::string head = header( e.image.type() ) ;
+	m_iov.clear() ;
+	if( !head.empty() )
+	{
+		struct ::iovec io ;
+		io.iov_base = const_cast<char*>(head.data()) ;
+		io.iov_len = head.size() ;
+		m_iov.push_back( io ) ;
+	}
+	typedef Gr::traits::imagebuffer<Gr::ImageBuffer>::const_row_iterator row_iterator ;
+	const Gr::ImageBuffer & buffer = e.image.data() ;
+	for( row_iterator part_p = Gr::imagebuffer::row_begin(buffer) ; part_p != Gr::imagebuffer::row_end(buffer) ; ++part_p )
+	{
+		struct ::iovec io ;
+		io.iov_base = const_cast<char*>(Gr::imagebuffer::row_ptr(part_p)) ;
+		io.iov_len = Gr::imagebuffer::row_size(part_p) ;
+		if( io.iov_len != 0U )
+			m_iov.push_back( io ) ;
+	}
+
+	int fd = -1 ;
+	int err = 0 ;
 	{
 		G::Root claim_root ;
-		G::File::remove( e.cache_path , G::File::NoThrow() ) ;
+		fd = ::open( path.c_str() , O_WRONLY | O_CREAT | O_TRUNC , 
+			S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH ) ;
+		err = errno ;
 	}
-	else
+	if( fd < 0 && err == ENOENT )
 	{
-		move( e.cache_path , commit_path ) ;
+		mkdirs( path ) ;
+		G::Root claim_root ;
+		fd = ::open( path.c_str() , O_WRONLY | O_CREAT | O_TRUNC , 
+			S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH ) ;
 	}
-}
+	if( fd < 0 )
+		return false ;
 
-void Gv::Cache::close( Entry & e )
-{
-	int fd = e.fd ;
-	e.fd = -1 ;
-	if( ::close( fd ) < 0 )
-		fail( "close" ) ;
+	// normally one writev() call, but allow for IOV_MAX and short writes
+	bool ok = true ;
+	for( size_t i = 0U ; ok && i < m_iov.size() ; )
+	{
+		int count = static_cast<int>( std::min(m_iov.size()-i,size_t(IOV_MAX)) ) ;
+		ssize_t rc = ::writev( fd , &m_iov[i] , count ) ;
+		if( rc < 0 && errno == EINTR )
+			continue ;
+		ok = rc > 0 ;
+		for( size_t n = ok ? static_cast<size_t>(rc) : 0U ; n != 0U ; )
+		{
+			if( n >= m_iov[i].iov_len )
+			{
+				n -= m_iov[i].iov_len ;
+				i++ ;
+			}
+			else
+			{
+				m_iov[i].iov_base = static_cast<char*>(m_iov[i].iov_base) + n ;
+				m_iov[i].iov_len -= n ;
+				n = 0U ;
+			}
+		}
+	}
+	ok = ::close( fd ) == 0 && ok ;
+	G_DEBUG( "Gv::Cache::write: [" << path << "]" << (ok?"":": failed") ) ;
+	return ok ;
 }
 
 bool Gv::Cache::move( const std::string & src , const std::string & dst )
 {
 	int rc = -1 ;
+	int err = 0 ;
 	{
 		G::Root claim_root ;
 		rc = ::rename( src.c_str() , dst.c_str() ) ;
+		err = errno ;
 	}
 	if( rc < 0 )
 	{
-		int err = errno ;
 		if( err == ENOENT )
 		{
 			mkdirs( dst ) ;
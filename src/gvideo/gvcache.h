@@ -22,41 +22,49 @@
 #define GV_CACHE__H
 
 #include "gdef.h"
-#include "grimagebuffer.h"
+#include "grimage.h"
 #include "gexception.h"
 #include "gpath.h"
+#include "gdatetime.h"
+#include <deque>
 #include <vector>
+#include <sys/uio.h> // ::iovec
 #include <string>
 
 namespace Gv
 {
 	class Cache ;
+	class SegmentWriter ;
 }
 
 /// \class Gv::Cache
 /// A queue of recent images that can be flushed to the filesystem on demand.
 /// 
-/// The implementation keeps a large set of cache files open and re-writes them 
-/// on a least-recently used basis. When a commit is requested the files are 
-/// closed and moved into their proper place (see ImageOutput). By keeping the 
-/// files open the images live in the kernel's buffer cache and do not need to 
-/// hit the filesystem at all.
+/// The images are held in memory as shared Gr::Image references, up to a 
+/// limit on the number of images and a limit on their total size, with the 
+/// oldest images discarded first. Nothing is written to disk until a commit 
+/// is requested, at which point each image is written to its proper place
+/// (see ImageOutput) with a single vectored write.
 /// 
 class Gv::Cache
 {
 public:
 	G_EXCEPTION( Error , "cache error" ) ;
 
-	explicit Cache( const G::Path & base_dir , const std::string & name , size_t size ) ;
-		///< Constructor. Paths are like "<base-dir>/.cache/<name>.123".
+	Cache( const G::Path & base_dir , const std::string & name , size_t size , size_t max_bytes ) ;
+		///< Constructor. The name is used only for logging. The cache 
+		///< holds at most 'size' images and at most 'max_bytes' of 
+		///< image data.
 
 	~Cache() ;
 		///< Destructor.
 
-	void store( const Gr::ImageBuffer & , const std::string & commit_path , 
+	void store( const Gr::Image & , const std::string & commit_path , 
 		const std::string & commit_path_other = std::string() ,
-		const std::string & same_as = std::string() ) ;
-			///< Stores an image in the cache.
+		const std::string & same_as = std::string() ,
+		G::EpochTime time = G::EpochTime(0) ) ;
+			///< Stores an image in the cache. The image data is shared,
+			///< not copied.
 			///< 
 			///< An alternate path for the committed file can be supplied,
 			///< with the choice dictated by a parameter passed to commit().
@@ -67,49 +75,55 @@ public:
 			///< cached version. (In practice this avoids duplicates
 			///< when recording in slow mode and then switching to fast
 			///< mode with an associated flush of the cache.)
+			///<
+			///< The timestamp is only used by the segment-file
+			///< overload of commit().
 
 	void commit( bool other = false ) ;
-		///< Commits all cached images to their non-cache location.
+		///< Commits all cached images to their non-cache location,
+		///< oldest first, and empties the cache.
+
+	void commit( Gv::SegmentWriter & , bool other = false ) ;
+		///< Commits all cached images into segment files, oldest
+		///< first, and empties the cache. Images with a "same-as" 
+		///< path are already saved so they are just discarded.
 
 	std::string base() const ;
 		///< Returns the base directory, as passed to the constructor.
 
+	size_t bytes() const ;
+		///< Returns the total size of the cached image data.
+
 private:
 	struct Entry 
 	{ 
-		Entry( int fd_ = -1 , const std::string & cache_path_ = std::string() , const std::string & commit_path_ = std::string() ) : 
-			fd(fd_) , 
-			cache_path(cache_path_) , 
-			commit_path(commit_path_)
-		{
-		}
-		int fd ; 
-		std::string cache_path ; 
+		Gr::Image image ;
 		std::string commit_path ; 
 		std::string commit_path_other ; 
 		std::string same_as_path ;
+		G::EpochTime time ;
+		Entry() : time(0) {}
 	} ;
 
 private:
 	Cache( const Cache & ) ;
 	void operator=( const Cache & ) ;
-	std::string commitPath( const std::string & , G::EpochTime ) const ;
 	void fail( const char * where ) ;
-	void open( Entry & e ) ;
-	void write( Entry & e , const Gr::ImageBuffer & ) ;
 	void commit( Entry & e , bool ) ;
-	void close( Entry & e ) ;
+	void commit( Entry & e , bool , Gv::SegmentWriter & ) ;
+	bool write( const Entry & e , const std::string & path ) ;
 	bool move( const std::string & src , const std::string & dst ) ;
 	void mkdirs( const G::Path & path ) ;
+	static std::string header( const Gr::ImageType & ) ;
 
 private:
-	typedef std::vector<Entry> List ;
+	typedef std::deque<Entry> List ;
 	G::Path m_base_dir ;
-	std::string m_prefix ;
-	G::Path m_cache_dir ;
+	size_t m_size ;
+	size_t m_max_bytes ;
+	size_t m_bytes ;
 	List m_list ;
-	List::iterator m_p ;
-	bool m_ok ;
+	std::vector<struct ::iovec> m_iov ;
 } ;
 
 #endif
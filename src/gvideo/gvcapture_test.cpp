@@ -67,6 +67,7 @@ Gv::CaptureTest::CaptureTest( const std::string & config , ImageGenerator * gene
 			CaptureBufferComponent( 0 , 0 , 0 , 2 ) ,
 			CaptureBufferComponent( 1 , 1 , 0 , 4 ) ,
 			CaptureBufferComponent( 3 , 1 , 0 , 4 ) ) ;
+		m_converter = CaptureConverter( m_format , m_scale , CaptureConverter::isa(config) ) ;
 	}
 
 	createSockets() ;
@@ -161,7 +162,7 @@ bool Gv::CaptureTest::active() const
 
 std::string Gv::CaptureTest::info() const
 {
-	return std::string() ;
+	return std::string("converter=") + m_converter.name() ;
 }
 
 void Gv::CaptureTest::readSocket()
@@ -190,7 +191,7 @@ bool Gv::CaptureTest::read( CaptureCallback & callback )
 	readSocket() ;
 
 	// create the image
-	m_buffer->setFormat( m_format , m_scale ) ;
+	m_buffer->setFormat( m_format , m_scale , &m_converter ) ;
 	m_generator->fillBuffer( *m_buffer.get() , m_scale ) ;
 
 	// callback op()()
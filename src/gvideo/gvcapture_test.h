@@ -26,6 +26,7 @@
 #include "gtimer.h"
 #include "gvcapture.h"
 #include "gvcapturebuffer.h"
+#include "gvcaptureconverter.h"
 #include "gvimagegenerator.h"
 
 namespace Gv
@@ -100,6 +101,7 @@ private:
 	int m_fd_write ;
 	CaptureBufferFormat m_format ;
 	CaptureBufferScale m_scale ;
+	CaptureConverter m_converter ;
 	unique_ptr<CaptureBuffer> m_buffer ;
 	std::string m_config ;
 	GNet::Timer<CaptureTest> m_timer ;
@@ -174,6 +174,8 @@ Gv::CaptureV4l::CaptureV4l( const std::string & dev_name , const std::string & d
 	m_fd = open_device( dev_name ) ;
 	m_io = check_device( m_fd , dev_config ) ;
 	m_buffer_scale = init_device( dev_config ) ;
+	m_converter = CaptureConverter( m_format , m_buffer_scale , CaptureConverter::isa(dev_config) ) ;
+	G_LOG( "Gv::CaptureV4l::ctor: pixel format converter: " << m_converter.name() ) ;
 	create_buffers( m_buffer_scale.m_buffersize , dev_config ) ;
 	add_buffers() ;
 	start() ;
@@ -214,7 +216,8 @@ std::string Gv::CaptureV4l::info() const
 		<< "io=" << (m_simple?"simple-":"") << (m_io==IO_METHOD_READ?"read":(m_io==IO_METHOD_MMAP?"mmap":"userptr")) << " "
 		<< "dx=" << m_dx << " dy=" << m_dy << " "
 		<< "format=[" << m_format.name() << "] "
-		<< "fourcc=[" << fourcc(m_format.id()) << "]" ;
+		<< "fourcc=[" << fourcc(m_format.id()) << "] "
+		<< "converter=" << m_converter.name() ;
 	return ss.str() ;
 }
 
@@ -287,7 +290,7 @@ bool Gv::CaptureV4l::read_frame_read( CaptureCallback & callback )
 		CaptureImp::throw_errno( "read" , e ) ;
 	}
 	Gv::CaptureBuffer & buffer = *m_buffers[0] ;
-	buffer.setFormat( m_format , m_buffer_scale ) ;
+	buffer.setFormat( m_format , m_buffer_scale , &m_converter ) ;
 	callback( buffer ) ;
 	return true ;
 }
@@ -308,7 +311,7 @@ bool Gv::CaptureV4l::read_frame_mmap( CaptureCallback & callback )
 	G_ASSERT( m_buffers.size() >= 1U ) ;
 	G_ASSERT( buf.index < m_buffers.size() ) ;
 	Gv::CaptureBuffer & buffer = *m_buffers[buf.index] ;
-	buffer.setFormat( m_format , m_buffer_scale ) ;
+	buffer.setFormat( m_format , m_buffer_scale , &m_converter ) ;
 	callback( buffer ) ;
 	return true ;
 }
@@ -339,7 +342,7 @@ bool Gv::CaptureV4l::read_frame_userptr( CaptureCallback & callback )
 		throw Capture::Error( "buffer not found" ) ;
 
 	Gv::CaptureBuffer & buffer = *m_buffers[i] ;
-	buffer.setFormat( m_format , m_buffer_scale ) ;
+	buffer.setFormat( m_format , m_buffer_scale , &m_converter ) ;
 	callback( buffer ) ;
 	return true ;
 }
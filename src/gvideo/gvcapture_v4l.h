@@ -25,6 +25,7 @@
 #include "gvcapture.h"
 #include "gvcapture_v4l.h"
 #include "gvcapturebuffer.h"
+#include "gvcaptureconverter.h"
 #include <string>
 #include <vector>
 
@@ -56,7 +57,7 @@ public:
 	CaptureV4l( const std::string & dev_name , const std::string & dev_config ) ;
 		///< Constructor. Opens the video device, with optional device-specific
 		///< configuration that can include "buffers=<n>", "nolibv4l", "mmap", 
-		///< "read", "userptr", and "fmt=<n>". The number of buffers should
+		///< "read", "userptr", "nosimd", "noavx2" and "fmt=<n>". The number of buffers should
 		///< be small to reduce latency, or larger for better throughput.
 
 	~CaptureV4l() ;
@@ -134,6 +135,7 @@ private:
 	bool m_active ;
 	CaptureBufferFormat m_format ;
 	CaptureBufferScale m_buffer_scale ;
+	CaptureConverter m_converter ;
 	bool m_simple ;
 } ;
 
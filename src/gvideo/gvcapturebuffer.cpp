@@ -20,6 +20,7 @@
 
 #include "gdef.h"
 #include "gvcapturebuffer.h"
+#include "gvcaptureconverter.h"
 #include <stdexcept>
 #include <sys/mman.h> // munmap
 #include <stdlib.h>
@@ -40,6 +41,7 @@ namespace
 
 Gv::CaptureBuffer::CaptureBuffer( size_t length ) :
 	m_format(nullptr) ,
+	m_converter(nullptr) ,
 	m_freeme(nullptr) ,
 	m_start(nullptr) ,
 	m_length(length) ,
@@ -53,6 +55,7 @@ Gv::CaptureBuffer::CaptureBuffer( size_t length ) :
 
 Gv::CaptureBuffer::CaptureBuffer( size_t length , void * p , int (*unmap)(void*,size_t) ) :
 	m_format(nullptr) ,
+	m_converter(nullptr) ,
 	m_freeme(nullptr) ,
 	m_start(p) ,
 	m_length(length) ,
@@ -64,6 +67,7 @@ Gv::CaptureBuffer::CaptureBuffer( size_t length , void * p , int (*unmap)(void*,
 
 Gv::CaptureBuffer::CaptureBuffer( size_t page_size , size_t buffer_size ) :
 	m_format(nullptr) ,
+	m_converter(nullptr) ,
 	m_length(size4(buffer_size)) ,
 	m_unmap(0)
 {
@@ -85,10 +89,12 @@ Gv::CaptureBuffer::~CaptureBuffer()
 	}
 }
 
-void Gv::CaptureBuffer::setFormat( const CaptureBufferFormat & f , const CaptureBufferScale & s )
+void Gv::CaptureBuffer::setFormat( const CaptureBufferFormat & f , const CaptureBufferScale & s , 
+	const CaptureConverter * converter )
 {
 	m_format = &f ;
 	m_scale = s ;
+	m_converter = converter ;
 	checkFormat() ;
 }
 
@@ -110,6 +116,7 @@ void Gv::CaptureBuffer::checkFormat() const
 
 void Gv::CaptureBuffer::copyTo( Gr::ImageData & data ) const
 {
+	G_ASSERT( data.dx() == int(m_scale.m_dx) && data.dy() == int(m_scale.m_dy) ) ;
 	if( m_format->is_simple() && m_scale.is_simple(data.dx(),data.dy()) && data.channels() == 3 ) // optimisation
 	{
 		G_ASSERT( data.rowsize() == m_scale.m_linesize ) ;
@@ -120,6 +127,26 @@ void Gv::CaptureBuffer::copyTo( Gr::ImageData & data ) const
 			std::memcpy( data.row(y) , p_in , rowsize ) ;
 		}
 	}
+	else if( m_converter != nullptr && data.channels() == 3 && m_converter->rgb() )
+	{
+		for( size_t y = 0U ; y < m_scale.m_dy ; y++ )
+			m_converter->rgb( begin() , y , data.row(y) ) ;
+	}
+	else if( m_converter != nullptr && data.channels() == 1 && m_converter->luma() )
+	{
+		for( size_t y = 0U ; y < m_scale.m_dy ; y++ )
+			m_converter->luma( begin() , y , data.row(y) ) ;
+	}
+	else if( data.channels() == 1 )
+	{
+		for( size_t y = 0U ; y < m_scale.m_dy ; y++ )
+		{
+			CaptureBufferIterator bp = row( y ) ;
+			unsigned char * p_out = data.row( y ) ;
+			for( size_t x = 0U ; x < m_scale.m_dx ; x++ , ++bp )
+				*p_out++ = bp.luma() ;
+		}
+	}
 	else
 	{
 		for( size_t y = 0U ; y < m_scale.m_dy ; y++ )
@@ -147,6 +174,12 @@ void Gv::CaptureBuffer::copy( int dx , int dy , unsigned char * p_out , size_t n
 		G_ASSERT( n_out == size() ) ;
 		std::memcpy( p_out , begin() , std::min(n_out,size()) ) ;
 	}
+	else if( m_converter != nullptr && m_converter->rgb() && size_t(dx) == m_scale.m_dx && size_t(dy) == m_scale.m_dy )
+	{
+		const size_t rowsize = size_t(dx) * 3U ;
+		for( int y = 0 ; y < dy ; y++ , p_out += rowsize )
+			m_converter->rgb( begin() , y , p_out ) ;
+	}
 	else
 	{
 		unsigned char * const p_end = p_out + n_out ;
@@ -34,6 +34,7 @@ namespace Gv
 	class CaptureBufferScale ;
 	class CaptureBufferComponent ;
 	class CaptureBufferIterator ;
+	class CaptureConverter ;
 }
 
 /// \class Gv::CaptureBufferScale
@@ -70,7 +71,8 @@ public:
 /// the video device; the setFormat() must be used to tell the buffer what
 /// format it contains. The accessor methods row() and copy()/copyTo() can then 
 /// be used to extract RGB pixels. The low-level pixelformat conversion is 
-/// performed by the Gv::CaptureBufferIterator class.
+/// performed a row at a time by an optional Gv::CaptureConverter, or 
+/// otherwise pixel by pixel by the Gv::CaptureBufferIterator class.
 /// 
 class Gv::CaptureBuffer
 {
@@ -102,12 +104,15 @@ public:
 	CaptureBufferIterator row( int y ) const ;
 		///< Returns a pixel iterator for the y'th row.
 
-	void setFormat( const CaptureBufferFormat & , const CaptureBufferScale & ) ;
-		///< Used by the Gv::Capture class to imbue the buffer with a particular
-		///< format description and scale.
+	void setFormat( const CaptureBufferFormat & , const CaptureBufferScale & , 
+		const CaptureConverter * converter = nullptr ) ;
+			///< Used by the Gv::Capture class to imbue the buffer with a particular
+			///< format description and scale, and optionally a row converter
+			///< for the same format and scale.
 
 	void copyTo( Gr::ImageData & ) const ;
-		///< Copies the image to a correctly-sized image data buffer.
+		///< Copies the image to a correctly-sized image data buffer, 
+		///< which can have one channel (luma) or three (rgb).
 
 	void copy( int dx , int dy , char * p_out , size_t out_size ) const ;
 		///< Copies the image to an rgb output buffer.
@@ -140,6 +145,7 @@ private:
 private:
 	const CaptureBufferFormat * m_format ;
 	CaptureBufferScale m_scale ;
+	const CaptureConverter * m_converter ;
 	mutable void * m_freeme ;
 	mutable void * m_start ;
 	size_t m_length ;
@@ -182,6 +188,10 @@ public:
 		///< the depth is eight, the shift is zero, the step is three,
 		///< and the offset matches the parameter.
 
+	bool is_byte() const ;
+		///< Returns true if the component values are whole bytes,
+		///< ie. the depth is eight and the shift is zero.
+
 	unsigned short xshift() const ;
 		///< Returns the x_shift.
 
@@ -419,6 +429,12 @@ bool Gv::CaptureBufferComponent::is_simple() const
 	return m_simple && m_x_shift == 0 && m_y_shift == 0 && m_step == 3 ;
 }
 
+inline
+bool Gv::CaptureBufferComponent::is_byte() const
+{
+	return m_simple ;
+}
+
 inline
 bool Gv::CaptureBufferComponent::is_simple( size_t offset ) const
 {
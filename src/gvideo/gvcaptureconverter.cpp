@@ -0,0 +1,492 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// gvcaptureconverter.cpp
+//
+
+#include "gdef.h"
+#include "gvcaptureconverter.h"
+#include "grcolourspace.h"
+#include "gstr.h"
+#include "gassert.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) ) && defined(__SSE2__)
+#define GV_CAPTURE_CONVERTER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	// the scalar kernels use the Gr::ColourSpace lookup tables, but the simd 
+	// kernels use BT.601 in fixed point: y is clamped to 16..235 and uv to 
+	// 16..240, the values are scaled up by 128 and multiplied by 2^14-scaled 
+	// coefficients keeping the high word (ie. 'pmulhw'), and the result 
+	// has five fractional bits -- every intermediate fits in a signed 
+	// 16-bit word and the result is within one of the lookup tables
+	//
+	g__constexpr int c_y = 19077 ; // 1.164
+	g__constexpr int c_rv = 26185 ; // 1.596
+	g__constexpr int c_gu = 6423 ; // 0.392
+	g__constexpr int c_gv = 13320 ; // 0.813
+	g__constexpr int c_bu = 293 ; // 2.017 - 2
+	g__constexpr int c_round = 15 ;
+
+	inline void yuv_to_rgb( unsigned char y , unsigned char u , unsigned char v , unsigned char * out )
+	{
+		const Gr::ColourSpace::triple<unsigned char> rgb = 
+			Gr::ColourSpace::rgb_int( Gr::ColourSpace::triple<unsigned char>(y,u,v) ) ;
+		out[0] = rgb.r() ;
+		out[1] = rgb.g() ;
+		out[2] = rgb.b() ;
+	}
+
+	// scalar kernels, also used for the right-hand tail of each row by the
+	// simd kernels -- YSTEP is the luma step and CSTEP the chroma step per
+	// pair of pixels
+	//
+	template <int YSTEP, int CSTEP>
+	void rgb_row_scalar( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 ,
+		unsigned char * out , int x , int dx )
+	{
+		for( out += x*3 ; x < dx ; x++ , out += 3 )
+			yuv_to_rgb( p0[x*YSTEP] , p1[(x>>1)*CSTEP] , p2[(x>>1)*CSTEP] , out ) ;
+	}
+
+	template <int YSTEP>
+	void luma_row_scalar( const unsigned char * p0 , unsigned char * out , int x , int dx )
+	{
+		for( ; x < dx ; x++ )
+			out[x] = p0[x*YSTEP] ;
+	}
+
+	void rgb_packed_scalar( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		rgb_row_scalar<2,4>( p0 , p1 , p2 , out , 0 , dx ) ;
+	}
+
+	void rgb_planar_scalar( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		rgb_row_scalar<1,1>( p0 , p1 , p2 , out , 0 , dx ) ;
+	}
+
+	void rgb_semiplanar_scalar( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		rgb_row_scalar<1,2>( p0 , p1 , p2 , out , 0 , dx ) ;
+	}
+
+	void luma_packed_scalar( const unsigned char * p0 , const unsigned char * , const unsigned char * , unsigned char * out , int dx )
+	{
+		luma_row_scalar<2>( p0 , out , 0 , dx ) ;
+	}
+
+	void luma_copy( const unsigned char * p0 , const unsigned char * , const unsigned char * , unsigned char * out , int dx )
+	{
+		std::memcpy( out , p0 , dx ) ;
+	}
+
+	// the packed and semi-planar kernels work from the start of the
+	// interleaved data, with flags for the byte order
+	//
+	struct Packing
+	{
+		Packing( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , bool packed ) :
+			base(packed?std::min(p0,std::min(p1,p2)):std::min(p1,p2)) ,
+			y_odd(packed&&p0!=base) ,
+			u_first(p1<p2)
+		{
+		}
+		const unsigned char * base ;
+		bool y_odd ; // luma in the odd bytes, eg. uyvy
+		bool u_first ; // u before v, eg. yuyv, nv12
+	} ;
+}
+
+#ifdef GV_CAPTURE_CONVERTER_X86
+namespace
+{
+	// == SSE2
+
+	inline void rgb8_sse2( __m128i y , __m128i u , __m128i v , __m128i & r , __m128i & g , __m128i & b )
+	{
+		// eight pixels, with y, u and v in the low bytes of each word
+		y = _mm_slli_epi16( _mm_sub_epi16( _mm_min_epi16( _mm_max_epi16( y , _mm_set1_epi16(16) ) , _mm_set1_epi16(235) ) , _mm_set1_epi16(16) ) , 7 ) ;
+		u = _mm_slli_epi16( _mm_sub_epi16( _mm_min_epi16( _mm_max_epi16( u , _mm_set1_epi16(16) ) , _mm_set1_epi16(240) ) , _mm_set1_epi16(128) ) , 7 ) ;
+		v = _mm_slli_epi16( _mm_sub_epi16( _mm_min_epi16( _mm_max_epi16( v , _mm_set1_epi16(16) ) , _mm_set1_epi16(240) ) , _mm_set1_epi16(128) ) , 7 ) ;
+		const __m128i ty = _mm_add_epi16( _mm_mulhi_epi16( y , _mm_set1_epi16(c_y) ) , _mm_set1_epi16(c_round) ) ;
+		r = _mm_srai_epi16( _mm_add_epi16( ty , _mm_mulhi_epi16( v , _mm_set1_epi16(c_rv) ) ) , 5 ) ;
+		g = _mm_srai_epi16( _mm_sub_epi16( _mm_sub_epi16( ty , _mm_mulhi_epi16( u , _mm_set1_epi16(c_gu) ) ) ,
+			_mm_mulhi_epi16( v , _mm_set1_epi16(c_gv) ) ) , 5 ) ;
+		b = _mm_srai_epi16( _mm_add_epi16( _mm_add_epi16( ty , _mm_srai_epi16(u,1) ) ,
+			_mm_mulhi_epi16( u , _mm_set1_epi16(c_bu) ) ) , 5 ) ;
+	}
+
+	inline void chroma_sse2( __m128i c , bool u_first , __m128i & u , __m128i & v )
+	{
+		// words of interleaved chroma (u0,v0,u1,v1...) to one u and v word per pixel
+		const __m128i first = _mm_and_si128( c , _mm_set1_epi32(0xffff) ) ;
+		const __m128i second = _mm_srli_epi32( c , 16 ) ;
+		u = u_first ? first : second ;
+		v = u_first ? second : first ;
+		u = _mm_or_si128( u , _mm_slli_epi32( u , 16 ) ) ;
+		v = _mm_or_si128( v , _mm_slli_epi32( v , 16 ) ) ;
+	}
+
+	inline void store16_sse2( unsigned char * out , __m128i r0 , __m128i g0 , __m128i b0 , __m128i r1 , __m128i g1 , __m128i b1 )
+	{
+		// sixteen pixels as words to 48 bytes of rgb, via rgbx
+		const __m128i zero = _mm_setzero_si128() ;
+		const __m128i r = _mm_packus_epi16( r0 , r1 ) ;
+		const __m128i g = _mm_packus_epi16( g0 , g1 ) ;
+		const __m128i b = _mm_packus_epi16( b0 , b1 ) ;
+		const __m128i rg_lo = _mm_unpacklo_epi8( r , g ) ;
+		const __m128i rg_hi = _mm_unpackhi_epi8( r , g ) ;
+		const __m128i bz_lo = _mm_unpacklo_epi8( b , zero ) ;
+		const __m128i bz_hi = _mm_unpackhi_epi8( b , zero ) ;
+		g_uint32_t rgbx[16] ;
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(rgbx+0) , _mm_unpacklo_epi16( rg_lo , bz_lo ) ) ;
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(rgbx+4) , _mm_unpackhi_epi16( rg_lo , bz_lo ) ) ;
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(rgbx+8) , _mm_unpacklo_epi16( rg_hi , bz_hi ) ) ;
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(rgbx+12) , _mm_unpackhi_epi16( rg_hi , bz_hi ) ) ;
+		for( int i = 0 ; i < 15 ; i++ )
+			std::memcpy( out+i*3 , rgbx+i , 4U ) ; // overlapping
+		std::memcpy( out+45 , rgbx+15 , 3U ) ;
+	}
+
+	void rgb_packed_sse2( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		const Packing packing( p0 , p1 , p2 , true ) ;
+		const __m128i mask = _mm_set1_epi16( 0xff ) ;
+		int x = 0 ;
+		for( ; (x+16) <= dx ; x += 16 )
+		{
+			__m128i r[2] , g[2] , b[2] ;
+			for( int i = 0 ; i < 2 ; i++ )
+			{
+				const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>(packing.base+x*2+i*16) ) ;
+				const __m128i y = packing.y_odd ? _mm_srli_epi16( a , 8 ) : _mm_and_si128( a , mask ) ;
+				const __m128i c = packing.y_odd ? _mm_and_si128( a , mask ) : _mm_srli_epi16( a , 8 ) ;
+				__m128i u , v ;
+				chroma_sse2( c , packing.u_first , u , v ) ;
+				rgb8_sse2( y , u , v , r[i] , g[i] , b[i] ) ;
+			}
+			store16_sse2( out+x*3 , r[0] , g[0] , b[0] , r[1] , g[1] , b[1] ) ;
+		}
+		rgb_row_scalar<2,4>( p0 , p1 , p2 , out , x , dx ) ;
+	}
+
+	void rgb_planar_sse2( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		const __m128i zero = _mm_setzero_si128() ;
+		int x = 0 ;
+		for( ; (x+16) <= dx ; x += 16 )
+		{
+			const __m128i y = _mm_loadu_si128( reinterpret_cast<const __m128i*>(p0+x) ) ;
+			__m128i u = _mm_loadl_epi64( reinterpret_cast<const __m128i*>(p1+x/2) ) ;
+			__m128i v = _mm_loadl_epi64( reinterpret_cast<const __m128i*>(p2+x/2) ) ;
+			u = _mm_unpacklo_epi8( u , u ) ;
+			v = _mm_unpacklo_epi8( v , v ) ;
+			__m128i r0 , g0 , b0 , r1 , g1 , b1 ;
+			rgb8_sse2( _mm_unpacklo_epi8(y,zero) , _mm_unpacklo_epi8(u,zero) , _mm_unpacklo_epi8(v,zero) , r0 , g0 , b0 ) ;
+			rgb8_sse2( _mm_unpackhi_epi8(y,zero) , _mm_unpackhi_epi8(u,zero) , _mm_unpackhi_epi8(v,zero) , r1 , g1 , b1 ) ;
+			store16_sse2( out+x*3 , r0 , g0 , b0 , r1 , g1 , b1 ) ;
+		}
+		rgb_row_scalar<1,1>( p0 , p1 , p2 , out , x , dx ) ;
+	}
+
+	void rgb_semiplanar_sse2( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		const Packing packing( p0 , p1 , p2 , false ) ;
+		const __m128i zero = _mm_setzero_si128() ;
+		int x = 0 ;
+		for( ; (x+16) <= dx ; x += 16 )
+		{
+			const __m128i y = _mm_loadu_si128( reinterpret_cast<const __m128i*>(p0+x) ) ;
+			const __m128i c = _mm_loadu_si128( reinterpret_cast<const __m128i*>(packing.base+x) ) ;
+			__m128i u0 , v0 , u1 , v1 ;
+			chroma_sse2( _mm_unpacklo_epi8(c,zero) , packing.u_first , u0 , v0 ) ;
+			chroma_sse2( _mm_unpackhi_epi8(c,zero) , packing.u_first , u1 , v1 ) ;
+			__m128i r0 , g0 , b0 , r1 , g1 , b1 ;
+			rgb8_sse2( _mm_unpacklo_epi8(y,zero) , u0 , v0 , r0 , g0 , b0 ) ;
+			rgb8_sse2( _mm_unpackhi_epi8(y,zero) , u1 , v1 , r1 , g1 , b1 ) ;
+			store16_sse2( out+x*3 , r0 , g0 , b0 , r1 , g1 , b1 ) ;
+		}
+		rgb_row_scalar<1,2>( p0 , p1 , p2 , out , x , dx ) ;
+	}
+
+	void luma_packed_sse2( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		const Packing packing( p0 , p1 , p2 , true ) ;
+		const __m128i mask = _mm_set1_epi16( 0xff ) ;
+		int x = 0 ;
+		for( ; (x+16) <= dx ; x += 16 )
+		{
+			__m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>(packing.base+x*2) ) ;
+			__m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>(packing.base+x*2+16) ) ;
+			a = packing.y_odd ? _mm_srli_epi16( a , 8 ) : _mm_and_si128( a , mask ) ;
+			b = packing.y_odd ? _mm_srli_epi16( b , 8 ) : _mm_and_si128( b , mask ) ;
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(out+x) , _mm_packus_epi16( a , b ) ) ;
+		}
+		luma_row_scalar<2>( p0 , out , x , dx ) ;
+	}
+
+	// == AVX2
+
+	__attribute__((target("avx2")))
+	inline void rgb16_avx2( __m256i y , __m256i u , __m256i v , __m256i & r , __m256i & g , __m256i & b )
+	{
+		// sixteen pixels, as per rgb8_sse2()
+		y = _mm256_slli_epi16( _mm256_sub_epi16( _mm256_min_epi16( _mm256_max_epi16( y , _mm256_set1_epi16(16) ) , _mm256_set1_epi16(235) ) , _mm256_set1_epi16(16) ) , 7 ) ;
+		u = _mm256_slli_epi16( _mm256_sub_epi16( _mm256_min_epi16( _mm256_max_epi16( u , _mm256_set1_epi16(16) ) , _mm256_set1_epi16(240) ) , _mm256_set1_epi16(128) ) , 7 ) ;
+		v = _mm256_slli_epi16( _mm256_sub_epi16( _mm256_min_epi16( _mm256_max_epi16( v , _mm256_set1_epi16(16) ) , _mm256_set1_epi16(240) ) , _mm256_set1_epi16(128) ) , 7 ) ;
+		const __m256i ty = _mm256_add_epi16( _mm256_mulhi_epi16( y , _mm256_set1_epi16(c_y) ) , _mm256_set1_epi16(c_round) ) ;
+		r = _mm256_srai_epi16( _mm256_add_epi16( ty , _mm256_mulhi_epi16( v , _mm256_set1_epi16(c_rv) ) ) , 5 ) ;
+		g = _mm256_srai_epi16( _mm256_sub_epi16( _mm256_sub_epi16( ty , _mm256_mulhi_epi16( u , _mm256_set1_epi16(c_gu) ) ) ,
+			_mm256_mulhi_epi16( v , _mm256_set1_epi16(c_gv) ) ) , 5 ) ;
+		b = _mm256_srai_epi16( _mm256_add_epi16( _mm256_add_epi16( ty , _mm256_srai_epi16(u,1) ) ,
+			_mm256_mulhi_epi16( u , _mm256_set1_epi16(c_bu) ) ) , 5 ) ;
+	}
+
+	__attribute__((target("avx2")))
+	inline void chroma_avx2( __m256i c , bool u_first , __m256i & u , __m256i & v )
+	{
+		const __m256i first = _mm256_and_si256( c , _mm256_set1_epi32(0xffff) ) ;
+		const __m256i second = _mm256_srli_epi32( c , 16 ) ;
+		u = u_first ? first : second ;
+		v = u_first ? second : first ;
+		u = _mm256_or_si256( u , _mm256_slli_epi32( u , 16 ) ) ;
+		v = _mm256_or_si256( v , _mm256_slli_epi32( v , 16 ) ) ;
+	}
+
+	__attribute__((target("avx2")))
+	inline void store16_avx2( unsigned char * out , __m256i r , __m256i g , __m256i b )
+	{
+		// sixteen pixels as words to 48 bytes of rgb -- the pack and unpack
+		// instructions work within each 128-bit lane so the low lane has
+		// pixels 0..7 and the high lane 8..15 throughout
+		const __m256i rg = _mm256_packus_epi16( r , g ) ;
+		const __m256i bb = _mm256_packus_epi16( b , b ) ;
+		const __m256i rgrg = _mm256_unpacklo_epi8( rg , _mm256_srli_si256( rg , 8 ) ) ;
+		const __m256i bzbz = _mm256_unpacklo_epi8( bb , _mm256_setzero_si256() ) ;
+		const __m256i compact = _mm256_setr_epi8( 0 , 1 , 2 , 4 , 5 , 6 , 8 , 9 , 10 , 12 , 13 , 14 , -1 , -1 , -1 , -1 ,
+			0 , 1 , 2 , 4 , 5 , 6 , 8 , 9 , 10 , 12 , 13 , 14 , -1 , -1 , -1 , -1 ) ;
+		const __m256i q0 = _mm256_shuffle_epi8( _mm256_unpacklo_epi16( rgrg , bzbz ) , compact ) ; // 0..3, 8..11
+		const __m256i q1 = _mm256_shuffle_epi8( _mm256_unpackhi_epi16( rgrg , bzbz ) , compact ) ; // 4..7, 12..15
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(out) , _mm256_castsi256_si128(q0) ) ; // overlapping
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(out+12) , _mm256_castsi256_si128(q1) ) ;
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(out+24) , _mm256_extracti128_si256(q0,1) ) ;
+		const __m128i last = _mm256_extracti128_si256( q1 , 1 ) ;
+		_mm_storel_epi64( reinterpret_cast<__m128i*>(out+36) , last ) ;
+		const g_uint32_t tail = _mm_cvtsi128_si32( _mm_srli_si128( last , 8 ) ) ;
+		std::memcpy( out+44 , &tail , 4U ) ;
+	}
+
+	__attribute__((target("avx2")))
+	void rgb_packed_avx2( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		const Packing packing( p0 , p1 , p2 , true ) ;
+		const __m256i mask = _mm256_set1_epi16( 0xff ) ;
+		int x = 0 ;
+		for( ; (x+16) <= dx ; x += 16 )
+		{
+			const __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(packing.base+x*2) ) ;
+			const __m256i y = packing.y_odd ? _mm256_srli_epi16( a , 8 ) : _mm256_and_si256( a , mask ) ;
+			const __m256i c = packing.y_odd ? _mm256_and_si256( a , mask ) : _mm256_srli_epi16( a , 8 ) ;
+			__m256i u , v , r , g , b ;
+			chroma_avx2( c , packing.u_first , u , v ) ;
+			rgb16_avx2( y , u , v , r , g , b ) ;
+			store16_avx2( out+x*3 , r , g , b ) ;
+		}
+		rgb_row_scalar<2,4>( p0 , p1 , p2 , out , x , dx ) ;
+	}
+
+	__attribute__((target("avx2")))
+	void rgb_planar_avx2( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		int x = 0 ;
+		for( ; (x+16) <= dx ; x += 16 )
+		{
+			const __m128i y = _mm_loadu_si128( reinterpret_cast<const __m128i*>(p0+x) ) ;
+			const __m128i u = _mm_loadl_epi64( reinterpret_cast<const __m128i*>(p1+x/2) ) ;
+			const __m128i v = _mm_loadl_epi64( reinterpret_cast<const __m128i*>(p2+x/2) ) ;
+			__m256i r , g , b ;
+			rgb16_avx2( _mm256_cvtepu8_epi16(y) , _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u,u)) ,
+				_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v,v)) , r , g , b ) ;
+			store16_avx2( out+x*3 , r , g , b ) ;
+		}
+		rgb_row_scalar<1,1>( p0 , p1 , p2 , out , x , dx ) ;
+	}
+
+	__attribute__((target("avx2")))
+	void rgb_semiplanar_avx2( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		const Packing packing( p0 , p1 , p2 , false ) ;
+		int x = 0 ;
+		for( ; (x+16) <= dx ; x += 16 )
+		{
+			const __m128i y = _mm_loadu_si128( reinterpret_cast<const __m128i*>(p0+x) ) ;
+			const __m128i c = _mm_loadu_si128( reinterpret_cast<const __m128i*>(packing.base+x) ) ;
+			__m256i u , v , r , g , b ;
+			chroma_avx2( _mm256_cvtepu8_epi16(c) , packing.u_first , u , v ) ;
+			rgb16_avx2( _mm256_cvtepu8_epi16(y) , u , v , r , g , b ) ;
+			store16_avx2( out+x*3 , r , g , b ) ;
+		}
+		rgb_row_scalar<1,2>( p0 , p1 , p2 , out , x , dx ) ;
+	}
+
+	__attribute__((target("avx2")))
+	void luma_packed_avx2( const unsigned char * p0 , const unsigned char * p1 , const unsigned char * p2 , unsigned char * out , int dx )
+	{
+		const Packing packing( p0 , p1 , p2 , true ) ;
+		const __m256i mask = _mm256_set1_epi16( 0xff ) ;
+		int x = 0 ;
+		for( ; (x+32) <= dx ; x += 32 )
+		{
+			__m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(packing.base+x*2) ) ;
+			__m256i b = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(packing.base+x*2+32) ) ;
+			a = packing.y_odd ? _mm256_srli_epi16( a , 8 ) : _mm256_and_si256( a , mask ) ;
+			b = packing.y_odd ? _mm256_srli_epi16( b , 8 ) : _mm256_and_si256( b , mask ) ;
+			const __m256i ab = _mm256_permute4x64_epi64( _mm256_packus_epi16( a , b ) , 0xd8 ) ;
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>(out+x) , ab ) ;
+		}
+		luma_row_scalar<2>( p0 , out , x , dx ) ;
+	}
+}
+#endif
+
+// ==
+
+Gv::CaptureConverter::CaptureConverter() :
+	m_dx(0) ,
+	m_layout("none") ,
+	m_isa(isa_none) ,
+	m_rgb_fn(nullptr) ,
+	m_luma_fn(nullptr)
+{
+}
+
+Gv::CaptureConverter::CaptureConverter( const CaptureBufferFormat & format , const CaptureBufferScale & scale , Isa isa_ ) :
+	m_scale(scale) ,
+	m_dx(static_cast<int>(scale.m_dx)) ,
+	m_layout("none") ,
+	m_isa(isa_none) ,
+	m_rgb_fn(nullptr) ,
+	m_luma_fn(nullptr)
+{
+	for( int c = 0 ; c < 3 ; c++ )
+		m_c[c] = format.component( c ) ;
+
+	const CaptureBufferComponent & c0 = m_c[0] ;
+	const CaptureBufferComponent & c1 = m_c[1] ;
+	const CaptureBufferComponent & c2 = m_c[2] ;
+	if( ( !format.is_yuv() && !format.is_grey() ) || !c0.is_byte() || c0.xshift() != 0 || c0.yshift() != 0 )
+		return ;
+
+	const size_t offset0 = c0.offset( 0 , scale ) ;
+	const size_t offset1 = c1.offset( 0 , scale ) ;
+	const size_t offset2 = c2.offset( 0 , scale ) ;
+	const size_t offset_d = offset1 > offset2 ? (offset1-offset2) : (offset2-offset1) ;
+	const bool yuv = format.is_yuv() && c1.is_byte() && c2.is_byte() &&
+		c1.xshift() == 1 && c2.xshift() == 1 && c1.yshift() == c2.yshift() ;
+
+	m_isa = isa_ ;
+	const bool sse2 = m_isa == isa_sse2 ;
+	const bool avx2 = m_isa == isa_avx2 ;
+	RowFn rgb_fn[3] = { nullptr , nullptr , nullptr } ; // scalar, sse2, avx2
+	RowFn luma_fn[3] = { nullptr , nullptr , nullptr } ;
+	if( c0.step() == 2U && yuv && c1.step() == 4U && c2.step() == 4U && c1.yshift() == 0 &&
+		offset0 < 2U && offset1 < 4U && offset2 < 4U && offset_d == 2U && (offset0&1U) != (offset1&1U) )
+	{
+		m_layout = "packed" ; // yuyv, yvyu, uyvy, vyuy
+		rgb_fn[0] = rgb_packed_scalar ;
+		luma_fn[0] = luma_packed_scalar ;
+		#ifdef GV_CAPTURE_CONVERTER_X86
+		rgb_fn[1] = rgb_packed_sse2 ;
+		rgb_fn[2] = rgb_packed_avx2 ;
+		luma_fn[1] = luma_packed_sse2 ;
+		luma_fn[2] = luma_packed_avx2 ;
+		#endif
+	}
+	else if( c0.step() == 1U && yuv && c1.step() == 1U && c2.step() == 1U )
+	{
+		m_layout = "planar" ; // yuv420, yvu420, yuv422p
+		rgb_fn[0] = rgb_planar_scalar ;
+		luma_fn[0] = luma_copy ;
+		#ifdef GV_CAPTURE_CONVERTER_X86
+		rgb_fn[1] = rgb_planar_sse2 ;
+		rgb_fn[2] = rgb_planar_avx2 ;
+		#endif
+	}
+	else if( c0.step() == 1U && yuv && c1.step() == 2U && c2.step() == 2U && offset_d == 1U )
+	{
+		m_layout = "semiplanar" ; // nv12, nv21, nv16, nv61
+		rgb_fn[0] = rgb_semiplanar_scalar ;
+		luma_fn[0] = luma_copy ;
+		#ifdef GV_CAPTURE_CONVERTER_X86
+		rgb_fn[1] = rgb_semiplanar_sse2 ;
+		rgb_fn[2] = rgb_semiplanar_avx2 ;
+		#endif
+	}
+	else if( c0.step() == 1U )
+	{
+		m_layout = "luma" ; // grey, nv24 etc
+		luma_fn[0] = luma_copy ;
+	}
+
+	const int i = avx2 ? 2 : ( sse2 ? 1 : 0 ) ;
+	m_rgb_fn = rgb_fn[i] ? rgb_fn[i] : rgb_fn[0] ;
+	m_luma_fn = luma_fn[i] ? luma_fn[i] : luma_fn[0] ;
+}
+
+Gv::CaptureConverter::Isa Gv::CaptureConverter::isa( const std::string & dev_config )
+{
+	#ifdef GV_CAPTURE_CONVERTER_X86
+		if( G::Str::splitMatch(dev_config,"nosimd",";") )
+			return isa_scalar ;
+		else if( !G::Str::splitMatch(dev_config,"noavx2",";") && __builtin_cpu_supports("avx2") )
+			return isa_avx2 ;
+		else
+			return isa_sse2 ;
+	#else
+		return isa_scalar ;
+	#endif
+}
+
+void Gv::CaptureConverter::rgb( const unsigned char * buffer , int y , unsigned char * out ) const
+{
+	G_ASSERT( m_rgb_fn != nullptr ) ;
+	(*m_rgb_fn)( buffer + m_c[0].offset(y,m_scale) , buffer + m_c[1].offset(y,m_scale) ,
+		buffer + m_c[2].offset(y,m_scale) , out , m_dx ) ;
+}
+
+void Gv::CaptureConverter::luma( const unsigned char * buffer , int y , unsigned char * out ) const
+{
+	G_ASSERT( m_luma_fn != nullptr ) ;
+	(*m_luma_fn)( buffer + m_c[0].offset(y,m_scale) , buffer + m_c[1].offset(y,m_scale) ,
+		buffer + m_c[2].offset(y,m_scale) , out , m_dx ) ;
+}
+
+std::string Gv::CaptureConverter::name() const
+{
+	if( m_rgb_fn == nullptr && m_luma_fn == nullptr )
+		return "none" ;
+	const char * isa_name = m_isa == isa_avx2 ? "avx2" : ( m_isa == isa_sse2 ? "sse2" : "scalar" ) ;
+	return std::string(m_layout) + "-" + isa_name ;
+}
+
+/// \file gvcaptureconverter.cpp
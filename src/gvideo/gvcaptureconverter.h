@@ -0,0 +1,109 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gvcaptureconverter.h
+///
+
+#ifndef GV_CAPTURE_CONVERTER__H
+#define GV_CAPTURE_CONVERTER__H
+
+#include "gdef.h"
+#include "gvcapturebuffer.h"
+#include <string>
+
+namespace Gv
+{
+	class CaptureConverter ;
+}
+
+/// \class Gv::CaptureConverter
+/// Converts whole rows of a raw capture buffer into packed RGB or into
+/// luma, using vectorised kernels for the common V4L pixel formats: packed
+/// YUV 4:2:2 (yuyv, uyvy etc), planar YUV (yuv420, yuv422p etc) and
+/// semi-planar YUV (nv12, nv21, nv16 etc).
+///
+/// The kernels are selected once, at setup time, from the format and scale
+/// of the capture buffer and from the capabilities of the cpu (AVX2, SSE2
+/// or plain C++), and Gv::CaptureBuffer then uses them in preference to
+/// its per-pixel Gv::CaptureBufferIterator.
+///
+/// The plain C++ kernels use the Gr::ColourSpace lookup tables; the 
+/// vectorised kernels use fixed-point arithmetic that is within one
+/// unit of the lookup tables.
+///
+class Gv::CaptureConverter
+{
+public:
+	enum Isa { isa_none , isa_scalar , isa_sse2 , isa_avx2 } ;
+
+	CaptureConverter() ;
+		///< Default constructor for a converter that converts nothing.
+
+	CaptureConverter( const CaptureBufferFormat & , const CaptureBufferScale & , Isa ) ;
+		///< Constructor for the given buffer format and scale, using kernels
+		///< for the given instruction set. Neither rgb() nor luma() will be 
+		///< true if the format is not supported.
+
+	bool rgb() const ;
+		///< Returns true if rows can be converted to RGB.
+
+	bool luma() const ;
+		///< Returns true if rows can be converted to luma.
+
+	void rgb( const unsigned char * buffer , int y , unsigned char * out ) const ;
+		///< Converts the y'th row of the given capture buffer into
+		///< dx*3 bytes of packed RGB. Precondition: rgb().
+
+	void luma( const unsigned char * buffer , int y , unsigned char * out ) const ;
+		///< Converts the y'th row of the given capture buffer into
+		///< dx bytes of luma. Precondition: luma().
+
+	std::string name() const ;
+		///< Returns a short descriptive name for logging purposes,
+		///< eg. "packed-avx2".
+
+	static Isa isa( const std::string & dev_config = std::string() ) ;
+		///< Returns the best instruction set available on this cpu, 
+		///< limited by "nosimd" or "noavx2" in the device configuration
+		///< string.
+
+public:
+	typedef void (*RowFn)( const unsigned char * , const unsigned char * , const unsigned char * , unsigned char * , int ) ;
+
+private:
+	CaptureBufferComponent m_c[3] ;
+	CaptureBufferScale m_scale ;
+	int m_dx ;
+	const char * m_layout ;
+	Isa m_isa ;
+	RowFn m_rgb_fn ;
+	RowFn m_luma_fn ;
+} ;
+
+inline
+bool Gv::CaptureConverter::rgb() const
+{
+	return m_rgb_fn != nullptr ;
+}
+
+inline
+bool Gv::CaptureConverter::luma() const
+{
+	return m_luma_fn != nullptr ;
+}
+
+#endif
@@ -0,0 +1,155 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// gvframediff.cpp
+//
+
+#include "gdef.h"
+#include "gvframediff.h"
+#include "gassert.h"
+
+#if defined(__SSE2__)
+#define GV_FRAME_DIFF_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	inline unsigned int absdiff( unsigned char a , unsigned char b )
+	{
+		return a > b ? (a-b) : (b-a) ;
+	}
+
+	#ifdef GV_FRAME_DIFF_SSE2
+	inline unsigned int hsum( __m128i acc )
+	{
+		// sum the byte counters
+		__m128i sad = _mm_sad_epu8( acc , _mm_setzero_si128() ) ;
+		return static_cast<unsigned int>( _mm_cvtsi128_si32(sad) + _mm_cvtsi128_si32(_mm_srli_si128(sad,8)) ) ;
+	}
+	#endif
+}
+
+void Gv::FrameDiff::count( const unsigned char * p_old , const unsigned char * p_new , const unsigned char * mask ,
+	size_t n , unsigned int squelch , unsigned int & changed_out , unsigned int & unmasked_out )
+{
+	unsigned int changed = 0U ;
+	unsigned int unmasked = 0U ;
+	size_t i = 0U ;
+
+	#ifdef GV_FRAME_DIFF_SSE2
+	if( squelch < 255U )
+	{
+		// 'changed' is abs(a-b) >= squelch+1, computed as max(d,squelch+1) == d, with
+		// the 0xff results subtracted from byte counters that are flushed before
+		// they can overflow
+		const __m128i threshold = _mm_set1_epi8( static_cast<char>(squelch+1U) ) ;
+		const __m128i ones = _mm_set1_epi8( static_cast<char>(0xff) ) ;
+		while( (i+16U) <= n )
+		{
+			__m128i acc_changed = _mm_setzero_si128() ;
+			__m128i acc_unmasked = _mm_setzero_si128() ;
+			for( int j = 0 ; j < 255 && (i+16U) <= n ; j++ , i += 16U )
+			{
+				const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>(p_old+i) ) ;
+				const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>(p_new+i) ) ;
+				const __m128i d = _mm_or_si128( _mm_subs_epu8(a,b) , _mm_subs_epu8(b,a) ) ;
+				__m128i c = _mm_cmpeq_epi8( _mm_max_epu8(d,threshold) , d ) ;
+				__m128i u = ones ;
+				if( mask != nullptr )
+				{
+					const __m128i m = _mm_loadu_si128( reinterpret_cast<const __m128i*>(mask+i) ) ;
+					c = _mm_andnot_si128( m , c ) ;
+					u = _mm_andnot_si128( m , u ) ;
+				}
+				acc_changed = _mm_sub_epi8( acc_changed , c ) ;
+				acc_unmasked = _mm_sub_epi8( acc_unmasked , u ) ;
+			}
+			changed += hsum( acc_changed ) ;
+			unmasked += hsum( acc_unmasked ) ;
+		}
+	}
+	#endif
+
+	for( ; i < n ; i++ )
+	{
+		if( mask == nullptr || mask[i] == 0 )
+		{
+			unmasked++ ;
+			if( absdiff(p_old[i],p_new[i]) > squelch )
+				changed++ ;
+		}
+	}
+
+	changed_out += changed ;
+	unmasked_out += unmasked ;
+}
+
+void Gv::FrameDiff::visualise( const unsigned char * p_old , const unsigned char * p_new , const unsigned char * mask ,
+	size_t n , unsigned int squelch , bool plain , unsigned char * p_out )
+{
+	for( size_t i = 0U ; i < n ; i++ , p_out += 3 )
+	{
+		const bool masked = mask != nullptr && mask[i] != 0 ;
+		const unsigned char luma = p_new[i] ;
+		const unsigned char luma_dimmed = luma / 4U ;
+		if( plain && masked )
+		{
+			p_out[0] = p_out[1] = p_out[2] = 0U ;
+		}
+		else if( plain )
+		{
+			p_out[0] = p_out[1] = p_out[2] = luma ;
+		}
+		else if( masked )
+		{
+			p_out[0] = luma_dimmed ;
+			p_out[1] = 0U ;
+			p_out[2] = 0U ;
+		}
+		else
+		{
+			// dimmed grey or bright green
+			p_out[0] = luma_dimmed ;
+			p_out[1] = absdiff(p_old[i],luma) > squelch ? 255U : luma_dimmed ;
+			p_out[2] = luma_dimmed ;
+		}
+	}
+}
+
+void Gv::FrameDiff::visualise( const unsigned char * changes , const unsigned char * p_new , const unsigned char * mask ,
+	size_t n , bool plain , unsigned char * p_out )
+{
+	for( size_t i = 0U ; i < n ; i++ , p_out += 3 )
+	{
+		const bool masked = mask != nullptr && mask[i] != 0 ;
+		const unsigned char luma = p_new[i] ;
+		const unsigned char luma_dimmed = luma / 4U ;
+		if( plain )
+		{
+			p_out[0] = p_out[1] = p_out[2] = masked ? 0U : luma ;
+		}
+		else
+		{
+			p_out[0] = luma_dimmed ;
+			p_out[1] = masked ? 0U : ( changes[i] ? 255U : luma_dimmed ) ;
+			p_out[2] = masked ? 0U : luma_dimmed ;
+		}
+	}
+}
+
+/// \file gvframediff.cpp
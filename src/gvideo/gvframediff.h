@@ -0,0 +1,69 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gvframediff.h
+///
+
+#ifndef GV_FRAME_DIFF__H
+#define GV_FRAME_DIFF__H
+
+#include "gdef.h"
+
+namespace Gv
+{
+	class FrameDiff ;
+}
+
+/// \class Gv::FrameDiff
+/// Frame-differencing kernels for motion detection, comparing runs of
+/// luma values from consecutive frames against a squelch value, subject
+/// to a mask plane.
+///
+/// The mask plane has one byte per pixel, either zero or 0xff for
+/// masked-out pixels (see Gv::Mask::plane()). The counting kernel uses
+/// SSE2, where available, and it does not need the two images to be
+/// contiguous so it can be used row by row or on sub-images.
+///
+class Gv::FrameDiff
+{
+public:
+	static void count( const unsigned char * p_old , const unsigned char * p_new , const unsigned char * mask ,
+		size_t n , unsigned int squelch , unsigned int & changed , unsigned int & unmasked ) ;
+			///< Compares n new luma values with their old values, adding to
+			///< 'changed' the number of unmasked pixels that differ by more
+			///< than the squelch value, and adding to 'unmasked' the number
+			///< that are not masked. The mask pointer can be null.
+
+	static void visualise( const unsigned char * p_old , const unsigned char * p_new , const unsigned char * mask ,
+		size_t n , unsigned int squelch , bool plain , unsigned char * rgb_out ) ;
+			///< Writes n rgb pixels that visualise the comparison: changed
+			///< pixels are bright green, masked pixels are dimmed red and
+			///< the rest are dimmed grey. In 'plain' mode the unmasked
+			///< pixels are full-brightness grey and the masked pixels are
+			///< black. The mask pointer can be null.
+
+	static void visualise( const unsigned char * changes , const unsigned char * p_new , const unsigned char * mask ,
+		size_t n , bool plain , unsigned char * rgb_out ) ;
+			///< An overload that takes a row of pre-computed change flags,
+			///< 0xff or zero, rather than the old luma values (see
+			///< Gv::BackgroundModel::update()).
+
+private:
+	FrameDiff() ;
+} ;
+
+#endif
@@ -24,6 +24,7 @@
 #include "groot.h"
 #include "ghexdump.h"
 #include "grimagebuffer.h"
+#include "grimagepool.h"
 #include "grglyph.h"
 #include "gstr.h"
 #include "glog.h"
@@ -344,7 +345,7 @@ void Gv::HttpServerPeer::buildPduFromFile()
 		if( file.good() )
 		{
 			// read the whole file
-			shared_ptr<Gr::ImageBuffer> image_buffer_ptr( new Gr::ImageBuffer ) ;
+			shared_ptr<Gr::ImageBuffer> image_buffer_ptr = Gr::ImagePool::get() ;
 			file >> *image_buffer_ptr ;
 			if( file.fail() )
 			{
@@ -848,15 +849,8 @@ const std::vector<std::pair<const char *,size_t> > & Gv::HttpServerPeer::Pdu::se
 	if( !m_head.empty() ) m_segments.push_back( Segment(m_head.data(),m_head.size()) ) ;
 	if( m_body_ptr_size != 0U ) 
 	{
-		const Gr::ImageBuffer & image_buffer = *m_body_ptr.get() ;
-
-		typedef Gr::traits::imagebuffer<Gr::ImageBuffer>::const_row_iterator row_iterator ;
-		for( row_iterator part_p = Gr::imagebuffer::row_begin(image_buffer) ; part_p != Gr::imagebuffer::row_end(image_buffer) ; ++part_p )
-		{
-			const char * segment_p = Gr::imagebuffer::row_ptr(part_p) ;
-			size_t segment_n = Gr::imagebuffer::row_size(part_p) ;
-			m_segments.push_back( Segment(segment_p,segment_n) ) ;
-		}
+		// one segment per contiguous run of image buffer rows
+		Gr::imagebuffer::segments( *m_body_ptr.get() , m_segments ) ;
 	}
 	return m_segments ;
 }
@@ -97,20 +97,108 @@ void Gv::ImageInputSource::sendNonImageInput( Gr::Image non_image_in , const std
 	collectGarbage() ;
 }
 
+bool Gv::ImageInputSource::selected( const ImageInputTask & task , ImageInputHandler * one_handler_p )
+{
+	return task.m_handler != nullptr && ( one_handler_p == nullptr || task.m_handler == one_handler_p ) ;
+}
+
 bool Gv::ImageInputSource::sendImageInput( Gr::Image image_in , ImageInputHandler * one_handler_p )
 {
 	G_DEBUG( "Gv::ImageInputSource::sendImageInput: type=[" << image_in.type() << "](" << image_in.type() << ")" ) ;
+	updateConversions( one_handler_p ) ;
+	bool all_ok = runConversions( image_in , one_handler_p ) ;
+	callHandlers( image_in , one_handler_p ) ;
+	collectGarbage() ;
+	return all_ok ;
+}
+
+bool Gv::ImageInputSource::sendImageInput( const G::PublisherView & view , Gr::ImageType type , Gr::Image & image_store )
+{
+	G_DEBUG( "Gv::ImageInputSource::sendImageInput: borrowed type=[" << type << "]" ) ;
+	updateConversions( nullptr ) ;
+
+	// decode straight out of the borrowed buffer for handlers that want raw images,
+	// or take a matching alternative representation if there is one
+	bool all_ok = true ;
+	bool need_copy = false ;
+	bool dropped = false ;
+	for( TaskList::iterator task_p = m_tasks.begin() ; task_p != m_tasks.end() && !dropped ; ++task_p )
+	{
+		if( (*task_p).m_handler == nullptr )
+			continue ;
+
+		if( !(*task_p).direct(view,type) )
+		{
+			need_copy = true ;
+			continue ;
+		}
+
+		TaskList::iterator previous = std::find( m_tasks.begin() , task_p , *task_p ) ;
+		if( previous != task_p )
+		{
+			(*task_p).m_image = (*previous).m_image ;
+		}
+		else
+		{
+			try
+			{
+				if( ! (*task_p).run(m_converter,view,type) )
+					all_ok = false ;
+			}
+			catch( std::exception & )
+			{
+				if( view.valid() ) throw ;
+				dropped = true ; // decoder choked on a buffer that was being overwritten
+			}
+		}
+	}
 
-	// update the conversion types
+	// take a copy of the borrowed image for everyone else
+	if( need_copy && !dropped )
+	{
+		if( Gr::Image::copy(view,image_store,type) )
+		{
+			for( TaskList::iterator task_p = m_tasks.begin() ; task_p != m_tasks.end() ; ++task_p )
+			{
+				if( (*task_p).m_handler == nullptr || (*task_p).direct(view,type) )
+					continue ;
+
+				TaskList::iterator previous = std::find( m_tasks.begin() , task_p , *task_p ) ;
+				if( previous != task_p )
+					(*task_p).m_image = (*previous).m_image ;
+				else if( ! (*task_p).run(m_converter,image_store) )
+					all_ok = false ;
+			}
+		}
+		else
+		{
+			dropped = true ;
+		}
+	}
+
+	// call the handlers, unless the publisher has overwritten the borrowed buffer
+	if( dropped || !view.valid() )
+		G_DEBUG( "Gv::ImageInputSource::sendImageInput: borrowed image overwritten: dropped" ) ;
+	else
+		callHandlers( image_store , nullptr ) ;
+
+	collectGarbage() ;
+	return all_ok ;
+}
+
+void Gv::ImageInputSource::updateConversions( ImageInputHandler * one_handler_p )
+{
 	for( TaskList::iterator task_p = m_tasks.begin() ; task_p != m_tasks.end() ; ++task_p )
 	{
-		if( (*task_p).m_handler != nullptr && (one_handler_p==nullptr || (*task_p).m_handler==one_handler_p) )
+		if( selected(*task_p,one_handler_p) )
 		{
 			(*task_p).m_conversion = (*task_p).m_handler->imageInputConversion(*this) ;
 		}
 	}
+}
 
-	// do the conversions
+bool Gv::ImageInputSource::runConversions( Gr::Image image_in , ImageInputHandler * one_handler_p )
+{
 	bool all_ok = true ;
 	for( TaskList::iterator task_p = m_tasks.begin() ; task_p != m_tasks.end() ; ++task_p )
 	{
@@ -128,11 +216,14 @@ bool Gv::ImageInputSource::sendImageInput( Gr::Image image_in , ImageInputHandle
 				all_ok = false ;
 		}
 	}
+	return all_ok ;
+}
 
-	// call the handlers
+void Gv::ImageInputSource::callHandlers( Gr::Image image_in , ImageInputHandler * one_handler_p )
+{
 	for( TaskList::iterator task_p = m_tasks.begin() ; task_p != m_tasks.end() ; ++task_p )
 	{
-		if( (*task_p).m_handler != nullptr && (one_handler_p==nullptr || (*task_p).m_handler==one_handler_p) )
+		if( selected(*task_p,one_handler_p) )
 		{
 			if( (*task_p).m_image.empty() ) // ie. no conversion -- use the input image
 				(*task_p).m_handler->onImageInput( *this , image_in ) ;
@@ -140,9 +231,6 @@ bool Gv::ImageInputSource::sendImageInput( Gr::Image image_in , ImageInputHandle
 				(*task_p).m_handler->onImageInput( *this , (*task_p).m_image ) ;
 		}
 	}
-
-	collectGarbage() ;
-	return all_ok ;
 }
 
 void Gv::ImageInputSource::collectGarbage()
@@ -201,8 +289,18 @@ bool Gv::ImageInput::receive( bool peek )
 	}
 	else
 	{
-		if( ! Gr::Image::receive(m_channel,m_image,m_type_str) )
+		// zero-copy receive, with the data left in the channel's shared memory
+		Gr::ImageType type ;
+		if( ! Gr::Image::borrow(m_channel,m_view,type) )
 			return false ; // publisher has gone away
+
+		if( type.valid() )
+			sendImageInput( m_view , type , m_image ) ;
+		else if( !m_view.empty() && Gr::Image::copy(m_view,m_image,type) )
+			sendNonImageInput( m_image , m_view.type() ) ;
+
+		m_view.clear() ;
+		return true ;
 	}
 
 	if( m_image.valid() )
@@ -217,6 +315,7 @@ void Gv::ImageInput::close()
 {
 	if( m_channel.fd() != -1 )
 	{
+		m_view.clear() ;
 		m_channel.close() ;
 		m_image.clear() ;
 	}
@@ -282,6 +381,54 @@ Gv::ImageInputTask::ImageInputTask() :
 {
 }
 
+bool Gv::ImageInputTask::noop( Gr::ImageType type_in ) const
+{
+	const bool to_raw = m_conversion.type == ImageInputConversion::to_raw ;
+	const bool to_jpeg = m_conversion.type == ImageInputConversion::to_jpeg ;
+	const bool keep_type = m_conversion.type == ImageInputConversion::none ;
+	return 
+		( keep_type || (to_jpeg && type_in.isJpeg()) || (to_raw && type_in.isRaw()) ) && 
+		m_conversion.scale == 1 && (m_conversion.monochrome?1:3) == type_in.channels() ;
+}
+
+bool Gv::ImageInputTask::direct( Gr::ImageType type_in ) const
+{
+	const bool to_raw = m_conversion.type == ImageInputConversion::to_raw ;
+	const bool keep_type = m_conversion.type == ImageInputConversion::none ;
+	return 
+		!noop(type_in) && ( to_raw || (keep_type && type_in.isRaw()) ) && 
+		Gr::ImageConverter::convertible(type_in) ;
+}
+
+bool Gv::ImageInputTask::direct( const G::PublisherView & view , Gr::ImageType type_in ) const
+{
+	if( direct(type_in) )
+		return true ;
+
+	const bool to_jpeg = m_conversion.type == ImageInputConversion::to_jpeg ;
+	return 
+		to_jpeg && !noop(type_in) && view.header().m_representations != 0U &&
+		Gr::Image::select(view,type_in,true,m_conversion.scale,m_conversion.monochrome).p != view.data() ;
+}
+
+bool Gv::ImageInputTask::run( Gr::ImageConverter & converter , const G::PublisherView & view , Gr::ImageType type_in )
+{
+	G_ASSERT( direct(view,type_in) ) ;
+	const bool to_jpeg = m_conversion.type == ImageInputConversion::to_jpeg ;
+	Gr::Image::Part part = Gr::Image::select( view , type_in , to_jpeg , m_conversion.scale , m_conversion.monochrome ) ;
+	if( to_jpeg )
+	{
+		G_DEBUG( "Gv::ImageInputTask::run: direct to-jpeg: using [" << part.type << "]" ) ;
+		Gr::Image::copy( view , part , m_image ) ;
+		return true ; // caller checks view.valid()
+	}
+	else
+	{
+		G_DEBUG( "Gv::ImageInputTask::run: direct to-raw: s=" << part.scale << " m=" << m_conversion.monochrome << " from [" << part.type << "]" ) ;
+		return converter.toRaw( part.p , part.n , part.type , m_image , part.scale , m_conversion.monochrome ) ;
+	}
+}
+
 bool Gv::ImageInputTask::run( Gr::ImageConverter & converter , Gr::Image image_in )
 {
 	const bool to_raw = m_conversion.type == ImageInputConversion::to_raw ;
@@ -289,13 +436,11 @@ bool Gv::ImageInputTask::run( Gr::ImageConverter & converter , Gr::Image image_i
 	const bool keep_type = m_conversion.type == ImageInputConversion::none ;
 	const bool is_jpeg = image_in.type().isJpeg() ;
 	const bool is_raw = image_in.type().isRaw() ;
-	const int channels = image_in.type().channels() ;
 
 	G_DEBUG( "Gv::ImageInputTask::run: conversion=[t=" << m_conversion.type << ",m=" << m_conversion.monochrome << ",s=" << m_conversion.scale << "]" ) ;
 	G_DEBUG( "Gv::ImageInputTask::run: input=[" << image_in.type() << "]" ) ;
 
-	if( ( keep_type || (to_jpeg && is_jpeg) || (to_raw && is_raw) ) && 
-		m_conversion.scale == 1 && (m_conversion.monochrome?1:3) == channels )
+	if( noop(image_in.type()) )
 	{
 		G_DEBUG( "Gv::ImageInputTask::run: no-op" ) ;
 		m_image.clear() ; // no conversion
@@ -73,6 +73,23 @@ public:
 	bool run( Gr::ImageConverter & , Gr::Image ) ;
 		///< Runs the conversion. Returns false on error.
 
+	bool noop( Gr::ImageType ) const ;
+		///< Returns true if no conversion is required.
+
+	bool direct( Gr::ImageType ) const ;
+		///< Returns true if the conversion is a decode to raw, so it can
+		///< use run() with a borrowed buffer rather than a Gr::Image.
+
+	bool direct( const G::PublisherView & , Gr::ImageType ) const ;
+		///< An overload that also returns true if the borrowed publication 
+		///< contains an alternative representation that exactly matches a 
+		///< jpeg conversion.
+
+	bool run( Gr::ImageConverter & , const G::PublisherView & , Gr::ImageType ) ;
+		///< Runs a direct() conversion from borrowed data, using the cheapest
+		///< representation in the publication (see Gr::Image::select()). 
+		///< Returns false on error.
+
 	ImageInputHandler * m_handler ;
 	ImageInputConversion m_conversion ;
 	Gr::Image m_image ;
@@ -145,6 +162,13 @@ protected:
 		///< Sends a new image to all registered handlers, or optionally to just 
 		///< one of them. Returns false if there were any image conversion errors.
 
+	bool sendImageInput( const G::PublisherView & , Gr::ImageType , Gr::Image & image_store ) ;
+		///< An overload that sends a borrowed image to all registered handlers.
+		///< Handlers that want a raw image have it decoded directly from
+		///< the borrowed data; the image store is used for an intermediate 
+		///< copy only if other handlers need it. The image is silently 
+		///< dropped if the view becomes invalid.
+
 	void sendNonImageInput( Gr::Image non_image , const std::string & type_str ,
 		ImageInputHandler * one_handler_p = nullptr ) ;
 			///< Sends non-image data to registered handlers (or one).
@@ -153,6 +177,10 @@ private:
 	ImageInputSource( const ImageInputSource & ) ;
 	void operator=( const ImageInputSource & ) ;
 	void collectGarbage() ;
+	void updateConversions( ImageInputHandler * ) ;
+	bool runConversions( Gr::Image , ImageInputHandler * ) ;
+	void callHandlers( Gr::Image , ImageInputHandler * ) ;
+	static bool selected( const ImageInputTask & , ImageInputHandler * ) ;
 
 private:
 	typedef std::vector<ImageInputTask> TaskList ;
@@ -207,6 +235,7 @@ private:
 private:
 	G::PublisherSubscription m_channel ;
 	Gr::Image m_image ;
+	G::PublisherView m_view ;
 	std::string m_type_str ;
 	GNet::Timer<ImageInput> m_resend_timer ;
 	ImageInputHandler * m_resend_to ;
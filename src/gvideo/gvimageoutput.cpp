@@ -20,7 +20,11 @@
 
 #include "gdef.h"
 #include "gvimageoutput.h"
+#include "grimage.h"
+#include "grimageconverter.h"
 #include "grimagetype.h"
+#include "gvsegment.h"
+#include "gravc.h"
 #include "gprocess.h"
 #include "gdatetime.h"
 #include "gstr.h"
@@ -68,6 +72,7 @@ Gv::ImageOutput::ImageOutput() :
 	m_fast(false) ,
 	m_tz(0) ,
 	m_save_test_mode(false) ,
+	m_segments(nullptr) ,
 	m_viewer_up(false)
 {
 }
@@ -76,6 +81,7 @@ Gv::ImageOutput::ImageOutput( GNet::EventExceptionHandler & handler ) :
 	m_fast(false) ,
 	m_tz(0) ,
 	m_save_test_mode(false) ,
+	m_segments(nullptr) ,
 	m_viewer_up(false)
 {
 	m_ping_timer_ptr.reset( new GNet::Timer<ImageOutput>(*this,&ImageOutput::onPingTimeout,handler) ) ;
@@ -99,6 +105,16 @@ void Gv::ImageOutput::startPublisher( const std::string & channel , const G::Ite
 	m_publisher.reset( new G::Publisher(channel,info) ) ;
 }
 
+void Gv::ImageOutput::startPublisher( const std::string & channel , const G::Item & info_in , 
+	const G::PublisherConfig & config )
+{
+	G::Item info( info_in ) ;
+	if( !info.has("type") )
+		info.add( "type" , G::Str::tail(G::Path(G::Arg::v0()).basename(),"-",false) ) ;
+
+	m_publisher.reset( new G::Publisher(channel,info,config) ) ;
+}
+
 void Gv::ImageOutput::startPublisher( G::Publisher * p )
 {
 	m_publisher.reset( p ) ;
@@ -180,13 +196,16 @@ void Gv::ImageOutput::pingViewerCheck()
 		throw std::runtime_error( "viewer has gone away" ) ;
 }
 
-void Gv::ImageOutput::saveTo( const std::string & base_dir , const std::string & name , bool fast , const Gv::Timezone & tz , bool test_mode )
+void Gv::ImageOutput::saveTo( const std::string & base_dir , const std::string & name , bool fast , const Gv::Timezone & tz , bool test_mode ,
+	Gv::SegmentWriter * segments )
 {
+	G_ASSERT( segments == nullptr || base_dir.empty() || segments->base().str() == base_dir ) ;
 	m_base_dir = base_dir ;
 	m_name = name ;
 	m_fast = fast ;
 	m_tz = tz ;
 	m_save_test_mode = test_mode ;
+	m_segments = segments ;
 }
 
 const std::string & Gv::ImageOutput::dir() const
@@ -199,7 +218,7 @@ G::Path Gv::ImageOutput::send( const char * p , size_t n , Gr::ImageType type ,
 	Gr::ImageType::String type_str ; type.set( type_str ) ;
 
 	if( m_publisher.get() )
-		m_publisher->publish( p , n , type_str.c_str() ) ;
+		publish( nullptr , p , n , type , time , type_str.c_str() ) ;
 
 	if( m_fat_pipe.get() )
 		m_fat_pipe->send( p , n , type_str.c_str() ) ;
@@ -215,10 +234,14 @@ G::Path Gv::ImageOutput::send( const Gr::ImageBuffer & buffer , Gr::ImageType ty
 	Gr::ImageType::String type_str ; type.set( type_str ) ;
 
 	if( m_publisher.get() )
-		m_publisher->publish( buffer , type_str.c_str() ) ;
+		publish( &buffer , nullptr , 0U , type , time , type_str.c_str() ) ;
 
 	if( m_fat_pipe.get() )
-		m_fat_pipe->send( buffer , type_str.c_str() ) ;
+	{
+		m_parts.clear() ;
+		Gr::imagebuffer::segments( buffer , m_parts ) ;
+		m_fat_pipe->send( m_parts , type_str.c_str() ) ;
+	}
 
 	if( m_base_dir.empty() )
 		return G::Path() ;
@@ -226,6 +249,72 @@ G::Path Gv::ImageOutput::send( const Gr::ImageBuffer & buffer , Gr::ImageType ty
 		return save( buffer , type , time ) ;
 }
 
+void Gv::ImageOutput::addRepresentation( bool jpeg , int scale , bool monochrome )
+{
+	if( m_representations.size() < G::PublisherHeader::REPRESENTATIONS )
+	{
+		Representation r ;
+		r.jpeg = jpeg ;
+		r.scale = std::max( 1 , scale ) ;
+		r.monochrome = monochrome ;
+		m_representations.push_back( r ) ;
+	}
+	if( m_converter.get() == nullptr )
+		m_converter.reset( new Gr::ImageConverter ) ;
+}
+
+void Gv::ImageOutput::publish( const Gr::ImageBuffer * buffer_p , const char * p , size_t n , 
+	Gr::ImageType type , G::EpochTime time , const char * type_str )
+{
+	// the primary image is published as a scatter-gather list that has only 
+	// one segment if the image buffer is contiguous -- any alternative 
+	// representations follow on as more segments
+	m_parts.clear() ;
+	if( buffer_p != nullptr )
+		Gr::imagebuffer::segments( *buffer_p , m_parts ) ;
+	else
+		m_parts.push_back( std::make_pair(p,n) ) ;
+
+	// h264 pictures are only flagged as key frames if they start with an idr picture
+	G::PublisherHeader header = m_parts.empty() ?
+		Gr::Image::header( type , time ) :
+		Gr::Image::header( type , time , m_parts[0].first , m_parts[0].second ) ;
+
+	if( m_representations.empty() || !type.valid() )
+	{
+		m_publisher->publish( m_parts , type_str , &header ) ;
+		return ;
+	}
+
+	size_t offset = buffer_p ? Gr::imagebuffer::size_of(*buffer_p) : n ;
+
+	for( std::vector<Representation>::iterator r = m_representations.begin() ; r != m_representations.end() ; ++r )
+	{
+		bool ok = false ;
+		try
+		{
+			ok = buffer_p != nullptr ?
+				m_converter->toRaw( *buffer_p , type , (*r).raw , (*r).scale , (*r).monochrome ) :
+				m_converter->toRaw( p , n , type , (*r).raw , (*r).scale , (*r).monochrome ) ;
+			if( ok && (*r).jpeg )
+				ok = m_converter->toJpeg( (*r).raw , (*r).jpeg_image ) ;
+		}
+		catch( std::exception & e )
+		{
+			G_DEBUG( "Gv::ImageOutput::publish: cannot convert image: " << e.what() ) ;
+			ok = false ;
+		}
+		if( !ok )
+			continue ;
+
+		const Gr::Image & image = (*r).jpeg ? (*r).jpeg_image : (*r).raw ;
+		Gr::Image::add( header , offset , image ) ;
+		Gr::imagebuffer::segments( image.data() , m_parts ) ;
+		offset += image.size() ;
+	}
+	m_publisher->publish( m_parts , type_str , &header ) ;
+}
+
 void Gv::ImageOutput::sendText( const char * p , size_t n , const std::string & type )
 {
 	if( m_publisher.get() )
@@ -323,6 +412,8 @@ void Gv::ImageOutput::path( std::string & out , const std::string & base_dir , c
 		out.append( ".jpg" ) ;
 	else if( type.isRaw() )
 		out.append( type.channels() == 1 ? ".pgm" : ".ppm" ) ;
+	else if( type.isAvc() )
+		out.append( ".h264" ) ;
 	else
 		out.append( ".dat" ) ;
 }
@@ -334,8 +425,28 @@ std::string Gv::ImageOutput::path( G::EpochTime time , Gr::ImageType type , bool
 	return result ;
 }
 
+bool Gv::ImageOutput::dependent( Gr::ImageType type ) const
+{
+	// h264 pictures other than key frames depend on the pictures before them
+	return type.isAvc() && ( m_parts.empty() || !Gr::Avc::ByteStream::keyframe( m_parts[0].first , m_parts[0].second ) ) ;
+}
+
 G::Path Gv::ImageOutput::save( const char * p , size_t n , Gr::ImageType type , G::EpochTime time )
 {
+	m_parts.clear() ;
+	m_parts.push_back( std::make_pair(p,n) ) ;
+
+	// in slow mode only key frames are worth keeping
+	if( !m_fast && dependent(type) )
+		return G::Path() ;
+
+	if( m_segments != nullptr )
+	{
+		G::Path path ;
+		if( saveSegment( type , time , path ) )
+			return path ;
+	}
+
 	std::ofstream file ;
 	G::Path path = openFile( file , type , time ) ;
 	if( path != G::Path() )
@@ -348,6 +459,20 @@ G::Path Gv::ImageOutput::save( const char * p , size_t n , Gr::ImageType type ,
 
 G::Path Gv::ImageOutput::save( const Gr::ImageBuffer & image_buffer , Gr::ImageType type , G::EpochTime time )
 {
+	m_parts.clear() ;
+	Gr::imagebuffer::segments( image_buffer , m_parts ) ;
+
+	// in slow mode only key frames are worth keeping
+	if( !m_fast && dependent(type) )
+		return G::Path() ;
+
+	if( m_segments != nullptr )
+	{
+		G::Path path ;
+		if( saveSegment( type , time , path ) )
+			return path ;
+	}
+
 	std::ofstream file ;
 	G::Path path = openFile( file , type , time ) ;
 	if( path != G::Path() )
@@ -358,6 +483,42 @@ G::Path Gv::ImageOutput::save( const Gr::ImageBuffer & image_buffer , Gr::ImageT
 	return path ;
 }
 
+bool Gv::ImageOutput::saveSegment( Gr::ImageType type , G::EpochTime time , G::Path & path_out )
+{
+	// the image data is in m_parts -- returns false to fall back to saving a separate file
+	if( time.s == 0 ) time = G::DateTime::now() ;
+	G::Path path = this->path( time , type , m_fast ) ;
+
+	// if the same filename as last time keep the old contents
+	if( path == m_old_path ) 
+	{
+		path_out = G::Path() ;
+		return true ;
+	}
+
+	const bool dependent = this->dependent( type ) ;
+
+	// for raw images prefix with a 'portable-anymap' header
+	std::string header ;
+	if( type.isRaw() )
+	{
+		header.append( type.channels()==1 ? "P5\n" : "P6\n" ) ;
+		header.append( G::Str::fromInt(type.dx()) ).append( 1U , ' ' ).append( G::Str::fromInt(type.dy()) ) ;
+		header.append( "\n255\n" ) ;
+		m_parts.insert( m_parts.begin() , std::make_pair(header.data(),header.size()) ) ;
+	}
+
+	if( !m_segments->write( path.str() , time , m_parts , dependent ) )
+	{
+		G_WARNING_ONCE( "Gv::ImageOutput::saveSegment: cannot save into a segment file: using separate files" ) ;
+		return false ;
+	}
+
+	m_old_path = path ;
+	path_out = path ;
+	return true ;
+}
+
 G::Path Gv::ImageOutput::openFile( std::ofstream & file , Gr::ImageType type , G::EpochTime time )
 {
 	if( m_base_dir.empty() )
@@ -372,19 +533,7 @@ G::Path Gv::ImageOutput::openFile( std::ofstream & file , Gr::ImageType type , G
 		return G::Path() ;
 
 	// create the directory if necessary
-	{
-		G::Path dir = path.dirname() ;
-		if( m_old_dir != dir )
-		{
-			bool ok = false ;
-			{
-				G::Root claim_root ;
-				ok = G::File::mkdirs( dir , G::File::NoThrow() ) ;
-			}
-			if( !ok )
-				m_old_dir = dir ;
-		}
-	}
+	makeDir( path.dirname() ) ;
 
 	// create the file
 	{
@@ -406,6 +555,69 @@ G::Path Gv::ImageOutput::openFile( std::ofstream & file , Gr::ImageType type , G
 	return path ;
 }
 
+void Gv::ImageOutput::makeDir( const G::Path & dir )
+{
+	if( m_old_dir != dir )
+	{
+		bool ok = false ;
+		{
+			G::Root claim_root ;
+			ok = G::File::mkdirs( dir , G::File::NoThrow() ) ;
+		}
+		if( !ok )
+			m_old_dir = dir ;
+	}
+}
+
+bool Gv::ImageOutput::saves( Gr::ImageType type , G::EpochTime time ) const
+{
+	if( m_base_dir.empty() )
+		return false ;
+	if( time.s == 0 ) time = G::DateTime::now() ;
+	return this->path( time , type , m_fast ) != m_old_path.str() ;
+}
+
+bool Gv::ImageOutput::saveReference( Gr::ImageType type , G::EpochTime time , G::Path & path_out )
+{
+	path_out = G::Path() ;
+	if( m_base_dir.empty() || m_old_path == G::Path() )
+		return false ;
+
+	if( time.s == 0 ) time = G::DateTime::now() ;
+	G::Path path = this->path( time , type , m_fast ) ;
+
+	// if the same filename as last time keep the old contents
+	if( path == m_old_path )
+		return true ;
+
+	// the last image has the same type, so the same extension
+	if( path.extension() != m_old_path.extension() )
+		return false ;
+
+	if( m_segments != nullptr )
+	{
+		if( !m_segments->writeReference( path.str() , time , m_old_path.str() ) )
+			return false ;
+	}
+	else
+	{
+		makeDir( path.dirname() ) ;
+		int rc = -1 ;
+		{
+			std::string old_path_str = m_old_path.str() ;
+			std::string path_str = path.str() ;
+			G::Root claim_root ;
+			rc = ::link( old_path_str.c_str() , path_str.c_str() ) ;
+		}
+		if( rc != 0 )
+			return false ;
+	}
+
+	m_old_path = path ;
+	path_out = path ;
+	return true ;
+}
+
 void Gv::ImageOutput::commitFile( std::ofstream & file , const G::Path & path )
 {
 	file.close() ;
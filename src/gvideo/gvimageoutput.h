@@ -27,6 +27,7 @@
 #include "gpublisher.h"
 #include "gdatetime.h"
 #include "gvtimezone.h"
+#include "grimage.h"
 #include "grimagetype.h"
 #include "gtimer.h"
 #include <string>
@@ -34,6 +35,12 @@
 namespace Gv
 {
 	class ImageOutput ;
+	class SegmentWriter ;
+}
+
+namespace Gr
+{
+	class ImageConverter ;
 }
 
 /// \class Gv::ImageOutput
@@ -66,16 +73,34 @@ public:
 		///< Starts the publisher channel with additional infomation describing
 		///< the publisher.
 
+	void startPublisher( const std::string & channel , const G::Item & publisher_info , 
+		const G::PublisherConfig & ) ;
+			///< Starts the publisher channel with additional configuration, 
+			///< such as the depth of the channel's image history.
+
 	void startPublisher( G::Publisher * ) ;
 		///< Starts the publisher channel by taking ownership of a new-ed publisher object.
 
+	void addRepresentation( bool jpeg , int scale , bool monochrome ) ;
+		///< Adds a reduced alternative representation to every image that
+		///< is published, such as a small monochrome image for motion 
+		///< detection, so that subscribers can avoid doing the conversion
+		///< themselves. See Gr::Image::select().
+
 	void saveTo( const std::string & base_dir , const std::string & name , bool fast , 
-		const Gv::Timezone & tz , bool test_mode = false ) ;
+		const Gv::Timezone & tz , bool test_mode = false , Gv::SegmentWriter * segments = nullptr ) ;
 			///< Saves images to the filesystem inside a deeply-nested directory 
 			///< hierarchy with the given base directory. Every filename is prefixed
 			///< with the given name. Directory paths are derived from a timestamp; 
 			///< if the 'fast' flag is true then sub-second parts of the timestamp
 			///< are used.
+			///<
+			///< If a segment writer is supplied then the images are appended
+			///< to per-minute segment files instead, falling back to separate
+			///< files if that fails. The segment writer must have the
+			///< same base directory. The returned paths from send() are then
+			///< the paths within the segments, which are readable with
+			///< Gv::SegmentReader.
 
 	bool viewing() const ;
 		///< Returns true if startViewer() has been called.
@@ -95,6 +120,20 @@ public:
 	G::Path send( const Gr::ImageBuffer & data , Gr::ImageType type , G::EpochTime = G::EpochTime(0) ) ;
 		///< Emits an image. Returns the path if saveTo()d the filesystem.
 
+	bool saves( Gr::ImageType type , G::EpochTime ) const ;
+		///< Returns true if send() would save an image with the given
+		///< type and timestamp to the filesystem, ie. if saveTo() is in
+		///< effect and the image's path is not the same as the path of
+		///< the last image saved.
+
+	bool saveReference( Gr::ImageType type , G::EpochTime , G::Path & path_out ) ;
+		///< Saves a reference to the last image saved in place of an
+		///< image that is the same, returning the new path by reference. 
+		///< The reference is a hard link to the last image's file or a 
+		///< reference record in the segment file, so readers see a copy
+		///< of the last image. Returns false if a reference cannot be 
+		///< saved, in which case the image should be send()t in full.
+
 	void sendText( const char * data , size_t size , const std::string & type ) ;
 		///< Emits a non-image message. Non-image messages are not saveTo()d the filesystem.
 
@@ -118,21 +157,37 @@ private:
 	void operator=( const ImageOutput & ) ;
 	G::Path save( const char * p , size_t n , Gr::ImageType , G::EpochTime ) ;
 	G::Path save( const Gr::ImageBuffer & , Gr::ImageType , G::EpochTime ) ;
+	bool saveSegment( Gr::ImageType , G::EpochTime , G::Path & ) ;
+	bool dependent( Gr::ImageType ) const ;
 	G::Path openFile( std::ofstream & , Gr::ImageType , G::EpochTime ) ;
+	void makeDir( const G::Path & ) ;
 	void commitFile( std::ofstream & , const G::Path & ) ;
 	static std::string viewer( const G::Path & ) ;
 	static std::string sanitise( const std::string & ) ;
 	void onPingTimeout() ;
+	void publish( const Gr::ImageBuffer * , const char * , size_t , Gr::ImageType , G::EpochTime , const char * ) ;
 
 private:
+	struct Representation
+	{
+		bool jpeg ;
+		int scale ;
+		bool monochrome ;
+		Gr::Image raw ;
+		Gr::Image jpeg_image ;
+	} ;
 	unique_ptr<GNet::Timer<ImageOutput> > m_ping_timer_ptr ;
 	std::string m_base_dir ;
 	std::string m_name ;
 	bool m_fast ;
 	Gv::Timezone m_tz ;
 	bool m_save_test_mode ;
+	Gv::SegmentWriter * m_segments ;
 	unique_ptr<G::Publisher> m_publisher ;
 	unique_ptr<G::FatPipe> m_fat_pipe ;
+	std::vector<Representation> m_representations ;
+	unique_ptr<Gr::ImageConverter> m_converter ;
+	std::vector<std::pair<const char*,size_t> > m_parts ;
 	G::Path m_old_path ;
 	G::Path m_old_dir ;
 	bool m_viewer_up ;
@@ -34,20 +34,39 @@
 #include <fstream>
 #include <stdexcept>
 
+namespace
+{
+	void append( Gv::Mask::Row & row , int x0 , int x1 )
+	{
+		// adds a masked run, merging with the previous one if adjacent
+		if( !row.empty() && row.back().x1 == x0 )
+		{
+			row.back().x1 = x1 ;
+		}
+		else
+		{
+			Gv::Mask::Span span = { x0 , x1 } ;
+			row.push_back( span ) ;
+		}
+	}
+}
+
 Gv::Mask::Mask( int dx , int dy , const std::string & path , bool create ) :
-	m_dx(dx) ,
-	m_dy(dy) ,
+	m_source_dx(dx) ,
+	m_source_dy(dy) ,
+	m_source(dy) ,
+	m_plane(nullptr) ,
 	m_path(path) ,
-	m_empty(true) ,
-	m_map(dx*dy) ,
-	m_map_current(dx*dy) ,
 	m_down(false) ,
 	m_down_x(0) ,
 	m_down_y(0) ,
 	m_down_shift(false) ,
+	m_move_x(0) ,
+	m_move_y(0) ,
 	m_file_time(0)
 {
-	G_ASSERT( m_dx > 0 && m_dy > 0 ) ;
+	G_ASSERT( dx > 0 && dy > 0 ) ;
+	reset( dx , dy ) ;
 	if( m_path != G::Path() )
 	{
 		// create the file if it doesnt exist
@@ -61,24 +80,106 @@ Gv::Mask::Mask( int dx , int dy , const std::string & path , bool create ) :
 		Gr::ImageData image_data ;
 		Gr::PnmInfo info = read( file , image_data ) ;
 
-		// subsample or supersample to convert from file_size to m_dx/dy
+		// convert to runs and resample to dx/dy
 		sample( image_data , info ) ;
 	}
 }
 
 void Gv::Mask::sample( const Gr::ImageData & image_data , const Gr::PnmInfo & info )
 {
-	for( Gr::Scaler y_scaler(m_dy,info.dy()) ; !!y_scaler ; ++y_scaler )
+	m_source_dx = info.dx() ;
+	m_source_dy = info.dy() ;
+	m_source.assign( m_source_dy , Row() ) ;
+	for( int y = 0 ; y < m_source_dy ; y++ )
 	{
-		for( Gr::Scaler x_scaler(m_dx,info.dx()) ; !!x_scaler ; ++x_scaler )
+		for( int x = 0 ; x < m_source_dx ; x++ )
 		{
 			// black pixels in the mask are masked out, but note that black
 			// pixels are "1" in a pnm file, albeit parsed to zero rgb values
-			bool masked = 0 == image_data.r( x_scaler.second() , y_scaler.second() ) ;
-			if( masked ) m_empty = false ;
-			m_map[ y_scaler.first() * m_dx + x_scaler.first() ] = masked ;
+			if( 0 == image_data.r( x , y ) )
+				append( m_source[y] , x , x+1 ) ;
 		}
 	}
+	reset( m_plane->dx , m_plane->dy ) ;
+}
+
+void Gv::Mask::reset( int dx , int dy )
+{
+	m_cache.clear() ;
+	m_cache.push_front( Plane() ) ;
+	m_plane = &m_cache.front() ;
+	build( *m_plane , dx , dy ) ;
+}
+
+void Gv::Mask::resize( int dx , int dy )
+{
+	G_ASSERT( dx > 0 && dy > 0 ) ;
+	if( dx == m_plane->dx && dy == m_plane->dy )
+		return ;
+
+	for( std::list<Plane>::iterator p = m_cache.begin() ; p != m_cache.end() ; ++p )
+	{
+		if( p->dx == dx && p->dy == dy )
+		{
+			m_cache.splice( m_cache.begin() , m_cache , p ) ;
+			m_plane = &m_cache.front() ;
+			return ;
+		}
+	}
+
+	const size_t cache_limit = 4U ;
+	if( m_cache.size() >= cache_limit )
+		m_cache.pop_back() ;
+	m_cache.push_front( Plane() ) ;
+	m_plane = &m_cache.front() ;
+	build( *m_plane , dx , dy ) ;
+}
+
+void Gv::Mask::build( Plane & plane , int dx , int dy ) const
+{
+	plane.dx = dx ;
+	plane.dy = dy ;
+	plane.empty = true ;
+	plane.rows.assign( dy , Row() ) ;
+	plane.data.assign( static_cast<size_t>(dx) * dy , 0 ) ;
+
+	// map output columns and rows onto the source in the same way as
+	// a nested pair of scalers
+	std::vector<int> x_map( dx ) ;
+	for( Gr::Scaler x_scaler(dx,m_source_dx) ; !!x_scaler ; ++x_scaler )
+		x_map[x_scaler.first()] = x_scaler.second() ;
+	std::vector<int> y_map( dy ) ;
+	for( Gr::Scaler y_scaler(dy,m_source_dy) ; !!y_scaler ; ++y_scaler )
+		y_map[y_scaler.first()] = y_scaler.second() ;
+
+	for( int y = 0 ; y < dy ; y++ )
+	{
+		Row & row = plane.rows[y] ;
+		unsigned char * p = &plane.data[static_cast<size_t>(y)*dx] ;
+		if( y > 0 && y_map[y] == y_map[y-1] )
+		{
+			row = plane.rows[y-1] ;
+			std::copy( p-dx , p , p ) ;
+		}
+		else
+		{
+			// the column map is monotonic so each source run maps onto
+			// a contiguous (possibly empty) output run
+			const Row & source_row = m_source[y_map[y]] ;
+			for( Row::const_iterator s = source_row.begin() ; s != source_row.end() ; ++s )
+			{
+				const int x0 = static_cast<int>( std::lower_bound(x_map.begin(),x_map.end(),s->x0) - x_map.begin() ) ;
+				const int x1 = static_cast<int>( std::lower_bound(x_map.begin(),x_map.end(),s->x1) - x_map.begin() ) ;
+				if( x0 < x1 )
+				{
+					append( row , x0 , x1 ) ;
+					std::fill( p+x0 , p+x1 , 0xff ) ;
+				}
+			}
+		}
+		if( !row.empty() )
+			plane.empty = false ;
+	}
 }
 
 void Gv::Mask::findOrCreate( bool create )
@@ -123,7 +224,7 @@ Gr::PnmInfo Gv::Mask::read( std::ifstream & file , Gr::ImageData & image_data )
 
 bool Gv::Mask::empty() const
 {
-	return m_empty ;
+	return m_plane->empty ;
 }
 
 G::EpochTime Gv::Mask::time() const
@@ -142,14 +243,16 @@ void Gv::Mask::write( const G::Path & path ) const
 	if( !f.good() ) 
 		throw std::runtime_error( "cannot write mask file [" + path.str() + "]" ) ;
 
+	const int dx = m_plane->dx ;
+	const int dy = m_plane->dy ;
 	f << "P1\n" ;
-	f << m_dx << " " << m_dy << "\n" ;
-	for( int y = 0 ; y < m_dy ; y++ )
+	f << dx << " " << dy << "\n" ;
+	for( int y = 0 ; y < dy ; y++ )
 	{
 		const char * sep = "" ;
-		for( int x = 0 ; x < m_dx ; x++ , sep = " " )
+		for( int x = 0 ; x < dx ; x++ , sep = " " )
 		{
-			f << sep << (m_map[y*m_dx+x]?"1":"0") ; // masked-out = black = "1"
+			f << sep << (masked(static_cast<size_t>(y)*dx+x)?"1":"0") ; // masked-out = black = "1"
 		}
 		f << "\n" ;
 	}
@@ -160,12 +263,12 @@ void Gv::Mask::write( const G::Path & path ) const
 
 int Gv::Mask::clip_x( int x ) const
 {
-	return std::min( std::max(0,x) , m_dx-1 ) ;
+	return std::min( std::max(0,x) , m_plane->dx-1 ) ;
 }
 
 int Gv::Mask::clip_y( int y ) const
 {
-	return std::min( std::max(0,y) , m_dy-1 ) ;
+	return std::min( std::max(0,y) , m_plane->dy-1 ) ;
 }
 
 void Gv::Mask::down( int x , int y , bool shift , bool control )
@@ -180,34 +283,42 @@ void Gv::Mask::move( int x , int y )
 {
 	if( m_down )
 	{
-		fill( m_map_current , m_down_x , m_down_y , m_move_x , m_move_y , false ) ;
 		m_move_x = clip_x(x) ;
 		m_move_y = clip_y(y) ;
-		fill( m_map_current , m_down_x , m_down_y , m_move_x , m_move_y , true ) ;
 	}
 }
 
-bool Gv::Mask::fill( std::vector<bool> & map , int x0 , int y0 , int x1 , int y1 , bool b )
+void Gv::Mask::fill( int x0 , int y0 , int x1 , int y1 , bool b )
 {
-	bool changed = false ;
-	for( int x = std::min(x0,x1) ; x < std::max(x0,x1) ; x++ )
+	const int dx = m_plane->dx ;
+	for( int y = std::min(y0,y1) ; y < std::max(y0,y1) ; y++ )
 	{
-		for( int y = std::min(y0,y1) ; y < std::max(y0,y1) ; y++ )
-		{
-			size_t offset = y*m_dx+x ;
-			if( !changed && (map[offset]!= b) ) changed = true ;
-			map[offset] = b ;
-		}
+		unsigned char * p = &m_plane->data[static_cast<size_t>(y)*dx] ;
+		std::fill( p+std::min(x0,x1) , p+std::max(x0,x1) , b ? 0xff : 0 ) ;
 	}
-	return changed ;
 }
 
 void Gv::Mask::up( int up_x , int up_y , bool shift , bool control )
 {
 	m_down = false ;
-	m_map_current.assign( m_map_current.size() , false ) ;
-	if( fill( m_map , m_down_x , m_down_y , clip_x(up_x) , clip_y(up_y) , !m_down_shift ) && !m_down_shift )
-		m_empty = false ;
+	fill( m_down_x , m_down_y , clip_x(up_x) , clip_y(up_y) , !m_down_shift ) ;
+
+	// the edited plane becomes the new source
+	const int dx = m_plane->dx ;
+	const int dy = m_plane->dy ;
+	m_source_dx = dx ;
+	m_source_dy = dy ;
+	m_source.assign( dy , Row() ) ;
+	for( int y = 0 ; y < dy ; y++ )
+	{
+		const unsigned char * p = &m_plane->data[static_cast<size_t>(y)*dx] ;
+		for( int x = 0 ; x < dx ; x++ )
+		{
+			if( p[x] )
+				append( m_source[y] , x , x+1 ) ;
+		}
+	}
+	reset( dx , dy ) ;
 }
 
 bool Gv::Mask::update()
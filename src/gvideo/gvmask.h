@@ -27,6 +27,8 @@
 #include "grpnm.h"
 #include <string>
 #include <vector>
+#include <list>
+#include <algorithm>
 #include <istream>
 
 namespace Gv
@@ -38,25 +40,47 @@ namespace Gv
 /// Implements a binary mask over an image that can be edited by mouse actions, 
 /// and that can be stored on disk.
 /// 
+/// The mask is held as a list of masked runs for each row at the resolution
+/// of the mask file. Resampled copies are built from the runs whenever a new
+/// size is needed, and these are cached so that switching between image sizes 
+/// does not involve re-reading or re-sampling the file. Each copy has its
+/// own runs and a byte plane, so callers can either skip masked spans or use 
+/// the plane for per-pixel tests.
+/// 
 class Gv::Mask
 {
 public:
+	struct Span /// A run of masked pixels in a row, from x0 up to but not including x1.
+	{
+		int x0 ;
+		int x1 ;
+	} ;
+	typedef std::vector<Span> Row ;
+
 	Mask( int dx , int dy , const std::string & file = std::string() , bool create = false ) ;
 		///< Constructor, optionally reading the mask from an existing
 		///< file. If the file is a different size from the parameters 
 		///< then its contents are resampled to fit.
 
 	bool empty() const ;
-		///< Returns true if empty.
+		///< Returns true if nothing is masked at the current size.
+
+	int dx() const ;
+		///< Returns the current width.
+
+	int dy() const ;
+		///< Returns the current height.
 
 	void write( const G::Path & filename ) const ;
-		///< Writes to file.
+		///< Writes to file at the current size.
 
 	bool update() ;
-		///< Updates the mask from the file. Returns true if updated.
+		///< Updates the mask from the file if the file has been
+		///< modified. Returns true if updated.
 
-	void scale( int factor ) ;
-		///< Scales down.
+	void resize( int dx , int dy ) ;
+		///< Changes the current size of the mask, resampling from 
+		///< the mask file's resolution or reusing a cached copy.
 
 	void up( int x , int y , bool shift , bool control ) ;
 		///< Called on mouse-up. Commits any down()/move() edits.
@@ -73,29 +97,52 @@ public:
 	bool masked( size_t ) const ;
 		///< Optimised overload, ignoring the current edit.
 
+	const Row & row( int y ) const ;
+		///< Returns the masked runs for the given row, in order and
+		///< non-overlapping, ignoring the current edit.
+
+	const unsigned char * plane() const ;
+		///< Returns the mask as a contiguous plane of dx*dy bytes,
+		///< with 0xff for masked pixels and zero otherwise, ignoring 
+		///< the current edit. This is intended for vectorised code 
+		///< such as Gv::FrameDiff.
+
 	G::EpochTime time() const ;
 		///< Returns the timestamp on the mask file at 
-		///< construction, not affected by any calls
-		///< to write().
+		///< construction or at the last update(), not 
+		///< affected by any calls to write().
+
+private:
+	struct Plane
+	{
+		int dx ;
+		int dy ;
+		bool empty ;
+		std::vector<Row> rows ;
+		std::vector<unsigned char> data ;
+	} ;
 
 private:
 	Mask( const Mask & ) ;
 	void operator=( const Mask & ) ;
 	int clip_x( int ) const ;
 	int clip_y( int ) const ;
-	bool fill( std::vector<bool>& , int , int , int , int , bool ) ;
+	bool editing( int x , int y ) const ;
+	void fill( int , int , int , int , bool ) ;
 	void sample( const Gr::ImageData & image_data , const Gr::PnmInfo & info ) ;
+	void build( Plane & , int dx , int dy ) const ;
+	void reset( int dx , int dy ) ;
 	void findOrCreate( bool ) ;
 	void open( std::ifstream & file ) ;
 	Gr::PnmInfo read( std::ifstream & file , Gr::ImageData & image_data ) ;
 
 private:
-	int m_dx ;
-	int m_dy ;
+	int m_source_dx ;
+	int m_source_dy ;
+	std::vector<Row> m_source ; // masked runs at the file's resolution
+	std::list<Plane> m_cache ; // most-recently used first
+	Plane * m_plane ;
 	G::Path m_path ;
-	bool m_empty ;
-	std::vector<bool> m_map ;
-	std::vector<bool> m_map_current ;
 	bool m_down ;
 	int m_down_x ;
 	int m_down_y ;
@@ -105,20 +152,54 @@ private:
 	G::EpochTime m_file_time ;
 } ;
 
+inline
+int Gv::Mask::dx() const
+{
+	return m_plane->dx ;
+}
+
+inline
+int Gv::Mask::dy() const
+{
+	return m_plane->dy ;
+}
+
 inline
 bool Gv::Mask::masked( size_t offset ) const
 {
-	return m_map[offset] ;
+	return m_plane->data[offset] != 0 ;
+}
+
+inline
+const Gv::Mask::Row & Gv::Mask::row( int y ) const
+{
+	return m_plane->rows[y] ;
+}
+
+inline
+const unsigned char * Gv::Mask::plane() const
+{
+	return &m_plane->data[0] ;
+}
+
+inline
+bool Gv::Mask::editing( int x , int y ) const
+{
+	return 
+		x >= std::min(m_down_x,m_move_x) && x < std::max(m_down_x,m_move_x) &&
+		y >= std::min(m_down_y,m_move_y) && y < std::max(m_down_y,m_move_y) ;
 }
 
 inline
 bool Gv::Mask::masked( int x , int y ) const
 {
-	const size_t offset = y * m_dx + x ;
-	if( m_down && m_down_shift )
-		return m_map[offset] && !m_map_current[offset] ;
+	const bool b = masked( static_cast<size_t>(y) * m_plane->dx + x ) ;
+	if( !m_down )
+		return b ;
+	else if( m_down_shift )
+		return b && !editing(x,y) ;
 	else
-		return m_map[offset] || m_map_current[offset] ;
+		return b || editing(x,y) ;
 }
 
 #endif
@@ -25,6 +25,7 @@
 #include "gdate.h"
 #include "gtime.h"
 #include "gfiletree.h"
+#include "gvsegment.h"
 #include "gassert.h"
 #include <algorithm>
 #include <string>
@@ -99,7 +100,8 @@ void Gv::Ribbon::scan( const Gv::RibbonRange & range )
 {
 	if( !m_list.empty() )
 	{
-		G::FileTree file_tree ;
+		Gv::SegmentTree segments ;
+		G::FileTree file_tree( G::Path() , &segments ) ;
 		if( scanStart( file_tree , range ) )
 			scanSome( file_tree , G::EpochTime(0) ) ;
 	}
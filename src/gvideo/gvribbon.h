@@ -138,6 +138,8 @@ public:
 		///< Prepares for an iterative scan, with subsequent calls to scanSome(). 
 		///< The default-constructed G::FileTree object contains the scan
 		///< state. Returns true if there is scanSome() work to do.
+		///< The G::FileTree should have a Gv::SegmentTree callback if 
+		///< segment files are to be scanned.
 
 	bool scanStart( G::FileTree & , const G::Path & path , size_t tpos ) ;
 		///< Prepares for an iterative scan, with subsequent calls to scanSome(). 
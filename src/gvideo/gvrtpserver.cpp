@@ -36,10 +36,14 @@
 
 Gv::RtpServer::RtpServer( RtpServerHandler & handler , int scale , bool monochrome , GNet::Address bind_address , 
 	const std::string & group_address , unsigned int packet_type , const G::Path & fmtp_file , 
-	int jpeg_fudge_factor , const std::string & filter_spec , unsigned int source_stale_timeout ) :
+	int jpeg_fudge_factor , const std::string & filter_spec , unsigned int source_stale_timeout ,
+	bool images , bool motion_vectors , bool avc_passthrough ) :
 		m_handler(handler) ,
 		m_scale(scale) ,
 		m_monochrome(monochrome) ,
+		m_images(images) ,
+		m_motion_vectors(motion_vectors) ,
+		m_avc_passthrough(avc_passthrough) ,
 		m_packet_type(packet_type) ,
 		m_source_id(0) ,
 		m_source_time(0) ,
@@ -51,6 +55,8 @@ Gv::RtpServer::RtpServer( RtpServerHandler & handler , int scale , bool monochro
 		m_packet_buffer(1500U) ,
 		m_packet_stream(jpeg_fudge_factor) ,
 		m_seq_old(0U) ,
+		m_avc_access_unit_timestamp(0UL) ,
+		m_avc_access_unit_key_frame(false) ,
 		m_test_timer(*this,&RtpServer::onTimer,*this) ,
 		m_test_index(0)
 {
@@ -246,7 +252,11 @@ void Gv::RtpServer::processRtpData( const char * p , std::string::size_type n )
 			m_packet_stream.add( rtp_packet , avc_packet ) ;
 
 		while( m_packet_stream.more() )
-			processAvcPayload( m_packet_stream.get() ) ;
+			processAvcPayload( m_packet_stream.get() , rtp_packet.timestamp() ) ;
+
+		// the marker bit is set on the last packet of each access unit
+		if( m_avc_passthrough && rtp_packet.marker() )
+			passAvcAccessUnit() ;
 	}
 }
 
@@ -276,6 +286,8 @@ void Gv::RtpServer::processJpegPayload( const std::vector<char> & payload )
 	Gr::JpegInfo jpeg_info( &payload[0] , payload.size() ) ;
 	Gr::ImageType image_type = Gr::ImageType::jpeg( jpeg_info.dx() , jpeg_info.dy() , jpeg_info.channels() ) ;
 	G_DEBUG( "Gv::RtpServer::processJpegFrame: processing jpeg image: " << image_type ) ;
+	if( !m_images )
+		return ;
 
 	int scale = autoscale( m_scale , jpeg_info.dx() ) ;
 	if( scale > 1 || m_monochrome )
@@ -291,7 +303,7 @@ void Gv::RtpServer::processJpegPayload( const std::vector<char> & payload )
 	}
 }
 
-void Gv::RtpServer::processAvcPayload( const std::vector<char> & payload )
+void Gv::RtpServer::processAvcPayload( const std::vector<char> & payload , unsigned long timestamp )
 {
 	// lazy decoding of the fmtp into the avcc and lazy construction of the decoder reader stream
 	if( m_avcc.get() == nullptr && m_fmtp_file != G::Path() )
@@ -307,15 +319,24 @@ void Gv::RtpServer::processAvcPayload( const std::vector<char> & payload )
 			m_avcc.reset( new Gr::Avc::Configuration(avcc) ) ;
 
 			if( m_avc_reader_stream.get() == nullptr )
-				m_avc_reader_stream.reset( new Gv::AvcReaderStream( *m_avcc.get() ) ) ;
+				m_avc_reader_stream.reset( new Gv::AvcReaderStream( *m_avcc.get() , m_motion_vectors ) ) ;
 		}
 	}
 
+	// in pass-through mode only decode for the motion vectors
+	if( m_avc_passthrough )
+	{
+		if( m_images )
+			passAvcPayload( payload , timestamp ) ;
+		if( !m_motion_vectors )
+			return ;
+	}
+
 	// if no fmtp then create a decoder reader stream without the avcc and rely on SPS and PPS NALUs
 	if( m_avc_reader_stream.get() == nullptr )
 	{
 		G_DEBUG( "Gv::RtpServer::processAvcFrame: initialising avc decoder without fmtp" ) ;
-		m_avc_reader_stream.reset( new Gv::AvcReaderStream ) ;
+		m_avc_reader_stream.reset( new Gv::AvcReaderStream( m_motion_vectors ) ) ;
 	}
 
 	// decode
@@ -323,9 +344,16 @@ void Gv::RtpServer::processAvcPayload( const std::vector<char> & payload )
 	Gv::AvcReader reader( *m_avc_reader_stream.get() , &payload[0] , payload.size() ) ;
 	if( reader.valid() )
 	{
-		m_output_buffer.clear() ;
-		Gr::ImageType image_type = reader.fill( m_output_buffer , autoscale(m_scale,reader.dx()) , m_monochrome ) ;
-		m_handler.onImage( m_output_buffer , image_type , reader.keyframe() ) ;
+		if( m_motion_vectors )
+		{
+			m_handler.onMotion( reader.motion() , reader.dx() , reader.dy() ) ;
+		}
+		if( m_images && !m_avc_passthrough )
+		{
+			m_output_buffer.clear() ;
+			Gr::ImageType image_type = reader.fill( m_output_buffer , autoscale(m_scale,reader.dx()) , m_monochrome ) ;
+			m_handler.onImage( m_output_buffer , image_type , reader.keyframe() ) ;
+		}
 	}
 	else
 	{
@@ -333,6 +361,74 @@ void Gv::RtpServer::processAvcPayload( const std::vector<char> & payload )
 	}
 }
 
+void Gv::RtpServer::passAvcPayload( const std::vector<char> & payload , unsigned long timestamp )
+{
+	// each payload is one NALU with a four-byte start-code
+	if( payload.size() <= 4U )
+		return ;
+	const unsigned int nalu_type = static_cast<unsigned char>(payload[4]) & 0x1fU ;
+
+	// a new timestamp ends the current access unit in case its marker bit was lost
+	if( !m_avc_access_unit.empty() && timestamp != m_avc_access_unit_timestamp )
+		passAvcAccessUnit() ;
+
+	// keep the parameter sets to go in front of the next key frame
+	if( nalu_type == 7U )
+	{
+		m_avc_sps = payload ;
+		Gr::Avc::Sps sps( std::string(&payload[4],payload.size()-4U) ) ;
+		if( sps.valid() )
+			m_avc_type = Gr::ImageType::avc( static_cast<int>(sps.dx()) , static_cast<int>(sps.dy()) ) ;
+		return ;
+	}
+	else if( nalu_type == 8U )
+	{
+		m_avc_pps = payload ;
+		return ;
+	}
+	else if( nalu_type != 1U && nalu_type != 5U ) // not a coded slice, eg. SEI
+	{
+		return ;
+	}
+
+	if( !m_avc_type.valid() && m_avcc.get() != nullptr && m_avcc->spsCount() != 0U )
+		m_avc_type = Gr::ImageType::avc( static_cast<int>(m_avcc->sps(0).dx()) , static_cast<int>(m_avcc->sps(0).dy()) ) ;
+	if( !m_avc_type.valid() )
+	{
+		G_DEBUG( "Gv::RtpServer::passAvcPayload: no sps yet: picture ignored" ) ;
+		return ;
+	}
+
+	// collect the slices of the picture until the end of the access unit
+	m_avc_access_unit.insert( m_avc_access_unit.end() , payload.begin() , payload.end() ) ;
+	m_avc_access_unit_timestamp = timestamp ;
+	if( nalu_type == 5U )
+		m_avc_access_unit_key_frame = true ;
+}
+
+void Gv::RtpServer::passAvcAccessUnit()
+{
+	if( m_avc_access_unit.empty() )
+		return ;
+
+	const bool key_frame = m_avc_access_unit_key_frame ;
+	m_output_buffer.clear() ;
+	if( key_frame && !m_avc_sps.empty() && !m_avc_pps.empty() )
+	{
+		m_output_buffer.insert( m_output_buffer.end() , m_avc_sps.begin() , m_avc_sps.end() ) ;
+		m_output_buffer.insert( m_output_buffer.end() , m_avc_pps.begin() , m_avc_pps.end() ) ;
+	}
+	else if( key_frame && m_avcc.get() != nullptr )
+	{
+		std::string nalus = m_avcc->nalus() ;
+		m_output_buffer.insert( m_output_buffer.end() , nalus.begin() , nalus.end() ) ;
+	}
+	m_output_buffer.insert( m_output_buffer.end() , m_avc_access_unit.begin() , m_avc_access_unit.end() ) ;
+	m_avc_access_unit.clear() ;
+	m_avc_access_unit_key_frame = false ;
+	m_handler.onImage( m_output_buffer , m_avc_type , key_frame ) ;
+}
+
 int Gv::RtpServer::autoscale( int s , int dx )
 {
 	if( s == -1 ) // "auto"
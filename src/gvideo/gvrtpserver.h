@@ -56,10 +56,26 @@ public:
 
 	RtpServer( RtpServerHandler & , int scale , bool monochrome , GNet::Address bind_address , const std::string & group_address , 
 		unsigned int packet_type , const G::Path & fmtp_file ,
-		int jpeg_fudge_factor , const std::string & filter_spec , unsigned int source_stale_timeout ) ;
+		int jpeg_fudge_factor , const std::string & filter_spec , unsigned int source_stale_timeout ,
+		bool images , bool motion_vectors , bool avc_passthrough = false ) ;
 			///< Constructor. The received images are delivered to the given
 			///< callback interface.
 			///< 
+			///< If the 'avc-passthrough' flag is true then H.264 pictures
+			///< are delivered without decoding as "video/h264" NALU 
+			///< byte-streams, with the SPS and PPS parameter sets in front
+			///< of each key frame. The H.264 decoder is then only used 
+			///< for motion vectors, if at all. Each delivered picture is 
+			///< one whole access unit, so a picture that the camera has 
+			///< encoded as several slices (ie. several NALUs) is collected
+			///< up until the RTP marker bit or a change of RTP timestamp.
+			///< 
+			///< If the 'images' flag is false then images are not delivered, 
+			///< and H.264 images are decoded without any conversion to RGB. 
+			///< If the 'motion-vectors' flag is true then the H.264 decoder's
+			///< motion vectors are summarised and delivered for each decoded 
+			///< image.
+			///< 
 			///< If a non-zero packet type is specified it should normally be
 			///< 26 for "JPEG/90000" or some value in the dynamic range (96..127) 
 			///< for "H264/90000". In principle the sdp attribute "rtpmap"
@@ -77,7 +93,9 @@ private:
 	void onData( const char * p , std::string::size_type n ) ;
 	void processRtpData( const char * p , std::string::size_type n ) ;
 	void processJpegPayload( const std::vector<char> & ) ;
-	void processAvcPayload( const std::vector<char> & ) ;
+	void processAvcPayload( const std::vector<char> & , unsigned long timestamp ) ;
+	void passAvcPayload( const std::vector<char> & , unsigned long timestamp ) ;
+	void passAvcAccessUnit() ;
 	bool filter( const RtpAvcPacket & ) const ;
 	bool filter( const RtpJpegPacket & ) const ;
 	void onTimer() ;
@@ -89,6 +107,9 @@ private:
 	RtpServerHandler & m_handler ;
 	int m_scale ; // -1 for auto-scaling
 	bool m_monochrome ;
+	bool m_images ;
+	bool m_motion_vectors ;
+	bool m_avc_passthrough ;
 	unsigned int m_packet_type ;
 	unsigned long m_source_id ;
 	time_t m_source_time ;
@@ -104,6 +125,12 @@ private:
 	std::vector<char> m_output_buffer ;
 	unsigned int m_seq_old ;
 	unique_ptr<Gv::AvcReaderStream> m_avc_reader_stream ;
+	std::vector<char> m_avc_sps ;
+	std::vector<char> m_avc_pps ;
+	Gr::ImageType m_avc_type ;
+	std::vector<char> m_avc_access_unit ; // slices of the current picture
+	unsigned long m_avc_access_unit_timestamp ;
+	bool m_avc_access_unit_key_frame ;
 	GNet::Timer<RtpServer> m_test_timer ;
 	int m_test_index ;
 	Gr::JpegReader m_jpeg_reader ;
@@ -120,9 +147,14 @@ class Gv::RtpServerHandler
 public:
 	virtual void onImage( const std::vector<char> & , const Gr::ImageType & , bool avc_key_frame ) = 0 ;
 		///< Called on receipt of an image. This is either an un-compressed 
-		///< JPEG image in JFIF format, or a fully-decoded AVC image.
+		///< JPEG image in JFIF format, a fully-decoded AVC image, or
+		///< an undecoded AVC picture in pass-through mode.
 		///< The recipient is free to modify the data buffer.
 
+	virtual void onMotion( const Gv::AvcReader::Motion & , int dx , int dy ) = 0 ;
+		///< Called with a summary of the motion vectors after each AVC 
+		///< image is decoded, if enabled.
+
 protected:
 	virtual ~RtpServerHandler() ;
 } ;
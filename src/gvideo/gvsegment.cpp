@@ -0,0 +1,678 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// gvsegment.cpp
+//
+
+#include "gdef.h"
+#include "gvsegment.h"
+#include "groot.h"
+#include "gfile.h"
+#include "gassert.h"
+#include "glog.h"
+#include <algorithm>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+	// the file layout is a file magic number, a sequence of records, an
+	// optional index, and then a trailer if there is an index -- numbers
+	// are stored big-endian
+	//
+	// record: tag[4] name-size[4] data-size[4] seconds[8] microseconds[4] name data
+	// index entry: name-size[4] data-offset[8] data-size[4] seconds[8] microseconds[4] flags[4] name
+	// trailer: index-offset[8] index-magic[8]
+	//
+	// records for images that depend on earlier ones (ie. h264 pictures
+	// other than key frames) have a different tag and index flag -- an
+	// old "vtidx01" index without flags is ignored and the records are 
+	// scanned instead
+	//
+	// a reference record stands in for a repeat of an earlier image in
+	// the same segment -- its data is the earlier image's data-offset[8] 
+	// and data-size[4], and its index entry points straight at the 
+	// earlier image's data
+	//
+	const char file_magic[] = "vtseg01\n" ;
+	const char index_magic[] = "vtidx02\n" ;
+	const char record_tag[] = "rec\n" ;
+	const char dependent_record_tag[] = "dep\n" ;
+	const char reference_record_tag[] = "ref\n" ;
+	const unsigned int dependent_flag = 1U ;
+	const size_t magic_size = 8U ;
+	const size_t tag_size = 4U ;
+	const size_t record_header_size = 24U ;
+	const size_t reference_size = 12U ;
+	const size_t entry_header_size = 32U ;
+	const size_t trailer_size = 16U ;
+
+	// the length of "yyyy/mm/dd/hh/mm" within an image path
+	const size_t minute_length = 16U ;
+
+	void put( std::string & s , unsigned long long n , size_t size )
+	{
+		for( size_t i = 0U ; i < size ; i++ )
+			s.append( 1U , static_cast<char>( (n >> (8U*(size-i-1U))) & 0xffU ) ) ;
+	}
+
+	unsigned long long get( const char * p , size_t size )
+	{
+		unsigned long long n = 0U ;
+		for( size_t i = 0U ; i < size ; i++ )
+			n = ( n << 8U ) | static_cast<unsigned char>(p[i]) ;
+		return n ;
+	}
+
+	bool readAt( int fd , unsigned long long offset , char * p , size_t n )
+	{
+		while( n )
+		{
+			ssize_t rc = ::pread( fd , p , n , static_cast<off_t>(offset) ) ;
+			if( rc <= 0 )
+				return false ;
+			p += rc ;
+			n -= static_cast<size_t>(rc) ;
+			offset += static_cast<unsigned long long>(rc) ;
+		}
+		return true ;
+	}
+
+	template <typename E>
+	bool readIndex( int fd , unsigned long long size , std::vector<E> & index , unsigned long long & end )
+	{
+		// use the index if there is one
+		char buffer[record_header_size] ;
+		if( size >= (magic_size+trailer_size) && readAt( fd , size-trailer_size , buffer , trailer_size ) &&
+			std::memcmp( buffer+8 , index_magic , magic_size ) == 0 )
+		{
+			const unsigned long long index_offset = get( buffer , 8U ) ;
+			if( index_offset >= magic_size && index_offset <= (size-trailer_size) )
+			{
+				std::vector<char> data( static_cast<size_t>(size-trailer_size-index_offset) ) ;
+				if( data.empty() || readAt( fd , index_offset , &data[0] , data.size() ) )
+				{
+					bool ok = true ;
+					for( size_t pos = 0U ; ok && pos < data.size() ; )
+					{
+						ok = (pos+entry_header_size) <= data.size() ;
+						E e ;
+						const size_t name_size = ok ? static_cast<size_t>(get(&data[pos],4U)) : 0U ;
+						ok = ok && (pos+entry_header_size+name_size) <= data.size() ;
+						if( ok )
+						{
+							e.offset = get( &data[pos+4U] , 8U ) ;
+							e.size = static_cast<size_t>( get( &data[pos+12U] , 4U ) ) ;
+							e.time = G::EpochTime( static_cast<std::time_t>(get(&data[pos+16U],8U)) ,
+								static_cast<unsigned long>(get(&data[pos+24U],4U)) ) ;
+							e.dependent = ( get(&data[pos+28U],4U) & dependent_flag ) != 0U ;
+							e.name.assign( &data[pos+entry_header_size] , name_size ) ;
+							ok = (e.offset+e.size) <= index_offset ;
+							index.push_back( e ) ;
+							pos += entry_header_size + name_size ;
+						}
+					}
+					if( ok )
+					{
+						end = index_offset ;
+						return true ;
+					}
+				}
+			}
+			index.clear() ;
+		}
+
+		// otherwise scan the records, stopping at the first incomplete one
+		unsigned long long pos = magic_size ;
+		while( (pos+record_header_size) <= size && readAt( fd , pos , buffer , record_header_size ) &&
+			( std::memcmp( buffer , record_tag , tag_size ) == 0 || std::memcmp( buffer , dependent_record_tag , tag_size ) == 0 ||
+				std::memcmp( buffer , reference_record_tag , tag_size ) == 0 ) )
+		{
+			E e ;
+			e.dependent = std::memcmp( buffer , dependent_record_tag , tag_size ) == 0 ;
+			const bool reference = std::memcmp( buffer , reference_record_tag , tag_size ) == 0 ;
+			const size_t name_size = static_cast<size_t>( get( buffer+4 , 4U ) ) ;
+			e.size = static_cast<size_t>( get( buffer+8 , 4U ) ) ;
+			e.time = G::EpochTime( static_cast<std::time_t>(get(buffer+12,8U)) , static_cast<unsigned long>(get(buffer+20,4U)) ) ;
+			e.offset = pos + record_header_size + name_size ;
+			if( (e.offset+e.size) > size || ( reference && e.size != reference_size ) )
+				break ;
+			e.name.resize( name_size ) ;
+			if( name_size && !readAt( fd , pos+record_header_size , &e.name[0] , name_size ) )
+				break ;
+			pos = e.offset + e.size ;
+			if( reference )
+			{
+				if( !readAt( fd , e.offset , buffer , reference_size ) )
+					break ;
+				e.offset = get( buffer , 8U ) ;
+				e.size = static_cast<size_t>( get( buffer+8 , 4U ) ) ;
+				if( e.offset < magic_size || (e.offset+e.size) > pos )
+					break ;
+			}
+			index.push_back( e ) ;
+		}
+		end = pos ;
+		return true ;
+	}
+
+	bool isSegment( int fd )
+	{
+		char buffer[magic_size] ;
+		return readAt( fd , 0U , buffer , magic_size ) && std::memcmp( buffer , file_magic , magic_size ) == 0 ;
+	}
+}
+
+Gv::SegmentWriter::Entry::Entry() :
+	time(0) ,
+	offset(0U) ,
+	size(0U) ,
+	dependent(false)
+{
+}
+
+// ==
+
+Gv::SegmentWriter::SegmentWriter( const G::Path & base_dir ) :
+	m_base_dir(base_dir) ,
+	m_fd(-1) ,
+	m_offset(0U)
+{
+}
+
+Gv::SegmentWriter::~SegmentWriter()
+{
+	try
+	{
+		close() ;
+	}
+	catch(...) // dtor
+	{
+	}
+}
+
+const G::Path & Gv::SegmentWriter::base() const
+{
+	return m_base_dir ;
+}
+
+bool Gv::SegmentWriter::split( const std::string & base_dir , const std::string & path ,
+	std::string & segment_path , std::string & name )
+{
+	const size_t pos = base_dir.length() + 1U + minute_length ;
+	if( path.length() <= (pos+1U) || path.find(base_dir) != 0U || path.at(base_dir.length()) != '/' || path.at(pos) != '/' )
+		return false ;
+	segment_path = path.substr( 0U , pos ) ;
+	name = path.substr( pos+1U ) ;
+	return true ;
+}
+
+bool Gv::SegmentWriter::write( const std::string & path , G::EpochTime time , const Parts & parts , bool dependent )
+{
+	std::string segment_path ;
+	std::string name ;
+	if( !split( m_base_dir.str() , path , segment_path , name ) )
+		return false ;
+
+	if( segment_path != m_path )
+	{
+		close() ;
+		if( segment_path == m_bad_path || !open( segment_path ) )
+		{
+			m_bad_path = segment_path ;
+			return false ;
+		}
+	}
+
+	size_t data_size = 0U ;
+	for( Parts::const_iterator p = parts.begin() ; p != parts.end() ; ++p )
+		data_size += (*p).second ;
+
+	std::string header( dependent ? dependent_record_tag : record_tag , tag_size ) ;
+	put( header , name.size() , 4U ) ;
+	put( header , data_size , 4U ) ;
+	put( header , static_cast<unsigned long long>(time.s) , 8U ) ;
+	put( header , time.us , 4U ) ;
+	header.append( name ) ;
+
+	bool ok = append( header.data() , header.size() ) ;
+	for( Parts::const_iterator p = parts.begin() ; ok && p != parts.end() ; ++p )
+		ok = append( (*p).first , (*p).second ) ;
+
+	if( !ok )
+	{
+		// discard the partial record
+		G_WARNING( "Gv::SegmentWriter::write: segment write error [" << m_path << "]" ) ;
+		if( ::ftruncate( m_fd , static_cast<off_t>(m_offset) ) < 0 || ::lseek( m_fd , static_cast<off_t>(m_offset) , SEEK_SET ) < 0 )
+		{
+			::close( m_fd ) ;
+			m_fd = -1 ;
+			m_path.clear() ;
+		}
+		return false ;
+	}
+
+	Entry e ;
+	e.name = name ;
+	e.time = time ;
+	e.offset = m_offset + header.size() ;
+	e.size = data_size ;
+	e.dependent = dependent ;
+	m_index.push_back( e ) ;
+	m_offset = e.offset + e.size ;
+	return true ;
+}
+
+bool Gv::SegmentWriter::writeReference( const std::string & path , G::EpochTime time , const std::string & target_path )
+{
+	std::string segment_path ;
+	std::string name ;
+	std::string target_segment_path ;
+	std::string target_name ;
+	if( m_fd == -1 || !split( m_base_dir.str() , path , segment_path , name ) || segment_path != m_path ||
+		!split( m_base_dir.str() , target_path , target_segment_path , target_name ) || target_segment_path != m_path )
+			return false ;
+
+	// the target is normally the most recent entry
+	std::vector<Entry>::const_reverse_iterator target = m_index.rbegin() ;
+	for( ; target != m_index.rend() && (*target).name != target_name ; ++target )
+		{;}
+	if( target == m_index.rend() || (*target).dependent )
+		return false ;
+
+	std::string record( reference_record_tag , tag_size ) ;
+	put( record , name.size() , 4U ) ;
+	put( record , reference_size , 4U ) ;
+	put( record , static_cast<unsigned long long>(time.s) , 8U ) ;
+	put( record , time.us , 4U ) ;
+	record.append( name ) ;
+	put( record , (*target).offset , 8U ) ;
+	put( record , (*target).size , 4U ) ;
+
+	Entry e ;
+	e.name = name ;
+	e.time = time ;
+	e.offset = (*target).offset ;
+	e.size = (*target).size ;
+	if( !append( record.data() , record.size() ) )
+	{
+		G_WARNING( "Gv::SegmentWriter::writeReference: segment write error [" << m_path << "]" ) ;
+		if( ::ftruncate( m_fd , static_cast<off_t>(m_offset) ) < 0 || ::lseek( m_fd , static_cast<off_t>(m_offset) , SEEK_SET ) < 0 )
+		{
+			::close( m_fd ) ;
+			m_fd = -1 ;
+			m_path.clear() ;
+		}
+		return false ;
+	}
+
+	m_index.push_back( e ) ;
+	m_offset += record.size() ;
+	return true ;
+}
+
+bool Gv::SegmentWriter::append( const char * p , size_t n )
+{
+	while( n )
+	{
+		ssize_t rc = ::write( m_fd , p , n ) ;
+		if( rc <= 0 )
+			return false ;
+		p += rc ;
+		n -= static_cast<size_t>(rc) ;
+	}
+	return true ;
+}
+
+bool Gv::SegmentWriter::open( const std::string & segment_path )
+{
+	G_ASSERT( m_fd == -1 ) ;
+	m_index.clear() ;
+	{
+		G::Root claim_root ;
+		G::File::mkdirs( G::Path(segment_path).dirname() , G::File::NoThrow() ) ;
+		m_fd = ::open( segment_path.c_str() , O_RDWR | O_CREAT ,
+			S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH ) ;
+	}
+	if( m_fd == -1 )
+	{
+		G_WARNING( "Gv::SegmentWriter::open: cannot open segment [" << segment_path << "]" ) ;
+		return false ;
+	}
+
+	// start a new segment, or re-open an old one by truncating its index
+	bool ok = false ;
+	struct stat statbuf ;
+	if( ::fstat( m_fd , &statbuf ) == 0 && statbuf.st_size == 0 )
+	{
+		m_offset = magic_size ;
+		ok = append( file_magic , magic_size ) ;
+	}
+	else
+	{
+		ok =
+			isSegment( m_fd ) &&
+			readIndex( m_fd , static_cast<unsigned long long>(statbuf.st_size) , m_index , m_offset ) &&
+			::ftruncate( m_fd , static_cast<off_t>(m_offset) ) == 0 &&
+			::lseek( m_fd , static_cast<off_t>(m_offset) , SEEK_SET ) >= 0 ;
+	}
+	if( !ok )
+	{
+		G_WARNING( "Gv::SegmentWriter::open: invalid segment file [" << segment_path << "]" ) ;
+		::close( m_fd ) ;
+		m_fd = -1 ;
+		m_index.clear() ;
+		return false ;
+	}
+
+	G_DEBUG( "Gv::SegmentWriter::open: segment [" << segment_path << "]: " << m_index.size() << " existing entries" ) ;
+	m_path = segment_path ;
+	return true ;
+}
+
+void Gv::SegmentWriter::close()
+{
+	if( m_fd == -1 )
+		return ;
+
+	std::string index ;
+	index.reserve( m_index.size() * (entry_header_size+20U) + trailer_size ) ;
+	for( std::vector<Entry>::const_iterator p = m_index.begin() ; p != m_index.end() ; ++p )
+	{
+		put( index , (*p).name.size() , 4U ) ;
+		put( index , (*p).offset , 8U ) ;
+		put( index , (*p).size , 4U ) ;
+		put( index , static_cast<unsigned long long>((*p).time.s) , 8U ) ;
+		put( index , (*p).time.us , 4U ) ;
+		put( index , (*p).dependent ? dependent_flag : 0U , 4U ) ;
+		index.append( (*p).name ) ;
+	}
+	put( index , m_offset , 8U ) ;
+	index.append( index_magic , magic_size ) ;
+
+	if( !append( index.data() , index.size() ) )
+		G_WARNING( "Gv::SegmentWriter::close: cannot write segment index [" << m_path << "]" ) ;
+	if( ::close( m_fd ) < 0 )
+		G_WARNING( "Gv::SegmentWriter::close: segment close error [" << m_path << "]" ) ;
+
+	m_fd = -1 ;
+	m_path.clear() ;
+	m_index.clear() ;
+}
+
+// ==
+
+Gv::SegmentReader::SegmentReader() :
+	m_size(0U)
+{
+}
+
+bool Gv::SegmentReader::candidate( const G::DirectoryList::Item & item )
+{
+	// segments are named like the minute directories that they replace
+	return
+		!item.m_is_dir && item.m_name.length() == 2U &&
+		item.m_name[0] >= '0' && item.m_name[0] <= '5' &&
+		item.m_name[1] >= '0' && item.m_name[1] <= '9' ;
+}
+
+bool Gv::SegmentReader::size( const std::string & path , unsigned long long & size_out )
+{
+	struct stat statbuf ;
+	int rc = 0 ;
+	{
+		G::Root claim_root ;
+		rc = ::stat( path.c_str() , &statbuf ) ;
+	}
+	if( rc != 0 || !S_ISREG(statbuf.st_mode) )
+		return false ;
+	size_out = static_cast<unsigned long long>( statbuf.st_size ) ;
+	return true ;
+}
+
+bool Gv::SegmentReader::within( const std::string & path ) const
+{
+	return
+		!m_path.empty() && path.find(m_path) == 0U &&
+		( path.length() == m_path.length() || path.at(m_path.length()) == '/' ) ;
+}
+
+bool Gv::SegmentReader::locate( const G::Path & path_in , bool or_self )
+{
+	const std::string path = path_in.str() ;
+	std::string segment_path ;
+	if( within(path) )
+	{
+		segment_path = m_path ;
+	}
+	else
+	{
+		// find the nearest existing file -- for a stand-alone file that is
+		// the file itself
+		G::Path p = path_in ;
+		unsigned long long file_size = 0U ;
+		for( int i = 0 ; i < 3 ; i++ , p = p.dirname() )
+		{
+			if( size( p.str() , file_size ) )
+			{
+				if( i || or_self )
+					segment_path = p.str() ;
+				break ;
+			}
+		}
+		if( segment_path.empty() )
+			return false ;
+	}
+
+	// (re)read the index if new or if the file has changed size, eg. while
+	// it is still being written
+	unsigned long long file_size = 0U ;
+	if( !size( segment_path , file_size ) )
+	{
+		m_path.clear() ;
+		return false ;
+	}
+	if( segment_path == m_path && file_size == m_size )
+		return true ;
+
+	m_size = file_size ;
+	return open( segment_path ) ;
+}
+
+bool Gv::SegmentReader::open( const std::string & segment_path )
+{
+	m_path.clear() ;
+	m_index.clear() ;
+
+	int fd = -1 ;
+	{
+		G::Root claim_root ;
+		fd = ::open( segment_path.c_str() , O_RDONLY ) ;
+	}
+	if( fd == -1 )
+		return false ;
+
+	unsigned long long end = 0U ;
+	bool ok = isSegment( fd ) && readIndex( fd , m_size , m_index , end ) ;
+	::close( fd ) ;
+	if( !ok )
+	{
+		m_index.clear() ;
+		return false ;
+	}
+
+	// sort by name, keeping only the last of any duplicates
+	struct Less { bool operator()( const Entry & a , const Entry & b ) const { return a.name < b.name ; } } ;
+	std::stable_sort( m_index.begin() , m_index.end() , Less() ) ;
+	List::iterator out = m_index.begin() ;
+	for( List::iterator p = m_index.begin() ; p != m_index.end() ; ++p )
+	{
+		if( (p+1) != m_index.end() && (p+1)->name == p->name )
+			continue ;
+		if( out != p )
+			*out = *p ;
+		++out ;
+	}
+	m_index.erase( out , m_index.end() ) ;
+
+	G_DEBUG( "Gv::SegmentReader::open: segment [" << segment_path << "]: " << m_index.size() << " entries" ) ;
+	m_path = segment_path ;
+	return true ;
+}
+
+const Gv::SegmentReader::Entry * Gv::SegmentReader::find( const G::Path & path_in )
+{
+	if( !locate( path_in , false ) )
+		return nullptr ;
+
+	const std::string path = path_in.str() ;
+	if( path.length() <= (m_path.length()+1U) )
+		return nullptr ;
+
+	Entry key ;
+	key.name = path.substr( m_path.length()+1U ) ;
+	struct Less { bool operator()( const Entry & a , const Entry & b ) const { return a.name < b.name ; } } ;
+	List::const_iterator p = std::lower_bound( m_index.begin() , m_index.end() , key , Less() ) ;
+	if( p == m_index.end() || (*p).name != key.name )
+		return nullptr ;
+
+	return &(*p) ;
+}
+
+bool Gv::SegmentReader::read( const G::Path & path , std::vector<char> & out )
+{
+	bool dependent = false ;
+	return read( path , out , dependent ) ;
+}
+
+bool Gv::SegmentReader::read( const G::Path & path , std::vector<char> & out , bool & dependent )
+{
+	const Entry * p = find( path ) ;
+	if( p == nullptr )
+		return false ;
+	dependent = (*p).dependent ;
+
+	int fd = -1 ;
+	{
+		G::Root claim_root ;
+		fd = ::open( m_path.c_str() , O_RDONLY ) ;
+	}
+	if( fd == -1 )
+		return false ;
+
+	out.resize( (*p).size ) ;
+	bool ok = out.empty() || readAt( fd , (*p).offset , &out[0] , out.size() ) ;
+	::close( fd ) ;
+	return ok ;
+}
+
+bool Gv::SegmentReader::dependencies( const G::Path & path , std::vector<G::Path> & out )
+{
+	out.clear() ;
+	const Entry * p = find( path ) ;
+	if( p == nullptr )
+		return false ;
+	if( !(*p).dependent )
+		return true ;
+
+	// the index is in name order so collect the earlier records and put them in file order
+	struct Earlier { bool operator()( const Entry * a , const Entry * b ) const { return a->offset < b->offset ; } } ;
+	std::vector<const Entry*> earlier ;
+	for( List::const_iterator q = m_index.begin() ; q != m_index.end() ; ++q )
+	{
+		if( (*q).offset < (*p).offset )
+			earlier.push_back( &(*q) ) ;
+	}
+	std::sort( earlier.begin() , earlier.end() , Earlier() ) ;
+
+	// go back to the most recent independent record
+	size_t start = earlier.size() ;
+	while( start && earlier[start-1U]->dependent )
+		start-- ;
+	if( start )
+		start-- ;
+
+	for( size_t i = start ; i < earlier.size() ; i++ )
+		out.push_back( G::Path(m_path+"/"+earlier[i]->name) ) ;
+	return true ;
+}
+
+bool Gv::SegmentReader::list( const G::Path & dir_in , std::vector<G::DirectoryList::Item> & out )
+{
+	const std::string dir = dir_in.str() ;
+	if( !within(dir) )
+	{
+		G::DirectoryList::Item item ;
+		item.m_is_dir = false ;
+		item.m_name = dir_in.basename() ;
+		if( !candidate(item) )
+			return false ;
+	}
+	if( !locate( dir_in , true ) )
+		return false ;
+
+	// list the next level of names below the given directory
+	const std::string prefix = dir.length() > m_path.length() ? ( dir.substr(m_path.length()+1U) + "/" ) : std::string() ;
+	out.clear() ;
+	for( List::const_iterator p = m_index.begin() ; p != m_index.end() ; ++p )
+	{
+		const std::string & name = (*p).name ;
+		if( name.find(prefix) != 0U || name.length() == prefix.length() )
+			continue ;
+		const size_t pos = name.find( '/' , prefix.length() ) ;
+		G::DirectoryList::Item item ;
+		item.m_is_dir = pos != std::string::npos ;
+		item.m_name = name.substr( prefix.length() , pos == std::string::npos ? std::string::npos : (pos-prefix.length()) ) ;
+		item.m_path = G::Path( dir_in , item.m_name ) ;
+		if( out.empty() || out.back().m_name != item.m_name )
+			out.push_back( item ) ;
+	}
+
+	struct Less { bool operator()( const G::DirectoryList::Item & a , const G::DirectoryList::Item & b ) const { return a.m_name < b.m_name ; } } ;
+	std::sort( out.begin() , out.end() , Less() ) ;
+	return true ;
+}
+
+// ==
+
+Gv::SegmentTree::SegmentTree()
+{
+}
+
+Gv::SegmentTree::~SegmentTree()
+{
+}
+
+bool Gv::SegmentTree::directoryTreeIgnore( const G::DirectoryList::Item & , size_t )
+{
+	return false ;
+}
+
+bool Gv::SegmentTree::directoryTreeContainer( const G::DirectoryList::Item & item , size_t )
+{
+	return SegmentReader::candidate( item ) ;
+}
+
+bool Gv::SegmentTree::directoryTreeList( const G::Path & path , std::vector<G::DirectoryList::Item> & list )
+{
+	return m_reader.list( path , list ) ;
+}
+
+/// \file gvsegment.cpp
@@ -0,0 +1,215 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gvsegment.h
+///
+
+#ifndef GV_SEGMENT__H
+#define GV_SEGMENT__H
+
+#include "gdef.h"
+#include "gpath.h"
+#include "gdatetime.h"
+#include "gdirectory.h"
+#include "gdirectorytree.h"
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace Gv
+{
+	class SegmentWriter ;
+	class SegmentReader ;
+	class SegmentTree ;
+}
+
+/// \class Gv::SegmentWriter
+/// Writes images into segment files as an alternative to having one file
+/// per image.
+///
+/// A segment file holds all the images for one minute and it takes the
+/// place of that minute's directory in the "yyyy/mm/dd/hh/mm" hierarchy
+/// used by Gv::ImageOutput::path(). The images within a segment are named
+/// by the rest of their path, so a segment-aware reader (see Gv::SegmentTree
+/// and Gv::SegmentReader) can present them using the same paths as the
+/// equivalent stand-alone files.
+///
+/// The file format is a header followed by one record per image, each with
+/// its name and timestamp, and then an index of the records that is added
+/// when the segment is closed. A segment without an index, because it is
+/// still being written or because the writer was killed, is read by
+/// scanning the records.
+///
+/// Images that cannot be decoded on their own, ie. H.264 pictures other
+/// than key frames, are flagged as "dependent" so that a reader can go
+/// back to the preceding key frame (see Gv::SegmentReader::dependencies()).
+///
+/// An image that repeats an earlier image in the same segment can be 
+/// written as a reference record, and readers see it as a copy of the
+/// earlier image.
+///
+class Gv::SegmentWriter
+{
+public:
+	typedef std::vector<std::pair<const char*,size_t> > Parts ;
+
+	explicit SegmentWriter( const G::Path & base_dir ) ;
+		///< Constructor. The image paths passed to write() must be
+		///< under the given base directory.
+
+	~SegmentWriter() ;
+		///< Destructor. Closes the current segment.
+
+	bool write( const std::string & path , G::EpochTime , const Parts & , bool dependent = false ) ;
+		///< Appends an image to its segment, given the path that it would
+		///< have as a stand-alone file. The current segment is closed and
+		///< another one opened or created if necessary. Returns false
+		///< on error, eg. if the minute already has a directory.
+		///<
+		///< The 'dependent' flag should be set for images that depend
+		///< on the images before them.
+
+	bool writeReference( const std::string & path , G::EpochTime , const std::string & target_path ) ;
+		///< Appends a small reference record that makes the image at 
+		///< 'path' a repeat of the earlier image at 'target_path', which
+		///< must be in the current segment and not dependent. Returns
+		///< false if a reference cannot be used, in which case the image 
+		///< should be written in full.
+
+	void close() ;
+		///< Adds the index to the current segment and closes it.
+
+	const G::Path & base() const ;
+		///< Returns the base directory, as passed to the constructor.
+
+	static bool split( const std::string & base_dir , const std::string & path ,
+		std::string & segment_path_out , std::string & name_out ) ;
+			///< Splits a stand-alone image path into the path of its segment
+			///< and its name within the segment. Returns false if the path
+			///< does not have the expected structure.
+
+private:
+	SegmentWriter( const SegmentWriter & ) ;
+	void operator=( const SegmentWriter & ) ;
+	bool open( const std::string & segment_path ) ;
+	bool append( const char * , size_t ) ;
+
+private:
+	struct Entry
+	{
+		std::string name ;
+		G::EpochTime time ;
+		unsigned long long offset ;
+		size_t size ;
+		bool dependent ;
+		Entry() ;
+	} ;
+	friend class Gv::SegmentReader ;
+
+private:
+	G::Path m_base_dir ;
+	int m_fd ;
+	std::string m_path ;
+	std::string m_bad_path ;
+	std::vector<Entry> m_index ;
+	unsigned long long m_offset ; // end of the records
+} ;
+
+/// \class Gv::SegmentReader
+/// Reads images from segment files written by Gv::SegmentWriter, using
+/// the paths that the images would have as stand-alone files. The most
+/// recently used segment index is kept in memory.
+///
+class Gv::SegmentReader
+{
+public:
+	SegmentReader() ;
+		///< Default constructor.
+
+	bool read( const G::Path & path , std::vector<char> & out ) ;
+		///< Reads an image that is stored within a segment. Returns
+		///< false if the path is not within a segment, eg. if it
+		///< is a stand-alone file, or on error.
+
+	bool read( const G::Path & path , std::vector<char> & out , bool & dependent ) ;
+		///< An overload that also returns the image's 'dependent' flag.
+
+	bool dependencies( const G::Path & path , std::vector<G::Path> & out ) ;
+		///< Returns the paths of the records that a dependent image needs,
+		///< in the order that they were written, starting with the most 
+		///< recent independent image in the same segment. The list is
+		///< empty if the image is independent. Returns false if the path
+		///< is not within a segment.
+
+	bool list( const G::Path & dir , std::vector<G::DirectoryList::Item> & out ) ;
+		///< Lists the contents of a segment or of a directory within a
+		///< segment, in sorted order. Returns false if not a segment
+		///< path.
+
+	static bool candidate( const G::DirectoryList::Item & ) ;
+		///< Returns true if the given directory entry is a file that might
+		///< be a segment, judging by its name.
+
+private:
+	typedef SegmentWriter::Entry Entry ;
+	typedef std::vector<Entry> List ;
+	SegmentReader( const SegmentReader & ) ;
+	void operator=( const SegmentReader & ) ;
+	bool locate( const G::Path & path , bool or_self ) ;
+	const Entry * find( const G::Path & path ) ;
+	bool within( const std::string & path ) const ;
+	bool open( const std::string & segment_path ) ;
+	static bool size( const std::string & path , unsigned long long & ) ;
+
+private:
+	std::string m_path ;
+	unsigned long long m_size ;
+	List m_index ;
+} ;
+
+/// \class Gv::SegmentTree
+/// A G::DirectoryTreeCallback that allows a G::FileTree to step through
+/// the images in segment files as if they were stand-alone files.
+///
+class Gv::SegmentTree : public G::DirectoryTreeCallback
+{
+public:
+	SegmentTree() ;
+		///< Default constructor.
+
+	virtual ~SegmentTree() ;
+		///< Destructor.
+
+	virtual bool directoryTreeIgnore( const G::DirectoryList::Item & , size_t ) override ;
+		///< Override from G::DirectoryTreeCallback. This implementation
+		///< returns false.
+
+	virtual bool directoryTreeContainer( const G::DirectoryList::Item & , size_t ) override ;
+		///< Override from G::DirectoryTreeCallback.
+
+	virtual bool directoryTreeList( const G::Path & , std::vector<G::DirectoryList::Item> & ) override ;
+		///< Override from G::DirectoryTreeCallback.
+
+private:
+	SegmentTree( const SegmentTree & ) ;
+	void operator=( const SegmentTree & ) ;
+
+private:
+	SegmentReader m_reader ;
+} ;
+
+#endif
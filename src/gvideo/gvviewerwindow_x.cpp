@@ -74,6 +74,8 @@ void Gv::ViewerWindowX::onMouseMove( int x , int y )
 void Gv::ViewerWindowX::display( int data_dx , int data_dy , int data_channels , const char * data_p , size_t data_n )
 {
 	const unsigned char * p = reinterpret_cast<const unsigned char*>(data_p) ;
+	if( data_dx > 0 && data_dy > 0 )
+		m_mask.resize( data_dx , data_dy ) ;
 	if( m_mask.empty() && data_channels == 3 )
 		update( m_canvas.dx() , m_canvas.dy() , data_dx , data_dy , p , data_n ) ;
 	else
@@ -118,18 +120,22 @@ void Gv::ViewerWindowX::update( int x_max , int y_max , int data_dx , int data_d
 void Gv::ViewerWindowX::update( int x_max , int y_max , int data_dx , int data_dy , int data_channels , 
 	const unsigned char * p , size_t data_n )
 {
-	size_t mask_offset = 0U ;
 	int y_out = y_max - 1 ;
 	for( int y = 0 ; y < data_dy && y < y_max ; y++ , y_out-- )
 	{
+		// step through the mask's runs alongside the pixels
+		const Mask::Row & mask_row = m_mask.row( y ) ;
+		Mask::Row::const_iterator span = mask_row.begin() ;
 		for( int x = 0 ; x < data_dx ; x++ )
 		{
 			const unsigned int r = *p++ ;
 			const unsigned int g = data_channels > 1 ? *p++ : r ;
 			const unsigned int b = data_channels > 2 ? *p++ : r ;
+			if( span != mask_row.end() && x >= span->x1 ) 
+				++span ;
 			if( x < x_max )
 			{
-				if( m_mask.masked( mask_offset++ ) )
+				if( span != mask_row.end() && x >= span->x0 )
 					m_canvas.point( x , y_out , Gr::Colour(r>>1,g>>3,b>>3) ) ;
 				else
 					m_canvas.point( x , y_out , Gr::Colour(r,g,b) ) ;
@@ -0,0 +1,391 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// gvwritequeue.cpp
+//
+
+#include "gdef.h"
+#include "gvwritequeue.h"
+#include "glog.h"
+#include "gassert.h"
+#include <algorithm>
+#include <deque>
+#include <exception>
+#if GCONFIG_ENABLE_STD_THREAD
+#include <condition_variable>
+#endif
+
+/// \class Gv::WriteQueueImp
+/// A pimple-pattern implementation class for Gv::WriteQueue.
+///
+class Gv::WriteQueueImp
+{
+public:
+	WriteQueueImp( WriteQueueHandler & , size_t limit , WriteQueue::Policy ) ;
+	~WriteQueueImp() ;
+	void add( const WriteQueue::Item & ) ;
+	void flush() ;
+	WriteQueue::Stats stats() const ;
+	bool threaded() const ;
+
+private:
+	WriteQueueImp( const WriteQueueImp & ) ;
+	void operator=( const WriteQueueImp & ) ;
+	void run( WriteQueue::Item & ) ;
+	void count( const WriteQueue::Item & , const char * reason ) ;
+	bool dropOldest() ;
+	void stop() ;
+
+private:
+	typedef std::deque<WriteQueue::Item> List ;
+	WriteQueueHandler & m_handler ;
+	size_t m_limit ;
+	WriteQueue::Policy m_policy ;
+	WriteQueue::Stats m_stats ; // protected by m_mutex
+	List m_list ;
+	bool m_busy ;
+	bool m_stop ;
+#if GCONFIG_ENABLE_STD_THREAD
+	static void workerThread( WriteQueueImp * ) ;
+	void worker() ;
+	mutable std::mutex m_mutex ;
+	std::condition_variable m_work_cond ;
+	std::condition_variable m_space_cond ;
+	std::thread m_thread ;
+	bool m_threaded ;
+#endif
+} ;
+
+// ==
+
+Gv::WriteQueue::Item::Item() :
+	command(0) ,
+	arg(0) ,
+	time(0)
+{
+}
+
+Gv::WriteQueue::Item::Item( int command_ , int arg_ ) :
+	command(command_) ,
+	arg(arg_) ,
+	time(0)
+{
+}
+
+Gv::WriteQueue::Item::Item( int command_ , int arg_ , Gr::Image image_ , G::EpochTime time_ ) :
+	command(command_) ,
+	arg(arg_) ,
+	image(image_) ,
+	time(time_)
+{
+}
+
+Gv::WriteQueue::Stats::Stats() :
+	added(0UL) ,
+	written(0UL) ,
+	dropped(0UL) ,
+	blocked(0UL) ,
+	errors(0UL) ,
+	depth(0U) ,
+	max_depth(0U)
+{
+}
+
+// ==
+
+Gv::WriteQueue::WriteQueue( WriteQueueHandler & handler , size_t limit , Policy policy ) :
+	m_imp(new WriteQueueImp(handler,limit,policy))
+{
+}
+
+Gv::WriteQueue::~WriteQueue()
+{
+}
+
+void Gv::WriteQueue::add( const Item & item )
+{
+	m_imp->add( item ) ;
+}
+
+void Gv::WriteQueue::flush()
+{
+	m_imp->flush() ;
+}
+
+Gv::WriteQueue::Stats Gv::WriteQueue::stats() const
+{
+	return m_imp->stats() ;
+}
+
+bool Gv::WriteQueue::threaded() const
+{
+	return m_imp->threaded() ;
+}
+
+Gv::WriteQueue::Policy Gv::WriteQueue::policy( const std::string & s )
+{
+	if( s == "block" ) return Block ;
+	if( s == "drop-new" ) return DropNew ;
+	if( s == "drop-old" ) return DropOld ;
+	throw InvalidPolicy( s ) ;
+}
+
+// ==
+
+void Gv::WriteQueueImp::run( WriteQueue::Item & item )
+{
+	// (no lock held)
+	const char * reason = nullptr ;
+	std::string what ;
+	try
+	{
+		m_handler.writeQueueRun( item ) ;
+	}
+	catch( std::exception & e )
+	{
+		what = e.what() ;
+		reason = what.c_str() ;
+	}
+	catch(...)
+	{
+		reason = "unknown exception" ;
+	}
+	#if GCONFIG_ENABLE_STD_THREAD
+		G::threading::lock_type lock( m_mutex ) ;
+	#endif
+	count( item , reason ) ;
+}
+
+void Gv::WriteQueueImp::count( const WriteQueue::Item & item , const char * reason )
+{
+	// (lock held)
+	if( !item.image.empty() )
+		m_stats.written++ ;
+	if( reason != nullptr )
+	{
+		m_stats.errors++ ;
+		m_stats.reason = reason ;
+	}
+}
+
+#if GCONFIG_ENABLE_STD_THREAD
+
+Gv::WriteQueueImp::WriteQueueImp( WriteQueueHandler & handler , size_t limit , WriteQueue::Policy policy ) :
+	m_handler(handler) ,
+	m_limit(std::max(size_t(1U),limit)) ,
+	m_policy(policy) ,
+	m_busy(false) ,
+	m_stop(false) ,
+	m_threaded(G::threading::works())
+{
+	if( m_threaded )
+		m_thread = std::thread( &WriteQueueImp::workerThread , this ) ;
+	else
+		G_WARNING( "Gv::WriteQueue::ctor: threading not available: writing synchronously" ) ;
+}
+
+Gv::WriteQueueImp::~WriteQueueImp()
+{
+	try
+	{
+		stop() ;
+	}
+	catch(...) // dtor
+	{
+	}
+}
+
+void Gv::WriteQueueImp::stop()
+{
+	if( m_threaded )
+	{
+		{
+			G::threading::lock_type lock( m_mutex ) ;
+			m_stop = true ;
+		}
+		m_work_cond.notify_all() ;
+		m_thread.join() ;
+		m_threaded = false ;
+	}
+}
+
+bool Gv::WriteQueueImp::threaded() const
+{
+	return m_threaded ;
+}
+
+bool Gv::WriteQueueImp::dropOldest()
+{
+	// (lock held)
+	for( List::iterator p = m_list.begin() ; p != m_list.end() ; ++p )
+	{
+		if( !(*p).image.empty() )
+		{
+			m_list.erase( p ) ;
+			m_stats.dropped++ ;
+			m_stats.depth-- ;
+			return true ;
+		}
+	}
+	return false ;
+}
+
+void Gv::WriteQueueImp::add( const WriteQueue::Item & item )
+{
+	if( !m_threaded )
+	{
+		WriteQueue::Item copy( item ) ;
+		{
+			G::threading::lock_type lock( m_mutex ) ;
+			if( !item.image.empty() ) m_stats.added++ ;
+		}
+		run( copy ) ;
+		return ;
+	}
+
+	const bool is_image = !item.image.empty() ;
+	{
+		std::unique_lock<std::mutex> lock( m_mutex ) ;
+		if( is_image )
+		{
+			m_stats.added++ ;
+			if( m_stats.depth >= m_limit )
+			{
+				if( m_policy == WriteQueue::DropNew )
+				{
+					m_stats.dropped++ ;
+					return ;
+				}
+				else if( m_policy == WriteQueue::DropOld )
+				{
+					dropOldest() ;
+				}
+				else
+				{
+					m_stats.blocked++ ;
+					while( m_stats.depth >= m_limit )
+						m_space_cond.wait( lock ) ;
+				}
+			}
+			m_stats.depth++ ;
+			m_stats.max_depth = std::max( m_stats.max_depth , m_stats.depth ) ;
+		}
+		m_list.push_back( item ) ;
+	}
+	m_work_cond.notify_one() ;
+}
+
+void Gv::WriteQueueImp::flush()
+{
+	if( m_threaded )
+	{
+		std::unique_lock<std::mutex> lock( m_mutex ) ;
+		while( !m_list.empty() || m_busy )
+			m_space_cond.wait( lock ) ;
+	}
+}
+
+Gv::WriteQueue::Stats Gv::WriteQueueImp::stats() const
+{
+	G::threading::lock_type lock( m_mutex ) ;
+	return m_stats ;
+}
+
+void Gv::WriteQueueImp::workerThread( WriteQueueImp * This )
+{
+	This->worker() ;
+}
+
+void Gv::WriteQueueImp::worker()
+{
+	// run items until stopped and empty
+	for(;;)
+	{
+		WriteQueue::Item item ;
+		{
+			std::unique_lock<std::mutex> lock( m_mutex ) ;
+			m_busy = false ;
+			m_space_cond.notify_all() ;
+			while( !m_stop && m_list.empty() )
+				m_work_cond.wait( lock ) ;
+			if( m_list.empty() )
+				break ;
+			item = m_list.front() ;
+			m_list.pop_front() ;
+			if( !item.image.empty() )
+				m_stats.depth-- ;
+			m_busy = true ;
+		}
+		m_space_cond.notify_all() ;
+		run( item ) ;
+	}
+}
+
+#else
+
+Gv::WriteQueueImp::WriteQueueImp( WriteQueueHandler & handler , size_t limit , WriteQueue::Policy policy ) :
+	m_handler(handler) ,
+	m_limit(limit) ,
+	m_policy(policy) ,
+	m_busy(false) ,
+	m_stop(false)
+{
+}
+
+Gv::WriteQueueImp::~WriteQueueImp()
+{
+}
+
+void Gv::WriteQueueImp::stop()
+{
+}
+
+bool Gv::WriteQueueImp::threaded() const
+{
+	return false ;
+}
+
+bool Gv::WriteQueueImp::dropOldest()
+{
+	return false ;
+}
+
+void Gv::WriteQueueImp::add( const WriteQueue::Item & item )
+{
+	WriteQueue::Item copy( item ) ;
+	if( !item.image.empty() ) m_stats.added++ ;
+	run( copy ) ;
+}
+
+void Gv::WriteQueueImp::flush()
+{
+}
+
+Gv::WriteQueue::Stats Gv::WriteQueueImp::stats() const
+{
+	return m_stats ;
+}
+
+#endif
+
+// ==
+
+Gv::WriteQueueHandler::~WriteQueueHandler()
+{
+}
+
+/// \file gvwritequeue.cpp
@@ -0,0 +1,137 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+///
+/// \file gvwritequeue.h
+///
+
+#ifndef GV_WRITEQUEUE__H
+#define GV_WRITEQUEUE__H
+
+#include "gdef.h"
+#include "gdatetime.h"
+#include "grimage.h"
+#include "gexception.h"
+#include <string>
+
+namespace Gv
+{
+	class WriteQueue ;
+	class WriteQueueImp ;
+	class WriteQueueHandler ;
+}
+
+/// \class Gv::WriteQueue
+/// A bounded queue of write operations that are run in order by a
+/// background thread, so that the thread adding to the queue does
+/// not block on slow file-system i/o.
+///
+/// Each queue item is either an image or a command. When the queue
+/// already holds its limit of images a new image is handled according
+/// to the queue's policy: it is dropped, or the oldest queued image is
+/// dropped to make room, or the caller blocks until there is space.
+/// Commands are never dropped and they do not count towards the limit.
+///
+/// The images are held as shared Gr::Image references, which is safe
+/// because image buffers are read-only once shared (see
+/// Gr::Image::recycle()).
+///
+/// If threading is not available (see G::threading) then items are
+/// run synchronously by add().
+///
+/// The background thread is started by the constructor and only the
+/// forking thread survives a fork(), so a queue must not be constructed
+/// before the process daemonises (see G::Daemon::detach()).
+///
+class Gv::WriteQueue
+{
+public:
+	G_EXCEPTION( InvalidPolicy , "invalid write queue policy" ) ;
+	enum Policy { Block , DropNew , DropOld } ;
+
+	struct Item /// An image or command item for Gv::WriteQueue.
+	{
+		int command ; // opaque to the queue
+		int arg ;
+		Gr::Image image ; // non-empty() for droppable image items
+		G::EpochTime time ;
+		Item() ;
+		Item( int command , int arg ) ;
+		Item( int command , int arg , Gr::Image , G::EpochTime ) ;
+	} ;
+
+	struct Stats /// Queue statistics for Gv::WriteQueue.
+	{
+		unsigned long added ; // images added
+		unsigned long written ; // images run
+		unsigned long dropped ; // images dropped
+		unsigned long blocked ; // add()s that had to wait
+		unsigned long errors ; // items that threw
+		size_t depth ; // images currently queued
+		size_t max_depth ; // high-water mark
+		std::string reason ; // most recent exception text
+		Stats() ;
+	} ;
+
+	WriteQueue( WriteQueueHandler & , size_t limit , Policy ) ;
+		///< Constructor. The handler callback is run from the
+		///< background thread. The limit is the maximum number of
+		///< queued images.
+
+	~WriteQueue() ;
+		///< Destructor. Runs any outstanding items and then stops
+		///< the background thread.
+
+	void add( const Item & ) ;
+		///< Adds an item to the queue.
+
+	void flush() ;
+		///< Waits until the queue is empty.
+
+	Stats stats() const ;
+		///< Returns a snapshot of the queue statistics.
+
+	bool threaded() const ;
+		///< Returns true if there is a background thread.
+
+	static Policy policy( const std::string & ) ;
+		///< Converts a policy name ("block", "drop-new" or "drop-old")
+		///< to a policy. Throws on error.
+
+private:
+	WriteQueue( const WriteQueue & ) ;
+	void operator=( const WriteQueue & ) ;
+
+private:
+	unique_ptr<WriteQueueImp> m_imp ;
+} ;
+
+/// \class Gv::WriteQueueHandler
+/// A callback interface for Gv::WriteQueue.
+///
+class Gv::WriteQueueHandler
+{
+public:
+	virtual void writeQueueRun( WriteQueue::Item & ) = 0 ;
+		///< Runs a queue item. Called from the background thread.
+		///< Exceptions are caught and counted.
+
+protected:
+	virtual ~WriteQueueHandler() ;
+		///< Destructor.
+} ;
+
+#endif
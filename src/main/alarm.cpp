@@ -69,7 +69,7 @@ EventInfo::EventInfo( const std::string & s ) :
 		std::string event = item["event"]() ;
 		std::string count = item["count"]() ;
 		unsigned int repeat = G::Str::toUInt( item["repeat"]() , "0" ) ;
-		if( app == "watcher" && event == "changes" && repeat == 0 && !count.empty() && G::Str::isUInt(count) )
+		if( ( app == "watcher" || app == "rtpserver" ) && event == "changes" && repeat == 0 && !count.empty() && G::Str::isUInt(count) )
 		{
 			m_count = G::Str::toUInt( count ) ;
 			m_valid = true ;
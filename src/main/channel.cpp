@@ -39,6 +39,7 @@
 #include "gdirectory.h"
 #include "groot.h"
 #include "garg.h"
+#include "grimage.h"
 #include "grimagetype.h"
 #include "ggetopt.h"
 #include "gassert.h"
@@ -129,10 +130,14 @@ int main( int argc , char * argv [] )
 				std::vector<char> buffer ;
 				std::string type ;
 				G::EpochTime time( 0 ) ;
+				G::PublisherHeader header ;
 				bool peek = command == "peek" ;
-				bool ok = peek ? channel.peek(buffer,&type,&time) : channel.receive(buffer,&type,&time) ;
+				bool ok = peek ? channel.peek(buffer,&type,&time,&header) : channel.receive(buffer,&type,&time,&header) ;
 				if( ok )
 				{
+					if( header.m_size && header.m_size < buffer.size() )
+						buffer.resize( header.m_size ) ; // drop any alternative representations
+
 					if( !out_filename.empty() ) 
 					{
 						std::cout << type << "\n" ;
@@ -140,9 +145,9 @@ int main( int argc , char * argv [] )
 							std::cout << "time=" << time << "\n" ;
 					}
 
-					if( Gr::ImageType(type).isRaw() )
+					Gr::ImageType image_type = Gr::Image::type( header , type ) ;
+					if( image_type.isRaw() )
 					{
-						Gr::ImageType image_type( type ) ;
 						out
 							<< (image_type.channels()==1?"P5":"P6") << "\n" 
 							<< image_type.dx() << " " << image_type.dy() << "\n" 
@@ -65,6 +65,14 @@
 // for a matching file. The match name can be changed at run-time by using the
 // `--match-name` option on a `move` command sent to the command socket.
 //
+// Segment files written by `vt-recorder --segments` are played back in the 
+// same way as separate image files, and the images within a segment file can 
+// be specified on the command-line or in `move` commands using the paths that
+// they would have had as separate files. H.264 pictures recorded from 
+// `vt-rtpserver --passthrough` are decoded starting from the preceding key 
+// frame in the segment, which needs an H.264 decoder such as FFmpeg's 
+// libavcodec.
+//
 // usage: fileplayer [--viewer] [--channel=<channel>] [--sleep=<ms>] 
 //          [--skip=<count>] [--loop] [--root=<root>] <dir>
 //
@@ -77,6 +85,9 @@
 #include "groot.h"
 #include "gtimer.h"
 #include "gvribbon.h"
+#include "gvsegment.h"
+#include "gvavcreader.h"
+#include "gravc.h"
 #include "grimagetype.h"
 #include "grimagedecoder.h"
 #include "gexception.h"
@@ -93,6 +104,7 @@
 #include "ghexdump.h"
 #include "glogoutput.h"
 #include "gassert.h"
+#include <cstring>
 #include <exception>
 #include <iostream>
 #include <map>
@@ -130,7 +142,7 @@ private:
 	G::EpochTime m_sleep ;
 } ;
 
-class FileTreeIgnore : public G::DirectoryTreeCallback
+class FileTreeIgnore : public Gv::SegmentTree
 {
 public:
 	explicit FileTreeIgnore( const std::string & match_name ) ;
@@ -196,6 +208,8 @@ private:
 	void operator=( const Image & ) ;
 	Gr::ImageType readType( const G::Path & ) ;
 	bool decode( const G::Path & , Gr::ImageType , int scale , bool monochrome ) ;
+	bool decodeAvc( const G::Path & , int scale , bool monochrome ) ;
+	void fit( int dx , int dy , int scale ) ;
 	void blank( const G::Path & ) ;
 
 private:
@@ -211,6 +225,14 @@ private:
 	Gr::ImageBuffer m_image_buffer ;
 	Gr::ImageData m_image_data ;
 	Gr::ImageDecoder m_decoder ;
+	Gv::SegmentReader m_segment ;
+	std::vector<char> m_segment_data ;
+	bool m_in_segment ;
+	bool m_dependent ;
+	bool m_avc ;
+	unique_ptr<Gv::AvcReaderStream> m_avc_stream ;
+	G::Path m_avc_path ; // last picture decoded
+	std::vector<char> m_avc_buffer ;
 	std::string m_reason ;
 } ;
 
@@ -250,6 +272,7 @@ private:
 	const RibbonConfig & m_config  ;
 	size_t m_tpos ;
 	Gv::Ribbon * m_ribbon ;
+	Gv::SegmentTree m_segments ;
 	G::FileTree m_tree ;
 	bool m_busy ;
 } ;
@@ -864,7 +887,10 @@ Image::Image( ImageFader & fader , std::pair<int,int> dx_range , std::pair<int,i
 	m_fit_dx(0) ,
 	m_fit_dy(0) ,
 	m_ribbon_added(false) ,
-	m_image_data(m_image_buffer,Gr::ImageData::Contiguous) // contiguous to reduce reallocs esp. when dy changes
+	m_image_data(m_image_buffer,Gr::ImageData::Contiguous) , // contiguous to reduce reallocs esp. when dy changes
+	m_in_segment(false) ,
+	m_dependent(false) ,
+	m_avc(false)
 {
 	G_ASSERT( !valid() ) ;
 }
@@ -883,6 +909,19 @@ bool Image::read( const G::Path & path , int scale , bool monochrome , bool blan
 {
 	m_reason.clear() ;
 	Gr::ImageType image_type = readType( path ) ;
+	if( m_avc )
+	{
+		if( !decodeAvc( path , scale , monochrome ) )
+		{
+			if( blank_on_error )
+				blank( path ) ;
+			return false ;
+		}
+		m_path = path ;
+		m_ribbon_added = false ;
+		return true ;
+	}
+
 	if( !image_type.valid() )
 	{
 		if( blank_on_error )
@@ -909,11 +948,29 @@ Gr::ImageType Image::readType( const G::Path & path )
 {
 	// determine the image size early so that we can scale-to-fit
 	Gr::ImageType image_type ;
+	m_avc = false ;
 	try
 	{
-		image_type = Gr::ImageDecoder::readType( path , true/*do_throw*/ ) ;
-		if( !image_type.valid() )
+		// images in segment files are read into memory
+		m_in_segment = m_segment.read( path , m_segment_data , m_dependent ) ;
+		m_avc = m_in_segment && !m_segment_data.empty() &&
+			Gr::Avc::ByteStream::signature( reinterpret_cast<const unsigned char*>(&m_segment_data[0]) , m_segment_data.size() ) ;
+		if( m_avc )
+			return image_type ; // see decodeAvc()
+		else if( m_in_segment )
+			image_type = Gr::ImageType( m_segment_data ) ;
+		else
+			image_type = Gr::ImageDecoder::readType( path , true/*do_throw*/ ) ;
+
+		if( image_type.isAvc() )
+		{
+			m_reason = "h264 pictures can only be played back from segment files" ;
+			image_type = Gr::ImageType() ;
+		}
+		else if( !image_type.valid() )
+		{
 			m_reason = "not an image file" ;
+		}
 	}
 	catch( std::exception & e )
 	{
@@ -931,18 +988,18 @@ bool Image::decode( const G::Path & path , Gr::ImageType image_type_in , int sca
 		// the first image (after fixed scaling) defines the image-fit dimensions, but bounded by the given range
 		if( m_count == 0U ) 
 		{
-			Gr::ImageType real_type = Gr::ImageDecoder::readType( path ) ;
-			int dx = Gr::scaled( real_type.dx() , scale ) ;
-			int dy = Gr::scaled( real_type.dy() , scale ) ;
-			m_fit_dx = std::min( m_fit_dx_range.second , std::max(m_fit_dx_range.first,dx) ) ;
-			m_fit_dy = std::min( m_fit_dy_range.second , std::max(m_fit_dy_range.first,dy) ) ;
+			Gr::ImageType real_type = m_in_segment ? Gr::ImageType(m_segment_data) : Gr::ImageDecoder::readType( path ) ;
+			fit( real_type.dx() , real_type.dy() , scale ) ;
 		}
 
 		const int fudge_factor = 3 ;
 		Gr::ImageDecoder::ScaleToFit scale_to_fit( m_fit_dx , m_fit_dy , fudge_factor ) ;
 
 		m_decoder.setup( scale , monochrome ) ;
-		m_image_type = m_decoder.decode( image_type_in , path , m_image_data , scale_to_fit ) ;
+		if( m_in_segment )
+			m_image_type = m_decoder.decode( image_type_in , m_segment_data , m_image_data , scale_to_fit ) ;
+		else
+			m_image_type = m_decoder.decode( image_type_in , path , m_image_data , scale_to_fit ) ;
 
 		m_image_data.crop( m_fit_dx , m_fit_dy ) ;
 		m_image_data.expand( m_fit_dx , m_fit_dy ) ;
@@ -959,6 +1016,77 @@ bool Image::decode( const G::Path & path , Gr::ImageType image_type_in , int sca
 	}
 }
 
+bool Image::decodeAvc( const G::Path & path , int scale , bool monochrome )
+{
+	if( !Gv::AvcReader::available() )
+	{
+		m_reason = "no h264 decoder available" ;
+		return false ;
+	}
+
+	try
+	{
+		G_LOG( "FilePlayer::process: file=[" << path << "]: h264 picture" << (m_dependent?"":" (key frame)") ) ;
+
+		// carry on from the last picture if it is the one that this picture 
+		// follows, otherwise start again from the most recent key frame -- 
+		// the first pictures in a segment follow on from the previous 
+		// segment, if any
+		std::vector<G::Path> run ;
+		m_segment.dependencies( path , run ) ;
+		const bool follows_on = m_avc_stream.get() != nullptr && 
+			( run.empty() ? m_dependent : ( run.back() == m_avc_path ) ) ;
+		if( !follows_on )
+		{
+			m_avc_stream.reset( new Gv::AvcReaderStream ) ;
+			std::vector<char> data ;
+			for( std::vector<G::Path>::iterator p = run.begin() ; p != run.end() ; ++p )
+			{
+				if( m_segment.read( *p , data ) && !data.empty() )
+					Gv::AvcReader reader( *m_avc_stream.get() , &data[0] , data.size() ) ;
+			}
+		}
+
+		Gv::AvcReader reader( *m_avc_stream.get() , &m_segment_data[0] , m_segment_data.size() ) ;
+		m_avc_path = path ;
+		if( !reader.valid() )
+		{
+			m_reason = "h264 decode failed" ;
+			return false ;
+		}
+
+		if( m_count == 0U )
+			fit( reader.dx() , reader.dy() , scale ) ;
+
+		m_avc_buffer.clear() ;
+		Gr::ImageType raw_type = reader.fill( m_avc_buffer , scale , monochrome ) ;
+		m_image_data.resize( raw_type.dx() , raw_type.dy() , raw_type.channels() ) ;
+		for( int y = 0 ; y < raw_type.dy() ; y++ )
+			std::memcpy( m_image_data.row(y) , &m_avc_buffer[raw_type.rowsize()*y] , raw_type.rowsize() ) ;
+
+		m_image_data.crop( m_fit_dx , m_fit_dy ) ;
+		m_image_data.expand( m_fit_dx , m_fit_dy ) ;
+		m_image_type = Gr::ImageType::raw( m_image_data.dx() , m_image_data.dy() , m_image_data.channels() ) ;
+
+		m_count++ ; if(m_count==0U) m_count=1U ;
+		return true ;
+	}
+	catch( std::exception & e )
+	{
+		G_DEBUG( "Image::decodeAvc: h264 decode failed: " << e.what() ) ;
+		m_reason = e.what() ;
+		return false ;
+	}
+}
+
+void Image::fit( int dx_in , int dy_in , int scale )
+{
+	int dx = Gr::scaled( dx_in , scale ) ;
+	int dy = Gr::scaled( dy_in , scale ) ;
+	m_fit_dx = std::min( m_fit_dx_range.second , std::max(m_fit_dx_range.first,dx) ) ;
+	m_fit_dy = std::min( m_fit_dy_range.second , std::max(m_fit_dy_range.first,dy) ) ;
+}
+
 void Image::blank( const G::Path & path )
 {
 	m_path = path ;
@@ -1165,7 +1293,7 @@ void RibbonScanner::start( const G::Path & path , Gv::Ribbon * ribbon )
 	if( ribbon ) m_ribbon = ribbon ;
 	G_ASSERT( m_ribbon != nullptr ) ;
 	G_ASSERT( m_tpos != 0U ) ;
-	m_tree = G::FileTree() ;
+	m_tree = G::FileTree( G::Path() , &m_segments ) ;
 	m_busy = m_ribbon->scanStart(m_tree,path,m_tpos) && !m_ribbon->scanSome(m_tree,m_config.scanTimeFirst()) ;
 }
 
@@ -78,7 +78,8 @@ class HttpClient ;
 class Output : private GNet::EventExceptionHandler
 {
 public:
-	Output( const std::string & title , unsigned int viewer_scale , const std::string & channel , const G::Url & ) ;
+	Output( const std::string & title , unsigned int viewer_scale , const std::string & channel , 
+		size_t channel_history , int channel_luma , const G::Url & ) ;
 	void process( std::string , const char * , size_t ) ;
 
 private:
@@ -254,7 +255,7 @@ const G::Url & HttpClientFactory::url() const
 // ==
 
 Output::Output( const std::string & viewer_title , unsigned int viewer_scale , 
-	const std::string & channel , const G::Url & url ) :
+	const std::string & channel , size_t channel_history , int channel_luma , const G::Url & url ) :
 		m_image_output(*this)
 {
 	if( viewer_scale != 0 )
@@ -264,7 +265,9 @@ Output::Output( const std::string & viewer_title , unsigned int viewer_scale ,
 	{
 		G::Item info = G::Item::map() ;
 		info.add( "url" , url.summary() ) ; // no passwords
-		m_image_output.startPublisher( channel , info ) ;
+		m_image_output.startPublisher( channel , info , G::PublisherConfig(channel_history) ) ;
+		if( channel_luma > 0 )
+			m_image_output.addRepresentation( false , channel_luma , true ) ;
 	}
 }
 
@@ -327,6 +330,8 @@ int main( int argc, char ** argv )
 			"W!watchdog-timeout!watchdog timeout! (default 20s)!1!seconds!1" "|"
 			"T!request-timeout!time between http get requests! (default 1ms)!1!ms!1" "|"
 			"c!channel!publish to the named channel!!1!channel!1" "|"
+			"H!channel-history!number of recent images kept in the channel! for lead-in!1!count!1" "|"
+			"M!channel-luma!add a reduced monochrome image to each publication!!1!divisor!1" "|"
 			"x!connection-timeout!connection timeout!!1!seconds!1" "|"
 			"R!retry!retry failed connections! or zero to exit (default 1s)!1!seconds!1" "|"
 			"O!once!exit when the first connection closes!!0!!1" "|"
@@ -340,6 +345,8 @@ int main( int argc, char ** argv )
 			bool viewer = opt.contains("viewer") ;
 			std::string viewer_title = opt.contains("viewer-title") ? opt.value("viewer-title") : arg.prefix() ;
 			std::string channel = opt.value("channel",std::string()) ;
+			size_t channel_history = static_cast<size_t>( G::Str::toUInt(opt.value("channel-history","0")) ) ;
+			int channel_luma = G::Str::toInt(opt.value("channel-luma","0")) ;
 			unsigned int watchdog_timeout = G::Str::toUInt( opt.value("watchdog-timeout","20") ) ;
 			unsigned int request_timeout_ms = G::Str::toUInt( opt.value("request-timeout","1") ) ;
 			unsigned int retry = G::Str::toUInt( opt.value("retry","1") ) ;
@@ -368,7 +375,7 @@ int main( int argc, char ** argv )
 
 			GNet::Location location( url.host() , url.port("80") ) ;
 
-			Output output( viewer_title , viewer?viewer_scale:0U , channel , url ) ;
+			Output output( viewer_title , viewer?viewer_scale:0U , channel , channel_history , channel_luma , url ) ;
 			HttpClientFactory factory( output , location , url , connection_timeout , watchdog_timeout , request_timeout_ms ) ;
 			Gv::ClientHolder<HttpClientFactory,HttpClient> client_holder( factory , once , retry==0U?quitAlways:quitTest , retry ) ;
 
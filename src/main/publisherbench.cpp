@@ -0,0 +1,209 @@
+//
+// Copyright (C) 2017 Graeme Walker
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// ===
+//
+// publisherbench.cpp
+//
+// Measures the latency of G::Publisher::publish() with a number of
+// subscriber processes attached. This is a development tool and it is
+// not installed.
+//
+// The subscribers are forked child processes that receive() a copy of
+// every publication. The publisher publishes frames of the given size at
+// the given rate and reports the wall-clock time taken by each publish()
+// call, together with the cpu time used by the publishing thread itself.
+// The difference between the two is time spent off the cpu. The
+// context-switch counts show why: voluntary switches mean that publish()
+// blocked, typically on a lock, and involuntary switches mean that it was
+// preempted, typically by a subscriber that it had just woken up. On a
+// single cpu a preempting subscriber does its copy before publish()
+// returns, so the subscriber's copy time shows up in the wall-clock figure.
+//
+// usage: publisherbench [--subscribers=<count>] [--frames=<count>]
+//          [--size=<width>x<height>] [--fps=<rate>] [--channel=<channel>]
+//
+
+#include "gdef.h"
+#include "gpublisher.h"
+#include "gvstartup.h"
+#include "gvexit.h"
+#include "gstr.h"
+#include "garg.h"
+#include "ggetopt.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <vector>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+	double now( clockid_t clock )
+	{
+		struct timespec ts ;
+		::clock_gettime( clock , &ts ) ;
+		return static_cast<double>(ts.tv_sec) * 1000. + static_cast<double>(ts.tv_nsec) / 1000000. ;
+	}
+
+	void subscribe( const std::string & channel_name )
+	{
+		// child process -- receive until killed
+		try
+		{
+			G::PublisherSubscription subscription( channel_name ) ;
+			std::vector<char> buffer ;
+			while( subscription.receive( buffer ) )
+				{;}
+		}
+		catch( std::exception & e )
+		{
+			std::cerr << "subscriber: " << e.what() << std::endl ;
+		}
+		::_exit( 0 ) ;
+	}
+
+	void switches( long & voluntary , long & involuntary )
+	{
+		struct rusage usage ;
+		::getrusage( RUSAGE_SELF , &usage ) ;
+		voluntary = usage.ru_nvcsw ;
+		involuntary = usage.ru_nivcsw ;
+	}
+
+	double percentile( std::vector<double> v , double p )
+	{
+		if( v.empty() ) return 0. ;
+		std::sort( v.begin() , v.end() ) ;
+		size_t i = static_cast<size_t>( p * static_cast<double>(v.size()-1U) + 0.5 ) ;
+		return v[std::min(i,v.size()-1U)] ;
+	}
+
+	double mean( const std::vector<double> & v )
+	{
+		double sum = 0. ;
+		for( std::vector<double>::const_iterator p = v.begin() ; p != v.end() ; ++p )
+			sum += *p ;
+		return v.empty() ? 0. : ( sum / static_cast<double>(v.size()) ) ;
+	}
+}
+
+int main( int argc , char * argv [] )
+{
+	try
+	{
+		G::Arg arg( argc , argv ) ;
+		G::GetOpt opt( arg ,
+			"V!version!show the program version and exit!!0!!3" "|"
+			"h!help!show this help!!0!!3" "|"
+			"n!subscribers!number of subscriber processes! (default 1)!1!count!1" "|"
+			"f!frames!number of frames to publish! (default 250)!1!count!1" "|"
+			"s!size!frame size! (default 1920x1080)!1!wxh!1" "|"
+			"r!fps!publication rate! (default 25)!1!rate!1" "|"
+			"c!channel!channel name! (default publisherbench)!1!channel!1" "|"
+		) ;
+		std::string args_help = "" ;
+		Gv::Startup startup( opt , args_help , opt.args().c() == 1U ) ;
+		try
+		{
+			unsigned int subscribers = G::Str::toUInt( opt.value("subscribers","1") ) ;
+			unsigned int frames = G::Str::toUInt( opt.value("frames","250") ) ;
+			unsigned int fps = std::max( 1U , G::Str::toUInt( opt.value("fps","25") ) ) ;
+			std::string size = opt.value( "size" , "1920x1080" ) ;
+			std::string channel_name = opt.value( "channel" , "publisherbench" ) ;
+			unsigned int dx = G::Str::toUInt( G::Str::head(size,size.find('x'),size) ) ;
+			unsigned int dy = G::Str::toUInt( G::Str::tail(size,size.find('x'),"1") ) ;
+
+			G::Publisher publisher( channel_name ) ;
+			std::vector<char> frame( static_cast<size_t>(dx) * dy * 3U , 'x' ) ;
+			publisher.publish( frame , "application/octet-stream" ) ; // create the data segment
+
+			std::vector<pid_t> children ;
+			for( unsigned int i = 0U ; i < subscribers ; i++ )
+			{
+				pid_t pid = ::fork() ;
+				if( pid == 0 )
+					subscribe( channel_name ) ;
+				else if( pid > 0 )
+					children.push_back( pid ) ;
+			}
+			::sleep( 1 ) ;
+
+			std::vector<double> wall ;
+			std::vector<double> cpu ;
+			long voluntary = 0L ;
+			long involuntary = 0L ;
+			const double interval = 1000. / static_cast<double>(fps) ;
+			double next = now( CLOCK_MONOTONIC ) ;
+			for( unsigned int i = 0U ; i < frames ; i++ )
+			{
+				frame[i%frame.size()]++ ;
+				long v0 = 0L , i0 = 0L , v1 = 0L , i1 = 0L ;
+				switches( v0 , i0 ) ;
+				const double t0 = now( CLOCK_MONOTONIC ) ;
+				const double c0 = now( CLOCK_THREAD_CPUTIME_ID ) ;
+				publisher.publish( frame , "application/octet-stream" ) ;
+				const double c1 = now( CLOCK_THREAD_CPUTIME_ID ) ;
+				const double t1 = now( CLOCK_MONOTONIC ) ;
+				switches( v1 , i1 ) ;
+				wall.push_back( t1 - t0 ) ;
+				cpu.push_back( c1 - c0 ) ;
+				voluntary += ( v1 - v0 ) ;
+				involuntary += ( i1 - i0 ) ;
+
+				next += interval ;
+				const double delay = next - now( CLOCK_MONOTONIC ) ;
+				if( delay > 0. )
+					::usleep( static_cast<useconds_t>(delay*1000.) ) ;
+			}
+
+			for( std::vector<pid_t>::iterator p = children.begin() ; p != children.end() ; ++p )
+				::kill( *p , SIGTERM ) ;
+			for( std::vector<pid_t>::iterator p = children.begin() ; p != children.end() ; ++p )
+				::waitpid( *p , nullptr , 0 ) ;
+
+			std::cout
+				<< std::fixed << std::setprecision(2)
+				<< "subscribers=" << subscribers << " frames=" << frames << " size=" << dx << "x" << dy << "x3 "
+				<< "wall-ms: mean=" << mean(wall) << " p50=" << percentile(wall,.5) << " p95=" << percentile(wall,.95) << " "
+				<< "cpu-ms: mean=" << mean(cpu) << " p50=" << percentile(cpu,.5) << " "
+				<< "switches-per-frame: voluntary=" << (static_cast<double>(voluntary)/std::max(1U,frames)) << " "
+				<< "involuntary=" << (static_cast<double>(involuntary)/std::max(1U,frames)) << std::endl ;
+		}
+		catch( std::exception & e )
+		{
+			startup.report( arg.prefix() , e ) ;
+			throw ;
+		}
+		return EXIT_SUCCESS ;
+	}
+	catch( Gv::Exit & e )
+	{
+		return e.value() ;
+	}
+	catch( std::exception & e )
+	{
+		std::cerr << G::Arg::prefix(argv) << ": error: " << e.what() << std::endl ;
+	}
+	return EXIT_FAILURE ;
+}
+
+/// \file publisherbench.cpp
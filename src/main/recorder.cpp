@@ -37,21 +37,28 @@
 // program. On entering the fast state any in-memory images from the last few
 // seconds are also committed to disk.
 //
-// A sub-directory called `.cache` is used to hold the recent images that have 
-// not been commited to the main image store. These files are held open, and 
-// they should not be accessed externally. When the recorder is triggered
-// by a `fast` command on the command socket the cached files are moved
-// into the main image store so that they provide a lead-in to the event
+// The recent images that have not been commited to the main image store are 
+// held in memory, up to a limit on the number of images (`--cache-size`) and 
+// a limit on their total size in megabytes (`--cache-memory`), so there is no 
+// disk activity when the recorder is in the "stopped" state. When the recorder 
+// is triggered by a `fast` command on the command socket the cached images are 
+// written into the main image store so that they provide a lead-in to the event
 // that triggered the recording.
 //
-// On machines with limited memory the cache size should be tuned so that
-// there is no disk activity when the recorder is in the "stopped" state.
-// The cache can be completely disabled by setting the cache size to zero, 
-// but then there will be no lead-in to recordings triggered by an event.
+// On machines with limited memory the `--cache-memory` limit should be tuned to
+// suit the image size and the length of lead-in required. The cache can be 
+// completely disabled by setting the cache size to zero, but then there will be 
+// no lead-in to recordings triggered by an event.
 //
 // Use `--fast --timeout=0 --cache-size=0` for continuous recording of a 
 // channel.
 //
+// Alternatively, if the publisher keeps a history of recent images in its
+// channel (eg. `vt-webcamplayer --channel-history`) then the `--lead-in` 
+// option can be used to take the lead-in images directly from the channel's 
+// shared memory, with no disk activity at all until the fast state is entered. 
+// The in-memory cache is disabled by default in this case.
+//
 // The `--tz` option is the number of hours added to UTC when constructing
 // file system paths under the base directory, so to get local times at western
 // longitudes the value should be negative (eg. `--tz=-5`). However, if this 
@@ -73,17 +80,51 @@
 // this approach does not scale well on playback, so only use it for a very
 // small number of video streams.
 //
+// The `--segments` option reduces the number of files by appending the images 
+// for each minute into a single segment file that takes the place of the 
+// minute's directory. The segment file has an index of the image offsets 
+// and timestamps so that `vt-fileplayer` can step through the images as if 
+// they were separate files. Each recorder using segment files must have its 
+// own base directory. H.264 video published by `vt-rtpserver --passthrough` 
+// must be recorded into segment files, in which case the index also marks 
+// the pictures that depend on earlier pictures, and the "slow" state only 
+// records key frames.
+//
+// The `--dedupe` option avoids storing repeated copies of a static scene. 
+// Each image that is about to be saved is reduced to the average brightness
+// of each eight-by-eight block, using only the DC coefficients for JPEG 
+// images, and if no block differs from the last image saved in full by more 
+// than the given amount then the image is saved as a reference to that 
+// image. With separate files the reference is a hard link, and with segment 
+// files it is a small record that points back to the earlier image within 
+// the same segment. Either way `vt-fileplayer` plays back the timeline as 
+// normal.
+//
+// The `--write-behind` option moves the disk writes onto a background thread
+// so that a slow disk does not hold up the reading of the input channel. The 
+// option value is the number of images that can be queued, and the 
+// `--write-behind-policy` option determines what happens when the queue is 
+// full: `drop-new` discards the incoming image, `drop-old` discards the 
+// oldest queued image, and `block` waits for space. The queue statistics 
+// are logged once a minute, with a warning if any images have been dropped.
+// The `--write-behind` option cannot be used with `--user`.
+//
 // usage: recorder [<options>] <image-channel-in> <base-dir>
 //
 
 #include "gdef.h"
 #include "gvimageoutput.h"
 #include "gvcache.h"
+#include "gvsegment.h"
+#include "gvwritequeue.h"
 #include "gvimageinput.h"
 #include "gvstartup.h"
 #include "gvexit.h"
 #include "gvcommandsocket.h"
 #include "gvtimezone.h"
+#include "grjpeg.h"
+#include "grimagedata.h"
+#include "grcolourspace.h"
 #include "gdatetime.h"
 #include "gpublisher.h"
 #include "gpath.h"
@@ -93,23 +134,62 @@
 #include "glogoutput.h"
 #include "gassert.h"
 #include <errno.h>
+#include <algorithm>
 #include <exception>
 #include <iostream>
+#include <vector>
+
+class Deduper
+{
+public:
+	explicit Deduper( unsigned int tolerance ) ;
+	bool duplicate( const Gr::Image & ) ;
+	void saved() ;
+
+private:
+	Deduper( const Deduper & ) ;
+	void operator=( const Deduper & ) ;
+	bool fingerprint( const Gr::Image & ) ;
+
+private:
+	unsigned int m_tolerance ;
+	Gr::JpegReader m_dc_reader ;
+	Gr::ImageBuffer m_dc_buffer ;
+	Gr::ImageData m_dc_image ;
+	Gr::ImageType m_type ;
+	std::vector<unsigned char> m_blocks ; // block luma of the latest image
+	bool m_valid ;
+	Gr::ImageType m_reference_type ;
+	std::vector<unsigned char> m_reference ; // block luma of the last image saved in full
+	bool m_reference_valid ;
+} ;
 
-class Recorder : private Gv::ImageInputSource, private Gv::ImageInputHandler, private GNet::EventHandler, private Gv::CommandSocketMixin
+class Recorder : private Gv::ImageInputSource, private Gv::ImageInputHandler, private GNet::EventHandler, private Gv::CommandSocketMixin, private Gv::WriteQueueHandler
 {
 public:
 	enum State { s_init , s_stopped , s_fast , s_slow } ;
 	Recorder( Gr::ImageConverter & , const std::string & image_channel , const std::string & name , const std::string & command_socket_path ,
 		G::Path base_dir , int scale , const std::string & file_type , State base_state , bool set_state_fast ,
-		unsigned int fast_timeout , size_t , const Gv::Timezone & tz , unsigned int reopen_timeout , bool once ) ;
+		unsigned int fast_timeout , size_t cache_size , size_t cache_memory , unsigned int lead_in , const Gv::Timezone & tz , 
+		unsigned int reopen_timeout , bool once , bool segments , int dedupe ,
+		size_t write_behind , Gv::WriteQueue::Policy ) ;
 	~Recorder() ;
 	void run() ;
+	void start() ;
 
 private:
+	enum Command { c_image , c_state , c_commit } ;
 	void setState( State ) ;
 	void checkState() ;
-	void cacheStore( const Gr::ImageBuffer & , Gr::ImageType type , G::EpochTime , const G::Path & same_as ) ;
+	void submit( const Gv::WriteQueue::Item & ) ;
+	void report() ;
+	void save( State , const Gr::Image & , G::EpochTime ) ;
+	bool saveReference( const Gr::Image & , G::EpochTime , G::Path & ) ;
+	void saveTo( State ) ;
+	void cacheStore( State , const Gr::Image & , G::EpochTime , const G::Path & same_as ) ;
+	void leadIn() ;
+	void commit( bool other ) ;
+	virtual void writeQueueRun( Gv::WriteQueue::Item & ) override ; // Gv::WriteQueueHandler
 	virtual void onImageInput( Gv::ImageInputSource & , Gr::Image ) override ;
 	virtual Gv::ImageInputConversion imageInputConversion( Gv::ImageInputSource & ) override ;
 	virtual void resend( Gv::ImageInputHandler & ) override ;
@@ -123,7 +203,10 @@ private:
 	G::Path m_base_dir ;
 	std::string m_name ;
 	Gv::ImageOutput m_image_output ;
+	unique_ptr<Gv::SegmentWriter> m_segments ;
+	unique_ptr<Deduper> m_deduper ;
 	Gv::Cache m_cache ;
+	unsigned int m_lead_in ;
 	Gv::ImageInputConversion m_conversion ;
 	State m_state ;
 	State m_old_state ;
@@ -134,21 +217,32 @@ private:
 	bool m_once ;
 	Gr::Image m_image ;
 	std::string m_image_type_str ;
+	Gr::Image m_lead_in_image ;
+	G::EpochTime m_lead_in_time ;
 	GNet::Timer<Recorder> m_timer ;
+	G::EpochTime m_report_time ;
+	Gv::WriteQueue::Stats m_report_stats ;
+	size_t m_write_behind ;
+	Gv::WriteQueue::Policy m_write_behind_policy ;
+	unique_ptr<Gv::WriteQueue> m_queue ; // last
 } ;
 
 Recorder::Recorder( Gr::ImageConverter & converter , 
 	const std::string & image_channel_name , const std::string & name ,
 	const std::string & command_socket_path , G::Path base_dir , int scale , 
 	const std::string & file_type , State base_state , bool set_state_fast ,
-	unsigned int fast_timeout , size_t cache_size , const Gv::Timezone & tz , 
-	unsigned int reopen_timeout , bool once ) :
+	unsigned int fast_timeout , size_t cache_size , size_t cache_memory , unsigned int lead_in , 
+	const Gv::Timezone & tz , unsigned int reopen_timeout , bool once , bool segments , int dedupe ,
+	size_t write_behind , Gv::WriteQueue::Policy write_behind_policy ) :
 		Gv::ImageInputSource(converter) ,
 		Gv::CommandSocketMixin(command_socket_path) ,
 		m_image_channel(image_channel_name,reopen_timeout!=0U/*lazy-open*/) ,
 		m_base_dir(base_dir) ,
 		m_name(name) ,
-		m_cache(base_dir,name,cache_size) ,
+		m_segments(segments?new Gv::SegmentWriter(base_dir):nullptr) ,
+		m_deduper(dedupe>=0?new Deduper(static_cast<unsigned int>(dedupe)):nullptr) ,
+		m_cache(base_dir,name,cache_size,cache_memory) ,
+		m_lead_in(lead_in) ,
 		m_state(s_init) ,
 		m_old_state(s_init) ,
 		m_fast_time(0) ,
@@ -156,7 +250,11 @@ Recorder::Recorder( Gr::ImageConverter & converter ,
 		m_tz(tz) ,
 		m_reopen_timeout(reopen_timeout) ,
 		m_once(once) ,
-		m_timer(*this,&Recorder::onTimeout,*this)
+		m_lead_in_time(0) ,
+		m_timer(*this,&Recorder::onTimeout,*this) ,
+		m_report_time(G::DateTime::now()) ,
+		m_write_behind(write_behind) ,
+		m_write_behind_policy(write_behind_policy)
 {
 	G_ASSERT( base_state == s_slow || base_state == s_stopped ) ;
 	setState( base_state ) ;
@@ -197,11 +295,21 @@ Recorder::Recorder( Gr::ImageConverter & converter ,
 
 Recorder::~Recorder()
 {
+	m_queue.reset() ; // finish writing
 	removeImageInputHandler( *this ) ;
 	if( m_image_channel.fd() != -1 )
 		GNet::EventLoop::instance().dropRead( GNet::Descriptor(m_image_channel.fd()) ) ;
 }
 
+void Recorder::start()
+{
+	// start the write-behind thread only once we have daemonised, since 
+	// the fork()s in G::Daemon::detach() would leave the queue without
+	// a thread -- anything submitted before now was written synchronously
+	if( m_write_behind && m_queue.get() == nullptr )
+		m_queue.reset( new Gv::WriteQueue(*this,m_write_behind,m_write_behind_policy) ) ;
+}
+
 void Recorder::onException( std::exception & )
 {
 	throw ;
@@ -215,6 +323,50 @@ void Recorder::checkState()
 		G_ASSERT( m_old_state == s_slow || m_old_state == s_stopped ) ;
 		setState( m_old_state ) ;
 	}
+
+	// report on the write-behind queue once a minute
+	if( m_queue.get() && (G::DateTime::now()-m_report_time).s >= 60 )
+		report() ;
+}
+
+void Recorder::report()
+{
+	m_report_time = G::DateTime::now() ;
+	Gv::WriteQueue::Stats stats = m_queue->stats() ;
+	G_LOG( "Recorder::report: write-behind: queued=" << stats.depth << " max-queued=" << stats.max_depth << " "
+		<< "written=" << stats.written << " dropped=" << stats.dropped << " blocked=" << stats.blocked << " "
+		<< "errors=" << stats.errors ) ;
+	if( stats.dropped > m_report_stats.dropped )
+		G_WARNING( "Recorder::report: write-behind queue full: " << (stats.dropped-m_report_stats.dropped) << " image(s) dropped" ) ;
+	if( stats.errors > m_report_stats.errors )
+		G_WARNING( "Recorder::report: write-behind errors: " << stats.reason ) ;
+	m_report_stats = stats ;
+}
+
+void Recorder::submit( const Gv::WriteQueue::Item & item )
+{
+	if( m_queue.get() )
+	{
+		m_queue->add( item ) ;
+	}
+	else
+	{
+		Gv::WriteQueue::Item copy( item ) ;
+		writeQueueRun( copy ) ;
+	}
+}
+
+void Recorder::writeQueueRun( Gv::WriteQueue::Item & item )
+{
+	// (from the write-behind thread, if any)
+	if( item.command == c_image )
+		save( static_cast<State>(item.arg) , item.image , item.time ) ;
+	else if( item.command == c_state )
+		saveTo( static_cast<State>(item.arg) ) ;
+	else if( m_segments.get() )
+		m_cache.commit( *m_segments , item.arg != 0 ) ;
+	else
+		m_cache.commit( item.arg != 0 ) ;
 }
 
 void Recorder::setState( State state )
@@ -229,28 +381,59 @@ void Recorder::setState( State state )
 		if( state == s_fast )
 			m_old_state = m_state ;
 		m_state = state ;
-
-		if( m_state == s_fast )
-			m_image_output.saveTo( m_base_dir.str() , m_name , true , m_tz , false ) ;
-		else if( m_state == s_slow )
-			m_image_output.saveTo( m_base_dir.str() , m_name , false , m_tz , false ) ;
-		else
-			m_image_output.saveTo( std::string() , m_name , false , m_tz , false ) ;
+		submit( Gv::WriteQueue::Item(c_state,m_state) ) ;
 	}
 }
 
+void Recorder::saveTo( State state )
+{
+	if( state == s_fast )
+		m_image_output.saveTo( m_base_dir.str() , m_name , true , m_tz , false , m_segments.get() ) ;
+	else if( state == s_slow )
+		m_image_output.saveTo( m_base_dir.str() , m_name , false , m_tz , false , m_segments.get() ) ;
+	else
+		m_image_output.saveTo( std::string() , m_name , false , m_tz , false ) ;
+
+	// finish off the current segment when stopped so that it gets its index
+	if( state == s_stopped && m_segments.get() )
+		m_segments->close() ;
+}
+
 void Recorder::onImageInput( Gv::ImageInputSource & , Gr::Image image )
 {
 	if( image.valid() ) // only record images
 	{
-		G::EpochTime time = G::DateTime::now() ;
-
-		// save to disk
-		G::Path path = m_image_output.send( image.data() , image.type() , time ) ;
+		if( image.type().isAvc() && m_segments.get() == nullptr )
+			G_WARNING_ONCE( "Recorder::onImageInput: h264 images should be recorded with --segments so that they can be played back" ) ;
+		G::EpochTime time = m_lead_in_time.s ? m_lead_in_time : G::DateTime::now() ;
+		submit( Gv::WriteQueue::Item(c_image,m_state,image,time) ) ;
+	}
+}
 
-		// save to cache
-		cacheStore( image.data() , image.type() , time , path ) ;
+void Recorder::save( State state , const Gr::Image & image , G::EpochTime time )
+{
+	// save to disk, or just refer back to the last image saved if nothing has changed
+	G::Path path ;
+	if( !saveReference( image , time , path ) )
+	{
+		path = m_image_output.send( image.data() , image.type() , time ) ;
+		if( m_deduper.get() && path != G::Path() )
+			m_deduper->saved() ;
 	}
+
+	// save to cache
+	cacheStore( state , image , time , path ) ;
+}
+
+bool Recorder::saveReference( const Gr::Image & image , G::EpochTime time , G::Path & path )
+{
+	// only fingerprint images that are actually going to be saved
+	if( m_deduper.get() == nullptr || !m_image_output.saves( image.type() , time ) || !m_deduper->duplicate( image ) )
+		return false ;
+
+	const bool saved = m_image_output.saveReference( image.type() , time , path ) ;
+	G_DEBUG( "Recorder::saveReference: unchanged image: " << (saved?"saved as a reference":"cannot save as a reference") << ": " << path ) ;
+	return saved ;
 }
 
 Gv::ImageInputConversion Recorder::imageInputConversion( Gv::ImageInputSource & )
@@ -307,13 +490,16 @@ void Recorder::onCommandSocketData( std::string s )
 	G_LOG( "Recorder::onCommandSocketData: command=[" << G::Str::printable(s) << "]" ) ;
 	if( s == "fast" )
 	{
+		const bool was_fast = m_state == s_fast ;
 		setState( s_fast ) ;
-		m_cache.commit() ;
+		commit( false ) ;
+		if( !was_fast && m_lead_in != 0U )
+			leadIn() ;
 	}
 	else if( s == "slow" )
 	{
 		setState( s_slow ) ;
-		m_cache.commit( true ) ;
+		commit( true ) ;
 	}
 	else if( s == "stop" )
 	{
@@ -325,9 +511,10 @@ void Recorder::onCommandSocketData( std::string s )
 	}
 }
 
-void Recorder::cacheStore( const Gr::ImageBuffer & buffer , Gr::ImageType type , G::EpochTime time , const G::Path & same_as_path )
+void Recorder::cacheStore( State state , const Gr::Image & image , G::EpochTime time , const G::Path & same_as_path )
 {
-	if( m_state == s_stopped || m_state == s_slow )
+	const Gr::ImageType type = image.type() ;
+	if( state == s_stopped || state == s_slow )
 	{
 		std::string commit_path ; 
 		Gv::ImageOutput::path( commit_path , m_cache.base() , m_name , time , type , true , m_tz , false ) ;
@@ -335,7 +522,35 @@ void Recorder::cacheStore( const Gr::ImageBuffer & buffer , Gr::ImageType type ,
 		std::string commit_path_other ; 
 		Gv::ImageOutput::path( commit_path_other , m_cache.base() , m_name , time , type , false , m_tz , false ) ;
 
-		m_cache.store( buffer , commit_path , commit_path_other , same_as_path.str() ) ;
+		m_cache.store( image , commit_path , commit_path_other , same_as_path.str() , time ) ;
+	}
+}
+
+void Recorder::commit( bool other )
+{
+	submit( Gv::WriteQueue::Item(c_commit,other?1:0) ) ;
+}
+
+void Recorder::leadIn()
+{
+	// save the publisher's recent images, using their original timestamps
+	std::vector<G::PublisherView> views ;
+	if( !m_image_channel.history( G::DateTime::now() - G::EpochTime(m_lead_in) , views ) )
+	{
+		G_DEBUG( "Recorder::leadIn: no channel history" ) ;
+		return ;
+	}
+
+	G_LOG( "Recorder::leadIn: recording " << views.size() << " image(s) from the channel history" ) ;
+	for( std::vector<G::PublisherView>::iterator p = views.begin() ; p != views.end() ; ++p )
+	{
+		Gr::ImageType type( (*p).type() ) ;
+		if( type.valid() && Gr::Image::copy( *p , m_lead_in_image , type ) ) // copy could fail if overwritten
+		{
+			m_lead_in_time = (*p).time() ;
+			sendImageInput( m_lead_in_image ) ;
+			m_lead_in_time = G::EpochTime(0) ;
+		}
 	}
 }
 
@@ -354,6 +569,99 @@ Recorder::State state_from( const std::string & state_name )
 			state_name == "fast" ? Recorder::s_fast : Recorder::s_stopped ) ;
 }
 
+// ==
+
+Deduper::Deduper( unsigned int tolerance ) :
+	m_tolerance(tolerance) ,
+	m_dc_reader(8,true) ,
+	m_dc_image(m_dc_buffer,Gr::ImageData::Contiguous) ,
+	m_valid(false) ,
+	m_reference_valid(false)
+{
+}
+
+bool Deduper::duplicate( const Gr::Image & image )
+{
+	// compare the block luma with the block luma of the last image saved
+	m_valid = fingerprint( image ) ;
+	if( !m_valid || !m_reference_valid || m_type != m_reference_type || m_blocks.size() != m_reference.size() )
+		return false ;
+
+	for( size_t i = 0U ; i < m_blocks.size() ; i++ )
+	{
+		const unsigned int a = m_blocks[i] ;
+		const unsigned int b = m_reference[i] ;
+		if( (a>b?(a-b):(b-a)) > m_tolerance )
+			return false ;
+	}
+	return true ;
+}
+
+void Deduper::saved()
+{
+	// the latest image has been saved in full, so it becomes the reference
+	m_reference_valid = m_valid ;
+	m_reference_type = m_type ;
+	m_reference.swap( m_blocks ) ;
+	m_valid = false ;
+}
+
+bool Deduper::fingerprint( const Gr::Image & image )
+{
+	// jpegs are decoded at one-eighth scale, which uses only the dc 
+	// coefficients, and raw images are averaged over the same 
+	// eight-by-eight blocks -- other image types are not fingerprinted
+	m_type = image.type() ;
+	if( m_type.isJpeg() )
+	{
+		try
+		{
+			m_dc_reader.decode( m_dc_image , image.data() ) ;
+		}
+		catch( std::exception & e )
+		{
+			G_DEBUG( "Deduper::fingerprint: cannot decode: " << e.what() ) ;
+			return false ;
+		}
+		const size_t dx = static_cast<size_t>(m_dc_image.dx()) ;
+		const int dy = m_dc_image.dy() ;
+		m_blocks.resize( dx * dy ) ;
+		for( int y = 0 ; y < dy ; y++ )
+			std::copy( m_dc_image.row(y) , m_dc_image.row(y)+dx , m_blocks.begin()+y*dx ) ;
+		return !m_blocks.empty() ;
+	}
+	else if( m_type.isRaw() && ( m_type.channels() == 1 || m_type.channels() == 3 ) && image.size() == m_type.size() )
+	{
+		const Gr::ImageDataWrapper data( image.data() , m_type.dx() , m_type.dy() , m_type.channels() ) ;
+		const int channels = m_type.channels() ;
+		const int bdx = m_type.dx() / 8 ;
+		const int bdy = m_type.dy() / 8 ;
+		std::vector<unsigned int> sums( bdx ) ;
+		m_blocks.resize( static_cast<size_t>(bdx) * bdy ) ;
+		for( int by = 0 ; by < bdy ; by++ )
+		{
+			std::fill( sums.begin() , sums.end() , 0U ) ;
+			for( int y = by*8 ; y < (by*8+8) ; y++ )
+			{
+				const unsigned char * p = data.row( y ) ;
+				for( int bx = 0 ; bx < bdx ; bx++ )
+				{
+					unsigned int sum = 0U ;
+					for( int x = 0 ; x < 8 ; x++ , p += channels )
+						sum += channels == 1 ? p[0] : Gr::ColourSpace::y_int( p[0] , p[1] , p[2] ) ;
+					sums[bx] += sum ;
+				}
+			}
+			for( int bx = 0 ; bx < bdx ; bx++ )
+				m_blocks[by*bdx+bx] = static_cast<unsigned char>( sums[bx] / 64U ) ;
+		}
+		return !m_blocks.empty() ;
+	}
+	return false ;
+}
+
+// ==
+
 int main( int argc, char ** argv )
 {
 	try
@@ -376,10 +684,16 @@ int main( int argc, char ** argv )
 			"F!fast!start in fast state!!0!!1" "|"
 			"Z!state!state when not fast! (slow or stopped, slow by default)!1!state!1" "|"
 			"z!tz!timezone offset!!1!hours!1" "|"
-			"S!cache-size!cache size!!1!files!1" "|"
+			"S!cache-size!cache size!!1!images!1" "|"
+			"M!cache-memory!cache memory limit!!1!megabytes!1" "|"
+			"l!lead-in!take the lead-in from the channel history! rather than the memory cache!1!seconds!1" "|"
 			"n!name!prefix for all image files! (defaults to the channel name)!1!prefix!1" "|"
 			"R!retry!poll for the input channel to appear!!1!timeout!1" "|"
 			"O!once!exit if the input channel disappears!!0!!1" "|"
+			"g!segments!record into one file per minute! rather than one file per image!0!!1" "|"
+			"D!dedupe!record unchanged images as references to the last image saved! allowing the given change in block brightness!1!luma!1" "|"
+			"W!write-behind!write to disk from a background thread! with a queue of the given size!1!images!1" "|"
+			"w!write-behind-policy!action when the write-behind queue is full! (drop-new, drop-old or block)!1!policy!1" "|"
 		) ;
 		std::string args_help = "<input-channel> <base-dir>" ;
 		Gv::Startup startup( opt , args_help , opt.args().c() == 3U ) ;
@@ -389,7 +703,9 @@ int main( int argc, char ** argv )
 			std::string name = opt.value("name",image_channel_name) ;
 			std::string base_dir = opt.args().v(2U) ;
 			int scale = static_cast<int>( G::Str::toUInt(opt.value("scale","1")) ) ;
-			size_t cache_size = static_cast<size_t>( G::Str::toUInt(opt.value("cache-size","100")) ) ;
+			unsigned int lead_in = G::Str::toUInt(opt.value("lead-in","0")) ;
+			size_t cache_size = static_cast<size_t>( G::Str::toUInt(opt.value("cache-size",lead_in?"0":"100")) ) ;
+			size_t cache_memory = static_cast<size_t>( G::Str::toUInt(opt.value("cache-memory","32")) ) * 1024U * 1024U ;
 			unsigned int fast_state_timeout = G::Str::toUInt(opt.value("timeout","15")) ;
 			std::string state_name = opt.value("state","slow") ;
 			Recorder::State base_state = state_from( state_name ) ;
@@ -397,6 +713,9 @@ int main( int argc, char ** argv )
 			std::string file_type = opt.value("file-type","") ;
 			unsigned int retry = G::Str::toUInt(opt.value("retry","0")) ;
 			bool once = opt.contains("once") ;
+			int dedupe = opt.contains("dedupe") ? static_cast<int>(std::min(255U,G::Str::toUInt(opt.value("dedupe")))) : -1 ;
+			size_t write_behind = static_cast<size_t>( G::Str::toUInt(opt.value("write-behind","0")) ) ;
+			Gv::WriteQueue::Policy write_behind_policy = Gv::WriteQueue::policy( opt.value("write-behind-policy","drop-new") ) ;
 
 			if( base_state == Recorder::s_fast )
 				throw std::runtime_error( "invalid \"--state\" option" ) ;
@@ -404,16 +723,20 @@ int main( int argc, char ** argv )
 			if( name.find_first_of(G::Str::meta()+G::Str::ws()+"/\\") != std::string::npos )
 				throw std::runtime_error( "invalid characters in \"--name\"" ) ;
 
+			if( write_behind && opt.contains("user") )
+				throw std::runtime_error( "the \"--write-behind\" option cannot be used with \"--user\"" ) ;
+
 			GNet::TimerList timer_list ;
 			unique_ptr<GNet::EventLoop> event_loop( GNet::EventLoop::create() ) ;
 
 			Gr::ImageConverter converter ;
 			Recorder recorder( converter , image_channel_name , name , opt.value("command-socket") , base_dir , scale , 
 				file_type , base_state , opt.contains("fast") , 
-				fast_state_timeout , cache_size , Gv::Timezone(tz) , 
-				retry , once ) ;
+				fast_state_timeout , cache_size , cache_memory , lead_in , Gv::Timezone(tz) , 
+				retry , once , opt.contains("segments") , dedupe , write_behind , write_behind_policy ) ;
 	
 			startup.start() ;
+			recorder.start() ;
 			event_loop->run() ;
 		}
 		catch( std::exception & e )
@@ -34,6 +34,28 @@
 // using the `--filter` option, or by using `--scale` and `--monochrome`
 // to reduce the image resolution after decoding.
 //
+// The `--event-channel` option can be used to publish motion-detection
+// events based on the H.264 encoder's motion vectors, which is much
+// cheaper than decoding images and comparing them with `vt-watcher`. The
+// events have the same format as `vt-watcher` "changes" events, where the
+// "count" is the total area in pixels of the blocks that have moved, so
+// they can be used by `vt-alarm`. Events are only published when the
+// count reaches the `--threshold` value. If the `--viewer` and `--channel`
+// options are not used then the images are not converted to RGB at all.
+// This feature needs an H.264 decoder that can export motion vectors, ie.
+// a recent version of FFmpeg's libavcodec.
+//
+// The `--passthrough` option publishes the H.264 video to the channel without
+// decoding it, so the published images are H.264 pictures rather than RGB
+// images, and `--scale` and `--monochrome` have no effect. Each picture holds all 
+// the slices of one RTP access unit, as delimited by the RTP marker bit or 
+// a change of RTP timestamp. This avoids the cost of decoding when the 
+// video is only being recorded, and the recording 
+// is typically five to ten times smaller than the equivalent JPEG files. The
+// pictures must be recorded with `vt-recorder --segments` so that key frames
+// can be found again on playback, and they can only be played back by a 
+// `vt-fileplayer` that has an H.264 decoder.
+//
 // Cameras that use RTP will normally be controlled by an RTSP client (such as
 // `vt-rtspclient`); the RTSP client asks the camera to start sending
 // its video stream to the address that the RTP server is listening on.
@@ -51,6 +73,7 @@
 // usage: rtpserver [<options>] [--port=<port>] [--scale={auto|<scale>}] 
 //   [--address <bind-address>] [--multicast <group-address>]
 //   [--save <base-dir>] [--viewer] [--channel <channel>]
+//   [--event-channel <channel>]
 //
 // eg.
 /// $ ./rtpserver --port=8000 --address=239.0.0.1 --multicast=239.0.0.1
@@ -76,7 +99,9 @@
 #include "ggetopt.h"
 #include "glogoutput.h"
 #include "gassert.h"
+#include "gdatetime.h"
 #include <cstdlib>
+#include <sstream>
 #include <exception>
 #include <iostream>
 
@@ -88,28 +113,38 @@ class RtpServer : private Gv::RtpServer, public Gv::RtpServerHandler
 public:
 	RtpServer( GNet::Address bind_address , std::string group_address , unsigned int packet_type , 
 		std::string format_file , int jpeg_fudge_factor , const std::string & filter_spec ,
-		int scale , bool viewer , unique_ptr<G::Publisher> & , bool monochrome ,
-		unsigned int source_stale_timeout ) ;
+		int scale , bool viewer , unique_ptr<G::Publisher> & , int channel_luma , bool monochrome ,
+		unsigned int source_stale_timeout , const std::string & event_channel , unsigned int threshold ,
+		bool passthrough ) ;
 
 private:
 	virtual void onImage( const std::vector<char> & , const Gr::ImageType & , bool ) override ;
+	virtual void onMotion( const Gv::AvcReader::Motion & , int , int ) override ;
 
 private:
 	Gv::ImageOutput m_image_output ;
+	Gv::ImageOutput m_event_output ;
 	unsigned int m_frame_count ;
 	bool m_had_key_frame ;
+	unsigned int m_threshold ;
+	bool m_warned ;
 } ;
 
 // ==
 
 RtpServer::RtpServer( GNet::Address bind_address , std::string group_address , unsigned int packet_type , 
 	std::string format_file , int jpeg_fudge_factor , const std::string & filter_spec ,
-	int scale , bool viewer , unique_ptr<G::Publisher> & channel , bool monochrome ,
-	unsigned int source_stale_timeout ) :
-		Gv::RtpServer(*this,scale,monochrome,bind_address,group_address,packet_type,format_file,jpeg_fudge_factor,filter_spec,source_stale_timeout) ,
+	int scale , bool viewer , unique_ptr<G::Publisher> & channel , int channel_luma , bool monochrome ,
+	unsigned int source_stale_timeout , const std::string & event_channel , unsigned int threshold ,
+	bool passthrough ) :
+		Gv::RtpServer(*this,scale,monochrome,bind_address,group_address,packet_type,format_file,jpeg_fudge_factor,filter_spec,source_stale_timeout,
+			viewer||channel.get()!=nullptr,!event_channel.empty(),passthrough) ,
 		m_image_output(*this) ,
+		m_event_output(*this) ,
 		m_frame_count(0U) ,
-		m_had_key_frame(false)
+		m_had_key_frame(false) ,
+		m_threshold(threshold) ,
+		m_warned(false)
 {
 	G_LOG( "RtpServer::RtpServer: rtpserver listening on " << bind_address.displayString() ) ;
 
@@ -122,6 +157,15 @@ RtpServer::RtpServer( GNet::Address bind_address , std::string group_address , u
 	if( channel.get() != nullptr )
 	{
 		m_image_output.startPublisher( channel.release() ) ;
+		if( channel_luma > 0 )
+			m_image_output.addRepresentation( false , channel_luma , true ) ;
+	}
+
+	if( !event_channel.empty() )
+	{
+		G::Item info = G::Item::map() ;
+		info.add( "address" , bind_address.displayString() ) ;
+		m_event_output.startPublisher( event_channel , info ) ;
 	}
 }
 
@@ -137,6 +181,44 @@ void RtpServer::onImage( const std::vector<char> & buffer_in , const Gr::ImageTy
 		m_image_output.send( &buffer_in[0] , buffer_in.size() , image_type ) ;
 }
 
+void RtpServer::onMotion( const Gv::AvcReader::Motion & motion , int dx , int dy )
+{
+	if( !motion.valid )
+	{
+		if( !m_warned )
+			G_WARNING( "RtpServer::onMotion: no motion vectors available from the h264 decoder" ) ;
+		m_warned = true ;
+		return ;
+	}
+	if( motion.area < m_threshold )
+		return ;
+
+	// same format as vt-watcher's 'changes' events so that vt-alarm can use them
+	G::EpochTime now = G::DateTime::now() ;
+	std::ostringstream ss ;
+	ss
+		<< "{ "
+		<< "'app': 'rtpserver', "
+		<< "'version': 1, "
+		<< "'pid': " << ::getpid() << ", "
+		<< "'time': " << now.s << ", "
+		<< "'event': 'changes', "
+		<< "'source': 'motion-vectors', "
+		<< "'threshold': " << m_threshold << ", "
+		<< "'dx': " << dx << ", "
+		<< "'dy': " << dy << ", "
+		<< "'count': " << motion.area << ", "
+		<< "'blocks': " << motion.moving << ", "
+		<< "'box': [" << motion.x0 << ", " << motion.y0 << ", " 
+			<< (motion.x1-motion.x0) << ", " << (motion.y1-motion.y0) << "], "
+		<< "'repeat': 0 "
+		<< "}" ;
+	std::string text = ss.str() ;
+	G::Str::replaceAll( text , "'" , "\"" ) ;
+	G_LOG( "RtpServer::onMotion: event: " << text ) ;
+	m_event_output.sendText( text.data() , text.size() , "application/json" ) ;
+}
+
 // ==
 
 int main( int argc, char ** argv )
@@ -159,11 +241,16 @@ int main( int argc, char ** argv )
 			"o!monochrome!convert to monochrome!!0!!1" "|"
 			"l!port!listening port!!1!port!1" "|"
 			"c!channel!publish to the named channel!!1!channel!1" "|"
+			"E!event-channel!publish motion events derived from h264 motion vectors!!1!channel!1" "|"
+			"A!threshold!motion event threshold! in pixels (default 256)!1!pixels!1" "|"
+			"H!channel-history!number of recent images kept in the channel! for lead-in!1!count!1" "|"
+			"M!channel-luma!add a reduced monochrome image to each publication!!1!divisor!1" "|"
 			"a!address!listening address!!1!ip!1" "|"  
 			"m!multicast!multicast group address!!1!address!1" "|"
 			"F!format-file!file to read for the H264 format parameters!!1!path!1" "|"
 			"Y!type!process packets of one rtp payload type! (eg. 26 or 96)!1!type!1" "|"
 			"j!jpeg-table!tweak for jpeg quantisation tables! (0,1 or 2)!1!ff!1" "|"
+			"p!passthrough!publish h264 video to the channel without decoding!!0!!1" "|"
 			"f!filter!process only matching rtp packets! (eg. '5,7,8')!1!type!3" "|"
 		) ;
 		std::string args_help = "" ;
@@ -182,8 +269,11 @@ int main( int argc, char ** argv )
 				GNet::Address(GNet::Address::Family::ipv4(),port) : 
 				GNet::Address(ip_address,port) ;
 
-			if( !opt.contains("viewer") && opt.value("channel").empty() )
-				throw std::runtime_error( "nothing to do: use \"--viewer\" or \"--channel\"" ) ;
+			if( !opt.contains("viewer") && opt.value("channel").empty() && opt.value("event-channel").empty() )
+				throw std::runtime_error( "nothing to do: use \"--viewer\", \"--channel\" or \"--event-channel\"" ) ;
+
+			if( opt.contains("passthrough") && ( opt.contains("viewer") || opt.contains("channel-luma") ) )
+				throw std::runtime_error( "the \"--passthrough\" option cannot be used with \"--viewer\" or \"--channel-luma\"" ) ;
 
 			if( opt.contains("daemon") && opt.contains("format-file") && !G::Path(format_file).isAbsolute() )
 				throw std::runtime_error( "format file must be an absolute path when using \"--daemon\"" ) ;
@@ -204,7 +294,8 @@ int main( int argc, char ** argv )
 				G::Item info = G::Item::map() ;
 				info.add( "type" , G::Str::tail(G::Path(G::Arg::v0()).basename(),"-",false) ) ;
 				info.add( "address" , bind_address.displayString() ) ;
-				publisher.reset( new G::Publisher(opt.value("channel"),info,true) ) ;
+				size_t history = static_cast<size_t>( G::Str::toUInt(opt.value("channel-history","0")) ) ;
+				publisher.reset( new G::Publisher(opt.value("channel"),info,G::PublisherConfig(history),true) ) ;
 			}
 
 			startup.start() ;
@@ -216,8 +307,11 @@ int main( int argc, char ** argv )
 				scale = std::max( 1 , G::Str::toInt(opt.value("scale")) ) ;
 
 			::RtpServer server( bind_address , group_address , packet_type , format_file , 
-				jpeg_fudge_factor , filter , scale , opt.contains("viewer") , publisher ,
-				opt.contains("monochrome") , source_stale_timeout ) ;
+				jpeg_fudge_factor , filter , scale , opt.contains("viewer") , publisher , 
+				G::Str::toInt(opt.value("channel-luma","0")) ,
+				opt.contains("monochrome") , source_stale_timeout ,
+				opt.value("event-channel") , G::Str::toUInt(opt.value("threshold","256")) ,
+				opt.contains("passthrough") ) ;
 
 			event_loop->run() ;
 		}
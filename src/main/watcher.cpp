@@ -39,14 +39,71 @@
 //
 // The `--scale` option also has an important effect because it increases the
 // size of the motion detection pixels (by decreasing the resolution of the 
-// image), and it affects the interpretation of the threshold value.
+// image), and it affects the interpretation of the threshold value. If the
+// publisher adds a reduced monochrome image to its channel (eg. 
+// `vt-webcamplayer --channel-luma`) with a compatible reduction factor then 
+// that is used in preference to decoding the full-size image.
+//
+// JPEG images are relatively expensive to decode, but a `--scale` value of 8
+// allows them to be decoded using only their DC coefficients, giving the 
+// average brightness of each eight-by-eight block. Alternatively, the 
+// `--dc-gate` option can be used to keep the full resolution while avoiding
+// most of the decoding effort when nothing is happening. Each JPEG image is 
+// first decoded at one-eighth scale and compared with the image from the 
+// last full comparison, and the full decode and comparison are skipped 
+// unless at least the given number of the one-eighth scale pixels have 
+// changed by more than the squelch value. No events or analysis images are 
+// published for the skipped images.
 //
 // Histogram equalisation is enabled with the `--equalise` option and this can
 // be particularly useful for cameras that loose contrast in infra-red mode.
+// The equalisation mapping is only recalculated when the image histogram 
+// changes significantly, so that small fluctuations in overall brightness 
+// do not show up as changed pixels.
+//
+// The `--background` option selects a different algorithm where each image is
+// compared against a background model rather than against the previous image.
+// The model holds a running average and variance for every pixel, and a pixel
+// is counted as changed if it differs from its average by more than the squelch
+// value and by more than three standard deviations. This suppresses false
+// alarms from slow lighting changes and from noisy or flickering areas of the 
+// image. The option value is the time constant of the model, measured in
+// images, with larger values making the background adapt more slowly.
+//
+// More than one input channel can be given on the command-line, in which case
+// the channels are all watched by the one process, sharing the image decoder 
+// and the `--threads` thread pool. In this case the `--event-channel`, 
+// `--image-channel` and `--command-socket` values must contain `%c`, which 
+// is replaced by the input channel name, and the `--recorder`, `--mask` and 
+// `--viewer-title` values can also use it. The other options apply to all 
+// the channels.
+//
+// The `--threads` option can be used to spread the image analysis across more 
+// than one processor core, with each thread working on a horizontal band of
+// the image. Per-stage timings are logged periodically when using `--verbose`.
+//
+// The `--zones` option divides the image into a grid of zones, such as `4x3`,
+// and the changed pixels are then also counted separately for each zone. The
+// zone counts are added to the motion detection events, together with a 
+// bounding box of the zones that have changes. Each zone can have its own
+// threshold by using the `--zone-thresholds` option with a comma-separated 
+// list, in row order, where zero means no threshold. A motion detection event 
+// is emitted if the overall count reaches the `--threshold` value or if any 
+// zone count reaches its own threshold, so one watcher process can do the
+// work of several watchers using different masks.
+//
+// The `--idle-interval` option can be used to save processing power when 
+// nothing is happening. If there have been no motion detection events for 
+// the `--idle-timeout` period then the comparisons are done at the slower 
+// idle interval, and as soon as there is a detection the normal `--interval` 
+// is used again. Changes of rate are logged when using `--verbose`. Note that
+// a `--background` time constant counts compared images, so the background
+// adapts more quickly, in real time, while idle.
 //
 // The command socket, enabled with the `--command-socket` option, accepts
-// `squelch`, `threshold` and `equalise` commands. Multiple commands can
-// be sent in one datagram by using semi-colon separators.
+// `squelch`, `threshold`, `zone-thresholds`, `equalise` and `idle-interval` 
+// commands, and a `status` command that logs the current analysis rate. Multiple 
+// commands can be sent in one datagram by using semi-colon separators.
 //
 // The squelch and threshold values have default values that will need
 // fine-tuning for your camera. This can be done interactively by temporarily
@@ -57,7 +114,7 @@
 // Adjust the squelch value to eliminate the green highlights when there is 
 // no motion. Repeat in different lighting conditions.
 //
-// usage: watcher [<options>] [--viewer] [--event-channel <event-channel-out>] <video-channel-in>
+// usage: watcher [<options>] [--viewer] [--event-channel <event-channel-out>] <video-channel-in> [<video-channel-in> ...]
 //
 
 #include "gdef.h"
@@ -68,14 +125,19 @@
 #include "gvimageoutput.h"
 #include "gvcommandsocket.h"
 #include "gvmask.h"
+#include "gvframediff.h"
+#include "gvbackgroundmodel.h"
 #include "gvstartup.h"
 #include "gvcommandsocket.h"
 #include "gvexit.h"
 #include "grimageconverter.h"
+#include "grareascaler.h"
 #include "grimagebuffer.h"
 #include "grimage.h"
 #include "grhistogram.h"
+#include "grjpeg.h"
 #include "gpublisher.h"
+#include "gthreadpool.h"
 #include "gmsg.h"
 #include "groot.h"
 #include "gfile.h"
@@ -88,6 +150,8 @@
 #include <exception>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <vector>
 
 struct DiffParameters
 {
@@ -97,15 +161,39 @@ struct DiffParameters
 	unsigned int m_threshold ;
 	int m_log_threshold ;
 	bool m_equalise ;
+	unsigned int m_zones_x ; // zone grid columns, one if no grid
+	unsigned int m_zones_y ; // zone grid rows
+	std::vector<unsigned int> m_zone_thresholds ; // row-major, zero or missing for none
 	DiffParameters( G::EpochTime interval , unsigned int decoder_scale , unsigned int squelch , 
-		unsigned int threshold , int log_threshold , bool equalise ) :
+		unsigned int threshold , int log_threshold , bool equalise ,
+		unsigned int zones_x , unsigned int zones_y , const std::vector<unsigned int> & zone_thresholds ) :
 			m_interval(interval) ,
 			m_decoder_scale(decoder_scale) ,
 			m_squelch(squelch) ,
 			m_threshold(threshold) ,
 			m_log_threshold(log_threshold) ,
-			m_equalise(equalise)
+			m_equalise(equalise) ,
+			m_zones_x(std::max(1U,zones_x)) ,
+			m_zones_y(std::max(1U,zones_y)) ,
+			m_zone_thresholds(zone_thresholds)
+	{
+	}
+	bool zoned() const
+	{
+		return m_zones_x > 1U || m_zones_y > 1U ;
+	}
+	unsigned int zoneThreshold( size_t zone ) const
+	{
+		return zone < m_zone_thresholds.size() ? m_zone_thresholds[zone] : 0U ;
+	}
+	static std::vector<unsigned int> thresholds( const std::string & s )
 	{
+		std::vector<unsigned int> result ;
+		G::StringArray parts ;
+		G::Str::splitIntoFields( s , parts , "," ) ;
+		for( G::StringArray::iterator p = parts.begin() ; p != parts.end() ; ++p )
+			result.push_back( G::Str::isUInt(G::Str::trimmed(*p,G::Str::ws())) ? G::Str::toUInt(G::Str::trimmed(*p,G::Str::ws())) : 0U ) ;
+		return result ;
 	}
 } ;
 
@@ -115,55 +203,185 @@ struct DiffInfo
 	unsigned int m_dy ;
 	unsigned int m_count ; // number of unmasked pixels changed more than squelch
 	unsigned int m_noise ; // number of unmasked pixels changed less than squelch
+	unsigned int m_zones_x ;
+	unsigned int m_zones_y ;
+	std::vector<unsigned int> m_zones ; // changed pixels per zone, row-major
+	bool m_zone_triggered ; // a zone has reached its own threshold
+	unsigned int m_box_x ; // bounding box of active zones
+	unsigned int m_box_y ;
+	unsigned int m_box_dx ;
+	unsigned int m_box_dy ;
 	DiffInfo() :
 		m_dx(0) ,
 		m_dy(0) ,
 		m_count(0U) ,
-		m_noise(0U)
+		m_noise(0U) ,
+		m_zones_x(1U) ,
+		m_zones_y(1U) ,
+		m_zone_triggered(false) ,
+		m_box_x(0U) ,
+		m_box_y(0U) ,
+		m_box_dx(0U) ,
+		m_box_dy(0U)
 	{
 	}
 	DiffInfo( unsigned int dx , unsigned int dy ) :
 		m_dx(dx) ,
 		m_dy(dy) ,
 		m_count(0U) ,
-		m_noise(0U)
+		m_noise(0U) ,
+		m_zones_x(1U) ,
+		m_zones_y(1U) ,
+		m_zone_triggered(false) ,
+		m_box_x(0U) ,
+		m_box_y(0U) ,
+		m_box_dx(0U) ,
+		m_box_dy(0U)
 	{
 	}
 	bool valid() const
 	{
 		return m_dx && m_dy ;
 	}
+	bool triggered( const DiffParameters & params ) const
+	{
+		return m_count >= params.m_threshold || m_zone_triggered ;
+	}
+} ;
+
+struct RateGovernor
+{
+	// adapts the comparison interval, dropping to the idle interval once 
+	// nothing has been detected for the idle timeout, and going back to 
+	// the normal interval as soon as something is detected
+	unsigned int m_idle_interval_ms ; // zero to disable
+	unsigned int m_idle_timeout_s ;
+	G::EpochTime m_last_activity ;
+	bool m_idle ;
+	RateGovernor( unsigned int idle_interval_ms , unsigned int idle_timeout_s ) :
+		m_idle_interval_ms(idle_interval_ms) ,
+		m_idle_timeout_s(idle_timeout_s) ,
+		m_last_activity(G::DateTime::now()) ,
+		m_idle(false)
+	{
+	}
+	G::EpochTime interval( const DiffParameters & params ) const
+	{
+		return m_idle ? G::EpochTime(0,m_idle_interval_ms*1000UL) : params.m_interval ;
+	}
+	bool update( G::EpochTime now , bool activity ) // returns true on a change of state
+	{
+		const bool was_idle = m_idle ;
+		if( activity || m_idle_interval_ms == 0U )
+		{
+			m_last_activity = now ;
+			m_idle = false ;
+		}
+		else if( !m_idle && now >= (m_last_activity+m_idle_timeout_s) )
+		{
+			m_idle = true ;
+		}
+		return m_idle != was_idle ;
+	}
+	std::string str( const DiffParameters & params ) const
+	{
+		G::EpochTime t = interval( params ) ;
+		return std::string(m_idle?"idle":"active") + " (" + 
+			G::Str::fromULong(static_cast<unsigned long>(t.s)*1000UL+t.us/1000U) + "ms interval)" ;
+	}
+} ;
+
+struct Bands
+{
+	int m_dy ;
+	unsigned int m_n ;
+	Bands( int dy , unsigned int threads ) :
+		m_dy(dy) ,
+		m_n(std::max(1U,std::min(threads,static_cast<unsigned int>(std::max(1,dy)))))
+	{
+	}
+	unsigned int count() const
+	{
+		return m_n ;
+	}
+	int first( unsigned int band ) const
+	{
+		return static_cast<int>( ( static_cast<unsigned long>(m_dy) * band ) / m_n ) ;
+	}
+	int last( unsigned int band ) const // one-past
+	{
+		return first( band + 1U ) ;
+	}
+} ;
+
+struct StageTimes
+{
+	unsigned int m_count ;
+	unsigned long m_decode ;
+	unsigned long m_equalise ;
+	unsigned long m_compare ;
+	unsigned int m_lut_updates ;
+	unsigned int m_gated ; // comparisons skipped by the dc gate
+	unsigned long m_gate ;
+	StageTimes() :
+		m_count(0U) ,
+		m_decode(0UL) ,
+		m_equalise(0UL) ,
+		m_compare(0UL) ,
+		m_lut_updates(0U) ,
+		m_gated(0U) ,
+		m_gate(0UL)
+	{
+	}
+	static unsigned long us( G::EpochTime t )
+	{
+		return static_cast<unsigned long>(t.s) * 1000000UL + static_cast<unsigned long>(t.us) ;
+	}
 } ;
 
 class Comparator
 {
 public:
-	Comparator( const std::string & mask_file , bool plain , bool equalise ) ;
-	DiffInfo apply( Gr::Image , const std::string & , const DiffParameters & ) ;
+	Comparator( G::ThreadPool & , Gr::ImageConverter & , const std::string & name , 
+		const std::string & mask_file , bool plain , bool equalise , unsigned int background ,
+		unsigned int dc_gate ) ;
+	DiffInfo apply( const G::PublisherView & , Gr::ImageType , const DiffParameters & , bool visualise ) ;
 	Gr::Image image() const ;
 	G::EpochTime maskTime() const ;
 
 private:
+	bool decode( const Gr::Image::Part & ) ;
+	bool gateOpen( const Gr::Image::Part & , const DiffParameters & , bool first ) ;
+	void updateMask( int dx , int dy ) ;
 	void equalise( Gr::ImageType , const Gr::ImageBuffer & , Gr::ImageBuffer & , const Gv::Mask & ) ;
-	DiffInfo compare( const DiffParameters & params , Gr::Image image_new ) ;
-	static DiffInfo compareImp( const DiffParameters & , int dx , int dy , 
-		const Gr::ImageDataWrapper & , const Gr::ImageDataWrapper & , Gr::ImageData & ,
-		const Gv::Mask & , bool plain ) ;
+	DiffInfo compare( const DiffParameters & params , Gr::Image image_new , bool visualise ) ;
+	void logTimes( G::EpochTime , G::EpochTime , G::EpochTime , G::EpochTime ) ;
+	void logTimes() ;
 
 private:
-	Gr::ImageConverter m_converter ;
+	G::ThreadPool & m_pool ;
+	Gr::ImageConverter & m_converter ;
+	std::string m_name ;
+	StageTimes m_times ;
 	Gr::Histogram m_histogram ;
-	Gr::Image m_image_in ;
+	Gr::Histogram m_lut_histogram ; // the histogram last used for the equalisation map
+	bool m_lut_valid ;
+	std::vector<Gr::Histogram> m_band_histograms ;
 	Gr::Image m_image_raw ;
 	Gr::Image m_image_eq ;
 	Gr::Image m_image_old ;
 	Gr::Image m_image_out ;
 	Gr::ImageType m_image_in_type ;
-	std::string m_type_str ;
 	std::string m_mask_file ;
 	unique_ptr<Gv::Mask> m_mask ;
 	G::EpochTime m_mask_time ;
 	bool m_plain ;
+	unsigned int m_background_time ;
+	unique_ptr<Gv::BackgroundModel> m_background ;
+	unsigned int m_dc_gate ;
+	Gr::JpegReader m_dc_reader ;
+	Gr::ImageData m_dc_image ;
+	std::vector<unsigned char> m_dc_reference ; // dc image at the last full comparison
 } ;
 
 class Watcher : private GNet::EventHandler , private Gv::CommandSocketMixin
@@ -174,7 +392,10 @@ public:
 		const std::string & recorder_socket_path , bool viewer , 
 		const std::string & viewer_title , int decoder_scale , const std::string & mask_file , 
 		bool once , unsigned int interval , unsigned int squelch , unsigned int threshold , 
-		int log_threshold , bool equalise , bool plain , unsigned int repeat_timeout ) ;
+		int log_threshold , bool equalise , bool plain , unsigned int repeat_timeout ,
+		G::ThreadPool & , Gr::ImageConverter & , unsigned int background , 
+		unsigned int zones_x , unsigned int zones_y , const std::vector<unsigned int> & zone_thresholds ,
+		unsigned int idle_interval , unsigned int idle_timeout , unsigned int dc_gate ) ;
 
 private:
 	void emitImage( Gr::Image ) ;
@@ -192,6 +413,7 @@ private:
 private:
 	Comparator m_comparator ;
 	DiffParameters m_params ;
+	RateGovernor m_governor ;
 	std::string m_input_channel_name ;
 	G::PublisherSubscription m_input_channel ;
 	std::string m_mask_file ;
@@ -204,8 +426,8 @@ private:
 	bool m_once ;
 	unsigned int m_image_number ;
 	G::EpochTime m_interval_start_time ;
-	Gr::Image m_image_in ;
-	std::string m_image_type_str ;
+	G::PublisherView m_image_in ;
+	Gr::ImageType m_image_in_type ;
 	GNet::Timer<Watcher> m_reopen_timer ;
 	unsigned int m_repeat_timeout ;
 	std::string m_repeat_text ;
@@ -220,10 +442,15 @@ Watcher::Watcher( const std::string & input_channel , const std::string & event_
 	const std::string & recorder_socket_path , bool viewer , 
 	const std::string & viewer_title , int decoder_scale , const std::string & mask_file , 
 	bool once , unsigned int interval , unsigned int squelch , unsigned int threshold ,
-	int log_threshold , bool equalise , bool plain , unsigned int repeat_timeout ) :
+	int log_threshold , bool equalise , bool plain , unsigned int repeat_timeout ,
+	G::ThreadPool & pool , Gr::ImageConverter & converter , unsigned int background , 
+	unsigned int zones_x , unsigned int zones_y , const std::vector<unsigned int> & zone_thresholds ,
+	unsigned int idle_interval , unsigned int idle_timeout , unsigned int dc_gate ) :
 		Gv::CommandSocketMixin(command_socket) ,
-		m_comparator(mask_file,plain,equalise) ,
-		m_params(G::EpochTime(0,interval*1000U),decoder_scale,squelch,threshold,log_threshold,equalise) ,
+		m_comparator(pool,converter,input_channel,mask_file,plain,equalise,background,dc_gate) ,
+		m_params(G::EpochTime(0,interval*1000U),decoder_scale,squelch,threshold,log_threshold,equalise,
+			zones_x,zones_y,zone_thresholds) ,
+		m_governor(idle_interval,idle_timeout) ,
 		m_input_channel_name(input_channel) ,
 		m_input_channel(m_input_channel_name,!once/*lazy*/) ,
 		m_mask_file(mask_file) ,
@@ -306,8 +533,8 @@ void Watcher::readEvent()
 {
 	G_DEBUG( "Watcher::readEvent: read event on channel [" << m_input_channel_name << "]" ) ;
 
-	// read the image
-	if( !Gr::Image::receive( m_input_channel , m_image_in , m_image_type_str ) )
+	// borrow the image -- it stays in the publisher's shared memory
+	if( !Gr::Image::borrow( m_input_channel , m_image_in , m_image_in_type ) )
 	{
 		if( m_once )
 		{
@@ -322,24 +549,32 @@ void Watcher::readEvent()
 		}
 		return ;
 	}
+	if( m_image_in.empty() )
+		return ;
 
 	// only compare if the old image is old enough
 	//
 	G::EpochTime now = G::DateTime::now() ;
 	G::EpochTime interval = now - m_interval_start_time ;
-	if( interval < m_params.m_interval )
+	if( interval < m_governor.interval(m_params) )
 		return ;
 	m_interval_start_time = now ;
 
-	// compare
-	DiffInfo diff_info = m_comparator.apply( m_image_in , m_image_type_str , m_params ) ;
+	// compare -- only generating the visualisation image if someone is looking
+	const bool visualise = m_output_viewer.viewing() || m_publish_images ;
+	DiffInfo diff_info = m_comparator.apply( m_image_in , m_image_in_type , m_params , visualise ) ;
 	if( diff_info.valid() )
 	{
 		// publish the results
-		emitImage( m_comparator.image() ) ;
+		if( visualise )
+			emitImage( m_comparator.image() ) ;
 		emitChangesEvent( now , diff_info ) ;
 		emitRecorderCommand( now , diff_info ) ;
 	}
+
+	// adapt the analysis rate
+	if( m_governor.update( now , diff_info.valid() && diff_info.triggered(m_params) ) )
+		G_LOG( "Watcher::readEvent: [" << m_input_channel_name << "] analysis rate: " << m_governor.str(m_params) ) ;
 }
 
 void Watcher::emitImage( Gr::Image image )
@@ -351,7 +586,7 @@ void Watcher::emitImage( Gr::Image image )
 
 void Watcher::emitChangesEvent( G::EpochTime now , const DiffInfo & diff_info )
 {
-	const bool emit_event = diff_info.m_count >= m_params.m_threshold ;
+	const bool emit_event = diff_info.triggered( m_params ) ;
 	const bool emit_log = m_params.m_log_threshold >= 0 && diff_info.m_count >= static_cast<unsigned int>(m_params.m_log_threshold) ;
 
 	if( emit_event || emit_log )
@@ -364,6 +599,7 @@ void Watcher::emitChangesEvent( G::EpochTime now , const DiffInfo & diff_info )
 			<< "'pid': " << ::getpid() << ", "
 			<< "'time': " << now.s << ", "
 			<< "'event': 'changes', "
+			<< "'channel': '" << m_input_channel_name << "', "
 			<< "'squelch': " << m_params.m_squelch << ", "
 			<< "'threshold': " << m_params.m_threshold << ", "
 			<< "'equalise': " << static_cast<int>(m_params.m_equalise) << ", "
@@ -371,7 +607,20 @@ void Watcher::emitChangesEvent( G::EpochTime now , const DiffInfo & diff_info )
 			<< "'masktime': '" << m_comparator.maskTime() << "', "
 			<< "'dx': " << diff_info.m_dx << ", "
 			<< "'dy': " << diff_info.m_dy << ", "
-			<< "'count': " << diff_info.m_count << ", "
+			<< "'count': " << diff_info.m_count << ", " ;
+		if( m_params.zoned() )
+		{
+			ss << "'grid': [" << diff_info.m_zones_x << ", " << diff_info.m_zones_y << "], " ;
+			ss << "'zones': [" ;
+			const char * sep = "" ;
+			for( std::vector<unsigned int>::const_iterator p = diff_info.m_zones.begin() ; p != diff_info.m_zones.end() ; ++p , sep = ", " )
+				ss << sep << *p ;
+			ss << "], " ;
+			if( diff_info.m_box_dx && diff_info.m_box_dy ) // (no empty lists for G::Item)
+				ss << "'box': [" << diff_info.m_box_x << ", " << diff_info.m_box_y << ", " 
+					<< diff_info.m_box_dx << ", " << diff_info.m_box_dy << "], " ;
+		}
+		ss
 			<< "'repeat': _""_repeat_""_ "
 			<< "}" ;
 		std::string s = ss.str() ;
@@ -393,6 +642,7 @@ void Watcher::emitStartEvent()
 		<< "'pid': " << ::getpid() << ", "
 		<< "'time': " << now.s << ", "
 		<< "'event': 'startup', "
+		<< "'channel': '" << m_input_channel_name << "', "
 		<< "'squelch': " << m_params.m_squelch << ", "
 		<< "'threshold': " << m_params.m_threshold << ", "
 		<< "'mask': '" << m_mask_file << "', "
@@ -419,7 +669,7 @@ void Watcher::emitEventText( std::string text )
 
 void Watcher::emitRecorderCommand( G::EpochTime , const DiffInfo & diff_info )
 {
-	if( diff_info.m_count >= m_params.m_threshold && !m_recorder_socket_path.empty() )
+	if( diff_info.triggered(m_params) && !m_recorder_socket_path.empty() )
 	{
 		m_recorder_socket.close() ;
 		std::string reason = m_recorder_socket.connect( m_recorder_socket_path , Gv::CommandSocket::NoThrow() ) ;
@@ -448,6 +698,12 @@ void Watcher::onCommandSocketData( std::string line )
 			m_params.m_squelch = G::Str::toUInt( words[1] ) ;
 		else if( ( words[0] == "equalise" || words[0] == "equalize"/*:-(*/ ) && !words[1].empty() )
 			m_params.m_equalise = G::Str::isPositive( words[1] ) ;
+		else if( words[0] == "zone-thresholds" && !words[1].empty() )
+			m_params.m_zone_thresholds = DiffParameters::thresholds( words[1] ) ;
+		else if( words[0] == "idle-interval" && G::Str::isUInt(words[1]) )
+			m_governor.m_idle_interval_ms = G::Str::toUInt( words[1] ) ;
+		else if( words[0] == "status" )
+			G_LOG_S( "Watcher::onCommandSocketData: [" << m_input_channel_name << "] analysis rate: " << m_governor.str(m_params) ) ;
 		else
 			G_WARNING( "Watcher::onCommandSocketData: invalid command: [" << G::Str::printable(*p) << "]" ) ;
 	}
@@ -460,11 +716,217 @@ void Watcher::onException( std::exception & )
 
 // ==
 
-Comparator::Comparator( const std::string & mask_file , bool plain , bool equalise ) :
+struct ScaleJob : G::ThreadPool::Job
+{
+	// reduces a band of output rows from a contiguous raw image
+	Bands m_bands ;
+	const unsigned char * m_p_in ;
+	int m_dx_in ;
+	int m_dy_in ;
+	int m_channels_in ;
+	int m_scale ;
+	std::vector<unsigned char*> m_rows_out ;
+	ScaleJob( const Bands & bands , const unsigned char * p_in , int dx_in , int dy_in , int channels_in , int scale ) :
+		m_bands(bands) ,
+		m_p_in(p_in) ,
+		m_dx_in(dx_in) ,
+		m_dy_in(dy_in) ,
+		m_channels_in(channels_in) ,
+		m_scale(scale)
+	{
+	}
+	virtual void run( unsigned int band ) override
+	{
+		const int y_out_first = m_bands.first( band ) ;
+		const int y_in_first = y_out_first * m_scale ;
+		const int y_in_last = std::min( m_bands.last(band) * m_scale , m_dy_in ) ;
+		if( y_in_first >= y_in_last ) return ;
+		const size_t drow_in = static_cast<size_t>(m_dx_in) * static_cast<size_t>(m_channels_in) ;
+		const unsigned char * p_in = m_p_in + drow_in * static_cast<size_t>(y_in_first) ;
+		Gr::AreaScaler scaler( m_dx_in , y_in_last-y_in_first , m_channels_in , m_scale , true ) ;
+		for( int y_in = y_in_first , y_out = y_out_first ; y_in < y_in_last ; y_in++ , p_in += drow_in )
+		{
+			scaler.add( p_in ) ;
+			if( scaler.ready() )
+				scaler.emit( m_rows_out.at(y_out++) ) ;
+		}
+	}
+} ;
+
+struct EqualiseJob : G::ThreadPool::Job
+{
+	// builds per-band histograms, or remaps per band once they are merged
+	Bands m_bands ;
+	int m_dx ;
+	const Gr::ImageDataWrapper & m_data_in ;
+	Gr::ImageData & m_data_out ;
+	const Gv::Mask * m_mask ;
+	std::vector<Gr::Histogram> & m_histograms ;
+	const unsigned char * m_lut ; // set for remapping
+	EqualiseJob( const Bands & bands , int dx , const Gr::ImageDataWrapper & data_in , Gr::ImageData & data_out ,
+		const Gv::Mask * mask , std::vector<Gr::Histogram> & histograms ) :
+			m_bands(bands) ,
+			m_dx(dx) ,
+			m_data_in(data_in) ,
+			m_data_out(data_out) ,
+			m_mask(mask) ,
+			m_histograms(histograms) ,
+			m_lut(nullptr)
+	{
+	}
+	virtual void run( unsigned int band ) override
+	{
+		const size_t n = static_cast<size_t>(m_dx) ;
+		for( int y = m_bands.first(band) ; y < m_bands.last(band) ; y++ )
+		{
+			const unsigned char * row_in = m_data_in.row( y ) ;
+			if( m_lut )
+			{
+				const unsigned char * lut = m_lut ;
+				unsigned char * row_out = m_data_out.row( y ) ;
+				for( size_t x = 0U ; x < n ; x++ )
+					row_out[x] = lut[row_in[x]] ;
+			}
+			else if( m_mask == nullptr )
+			{
+				m_histograms[band].add( row_in , n , nullptr ) ;
+			}
+			else
+			{
+				// add the pixels between the masked runs
+				size_t x = 0U ;
+				const Gv::Mask::Row & row = m_mask->row( y ) ;
+				for( Gv::Mask::Row::const_iterator p = row.begin() ; p != row.end() ; x = (p++)->x1 )
+					m_histograms[band].add( row_in+x , p->x0-x , nullptr ) ;
+				m_histograms[band].add( row_in+x , n-x , nullptr ) ;
+			}
+		}
+	}
+} ;
+
+struct CompareJob : G::ThreadPool::Job
+{
+	// counts and optionally visualises the changed pixels per band
+	Bands m_bands ;
+	const DiffParameters & m_params ;
+	int m_dx ;
+	const Gr::ImageDataWrapper & m_data_old ;
+	const Gr::ImageDataWrapper & m_data_new ;
+	Gr::ImageData * m_data_out ;
+	const Gv::Mask * m_mask ;
+	bool m_plain ;
+	Gv::BackgroundModel * m_background ;
+	unsigned int m_zones_x ;
+	unsigned int m_zones_y ;
+	std::vector<size_t> m_zone_x ; // column boundaries
+	std::vector<unsigned int> m_changed ; // per band per zone
+	std::vector<unsigned int> m_unmasked ; // per band
+	std::vector<unsigned char> m_changes ; // one row per band
+	CompareJob( const Bands & bands , const DiffParameters & params , int dx ,
+		const Gr::ImageDataWrapper & data_old , const Gr::ImageDataWrapper & data_new , Gr::ImageData * data_out ,
+		const Gv::Mask * mask , bool plain , Gv::BackgroundModel * background ) :
+			m_bands(bands) ,
+			m_params(params) ,
+			m_dx(dx) ,
+			m_data_old(data_old) ,
+			m_data_new(data_new) ,
+			m_data_out(data_out) ,
+			m_mask(mask) ,
+			m_plain(plain) ,
+			m_background(background) ,
+			m_zones_x(std::min(params.m_zones_x,static_cast<unsigned int>(std::max(1,dx)))) ,
+			m_zones_y(std::min(params.m_zones_y,static_cast<unsigned int>(std::max(1,bands.m_dy)))) ,
+			m_changed(bands.count()*m_zones_x*m_zones_y) ,
+			m_unmasked(bands.count())
+	{
+		for( unsigned int i = 0U ; i <= m_zones_x ; i++ )
+			m_zone_x.push_back( ( static_cast<size_t>(dx) * i ) / m_zones_x ) ;
+		if( m_background != nullptr && m_data_out != nullptr )
+			m_changes.resize( static_cast<size_t>(dx) * bands.count() ) ;
+	}
+	void count( const unsigned char * p_old , const unsigned char * p_new , size_t x0 , size_t x1 , 
+		unsigned int & changed , unsigned int & unmasked ) const
+	{
+		Gv::FrameDiff::count( p_old+x0 , p_new+x0 , nullptr , x1-x0 , m_params.m_squelch , changed , unmasked ) ;
+	}
+	void count( const Gv::Mask::Row & row , const unsigned char * p_old , const unsigned char * p_new , 
+		size_t x0 , size_t x1 , unsigned int & changed , unsigned int & unmasked ) const
+	{
+		// count the pixels between the masked runs that overlap x0-x1
+		size_t x = x0 ;
+		for( Gv::Mask::Row::const_iterator p = row.begin() ; p != row.end() && static_cast<size_t>(p->x0) < x1 ; ++p )
+		{
+			if( static_cast<size_t>(p->x0) > x )
+				count( p_old , p_new , x , p->x0 , changed , unmasked ) ;
+			x = std::max( x , static_cast<size_t>(p->x1) ) ;
+		}
+		if( x < x1 )
+			count( p_old , p_new , x , x1 , changed , unmasked ) ;
+	}
+	unsigned int zones() const
+	{
+		return m_zones_x * m_zones_y ;
+	}
+	unsigned int zoneRow( int y ) const
+	{
+		return static_cast<unsigned int>( ( static_cast<unsigned long>(y) * m_zones_y ) / static_cast<unsigned long>(m_bands.m_dy) ) ;
+	}
+	virtual void run( unsigned int band ) override
+	{
+		// each row is processed in zone-sized pieces so that changes can 
+		// be counted per zone in the one pass
+		const size_t n = static_cast<size_t>(m_dx) ;
+		unsigned int & unmasked = m_unmasked[band] ;
+		for( int y = m_bands.first(band) ; y < m_bands.last(band) ; y++ )
+		{
+			const unsigned char * p_old = m_data_old.row( y ) ;
+			const unsigned char * p_new = m_data_new.row( y ) ;
+			const unsigned char * p_mask = m_mask ? ( m_mask->plane() + y * n ) : nullptr ;
+			unsigned int * changed = &m_changed[(band*m_zones_y+zoneRow(y))*m_zones_x] ;
+			if( m_background != nullptr )
+			{
+				unsigned char * p_changes = m_changes.empty() ? nullptr : &m_changes[band*n] ;
+				for( unsigned int i = 0U ; i < m_zones_x ; i++ )
+				{
+					const size_t x = m_zone_x[i] ;
+					m_background->update( static_cast<int>(x) , y , m_zone_x[i+1]-x , p_new+x , p_mask?(p_mask+x):nullptr , 
+						m_params.m_squelch , changed[i] , unmasked , p_changes?(p_changes+x):nullptr ) ;
+				}
+				if( m_data_out != nullptr )
+					Gv::FrameDiff::visualise( p_changes , p_new , p_mask , n , m_plain , m_data_out->row(y) ) ;
+			}
+			else
+			{
+				for( unsigned int i = 0U ; i < m_zones_x ; i++ )
+				{
+					if( m_mask == nullptr )
+						count( p_old , p_new , m_zone_x[i] , m_zone_x[i+1] , changed[i] , unmasked ) ;
+					else
+						count( m_mask->row(y) , p_old , p_new , m_zone_x[i] , m_zone_x[i+1] , changed[i] , unmasked ) ;
+				}
+				if( m_data_out != nullptr )
+					Gv::FrameDiff::visualise( p_old , p_new , p_mask , n , m_params.m_squelch , m_plain , m_data_out->row(y) ) ;
+			}
+		}
+	}
+} ;
+
+// ==
+
+Comparator::Comparator( G::ThreadPool & pool , Gr::ImageConverter & converter , const std::string & name ,
+	const std::string & mask_file , bool plain , bool equalise , unsigned int background ,
+	unsigned int dc_gate ) :
+	m_pool(pool) ,
+	m_converter(converter) ,
+	m_name(name) ,
 	m_histogram(equalise) ,
+	m_lut_histogram(equalise) ,
+	m_lut_valid(false) ,
 	m_mask_file(mask_file) ,
 	m_mask_time(0) ,
-	m_plain(plain)
+	m_plain(plain) ,
+	m_background_time(background) ,
+	m_dc_gate(dc_gate)
 {
 }
 
@@ -478,33 +940,51 @@ G::EpochTime Comparator::maskTime() const
 	return m_mask_time ;
 }
 
-DiffInfo Comparator::apply( Gr::Image image_in , const std::string & type_str , const DiffParameters & params )
+DiffInfo Comparator::apply( const G::PublisherView & image_in , Gr::ImageType image_in_type , const DiffParameters & params , bool visualise )
 {
-	// decode to monochrome and subsample to a smaller raw image
-	if( ! m_converter.toRaw( image_in , m_image_raw , params.m_decoder_scale , true ) )
+	G::EpochTime t0 = G::DateTime::now() ;
+
+	// decode to monochrome and subsample to a smaller raw image, straight 
+	// out of the publisher's shared memory, using the publisher's reduced
+	// monochrome image if it has one that fits
+	bool ok = false ;
+	bool gated = false ;
+	try
+	{
+		Gr::Image::Part part = Gr::Image::select( image_in , image_in_type , false , params.m_decoder_scale , true ) ;
+		gated = m_dc_gate && part.type.isJpeg() && !gateOpen( part , params , m_image_in_type != image_in_type ) ;
+		ok = gated || decode( part ) ;
+	}
+	catch( std::exception & )
+	{
+		if( image_in.valid() ) throw ;
+	}
+	if( !image_in.valid() )
+	{
+		G_DEBUG( "Comparator::apply: image overwritten while decoding: dropped" ) ;
+		return DiffInfo() ;
+	}
+	if( gated )
+	{
+		m_times.m_gated++ ;
+		logTimes() ;
+		return DiffInfo() ;
+	}
+	if( !ok )
 	{
-		G_WARNING( "Watcher:run: invalid image [" << image_in.type() << "]" ) ;
+		G_WARNING( "Watcher:run: invalid image [" << image_in_type << "]" ) ;
 		return DiffInfo() ;
 	}
+	G::EpochTime t1 = G::DateTime::now() ;
 
 	// update the mask, ensuring it fits the image
-	bool first = m_image_in_type != image_in.type() ; // first image or size change
+	bool first = m_image_in_type != image_in_type ; // first image or size change
 	if( first )
 	{
-		G_LOG( "Watcher::run: " << (m_image_in_type.valid()?"change of":"initial") << " image type: [" << image_in.type() << "]" ) ;
-		m_image_in_type = image_in.type() ;
-		m_mask.reset( new Gv::Mask(m_image_raw.type().dx(),m_image_raw.type().dy(),m_mask_file) ) ; 
-		m_mask_time = m_mask->time() ;
-	}
-	else
-	{
-		G_ASSERT( m_mask.get() != nullptr ) ;
-		if( m_mask->update() )
-		{
-			G_LOG( "Comparator::apply: mask re-read from [" << m_mask_file << "]" ) ;
-			m_mask_time = m_mask->time() ;
-		}
+		G_LOG( "Watcher::run: [" << m_name << "]: " << (m_image_in_type.valid()?"change of":"initial") << " image type: [" << image_in_type << "]" ) ;
+		m_image_in_type = image_in_type ;
 	}
+	updateMask( m_image_raw.type().dx() , m_image_raw.type().dy() ) ;
 
 	// pre-process the image
 	if( params.m_equalise )
@@ -513,15 +993,105 @@ DiffInfo Comparator::apply( Gr::Image image_in , const std::string & type_str ,
 		Gr::ImageType raw_type = m_image_raw.type() ;
 		equalise( raw_type , m_image_raw.data() , *Gr::Image::blank(m_image_eq,raw_type) , *m_mask ) ;
 	}
+	G::EpochTime t2 = G::DateTime::now() ;
 
-	// compare new with old
-	DiffInfo diff_info = first ? DiffInfo() : compare( params , params.m_equalise?m_image_eq:m_image_raw ) ;
+	// (re)initialise the background model
+	if( m_background_time && ( first || m_background.get() == nullptr ) )
+	{
+		Gr::Image image = params.m_equalise ? m_image_eq : m_image_raw ;
+		const int dx = image.type().dx() ;
+		const int dy = image.type().dy() ;
+		const Gr::ImageDataWrapper data( image.data() , dx , dy , 1 ) ;
+		m_background.reset( new Gv::BackgroundModel(dx,dy,m_background_time) ) ;
+		for( int y = 0 ; y < dy ; y++ )
+			m_background->init( y , data.row(y) ) ;
+	}
+
+	// compare new with old, or with the background
+	DiffInfo diff_info = first ? DiffInfo() : compare( params , params.m_equalise?m_image_eq:m_image_raw , visualise ) ;
+	if( !first )
+		logTimes( t0 , t1 , t2 , G::DateTime::now() ) ;
 
 	// make new old
 	m_image_old = ( params.m_equalise ? m_image_eq : m_image_raw ) ;
 	return diff_info ;
 }
 
+void Comparator::updateMask( int dx , int dy )
+{
+	// the mask is read once and then resampled as necessary, with the
+	// resampled copies cached so that the full-size and dc-gate sizes 
+	// can alternate cheaply
+	if( m_mask.get() == nullptr )
+	{
+		m_mask.reset( new Gv::Mask(dx,dy,m_mask_file) ) ;
+	}
+	else if( m_mask->update() )
+	{
+		G_LOG( "Comparator::apply: mask re-read from [" << m_mask_file << "]" ) ;
+	}
+	m_mask->resize( dx , dy ) ;
+	m_mask_time = m_mask->time() ;
+}
+
+bool Comparator::gateOpen( const Gr::Image::Part & part , const DiffParameters & params , bool first )
+{
+	// decode just the dc coefficients and compare with the dc image from the 
+	// last full comparison -- a full comparison is only needed if there are
+	// enough changes at this coarse scale
+	G::EpochTime t0 = G::DateTime::now() ;
+	m_dc_reader.decodeDc( m_dc_image , part.p , part.n ) ;
+	const int dx = m_dc_image.dx() ;
+	const int dy = m_dc_image.dy() ;
+	const size_t n = static_cast<size_t>(dx) ;
+	const bool resized = m_dc_reference.size() != (n*dy) ;
+	updateMask( dx , dy ) ;
+
+	bool open = true ;
+	if( !first && !resized )
+	{
+		unsigned int changed = 0U ;
+		unsigned int unmasked = 0U ;
+		const unsigned char * mask = m_mask->empty() ? nullptr : m_mask->plane() ;
+		for( int y = 0 ; y < dy ; y++ )
+			Gv::FrameDiff::count( &m_dc_reference[y*n] , m_dc_image.row(y) , mask ? (mask+y*n) : nullptr ,
+				n , params.m_squelch , changed , unmasked ) ;
+		open = changed >= m_dc_gate ;
+	}
+	if( open )
+	{
+		m_dc_reference.resize( n*dy ) ;
+		for( int y = 0 ; y < dy ; y++ )
+			std::copy( m_dc_image.row(y) , m_dc_image.row(y)+n , m_dc_reference.begin()+y*n ) ;
+	}
+	m_times.m_gate += StageTimes::us( G::DateTime::now() - t0 ) ;
+	return open ;
+}
+
+bool Comparator::decode( const Gr::Image::Part & part )
+{
+	// raw images are reduced in bands across the thread pool, but compressed
+	// images are decoded on this thread since a jpeg stream is not divisible
+	const int channels_in = part.type.isRaw() ? part.type.channels() : 0 ;
+	const bool banded = m_pool.threads() > 1U && part.p != nullptr && 
+		( channels_in == 1 || channels_in == 3 ) && ( part.scale > 1 || channels_in == 3 ) &&
+		part.n == part.type.size() ;
+	if( !banded )
+		return m_converter.toRaw( part.p , part.n , part.type , m_image_raw , part.scale , true ) ;
+
+	Gr::ImageType type_out = Gr::ImageType::raw( part.type , std::max(1,part.scale) , true ) ;
+	Gr::ImageBuffer * image_out_p = Gr::Image::blank( m_image_raw , type_out ) ;
+	Gr::ImageData image_data_out( *image_out_p , type_out.dx() , type_out.dy() , 1 ) ;
+
+	ScaleJob job( Bands(type_out.dy(),m_pool.threads()) , reinterpret_cast<const unsigned char*>(part.p) ,
+		part.type.dx() , part.type.dy() , channels_in , std::max(1,part.scale) ) ;
+	job.m_rows_out.reserve( type_out.dy() ) ;
+	for( int y = 0 ; y < type_out.dy() ; y++ )
+		job.m_rows_out.push_back( image_data_out.row(y) ) ;
+	m_pool.run( job , job.m_bands.count() ) ;
+	return m_image_raw.valid() ;
+}
+
 void Comparator::equalise( Gr::ImageType type , const Gr::ImageBuffer & image_buffer_in , 
 	Gr::ImageBuffer & image_buffer_out , const Gv::Mask & mask )
 {
@@ -531,35 +1101,37 @@ void Comparator::equalise( Gr::ImageType type , const Gr::ImageBuffer & image_bu
 	const Gr::ImageDataWrapper image_data_in( image_buffer_in , type.dx() , type.dy() , type.channels() ) ;
 	Gr::ImageData image_data_out( image_buffer_out , type.dx() , type.dy() , type.channels() ) ;
 
-	const int dx = type.dx() ;
-	const int dy = type.dy() ;
+	// build a histogram for each band and then merge them
+	Bands bands( type.dy() , m_pool.threads() ) ;
+	m_band_histograms.resize( bands.count() ) ;
+	for( std::vector<Gr::Histogram>::iterator p = m_band_histograms.begin() ; p != m_band_histograms.end() ; ++p )
+		p->clear() ;
+	EqualiseJob job( bands , type.dx() , image_data_in , image_data_out ,
+		mask.empty() ? nullptr : &mask , m_band_histograms ) ;
+	m_pool.run( job , bands.count() ) ;
 
-	// build the histogram
 	m_histogram.clear() ;
-	for( int y = 0 ; y < dy ; y++ )
+	for( std::vector<Gr::Histogram>::iterator p = m_band_histograms.begin() ; p != m_band_histograms.end() ; ++p )
+		m_histogram.add( *p ) ;
+
+	// only recompute the equalisation map if it would change by more than a
+	// couple of levels, so that small fluctuations in the histogram do not
+	// show up as changed pixels
+	const unsigned int tolerance = 2U ;
+	if( !m_lut_valid || m_histogram.distance(m_lut_histogram) > tolerance )
 	{
-		const unsigned char * row = image_data_in.row( y ) ;
-		for( int x = 0 ; x < dx ; x++ )
-		{
-			bool masked = mask.masked( x , y ) ;
-			if( !masked )
-				m_histogram.add( row[x] ) ;
-		}
+		m_lut_histogram = m_histogram ;
+		m_lut_histogram.compute() ;
+		m_lut_valid = true ;
+		m_times.m_lut_updates++ ;
 	}
-	m_histogram.compute() ;
 
 	// map pixel values according to the histogram
-	for( int y = 0 ; y < dy ; y++ )
-	{
-		const unsigned char * row = image_data_in.row( y ) ;
-		for( int x = 0 ; x < dx ; x++ )
-		{
-			image_data_out.rgb( x , y , m_histogram.map(row[x]) , 0 , 0 ) ;
-		}
-	}
+	job.m_lut = m_lut_histogram.lut() ;
+	m_pool.run( job , bands.count() ) ;
 }
 
-DiffInfo Comparator::compare( const DiffParameters & params , Gr::Image image_new )
+DiffInfo Comparator::compare( const DiffParameters & params , Gr::Image image_new , bool visualise )
 {
 	G_DEBUG( "Comparator::compare: diff images [" << m_image_old.type() << "] [" << image_new.type() << "] [" << m_image_out.type() << "]" ) ;
 	G_ASSERT( m_image_old.type().isRaw() ) ;
@@ -569,65 +1141,64 @@ DiffInfo Comparator::compare( const DiffParameters & params , Gr::Image image_ne
 	int dx = m_image_old.type().dx() ;
 	int dy = m_image_old.type().dy() ;
 
-	Gr::ImageBuffer * image_out_p = Gr::Image::blank( m_image_out , Gr::ImageType::raw(image_new.type().dx(),image_new.type().dy(),3) ) ;
-	Gr::ImageData data_out( *image_out_p , dx , dy , 3 ) ;
+	unique_ptr<Gr::ImageData> data_out ;
+	if( visualise )
+	{
+		Gr::ImageBuffer * image_out_p = Gr::Image::blank( m_image_out , Gr::ImageType::raw(image_new.type().dx(),image_new.type().dy(),3) ) ;
+		data_out.reset( new Gr::ImageData( *image_out_p , dx , dy , 3 ) ) ;
+	}
 
-	return compareImp( params , dx , dy ,
-		Gr::ImageDataWrapper(m_image_old.data(),dx,dy,1) ,
-		Gr::ImageDataWrapper(image_new.data(),dx,dy,1) ,
-		data_out , *m_mask , m_plain ) ;
-}
+	const Gr::ImageDataWrapper data_old( m_image_old.data() , dx , dy , 1 ) ;
+	const Gr::ImageDataWrapper data_new( image_new.data() , dx , dy , 1 ) ;
+	CompareJob job( Bands(dy,m_pool.threads()) , params , dx , data_old , data_new , data_out.get() , 
+		m_mask->empty() ? nullptr : m_mask.get() , m_plain , m_background.get() ) ;
+	m_pool.run( job , job.m_bands.count() ) ;
 
-DiffInfo Comparator::compareImp( const DiffParameters & params , int dx , int dy ,
-	const Gr::ImageDataWrapper & data_old , const Gr::ImageDataWrapper & data_new , 
-	Gr::ImageData & data_out , const Gv::Mask & mask , bool plain_output )
-{
+	// merge the bands
 	DiffInfo diff_info( dx , dy ) ;
-	for( int y = 0 ; y < dy ; y++ )
+	diff_info.m_zones_x = job.m_zones_x ;
+	diff_info.m_zones_y = job.m_zones_y ;
+	diff_info.m_zones.assign( job.zones() , 0U ) ;
+	unsigned int unmasked = 0U ;
+	for( unsigned int band = 0U ; band < job.m_bands.count() ; band++ )
 	{
-		const unsigned char * p_old = data_old.row( y ) ;
-		const unsigned char * p_new = data_new.row( y ) ;
-		unsigned char * p_out = data_out.row( y ) ;
-		for( int x = 0 ; x < dx ; x++ , ++p_old , ++p_new , p_out += 3 )
-		{
-			unsigned int dluma = *p_old > *p_new ? (*p_old - *p_new) : (*p_new - *p_old) ;
-			unsigned int luma_dimmed = (*p_new)/4U ;
-			bool masked = mask.masked(x,y) ;
-
-			if( plain_output && masked )
-			{
-				p_out[0] = 0 ;
-				p_out[1] = 0 ;
-				p_out[2] = 0 ;
-			}
-			else if( plain_output )
-			{
-				p_out[0] = p_new[0] ;
-				p_out[1] = p_new[0] ;
-				p_out[2] = p_new[0] ;
-			}
-			else if( masked )
-			{
-				p_out[0] = luma_dimmed ;
-				p_out[1] = 0U ;
-				p_out[2] = 0U ;
-			}
-			else
-			{
-				// dimmed grey or bright green
-				p_out[0] = luma_dimmed ;
-				p_out[1] = dluma > params.m_squelch ? 255U : luma_dimmed ;
-				p_out[2] = luma_dimmed ;
-			}
+		for( unsigned int zone = 0U ; zone < job.zones() ; zone++ )
+			diff_info.m_zones[zone] += job.m_changed[band*job.zones()+zone] ;
+		unmasked += job.m_unmasked[band] ;
+	}
+	for( unsigned int zone = 0U ; zone < job.zones() ; zone++ )
+		diff_info.m_count += diff_info.m_zones[zone] ;
+	diff_info.m_noise = unmasked - diff_info.m_count ;
 
-			if( !masked )
+	// check the zone thresholds and find the bounding box of the active 
+	// zones, ie. the zones at or above their threshold, or zones with 
+	// any changes if they have no threshold
+	if( params.zoned() )
+	{
+		unsigned int x_min = diff_info.m_zones_x , y_min = diff_info.m_zones_y , x_max = 0U , y_max = 0U ;
+		for( unsigned int zone = 0U ; zone < job.zones() ; zone++ )
+		{
+			const unsigned int threshold = params.zoneThreshold( zone ) ;
+			const unsigned int count = diff_info.m_zones[zone] ;
+			if( threshold != 0U && count >= threshold )
+				diff_info.m_zone_triggered = true ;
+			if( count != 0U && count >= threshold )
 			{
-				if( dluma > params.m_squelch )
-					diff_info.m_count++ ;
-				else
-					diff_info.m_noise++ ;
+				const unsigned int zx = zone % diff_info.m_zones_x ;
+				const unsigned int zy = zone / diff_info.m_zones_x ;
+				x_min = std::min( x_min , zx ) ; x_max = std::max( x_max , zx ) ;
+				y_min = std::min( y_min , zy ) ; y_max = std::max( y_max , zy ) ;
 			}
 		}
+		if( x_min <= x_max && y_min <= y_max )
+		{
+			const unsigned int y_first = static_cast<unsigned int>( ( static_cast<unsigned long>(dy) * y_min ) / diff_info.m_zones_y ) ;
+			const unsigned int y_last = static_cast<unsigned int>( ( static_cast<unsigned long>(dy) * (y_max+1U) ) / diff_info.m_zones_y ) ;
+			diff_info.m_box_x = static_cast<unsigned int>( job.m_zone_x[x_min] ) ;
+			diff_info.m_box_dx = static_cast<unsigned int>( job.m_zone_x[x_max+1U] - job.m_zone_x[x_min] ) ;
+			diff_info.m_box_y = y_first ;
+			diff_info.m_box_dy = y_last - y_first ;
+		}
 	}
 
 	if( G::Test::enabled("watcher-large-diff-count") )
@@ -638,8 +1209,40 @@ DiffInfo Comparator::compareImp( const DiffParameters & params , int dx , int dy
 	return diff_info ;
 }
 
+void Comparator::logTimes( G::EpochTime t0 , G::EpochTime t1 , G::EpochTime t2 , G::EpochTime t3 )
+{
+	m_times.m_count++ ;
+	m_times.m_decode += StageTimes::us( t1 - t0 ) ;
+	m_times.m_equalise += StageTimes::us( t2 - t1 ) ;
+	m_times.m_compare += StageTimes::us( t3 - t2 ) ;
+	logTimes() ;
+}
+
+void Comparator::logTimes()
+{
+	const unsigned int images = m_times.m_count + m_times.m_gated ;
+	if( images >= 100U )
+	{
+		const unsigned int count = std::max( 1U , m_times.m_count ) ;
+		G_LOG( "Comparator::logTimes: [" << m_name << "]: mean stage times over " << m_times.m_count << " images with " 
+			<< m_pool.threads() << " thread" << (m_pool.threads()==1U?"":"s") << ": "
+			<< "decode=" << (m_times.m_decode/count) << "us "
+			<< "equalise=" << (m_times.m_equalise/count) << "us "
+			<< "compare=" << (m_times.m_compare/count) << "us"
+			<< (m_lut_valid?(" equalisation-updates="+G::Str::fromUInt(m_times.m_lut_updates)):std::string())
+			<< (m_dc_gate?(" gated="+G::Str::fromUInt(m_times.m_gated)+" gate="+G::Str::fromULong(m_times.m_gate/images)+"us"):std::string()) ) ;
+		m_times = StageTimes() ;
+	}
+}
+
 // ==
 
+static std::string expand( std::string s , const std::string & channel_name )
+{
+	G::Str::replaceAll( s , "%c" , channel_name ) ;
+	return s ;
+}
+
 int main( int argc, char ** argv )
 {
 	try
@@ -671,37 +1274,75 @@ int main( int argc, char ** argv )
 			"C!command-socket!socket for update commands!!1!path!1" "|"
 			"e!plain!do not show changed-pixel highlights! in output images!0!!1" "|"
 			"W!repeat-timeout!send events repeatedly! with the given period!1!seconds!1" "|"
+			"T!threads!number of image analysis threads! (default 1)!1!count!1" "|"
+			"k!background!use a background model! with the given time constant in images!1!images!1" "|"
+			"z!zones!count changes in a grid of zones! (eg. 4x3)!1!grid!1" "|"
+			"Z!zone-thresholds!per-zone pixel count thresholds! as a comma-separated list!1!list!1" "|"
+			"I!idle-interval!time interval between comparisons when idle! (default 0 for no idling)!1!ms!1" "|"
+			"J!idle-timeout!time without detections before idling! (default 10)!1!seconds!1" "|"
+			"g!dc-gate!skip full comparisons of jpeg images! unless enough eighth-scale pixels have changed!1!pixels!1" "|"
 		) ;
-		std::string args_help = "<input-channel>" ;
-		Gv::Startup startup( opt , args_help , opt.args().c() == 2U ) ;
+		std::string args_help = "<input-channel> [<input-channel> ...]" ;
+		Gv::Startup startup( opt , args_help , opt.args().c() >= 2U ) ;
 		try
 		{
-			std::string input_channel_name = opt.args().v(1U) ;
+			G::StringArray input_channel_names ;
+			for( unsigned int i = 1U ; i < opt.args().c() ; i++ )
+				input_channel_names.push_back( opt.args().v(i) ) ;
+			const bool multi = input_channel_names.size() > 1U ;
 			bool viewer = opt.contains( "viewer" ) ;
 			std::string event_channel = opt.value( "event-channel" ) ;
 			std::string images_channel = opt.value( "image-channel" ) ;
 			std::string recorder = opt.value( "recorder" ) ;
-			std::string viewer_title = opt.value( "viewer-title" , input_channel_name ) ;
+			std::string viewer_title = opt.value( "viewer-title" , "%c" ) ;
 			std::string mask_file = opt.value( "mask" ) ;
 			bool once = opt.contains( "once" ) ;
 			bool equalise = opt.contains( "equalise" ) || opt.contains( "equalize" ) ;
 			bool plain = opt.contains( "plain" ) ;
 			unsigned int interval = G::Str::toUInt( opt.value("interval","250") ) ;
+			unsigned int idle_interval = G::Str::toUInt( opt.value("idle-interval","0") ) ;
+			unsigned int idle_timeout = G::Str::toUInt( opt.value("idle-timeout","10") ) ;
+			unsigned int dc_gate = G::Str::toUInt( opt.value("dc-gate","0") ) ;
 			unsigned int squelch = G::Str::toUInt( opt.value("squelch","50") ) ;
 			unsigned int threshold = G::Str::toUInt( opt.value("threshold","100") ) ;
 			int log_threshold = G::Str::toInt( opt.value("log-threshold","-1") ) ;
 			int scale = static_cast<int>( G::Str::toUInt(opt.value("scale","1")) ) ;
 			std::string command_socket = opt.value("command-socket","") ;
 			unsigned int repeat_timeout = G::Str::toUInt( opt.value("repeat-timeout","0") ) ;
+			unsigned int threads = G::Str::toUInt( opt.value("threads","1") ) ;
+			unsigned int background = G::Str::toUInt( opt.value("background","0") ) ;
+			G::StringArray zones = G::Str::splitIntoTokens( opt.value("zones","1x1") , "x" ) ;
+			if( zones.size() != 2U || !G::Str::isUInt(zones[0]) || !G::Str::isUInt(zones[1]) )
+				throw std::runtime_error( "invalid zones: use <columns>x<rows>" ) ;
+			std::vector<unsigned int> zone_thresholds = DiffParameters::thresholds( opt.value("zone-thresholds","") ) ;
+
+			// with more than one input channel the output channels and sockets 
+			// must be distinguished by a "%c" placeholder for the channel name
+			if( multi && (
+				( !event_channel.empty() && event_channel.find("%c") == std::string::npos ) ||
+				( !images_channel.empty() && images_channel.find("%c") == std::string::npos ) ||
+				( !command_socket.empty() && command_socket.find("%c") == std::string::npos ) ) )
+					throw std::runtime_error( "output channel names and the command socket path must contain "
+						"\"%c\" when there is more than one input channel" ) ;
 
 			GNet::TimerList timer_list ;
 			unique_ptr<GNet::EventLoop> event_loop( GNet::EventLoop::create() ) ;
 
-			Watcher watcher( input_channel_name , event_channel , images_channel ,
-				command_socket , recorder , viewer , viewer_title ,
-				scale , mask_file , once ,
-				interval , squelch , threshold , log_threshold , equalise , plain , 
-				repeat_timeout ) ;
+			// one watcher per input channel, sharing the image decoder and thread pool
+			G::ThreadPool pool( threads ) ;
+			Gr::ImageConverter converter ;
+			std::vector<shared_ptr<Watcher> > watchers ;
+			for( G::StringArray::iterator p = input_channel_names.begin() ; p != input_channel_names.end() ; ++p )
+			{
+				const std::string & name = *p ;
+				watchers.push_back( shared_ptr<Watcher>( new Watcher( name , expand(event_channel,name) , 
+					expand(images_channel,name) , expand(command_socket,name) , expand(recorder,name) , 
+					viewer , expand(viewer_title,name) , scale , expand(mask_file,name) , once ,
+					interval , squelch , threshold , log_threshold , equalise , plain , 
+					repeat_timeout , pool , converter , background ,
+					G::Str::toUInt(zones[0]) , G::Str::toUInt(zones[1]) , zone_thresholds ,
+					idle_interval , idle_timeout , dc_gate ) ) ) ;
+			}
 
 			startup.start() ;
 
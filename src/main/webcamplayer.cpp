@@ -62,8 +62,8 @@
 class WebcamPlayer : private Gv::ImageInputHandler , private GNet::EventExceptionHandler
 {
 public:
-	WebcamPlayer( Gr::ImageConverter & , const std::string & channel , bool with_viewer , 
-		const std::string & dev_name , const std::string & dev_config , 
+	WebcamPlayer( Gr::ImageConverter & , const std::string & channel , size_t channel_history , 
+		int channel_luma , bool with_viewer , const std::string & dev_name , const std::string & dev_config , 
 		bool once , unsigned int reopen_timeout , 
 		int scale , bool monochrome , const std::string & caption , 
 		const Gv::Timezone & caption_tz ) ;
@@ -89,8 +89,8 @@ private:
 
 // ==
 
-WebcamPlayer::WebcamPlayer( Gr::ImageConverter & converter , const std::string & channel , bool with_viewer , 
-	const std::string & dev_name , const std::string & dev_config , 
+WebcamPlayer::WebcamPlayer( Gr::ImageConverter & converter , const std::string & channel , size_t channel_history , 
+	int channel_luma , bool with_viewer , const std::string & dev_name , const std::string & dev_config , 
 	bool once , unsigned int reopen_timeout , 
 	int scale , bool monochrome , const std::string & caption , 
 	const Gv::Timezone & caption_tz ) :
@@ -113,7 +113,9 @@ WebcamPlayer::WebcamPlayer( Gr::ImageConverter & converter , const std::string &
 		G::Item info = G::Item::map() ;
 		info.add( "tz" , caption_tz.str() ) ;
 		info.add( "device" , dev_name ) ;
-		m_image_output.startPublisher( channel , info ) ;
+		m_image_output.startPublisher( channel , info , G::PublisherConfig(channel_history) ) ;
+		if( channel_luma > 0 )
+			m_image_output.addRepresentation( false , channel_luma , true ) ;
 	}
 
 	// issue a warning if the webcam device is not yet available
@@ -178,6 +180,8 @@ int main( int argc, char ** argv )
 			"C!caption-text!defines the caption text! in ascii, with %t for a timestamp!1!text!1" "|"
 			"w!viewer!run a viewer!!0!!1" "|"
 			"c!channel!publish to the named channel!!1!channel!1" "|"
+			"H!channel-history!number of recent images kept in the channel! for lead-in!1!count!1" "|"
+			"M!channel-luma!add a reduced monochrome image to each publication!!1!divisor!1" "|"
 			"s!scale!reduce the image size!!1!divisor!1" "|"
 			"z!tz!timezone offset! for the caption!1!hours!1" "|"
 			"o!monochrome!convert to monochrome!!0!!1" "|"
@@ -190,6 +194,8 @@ int main( int argc, char ** argv )
 		{
 			std::string dev_name = opt.value("device","/dev/video0") ;
 			std::string channel = opt.value("channel",std::string()) ;
+			size_t channel_history = static_cast<size_t>( G::Str::toUInt(opt.value("channel-history","0")) ) ;
+			int channel_luma = G::Str::toInt(opt.value("channel-luma","0")) ;
 			bool with_viewer = opt.contains("viewer") ;
 			std::string caption = opt.contains("caption") ? opt.value("caption-text","%t") : std::string() ;
 			std::string dev_config = G::Str::tail( dev_name , dev_name.find(';') , std::string() ) ;
@@ -207,7 +213,7 @@ int main( int argc, char ** argv )
 			unique_ptr<GNet::EventLoop> event_loop( GNet::EventLoop::create() ) ;
 
 			Gr::ImageConverter converter ;
-			WebcamPlayer webcam_player( converter , channel , with_viewer , dev_name , dev_config , 
+			WebcamPlayer webcam_player( converter , channel , channel_history , channel_luma , with_viewer , dev_name , dev_config , 
 				once , retry , scale , monochrome , caption , Gv::Timezone(caption_tz) ) ;
 
 			startup.start() ;